@@ -161,6 +161,9 @@ FCS_SHARED_LIB = libfreecell-solver.so.0
 TARGETS = fc-solve $(FCS_SHARED_LIB) \
           freecell-solver-range-parallel-solve \
           freecell-solver-multi-thread-solve \
+          freecell-solver-parallel-dfs-solve \
+          freecell-solver-endgame-db-gen \
+          freecell-solver-pattern-db-gen \
           freecell-solver-fork-solve \
           freecell-solver-fc-pro-range-solve
 
@@ -268,6 +271,21 @@ freecell-solver-range-parallel-solve: test_multi_parallel.o $(STATIC_LIB)
 freecell-solver-multi-thread-solve: threaded_range_solver.o $(STATIC_LIB)
 	$(CC) $(TCMALLOC_LINK) $(LFLAGS) -o $@ $(LIB_LINK_PRE) $< $(LIB_LINK_POST) -lpthread $(END_LFLAGS)
 
+freecell-solver-parallel-dfs-solve: parallel_dfs_solver.o $(STATIC_LIB)
+	$(CC) $(TCMALLOC_LINK) $(LFLAGS) -o $@ $(LIB_LINK_PRE) $< $(LIB_LINK_POST) -lpthread $(END_LFLAGS)
+
+freecell-solver-befs-weights-tuner: befs_weights_tuner.o $(STATIC_LIB)
+	$(CC) $(TCMALLOC_LINK) $(LFLAGS) -o $@ $(LIB_LINK_PRE) $< $(LIB_LINK_POST) -lpthread $(END_LFLAGS)
+
+freecell-solver-endgame-db-gen: endgame_db_gen.o
+	$(CC) $(LFLAGS) -o $@ $< $(END_LFLAGS)
+
+freecell-solver-pattern-db-gen: pattern_db_gen.o
+	$(CC) $(LFLAGS) -o $@ $< $(END_LFLAGS)
+
+freecell-solver-flares-plan-synth: flares_plan_synth.o
+	$(CC) $(LFLAGS) -o $@ $< $(END_LFLAGS)
+
 freecell-solver-fork-solve: forking_range_solver.o $(STATIC_LIB)
 	$(CC) $(TCMALLOC_LINK) $(LFLAGS) -o $@ $(LIB_LINK_PRE) $< $(LIB_LINK_POST) -lpthread $(END_LFLAGS)
 
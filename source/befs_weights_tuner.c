@@ -0,0 +1,521 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ *  befs_weights_tuner.c - searches for the BeFS weights (and optionally
+ *  the iterations' quota) of a scan that solve a range of boards from
+ *  the Microsoft/Freecell Pro deals with the fewest iterations.
+ *
+ *  The search is a successive halving: a pool of candidates is evaluated
+ *  on a small sample of the deals, the better half of it is evaluated
+ *  again on a sample twice as large, and so on until the last round runs
+ *  on the entire range. A candidate stops being evaluated once its total
+ *  exceeds that of the best candidate of the round so far, and the
+ *  candidates are evaluated in several POSIX threads.
+ *
+ *  See also:
+ *      - measure_depth_dep_tests_order_performance.c
+ *      - scripts/process-measure-output.pl
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "alloc_wrap.h"
+#include "portable_int64.h"
+
+#include "fcs_user.h"
+#include "fcs_cl.h"
+#include "fcs_enums.h"
+#include "unused.h"
+#include "inline.h"
+#include "bool.h"
+#include "rand.h"
+#include "min_and_max.h"
+
+#include "range_solvers_gen_ms_boards.h"
+
+static void print_help(void)
+{
+    printf("\n%s",
+"freecell-solver-befs-weights-tuner start end\n"
+"   [--num-workers n] [--num-candidates n] [--num-rounds n] [--seed seed]\n"
+"   [--total-iterations-limit limit] [--tune-step min,max]\n"
+"   [--preset-output filename] [fc-solve Arguments...]\n"
+"\n"
+"Searches for the BeFS weights (-asw) of the last soft thread in the\n"
+"fc-solve arguments, which solve the boards from start to end (inclusive)\n"
+"with the fewest iterations.\n"
+"\n"
+"--num-workers n\n"
+"     The number of threads to use (default: 3).\n"
+"--num-candidates n\n"
+"     The number of candidates in the first round (default: 16), including\n"
+"     the weights of the given arguments.\n"
+"--num-rounds n\n"
+"     The number of rounds (default: 4).\n"
+"--seed seed\n"
+"     The seed of the random candidates (default: 1).\n"
+"--total-iterations-limit limit\n"
+"     Limits each board for up to 'limit' iterations (default: 100000).\n"
+"     Unsolved boards count as 'limit' iterations.\n"
+"--tune-step min,max\n"
+"     Also search for the iterations' quota (-step) of the soft thread.\n"
+"--preset-output filename\n"
+"     Writes the best configuration as a preset file (see the files under\n"
+"     share/freecell-solver/presets).\n"
+          );
+}
+
+typedef struct
+{
+    /* Whether to keep the weights and step of the given arguments. */
+    fcs_bool_t is_given;
+    double weights[FCS_NUM_BEFS_WEIGHTS];
+    int step;
+    /* The number of boards that were solved in the last round before the
+     * evaluation was complete or cut off, and the iterations they took. */
+    int num_boards;
+    fcs_int64_t total;
+    fcs_bool_t was_cut_off;
+} candidate_t;
+
+static const pthread_mutex_t initial_mutex_constant =
+    PTHREAD_MUTEX_INITIALIZER
+    ;
+
+typedef struct {
+    int argc;
+    char * * argv;
+    int arg;
+    int start_board;
+    fcs_int_limit_t total_iterations_limit_per_board;
+
+    candidate_t * candidates;
+    int num_candidates;
+    /* The boards of the current round. */
+    int past_end_board;
+
+    pthread_mutex_t lock;
+    int next_candidate;
+    /* The best total of the current round, or -1 if there is none yet. */
+    fcs_int64_t best_total;
+} context_t;
+
+static context_t context = {.arg = 1, .total_iterations_limit_per_board = 100000};
+
+static GCC_INLINE void * alloc_instance(const candidate_t * const candidate)
+{
+    void * const instance = freecell_solver_user_alloc();
+
+    int arg = context.arg;
+    char * error_string;
+    switch(
+        freecell_solver_user_cmd_line_parse_args(
+            instance,
+            context.argc,
+            (const char * *)(void *)context.argv,
+            arg,
+            NULL,
+            NULL,
+            NULL,
+            &error_string,
+            &arg
+        )
+    )
+    {
+        case FCS_CMD_LINE_UNRECOGNIZED_OPTION:
+        {
+            fprintf(stderr, "Unknown option: %s", context.argv[arg]);
+            exit(-1);
+        }
+        break;
+
+        case FCS_CMD_LINE_PARAM_WITH_NO_ARG:
+        {
+            fprintf(stderr, "The command line parameter \"%s\" requires an argument"
+                " and was not supplied with one.\n", context.argv[arg]);
+            exit(-1);
+        }
+        break;
+
+        case FCS_CMD_LINE_ERROR_IN_ARG:
+        {
+            if (error_string != NULL)
+            {
+                fprintf(stderr, "%s", error_string);
+                free(error_string);
+            }
+            exit(-1);
+        }
+        break;
+    }
+
+    if (! candidate->is_given)
+    {
+        for (int i = 0 ; i < FCS_NUM_BEFS_WEIGHTS ; i++)
+        {
+            freecell_solver_user_set_a_star_weight(
+                instance, i, candidate->weights[i]
+            );
+        }
+        if (candidate->step > 0)
+        {
+            freecell_solver_user_set_soft_thread_step(instance, candidate->step);
+        }
+    }
+    freecell_solver_user_limit_iterations_long(
+        instance, context.total_iterations_limit_per_board
+    );
+
+    return instance;
+}
+
+static void evaluate_candidate(candidate_t * const candidate)
+{
+    void * const instance = alloc_instance(candidate);
+
+    candidate->num_boards = 0;
+    candidate->total = 0;
+    candidate->was_cut_off = FALSE;
+
+    for (int board_num = context.start_board ;
+        board_num < context.past_end_board ;
+        board_num++)
+    {
+        fcs_state_string_t state_string;
+        get_board(board_num, state_string);
+
+        freecell_solver_user_solve_board(instance, state_string);
+        candidate->total += freecell_solver_user_get_num_times_long(instance);
+        candidate->num_boards++;
+        freecell_solver_user_recycle(instance);
+
+        pthread_mutex_lock(&context.lock);
+        const fcs_int64_t best_total = context.best_total;
+        pthread_mutex_unlock(&context.lock);
+
+        if ((best_total >= 0) && (candidate->total > best_total))
+        {
+            candidate->was_cut_off = TRUE;
+            break;
+        }
+    }
+
+    if (! candidate->was_cut_off)
+    {
+        pthread_mutex_lock(&context.lock);
+        if ((context.best_total < 0) || (candidate->total < context.best_total))
+        {
+            context.best_total = candidate->total;
+        }
+        pthread_mutex_unlock(&context.lock);
+    }
+
+    freecell_solver_user_free(instance);
+}
+
+static void * worker_thread(void * GCC_UNUSED void_context)
+{
+    while (1)
+    {
+        pthread_mutex_lock(&context.lock);
+        const int idx = context.next_candidate++;
+        pthread_mutex_unlock(&context.lock);
+
+        if (idx >= context.num_candidates)
+        {
+            return NULL;
+        }
+        evaluate_candidate(&(context.candidates[idx]));
+    }
+}
+
+/*
+ * The complete candidates come first by their totals, and then the ones
+ * that were cut off, by how far they got.
+ * */
+static int compare_candidates(const void * const void_a, const void * const void_b)
+{
+    const candidate_t * const a = (const candidate_t *)void_a;
+    const candidate_t * const b = (const candidate_t *)void_b;
+
+    if (a->was_cut_off != b->was_cut_off)
+    {
+        return (a->was_cut_off ? 1 : -1);
+    }
+    if (a->was_cut_off && (a->num_boards != b->num_boards))
+    {
+        return ((a->num_boards > b->num_boards) ? -1 : 1);
+    }
+    return ((a->total < b->total) ? -1 : (a->total > b->total) ? 1 : 0);
+}
+
+static void fprint_candidate(FILE * const f, const candidate_t * const candidate)
+{
+    if (candidate->is_given)
+    {
+        fprintf(f, "%s", "(as given)");
+        return;
+    }
+    fprintf(f, "-asw ");
+    for (int i = 0 ; i < FCS_NUM_BEFS_WEIGHTS ; i++)
+    {
+        fprintf(f, "%s%.4f", (i ? "," : ""), candidate->weights[i]);
+    }
+    if (candidate->step > 0)
+    {
+        fprintf(f, " -step %d", candidate->step);
+    }
+}
+
+static double get_random_fraction(fcs_rand_t * const rand_gen)
+{
+    return ((double)fc_solve_rand_get_random_number(rand_gen)) / (1 << 30);
+}
+
+static void write_preset(const char * const filename, const candidate_t * const best)
+{
+    FILE * const f = fopen(filename, "wt");
+    if (! f)
+    {
+        fprintf(stderr, "Could not open \"%s\" for writing!\n", filename);
+        exit(-1);
+    }
+    fprintf(f, "%s",
+        "#!/bin/sh\n"
+        "\n"
+        "# This preset was generated by freecell-solver-befs-weights-tuner\n"
+        "\n"
+        "freecell-solver-range-parallel-solve 1 32000 1 \\\n"
+        "   "
+    );
+    for (int arg = context.arg ; arg < context.argc ; arg++)
+    {
+        fprintf(f, " %s", context.argv[arg]);
+    }
+    if (! best->is_given)
+    {
+        fprintf(f, " ");
+        fprint_candidate(f, best);
+    }
+    fprintf(f, "\n");
+    fclose(f);
+}
+
+static GCC_INLINE void read_arg_value(
+    const int argc, char * argv[], const char * const name
+)
+{
+    context.arg++;
+    if (context.arg == argc)
+    {
+        fprintf(stderr, "%s came without an argument!\n", name);
+        print_help();
+        exit(-1);
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "Not Enough Arguments!\n");
+        print_help();
+        exit(-1);
+    }
+    context.start_board = atoi(argv[context.arg++]);
+    const int end_board = atoi(argv[context.arg++]);
+    if (end_board < context.start_board)
+    {
+        fprintf(stderr, "end must not be less than start.\n");
+        print_help();
+        exit(-1);
+    }
+
+    int num_workers = 3;
+    int num_candidates = 16;
+    int num_rounds = 4;
+    int seed = 1;
+    int min_step = 0, max_step = 0;
+    const char * preset_output = NULL;
+    for (;context.arg < argc; context.arg++)
+    {
+        if (!strcmp(argv[context.arg], "--num-workers"))
+        {
+            read_arg_value(argc, argv, "--num-workers");
+            num_workers = atoi(argv[context.arg]);
+        }
+        else if (!strcmp(argv[context.arg], "--num-candidates"))
+        {
+            read_arg_value(argc, argv, "--num-candidates");
+            num_candidates = atoi(argv[context.arg]);
+        }
+        else if (!strcmp(argv[context.arg], "--num-rounds"))
+        {
+            read_arg_value(argc, argv, "--num-rounds");
+            num_rounds = atoi(argv[context.arg]);
+        }
+        else if (!strcmp(argv[context.arg], "--seed"))
+        {
+            read_arg_value(argc, argv, "--seed");
+            seed = atoi(argv[context.arg]);
+        }
+        else if (!strcmp(argv[context.arg], "--total-iterations-limit"))
+        {
+            read_arg_value(argc, argv, "--total-iterations-limit");
+            context.total_iterations_limit_per_board = atol(argv[context.arg]);
+        }
+        else if (!strcmp(argv[context.arg], "--tune-step"))
+        {
+            read_arg_value(argc, argv, "--tune-step");
+            if ((sscanf(argv[context.arg], "%d,%d", &min_step, &max_step) != 2)
+                || (min_step <= 0) || (max_step < min_step))
+            {
+                fprintf(stderr, "--tune-step should be min,max with 0 < min <= max.\n");
+                exit(-1);
+            }
+        }
+        else if (!strcmp(argv[context.arg], "--preset-output"))
+        {
+            read_arg_value(argc, argv, "--preset-output");
+            preset_output = argv[context.arg];
+        }
+        else
+        {
+            break;
+        }
+    }
+    if ((num_workers <= 0) || (num_candidates <= 0) || (num_rounds <= 0))
+    {
+        fprintf(stderr, "--num-workers, --num-candidates and --num-rounds must"
+            " be greater than 0.\n");
+        print_help();
+        exit(-1);
+    }
+
+    context.argc = argc;
+    context.argv = argv;
+    context.lock = initial_mutex_constant;
+
+    /* The first candidate is the given configuration, and the rest are
+     * random ones, about half of whose weights are 0, as in most of the
+     * hand-made presets. */
+    fcs_rand_t rand_gen;
+    fc_solve_rand_init(&rand_gen, seed);
+    candidate_t * const candidates = SMALLOC(candidates, num_candidates);
+    candidates[0].is_given = TRUE;
+    for (int c = 1 ; c < num_candidates ; c++)
+    {
+        candidate_t * const candidate = &(candidates[c]);
+        candidate->is_given = FALSE;
+        double sum = 0;
+        for (int i = 0 ; i < FCS_NUM_BEFS_WEIGHTS ; i++)
+        {
+            candidate->weights[i] =
+                ((get_random_fraction(&rand_gen) < 0.5)
+                 ? 0
+                 : get_random_fraction(&rand_gen)
+                );
+            sum += candidate->weights[i];
+        }
+        if (sum == 0)
+        {
+            candidate->weights[0] = 1;
+            sum = 1;
+        }
+        for (int i = 0 ; i < FCS_NUM_BEFS_WEIGHTS ; i++)
+        {
+            candidate->weights[i] /= sum;
+        }
+        candidate->step = ((max_step > 0)
+            ? (min_step + (int)(get_random_fraction(&rand_gen) * (max_step - min_step + 1)))
+            : 0
+        );
+    }
+    context.candidates = candidates;
+    context.num_candidates = num_candidates;
+
+    pthread_t * const workers = SMALLOC(workers, num_workers);
+    const int num_boards = end_board - context.start_board + 1;
+
+    for (int round = 0 ; round < num_rounds ; round++)
+    {
+        const int sample_size = max(num_boards >> (num_rounds - 1 - round), 1);
+        context.past_end_board = context.start_board + sample_size;
+        context.next_candidate = 0;
+        context.best_total = -1;
+
+        for ( int idx = 0 ; idx < num_workers ; idx++)
+        {
+            const int check = pthread_create(
+                &workers[idx],
+                NULL,
+                worker_thread,
+                NULL
+            );
+            if (check)
+            {
+                fprintf(stderr,
+                    "Worker Thread No. %d Initialization failed with error %d!\n",
+                    idx, check
+                );
+                exit(-1);
+            }
+        }
+        for( int idx = 0 ; idx < num_workers ; idx++)
+        {
+            pthread_join(workers[idx], NULL);
+        }
+
+        /* The best candidates are evaluated first in the next round, so
+         * the others will be cut off early. */
+        qsort(candidates, context.num_candidates, sizeof(candidates[0]),
+            compare_candidates);
+
+        printf("Round %d: %d candidates on %d boards; Best total: %li ; ",
+            round + 1, context.num_candidates, sample_size,
+            (long)candidates[0].total
+        );
+        fprint_candidate(stdout, &(candidates[0]));
+        printf("\n");
+        fflush(stdout);
+
+        context.num_candidates = max((context.num_candidates + 1) / 2, 1);
+    }
+
+    printf("Best: ");
+    fprint_candidate(stdout, &(candidates[0]));
+    printf("\n");
+
+    if (preset_output)
+    {
+        write_preset(preset_output, &(candidates[0]));
+    }
+
+    free(workers);
+    free(candidates);
+
+    return 0;
+}
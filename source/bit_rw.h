@@ -34,11 +34,44 @@
 #include "unused.h"
 #include "inline.h"
 
+#include <stdint.h>
+
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
 #define NUM_BITS_IN_BYTES 8
 
-typedef int fc_solve_bit_data_t;
+/*
+ * The widest field that can be written or read at once: a field of that
+ * size, shifted by the up to 7 bits that are still pending in the current
+ * byte, still fits in the 64-bit accumulator.
+ */
+#define FC_SOLVE_BIT_RW_MAX_LEN 57
+
+typedef uint64_t fc_solve_bit_data_t;
 typedef unsigned char fcs_uchar_t;
 
+/* The lowest len bits of data. */
+static GCC_INLINE fc_solve_bit_data_t fc_solve_bit_rw_mask(
+    const fc_solve_bit_data_t data,
+    const int len
+)
+{
+#ifdef __BMI2__
+    return _bzhi_u64(data, len);
+#else
+    return (data & ((((fc_solve_bit_data_t)1) << len) - 1));
+#endif
+}
+
+/*
+ * The writer keeps the bytes in the buffer up to date after every write,
+ * including the partially written last byte and zeroing the one after
+ * it once a byte is completed, because delta_states.c copies the
+ * encodings of the columns out of it. Only whole bytes are stored, so
+ * the buffer need not have any slack at its end.
+ */
 typedef struct
 {
     fcs_uchar_t * current;
@@ -54,17 +87,26 @@ static GCC_INLINE void fc_solve_bit_writer_init(fc_solve_bit_writer_t * writer,
 
 static GCC_INLINE void fc_solve_bit_writer_write(fc_solve_bit_writer_t * writer, int len, fc_solve_bit_data_t data)
 {
-    for (;len;len--,(data>>=1))
+    fcs_uchar_t * current = writer->current;
+    int num_bits = writer->bit_in_char_idx + len;
+    fc_solve_bit_data_t acc =
+        ((*current) | (fc_solve_bit_rw_mask(data, len) << writer->bit_in_char_idx));
+
+    for ( ; num_bits >= NUM_BITS_IN_BYTES ; num_bits -= NUM_BITS_IN_BYTES)
     {
-        *(writer->current) |= ((data & 0x1) << (writer->bit_in_char_idx++));
-        if (writer->bit_in_char_idx == NUM_BITS_IN_BYTES)
-        {
-            *(++writer->current) = 0;
-            writer->bit_in_char_idx = 0;
-        }
+        *(current++) = (fcs_uchar_t)acc;
+        acc >>= NUM_BITS_IN_BYTES;
     }
+    *current = (fcs_uchar_t)acc;
+
+    writer->current = current;
+    writer->bit_in_char_idx = num_bits;
 }
 
+/*
+ * The reader loads only the bytes that hold the bits that are requested,
+ * so it never reads past the end of the encoding.
+ */
 typedef struct
 {
     const fcs_uchar_t * current;
@@ -84,25 +126,19 @@ static GCC_INLINE void fc_solve_bit_reader_init(
 
 static GCC_INLINE fc_solve_bit_data_t  fc_solve_bit_reader_read(fc_solve_bit_reader_t * reader, int len)
 {
-    int idx;
-    fc_solve_bit_data_t ret = 0;
+    const fcs_uchar_t * current = reader->current;
+    const int num_bits = reader->bit_in_char_idx + len;
+    fc_solve_bit_data_t acc = 0;
 
-    for (idx = 0 ; idx < len ; idx++)
+    for (int shift = 0 ; shift < num_bits ; shift += NUM_BITS_IN_BYTES)
     {
-        ret |=
-        (
-            ((*(reader->current) >> (reader->bit_in_char_idx++)) & 0x1)
-                << idx
-        );
-
-        if (reader->bit_in_char_idx == NUM_BITS_IN_BYTES)
-        {
-            reader->current++;
-            reader->bit_in_char_idx = 0;
-        }
+        acc |= (((fc_solve_bit_data_t)*(current++)) << shift);
     }
 
-    return ret;
+    reader->current += (num_bits / NUM_BITS_IN_BYTES);
+    reader->bit_in_char_idx = (num_bits % NUM_BITS_IN_BYTES);
+
+    return fc_solve_bit_rw_mask(acc >> (num_bits - len), len);
 }
 
 #endif /*  FC_SOLVE_BIT_RW_H */
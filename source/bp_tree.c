@@ -0,0 +1,328 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * bp_tree.c - a B+tree keyed on fcs_encoded_state_buffer_t . See
+ * bp_tree.h .
+ */
+#include <string.h>
+#include <stdint.h>
+
+#include "alloc_wrap.h"
+#include "bp_tree.h"
+
+typedef fcs_encoded_state_buffer_t bp_key_t;
+
+#define GET_KEY(item) ((const bp_key_t *)(item))
+
+static GCC_INLINE int compare_keys(const bp_key_t * const a, const bp_key_t * const b)
+{
+    return memcmp(a, b, sizeof(*a));
+}
+
+/* Returns the index of the first key in keys that is greater than key. */
+static GCC_INLINE int upper_bound(
+    const bp_key_t * const keys, const int count, const bp_key_t * const key
+)
+{
+    int low = 0, high = count;
+
+    while (low < high)
+    {
+        const int mid = ((low + high) >> 1);
+        if (compare_keys(&(keys[mid]), key) <= 0)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+/* Returns the index of the first key in keys that is not less than key. */
+static GCC_INLINE int lower_bound(
+    const bp_key_t * const keys, const int count, const bp_key_t * const key
+)
+{
+    int low = 0, high = count;
+
+    while (low < high)
+    {
+        const int mid = ((low + high) >> 1);
+        if (compare_keys(&(keys[mid]), key) < 0)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+/*
+ * Fetch all the cache lines of the node at once, instead of one by one
+ * as the binary search reaches them.
+ * */
+static GCC_INLINE void prefetch_node(const void * const node)
+{
+#ifdef __GNUC__
+    for (size_t offset = 0 ; offset < FCS_BP_TREE_NODE_SIZE ; offset += 64)
+    {
+        __builtin_prefetch((const char *)node + offset);
+    }
+#endif
+}
+
+/* The nodes are aligned to cache lines. */
+static GCC_INLINE void * alloc_node(
+    fcs_bp_tree_t * const tree, const size_t size
+)
+{
+    const uintptr_t ptr = (uintptr_t)fcs_compact_alloc_ptr(
+        &(tree->dict_allocator), size + 64 - sizeof(void *)
+    );
+
+    return (void *)((ptr + 63) & (~(uintptr_t)63));
+}
+
+static GCC_INLINE fcs_bp_tree_leaf_t * alloc_leaf(fcs_bp_tree_t * const tree)
+{
+    fcs_bp_tree_leaf_t * const leaf = alloc_node(tree, sizeof(*leaf));
+    leaf->count = 0;
+    leaf->next = NULL;
+
+    return leaf;
+}
+
+fcs_bp_tree_t * fc_solve_bp_tree_create(
+    fcs_meta_compact_allocator_t * const meta_alloc
+)
+{
+    fcs_bp_tree_t * const tree = SMALLOC1(tree);
+
+    fc_solve_compact_allocator_init(&(tree->dict_allocator), meta_alloc);
+    tree->root = tree->first_leaf = alloc_leaf(tree);
+    tree->height = 1;
+    tree->count = 0;
+
+    return tree;
+}
+
+void fc_solve_bp_tree_destroy(fcs_bp_tree_t * const tree)
+{
+    fc_solve_compact_allocator_finish(&(tree->dict_allocator));
+    free(tree);
+}
+
+static GCC_INLINE fcs_bp_tree_leaf_t * find_leaf(
+    const fcs_bp_tree_t * const tree,
+    const bp_key_t * const key
+)
+{
+    const void * node = tree->root;
+
+    for (int level = tree->height ; level > 1 ; level--)
+    {
+        const fcs_bp_tree_inner_t * const inner = node;
+        node = inner->children[upper_bound(inner->keys, inner->count - 1, key)];
+        prefetch_node(node);
+    }
+
+    return (fcs_bp_tree_leaf_t *)node;
+}
+
+void * fc_solve_bp_tree_lookup(
+    const fcs_bp_tree_t * const tree,
+    const void * const item
+)
+{
+    const bp_key_t * const key = GET_KEY(item);
+    const fcs_bp_tree_leaf_t * const leaf = find_leaf(tree, key);
+    const int pos = lower_bound(leaf->keys, leaf->count, key);
+
+    return (((pos < leaf->count) && (! compare_keys(&(leaf->keys[pos]), key)))
+        ? leaf->items[pos] : NULL);
+}
+
+void fc_solve_bp_tree_delete(
+    fcs_bp_tree_t * const tree,
+    const void * const item
+)
+{
+    const bp_key_t * const key = GET_KEY(item);
+    fcs_bp_tree_leaf_t * const leaf = find_leaf(tree, key);
+    const int pos = lower_bound(leaf->keys, leaf->count, key);
+
+    if ((pos < leaf->count) && (! compare_keys(&(leaf->keys[pos]), key)))
+    {
+        const int num_after = leaf->count - pos - 1;
+        memmove(&(leaf->keys[pos]), &(leaf->keys[pos+1]),
+            sizeof(leaf->keys[0]) * num_after);
+        memmove(&(leaf->items[pos]), &(leaf->items[pos+1]),
+            sizeof(leaf->items[0]) * num_after);
+        leaf->count--;
+        tree->count--;
+    }
+}
+
+void * fc_solve_bp_tree_insert(fcs_bp_tree_t * const tree, void * const item)
+{
+    const bp_key_t * const key = GET_KEY(item);
+    fcs_bp_tree_inner_t * path[FCS_BP_TREE_MAX_HEIGHT];
+    int path_idx[FCS_BP_TREE_MAX_HEIGHT];
+    int depth = 0;
+    void * node = tree->root;
+
+    for (int level = tree->height ; level > 1 ; level--)
+    {
+        fcs_bp_tree_inner_t * const inner = node;
+        const int idx = upper_bound(inner->keys, inner->count - 1, key);
+        path[depth] = inner;
+        path_idx[depth++] = idx;
+        node = inner->children[idx];
+        prefetch_node(node);
+    }
+
+    fcs_bp_tree_leaf_t * const leaf = node;
+    const int pos = lower_bound(leaf->keys, leaf->count, key);
+
+    if ((pos < leaf->count) && (! compare_keys(&(leaf->keys[pos]), key)))
+    {
+        return leaf->items[pos];
+    }
+
+    tree->count++;
+
+    if (leaf->count < (int)FCS_BP_TREE_LEAF_MAX)
+    {
+        const int num_after = leaf->count - pos;
+        memmove(&(leaf->keys[pos+1]), &(leaf->keys[pos]),
+            sizeof(leaf->keys[0]) * num_after);
+        memmove(&(leaf->items[pos+1]), &(leaf->items[pos]),
+            sizeof(leaf->items[0]) * num_after);
+        leaf->keys[pos] = *key;
+        leaf->items[pos] = item;
+        leaf->count++;
+        return NULL;
+    }
+
+    /* Split the leaf. */
+    bp_key_t separator;
+    void * new_child;
+    {
+        fcs_bp_tree_leaf_t * const right = alloc_leaf(tree);
+        const int total = FCS_BP_TREE_LEAF_MAX + 1;
+        const int left_count = (total >> 1);
+        bp_key_t keys[FCS_BP_TREE_LEAF_MAX + 1];
+        void * items[FCS_BP_TREE_LEAF_MAX + 1];
+
+        memcpy(keys, leaf->keys, sizeof(keys[0]) * pos);
+        memcpy(items, leaf->items, sizeof(items[0]) * pos);
+        keys[pos] = *key;
+        items[pos] = item;
+        memcpy(&(keys[pos+1]), &(leaf->keys[pos]),
+            sizeof(keys[0]) * (FCS_BP_TREE_LEAF_MAX - pos));
+        memcpy(&(items[pos+1]), &(leaf->items[pos]),
+            sizeof(items[0]) * (FCS_BP_TREE_LEAF_MAX - pos));
+
+        memcpy(leaf->keys, keys, sizeof(keys[0]) * left_count);
+        memcpy(leaf->items, items, sizeof(items[0]) * left_count);
+        leaf->count = left_count;
+        memcpy(right->keys, &(keys[left_count]),
+            sizeof(keys[0]) * (total - left_count));
+        memcpy(right->items, &(items[left_count]),
+            sizeof(items[0]) * (total - left_count));
+        right->count = total - left_count;
+
+        right->next = leaf->next;
+        leaf->next = right;
+
+        separator = right->keys[0];
+        new_child = right;
+    }
+
+    /* Insert the separator into the ancestors, and split them as needed. */
+    while (depth > 0)
+    {
+        fcs_bp_tree_inner_t * const inner = path[--depth];
+        const int idx = path_idx[depth];
+
+        if (inner->count < (int)FCS_BP_TREE_INNER_MAX)
+        {
+            const int num_after = inner->count - 1 - idx;
+            memmove(&(inner->keys[idx+1]), &(inner->keys[idx]),
+                sizeof(inner->keys[0]) * num_after);
+            memmove(&(inner->children[idx+2]), &(inner->children[idx+1]),
+                sizeof(inner->children[0]) * num_after);
+            inner->keys[idx] = separator;
+            inner->children[idx+1] = new_child;
+            inner->count++;
+            return NULL;
+        }
+
+        fcs_bp_tree_inner_t * const right = alloc_node(tree, sizeof(*right));
+        const int total = FCS_BP_TREE_INNER_MAX + 1;
+        const int left_count = (total >> 1);
+        bp_key_t keys[FCS_BP_TREE_INNER_MAX];
+        void * children[FCS_BP_TREE_INNER_MAX + 1];
+
+        memcpy(keys, inner->keys, sizeof(keys[0]) * idx);
+        keys[idx] = separator;
+        memcpy(&(keys[idx+1]), &(inner->keys[idx]),
+            sizeof(keys[0]) * (FCS_BP_TREE_INNER_MAX - 1 - idx));
+        memcpy(children, inner->children, sizeof(children[0]) * (idx + 1));
+        children[idx+1] = new_child;
+        memcpy(&(children[idx+2]), &(inner->children[idx+1]),
+            sizeof(children[0]) * (FCS_BP_TREE_INNER_MAX - 1 - idx));
+
+        memcpy(inner->keys, keys, sizeof(keys[0]) * (left_count - 1));
+        memcpy(inner->children, children, sizeof(children[0]) * left_count);
+        inner->count = left_count;
+        memcpy(right->keys, &(keys[left_count]),
+            sizeof(keys[0]) * (total - left_count - 1));
+        memcpy(right->children, &(children[left_count]),
+            sizeof(children[0]) * (total - left_count));
+        right->count = total - left_count;
+
+        separator = keys[left_count - 1];
+        new_child = right;
+    }
+
+    /* Grow a new root. */
+    fcs_bp_tree_inner_t * const root = alloc_node(tree, sizeof(*root));
+    root->children[0] = tree->root;
+    root->children[1] = new_child;
+    root->keys[0] = separator;
+    root->count = 2;
+    tree->root = root;
+    tree->height++;
+
+    return NULL;
+}
@@ -0,0 +1,148 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * bp_tree.h - a B+tree of items that begin with an
+ * fcs_encoded_state_buffer_t, which serves as their key. It can replace
+ * the binary trees of the DBM solvers (see generic_tree.h).
+ *
+ * The keys are copied into nodes of about 512 bytes, so a lookup compares
+ * against keys that are next to each other in memory, and only follows a
+ * pointer once per level. The leaves are linked for ordered scans.
+ */
+#ifndef FC_SOLVE__BP_TREE_H
+#define FC_SOLVE__BP_TREE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+
+#include "inline.h"
+#include "meta_alloc.h"
+#include "delta_states.h"
+
+#define FCS_BP_TREE_NODE_SIZE 512
+#define FCS_BP_TREE_ENTRY_SIZE \
+    (sizeof(fcs_encoded_state_buffer_t) + sizeof(void *))
+#define FCS_BP_TREE_LEAF_MAX \
+    ((FCS_BP_TREE_NODE_SIZE - 16) / FCS_BP_TREE_ENTRY_SIZE)
+#define FCS_BP_TREE_INNER_MAX \
+    ((FCS_BP_TREE_NODE_SIZE - 16 + sizeof(fcs_encoded_state_buffer_t)) \
+     / FCS_BP_TREE_ENTRY_SIZE)
+#define FCS_BP_TREE_MAX_HEIGHT 32
+
+typedef struct fcs_bp_tree_leaf_struct
+{
+    fcs_encoded_state_buffer_t keys[FCS_BP_TREE_LEAF_MAX];
+    void * items[FCS_BP_TREE_LEAF_MAX];
+    struct fcs_bp_tree_leaf_struct * next;
+    int count;
+} fcs_bp_tree_leaf_t;
+
+typedef struct
+{
+    /* keys[i] is the smallest key that was ever inserted under
+     * children[i+1]. */
+    fcs_encoded_state_buffer_t keys[FCS_BP_TREE_INNER_MAX - 1];
+    void * children[FCS_BP_TREE_INNER_MAX];
+    int count;
+} fcs_bp_tree_inner_t;
+
+typedef struct
+{
+    /* A leaf if height is 1 and an inner node otherwise. */
+    void * root;
+    int height;
+    size_t count;
+    fcs_bp_tree_leaf_t * first_leaf;
+    /* The nodes are allocated from there, and the callers may use it for
+     * the items, like with the other trees. */
+    fcs_compact_allocator_t dict_allocator;
+} fcs_bp_tree_t;
+
+extern fcs_bp_tree_t * fc_solve_bp_tree_create(
+    fcs_meta_compact_allocator_t * meta_alloc
+);
+
+extern void fc_solve_bp_tree_destroy(fcs_bp_tree_t * tree);
+
+/* Returns the item whose key is that of item, or NULL. */
+extern void * fc_solve_bp_tree_lookup(
+    const fcs_bp_tree_t * tree,
+    const void * item
+);
+
+/*
+ * Inserts item, which should remain valid while it is in the tree.
+ * Returns NULL if it was inserted, or the item with the same key if
+ * there was one.
+ * */
+extern void * fc_solve_bp_tree_insert(fcs_bp_tree_t * tree, void * item);
+
+/*
+ * Removes the item with the key of item, if there is one.
+ *
+ * The nodes are not merged, so a tree keeps its size after deletions.
+ * The callers that delete (the LRU caches) keep their trees at a
+ * constant number of items, so the space is reused by the insertions.
+ * */
+extern void fc_solve_bp_tree_delete(fcs_bp_tree_t * tree, const void * item);
+
+typedef struct
+{
+    const fcs_bp_tree_leaf_t * leaf;
+    int idx;
+} fcs_bp_tree_iter_t;
+
+/* Returns the next item in the order of the keys, or NULL at the end. */
+static GCC_INLINE void * fc_solve_bp_tree_iter_next(
+    fcs_bp_tree_iter_t * const iter
+)
+{
+    while (iter->leaf && (iter->idx == iter->leaf->count))
+    {
+        iter->leaf = iter->leaf->next;
+        iter->idx = 0;
+    }
+
+    return (iter->leaf ? iter->leaf->items[iter->idx++] : NULL);
+}
+
+static GCC_INLINE void * fc_solve_bp_tree_iter_first(
+    const fcs_bp_tree_t * const tree,
+    fcs_bp_tree_iter_t * const iter
+)
+{
+    iter->leaf = tree->first_leaf;
+    iter->idx = 0;
+
+    return fc_solve_bp_tree_iter_next(iter);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FC_SOLVE__BP_TREE_H */
@@ -292,14 +292,36 @@ guint fc_solve_hash_function(gconstpointer key)
 static GCC_INLINE void upon_new_state(
     fc_solve_instance_t * const instance,
     fc_solve_hard_thread_t * const hard_thread,
-    fcs_state_extra_info_t * const new_state_info
+    fcs_kv_state_t * const new_state
 )
 {
+    fcs_state_extra_info_t * const new_state_info = new_state->val;
     fcs_collectible_state_t * const parent_state = new_state_info->parent;
+
+    /* A dead end that was trimmed out of the collection and is now
+     * reached again. It is not counted as an active child, just as if
+     * it was marked as a dead end by mark_as_dead_end() . */
+    const fcs_bool_t is_known_dead_end =
+    (
+        instance->transposition_table.entries
+        &&
+        fc_solve_tt_lookup(
+            &(instance->transposition_table),
+            fc_solve_tt_hash(new_state->key, sizeof(*(new_state->key)))
+        )
+    );
+    if (unlikely(is_known_dead_end))
+    {
+        new_state_info->visited |= FCS_VISITED_DEAD_END;
+    }
+
     /* The new state was not found in the cache, and it was already inserted */
     if (likely(parent_state))
     {
-        (FCS_S_NUM_ACTIVE_CHILDREN(parent_state))++;
+        if (likely(! is_known_dead_end))
+        {
+            (FCS_S_NUM_ACTIVE_CHILDREN(parent_state))++;
+        }
         /* If parent_val is defined, so is moves_to_parent */
         new_state_info->moves_to_parent =
             fc_solve_move_stack_compact_allocate(
@@ -328,7 +350,7 @@ fcs_bool_t fc_solve_check_and_add_state(
 #define existing_state_val (existing_state_raw->val)
 #define new_state_key      (new_state->key)
 
-#define ON_STATE_NEW() upon_new_state(instance, hard_thread, new_state->val);
+#define ON_STATE_NEW() upon_new_state(instance, hard_thread, new_state);
 
 #ifdef FCS_SINGLE_HARD_THREAD
 #define instance hard_thread
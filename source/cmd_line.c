@@ -379,8 +379,10 @@ if (*(p++) == '-')
 case '-':
 { switch(*(p++)) {
 case 'a':
+{ switch(*(p++)) {
+case '-':
 {
-if (!strcmp(p, "-star-weights")) {
+if (!strcmp(p, "star-weights")) {
 opt = FCS_OPT_BEFS_WEIGHTS;
 
 }
@@ -388,6 +390,21 @@ opt = FCS_OPT_BEFS_WEIGHTS;
 
 break;
 
+case 'd':
+{
+if (!strcmp(p, "aptive-tests-order")) {
+opt = FCS_OPT_ADAPTIVE_TESTS_ORDER;
+
+}
+}
+
+break;
+
+}
+}
+
+break;
+
 case 'c':
 
 {
@@ -481,8 +498,10 @@ break;
 break;
 
 case 'e':
+{ switch(*(p++)) {
+case 'm':
 {
-if (!strcmp(p, "mpty-stacks-filled-by")) {
+if (!strcmp(p, "pty-stacks-filled-by")) {
 opt = FCS_OPT_EMPTY_STACKS_FILLED_BY;
 
 }
@@ -490,6 +509,21 @@ opt = FCS_OPT_EMPTY_STACKS_FILLED_BY;
 
 break;
 
+case 'n':
+{
+if (!strcmp(p, "dgame-db")) {
+opt = FCS_OPT_ENDGAME_DB;
+
+}
+}
+
+break;
+
+}
+}
+
+break;
+
 case 'f':
 { switch(*(p++)) {
 case 'l':
@@ -744,9 +778,15 @@ break;
 case 'p':
 { switch(*(p++)) {
 case 'a':
+
+{
+if (*(p++) == 't')
+{
+{ switch(*(p++)) {
+case 's':
 {
-if (!strncmp(p, "tsolve-", 7)) {
-p += 7;
+if (!strncmp(p, "olve-", 5)) {
+p += 5;
 { switch(*(p++)) {
 case 'x':
 {
@@ -776,6 +816,25 @@ break;
 
 break;
 
+case 't':
+{
+if (!strcmp(p, "ern-db")) {
+opt = FCS_OPT_PATTERN_DB;
+
+}
+}
+
+break;
+
+}
+}
+
+}
+
+}
+
+break;
+
 case 'r':
 
 {
@@ -924,8 +983,10 @@ break;
 break;
 
 case 'o':
+{ switch(*(p++)) {
+case 'f':
 {
-if (!strcmp(p, "ft-thread-step")) {
+if (!strcmp(p, "t-thread-step")) {
 opt = FCS_OPT_SOFT_THREAD_STEP;
 
 }
@@ -933,6 +994,21 @@ opt = FCS_OPT_SOFT_THREAD_STEP;
 
 break;
 
+case 'l':
+{
+if (!strcmp(p, "ution-cache")) {
+opt = FCS_OPT_SOLUTION_CACHE;
+
+}
+}
+
+break;
+
+}
+}
+
+break;
+
 case 't':
 { switch(*(p++)) {
 case '-':
@@ -978,8 +1054,20 @@ opt = FCS_OPT_TESTS_ORDER;
 break;
 
 case 'r':
+{ switch(*(p++)) {
+case 'a':
 {
-if (!strcmp(p, "im-max-stored-states")) {
+if (!strcmp(p, "nsposition-table-size")) {
+opt = FCS_OPT_TRANSPOSITION_TABLE_SIZE;
+
+}
+}
+
+break;
+
+case 'i':
+{
+if (!strcmp(p, "m-max-stored-states")) {
 opt = FCS_OPT_TRIM_MAX_STORED_STATES;
 
 }
@@ -997,9 +1085,16 @@ break;
 
 break;
 
+}
+}
+
+break;
+
 case 'a':
+{ switch(*(p++)) {
+case 's':
 {
-if (!strcmp(p, "sw")) {
+if (!strcmp(p, "w")) {
 opt = FCS_OPT_BEFS_WEIGHTS;
 
 }
@@ -1007,6 +1102,21 @@ opt = FCS_OPT_BEFS_WEIGHTS;
 
 break;
 
+case 't':
+{
+if (!strcmp(p, "o")) {
+opt = FCS_OPT_ADAPTIVE_TESTS_ORDER;
+
+}
+}
+
+break;
+
+}
+}
+
+break;
+
 case 'd':
 {
 if (!strncmp(p, "to", 2)) {
@@ -1270,6 +1380,16 @@ opt = FCS_OPT_TESTS_ORDER;
 
 break;
 
+case 't':
+{
+if (!strcmp(p, "s")) {
+opt = FCS_OPT_TRANSPOSITION_TABLE_SIZE;
+
+}
+}
+
+break;
+
 }
 }
 
@@ -1533,6 +1653,10 @@ break;
             {
                 method = FCS_METHOD_A_STAR;
             }
+            else if (!strcmp((*arg), "optimal-a-star"))
+            {
+                method = FCS_METHOD_OPTIMAL_A_STAR;
+            }
             else if (!strcmp((*arg), "random-dfs"))
             {
                 method = FCS_METHOD_RANDOM_DFS;
@@ -1616,6 +1740,70 @@ break;
         }
         break;
 
+        case FCS_OPT_TRANSPOSITION_TABLE_SIZE: /* STRINGS=-tts|--transposition-table-size; */
+        {
+            PROCESS_OPT_ARG() ;
+
+            freecell_solver_user_set_transposition_table_size(
+                instance,
+                atol((*arg))
+            );
+        }
+        break;
+
+        case FCS_OPT_ENDGAME_DB: /* STRINGS=--endgame-db; */
+        {
+            char * fcs_user_errstr;
+
+            PROCESS_OPT_ARG() ;
+
+            if (freecell_solver_user_set_endgame_db(instance, (*arg), &fcs_user_errstr) != 0)
+            {
+                *error_string = calc_errstr_s(50, "Error in the endgame database!\n%s\n", fcs_user_errstr);
+                free(fcs_user_errstr);
+
+                RET_ERROR_IN_ARG() ;
+            }
+        }
+        break;
+
+        case FCS_OPT_PATTERN_DB: /* STRINGS=--pattern-db; */
+        {
+            char * fcs_user_errstr;
+
+            PROCESS_OPT_ARG() ;
+
+            if (freecell_solver_user_set_pattern_db(instance, (*arg), &fcs_user_errstr) != 0)
+            {
+                *error_string = calc_errstr_s(50, "Error in the pattern database!\n%s\n", fcs_user_errstr);
+                free(fcs_user_errstr);
+
+                RET_ERROR_IN_ARG() ;
+            }
+        }
+        break;
+
+        case FCS_OPT_SOLUTION_CACHE: /* STRINGS=--solution-cache; */
+        {
+            char * fcs_user_errstr;
+
+            PROCESS_OPT_ARG() ;
+
+            /* The config_id is set by freecell_solver_user_cmd_line_parse_args()
+             * once all the arguments were parsed. */
+            const int ret = freecell_solver_user_set_solution_cache(
+                instance, (*arg), NULL, &fcs_user_errstr
+            );
+            if (ret != 0)
+            {
+                *error_string = calc_errstr_s(50, "Error in the solution cache!\n%s\n", fcs_user_errstr);
+                free(fcs_user_errstr);
+
+                RET_ERROR_IN_ARG() ;
+            }
+        }
+        break;
+
         case FCS_OPT_NEXT_INSTANCE: /* STRINGS=-ni|--next-instance; */
         {
             freecell_solver_user_next_instance(instance);
@@ -1969,6 +2157,17 @@ break;
         }
         break;
 
+        case FCS_OPT_ADAPTIVE_TESTS_ORDER: /* STRINGS=-ato|--adaptive-tests-order; */
+        {
+            PROCESS_OPT_ARG() ;
+
+            freecell_solver_user_set_adaptive_tests_order(
+                instance,
+                atol((*arg))
+            );
+        }
+        break;
+
         case FCS_OPT_SET_PRUNING: /* STRINGS=-sp|--set-pruning; */
         {
             PROCESS_OPT_ARG() ;
@@ -2098,6 +2297,40 @@ end_of_arg_loop:
     return FCS_CMD_LINE_OK;
 }
 
+/*
+ * The solution cache only shares the solutions of the same configuration,
+ * which is identified by all the arguments that were parsed - except for
+ * the --solution-cache option itself, so it can be given anywhere.
+ * */
+static void set_solution_cache_config_id(
+    void * const instance,
+    freecell_solver_str_t argv[],
+    const int start_arg,
+    const int end_arg
+    )
+{
+    size_t config_id_len = 1;
+    for (int i = start_arg ; i < end_arg ; i++)
+    {
+        config_id_len += strlen(argv[i]) + 1;
+    }
+    char * const config_id = SMALLOC(config_id, config_id_len);
+    config_id[0] = '\0';
+    for (int i = start_arg ; i < end_arg ; i++)
+    {
+        if (!strcmp(argv[i], "--solution-cache"))
+        {
+            i++;
+            continue;
+        }
+        strcat(config_id, argv[i]);
+        strcat(config_id, "\n");
+    }
+
+    freecell_solver_user_set_solution_cache_config_id(instance, config_id);
+    free(config_id);
+}
+
 DLLEXPORT int freecell_solver_user_cmd_line_parse_args(
     void * instance,
     int argc,
@@ -2110,7 +2343,7 @@ DLLEXPORT int freecell_solver_user_cmd_line_parse_args(
     int * last_arg
     )
 {
-    return freecell_solver_user_cmd_line_parse_args_with_file_nesting_count(
+    const int ret = freecell_solver_user_cmd_line_parse_args_with_file_nesting_count(
         instance,
         argc,
         argv,
@@ -2123,5 +2356,9 @@ DLLEXPORT int freecell_solver_user_cmd_line_parse_args(
         -1,
         NULL
         );
+
+    set_solution_cache_config_id(instance, argv, start_arg, *last_arg);
+
+    return ret;
 }
 
@@ -44,6 +44,10 @@ enum
     FCS_OPT_SEED,
     FCS_OPT_MAX_STORED_STATES,
     FCS_OPT_TRIM_MAX_STORED_STATES,
+    FCS_OPT_TRANSPOSITION_TABLE_SIZE,
+    FCS_OPT_ENDGAME_DB,
+    FCS_OPT_PATTERN_DB,
+    FCS_OPT_SOLUTION_CACHE,
     FCS_OPT_NEXT_INSTANCE,
     FCS_OPT_NEXT_FLARE,
     FCS_OPT_NEXT_SOFT_THREAD,
@@ -63,6 +67,7 @@ enum
     FCS_OPT_LOAD_CONFIG,
     FCS_OPT_DEPTH_TESTS_ORDER,
     FCS_OPT_DEPTH_TESTS_ORDER_2,
+    FCS_OPT_ADAPTIVE_TESTS_ORDER,
     FCS_OPT_SET_PRUNING,
     FCS_OPT_CACHE_LIMIT,
     FCS_OPT_FLARES_CHOICE,
@@ -0,0 +1,411 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * dbm_bloom.h - a cache-line-blocked Bloom filter over all the encoded
+ * states that were ever inserted into the DBM store. It is consulted before
+ * fc_solve_dbm_store_does_key_exist() so most probes for states that were
+ * never seen do not require a lookup in the on-disk store.
+ *
+ * Every key is mapped to a single 64-byte block, and all of its bits are
+ * set inside that block, so a probe costs at most one cache miss.
+ *
+ * A filter that was initialised for 0 expected states is disabled: it
+ * holds no blocks, and every key may be contained in it.
+ */
+#ifndef FC_SOLVE__DBM_BLOOM_H
+#define FC_SOLVE__DBM_BLOOM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "bool.h"
+#include "inline.h"
+#include "alloc_wrap.h"
+
+#include "delta_states.h"
+
+#define FCS_DBM_BLOOM_WORDS_IN_BLOCK 8
+#define FCS_DBM_BLOOM_BITS_IN_BLOCK (FCS_DBM_BLOOM_WORDS_IN_BLOCK * 64)
+/* log2(FCS_DBM_BLOOM_BITS_IN_BLOCK) */
+#define FCS_DBM_BLOOM_BIT_IDX_BITS 9
+#define FCS_DBM_BLOOM_MAX_NUM_HASHES (64 / FCS_DBM_BLOOM_BIT_IDX_BITS)
+#define FCS_DBM_BLOOM_DEFAULT_BITS_PER_STATE 10
+
+typedef struct
+{
+    uint64_t words[FCS_DBM_BLOOM_WORDS_IN_BLOCK];
+} fcs_dbm_bloom_block_t;
+
+typedef struct
+{
+    fcs_dbm_bloom_block_t * blocks;
+    uint64_t num_blocks;
+    int num_hashes;
+    /* Statistics. */
+    long num_inserted, num_bits_set;
+    long num_definite_negatives, num_false_positives;
+} fcs_dbm_bloom_t;
+
+static GCC_INLINE uint64_t fcs_dbm_bloom__mix(uint64_t h)
+{
+    /* The splitmix64 finalizer. */
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+
+    return h;
+}
+
+static GCC_INLINE uint64_t fcs_dbm_bloom__hash(
+    const fcs_encoded_state_buffer_t * const key
+)
+{
+    /* FNV-1a */
+    uint64_t h = 0xCBF29CE484222325ULL;
+
+    for (size_t i = 0 ; i < sizeof(key->s) ; i++)
+    {
+        h ^= key->s[i];
+        h *= 0x100000001B3ULL;
+    }
+
+    return fcs_dbm_bloom__mix(h);
+}
+
+static GCC_INLINE void fcs_dbm_bloom__alloc_blocks(
+    fcs_dbm_bloom_t * const bloom
+)
+{
+    void * blocks;
+
+    if (posix_memalign(&blocks, sizeof(fcs_dbm_bloom_block_t),
+        sizeof(fcs_dbm_bloom_block_t) * bloom->num_blocks))
+    {
+        fprintf(stderr, "Could not allocate the Bloom filter of %lu blocks.\n",
+            (unsigned long)bloom->num_blocks);
+        exit(-1);
+    }
+    bloom->blocks = (fcs_dbm_bloom_block_t *)blocks;
+}
+
+static GCC_INLINE void fcs_dbm_bloom__init(
+    fcs_dbm_bloom_t * const bloom,
+    const long expected_num_states,
+    const int bits_per_state
+)
+{
+    const uint64_t num_bits = (uint64_t)
+        ((expected_num_states > 0) ? expected_num_states : 0) * bits_per_state;
+
+    bloom->num_blocks =
+        (num_bits + FCS_DBM_BLOOM_BITS_IN_BLOCK - 1) / FCS_DBM_BLOOM_BITS_IN_BLOCK;
+    bloom->blocks = NULL;
+    if (bloom->num_blocks)
+    {
+        fcs_dbm_bloom__alloc_blocks(bloom);
+        memset(bloom->blocks, '\0',
+            sizeof(bloom->blocks[0]) * bloom->num_blocks);
+    }
+
+    /* k = ln(2) * m/n is the optimal number of hashes. */
+    bloom->num_hashes = (bits_per_state * 69 + 50) / 100;
+    if (bloom->num_hashes < 1)
+    {
+        bloom->num_hashes = 1;
+    }
+    else if (bloom->num_hashes > FCS_DBM_BLOOM_MAX_NUM_HASHES)
+    {
+        bloom->num_hashes = FCS_DBM_BLOOM_MAX_NUM_HASHES;
+    }
+
+    bloom->num_inserted = bloom->num_bits_set = 0;
+    bloom->num_definite_negatives = bloom->num_false_positives = 0;
+}
+
+static GCC_INLINE fcs_bool_t fcs_dbm_bloom__is_enabled(
+    const fcs_dbm_bloom_t * const bloom
+)
+{
+    return (bloom->num_blocks != 0);
+}
+
+static GCC_INLINE void fcs_dbm_bloom__destroy(
+    fcs_dbm_bloom_t * const bloom
+)
+{
+    free(bloom->blocks);
+    bloom->blocks = NULL;
+}
+
+static GCC_INLINE fcs_dbm_bloom_block_t * fcs_dbm_bloom__get_block(
+    const fcs_dbm_bloom_t * const bloom,
+    const uint64_t h
+)
+{
+    /* Multiply-shift reduction of the top 32 bits into [0, num_blocks). */
+    return bloom->blocks + (((h >> 32) * bloom->num_blocks) >> 32);
+}
+
+#define FCS_DBM_BLOOM_BIT_MASK ((1 << FCS_DBM_BLOOM_BIT_IDX_BITS) - 1)
+
+static GCC_INLINE void fcs_dbm_bloom__insert(
+    fcs_dbm_bloom_t * const bloom,
+    const fcs_encoded_state_buffer_t * const key
+)
+{
+    if (! fcs_dbm_bloom__is_enabled(bloom))
+    {
+        return;
+    }
+    const uint64_t h = fcs_dbm_bloom__hash(key);
+    fcs_dbm_bloom_block_t * const block = fcs_dbm_bloom__get_block(bloom, h);
+    uint64_t bits = fcs_dbm_bloom__mix(h);
+
+    for (int i = 0 ; i < bloom->num_hashes ; i++,
+        bits >>= FCS_DBM_BLOOM_BIT_IDX_BITS)
+    {
+        const int bit_idx = (int)(bits & FCS_DBM_BLOOM_BIT_MASK);
+        uint64_t * const word = &(block->words[bit_idx >> 6]);
+        const uint64_t mask = (((uint64_t)1) << (bit_idx & 63));
+
+        if (! ((*word) & mask))
+        {
+            *word |= mask;
+            bloom->num_bits_set++;
+        }
+    }
+    bloom->num_inserted++;
+}
+
+/*
+ * Returns FALSE if the key was definitely never inserted, and TRUE if it
+ * may have been.
+ * */
+static GCC_INLINE fcs_bool_t fcs_dbm_bloom__may_contain(
+    fcs_dbm_bloom_t * const bloom,
+    const fcs_encoded_state_buffer_t * const key
+)
+{
+    if (! fcs_dbm_bloom__is_enabled(bloom))
+    {
+        return TRUE;
+    }
+    const uint64_t h = fcs_dbm_bloom__hash(key);
+    const fcs_dbm_bloom_block_t * const block =
+        fcs_dbm_bloom__get_block(bloom, h);
+    uint64_t bits = fcs_dbm_bloom__mix(h);
+
+    for (int i = 0 ; i < bloom->num_hashes ; i++,
+        bits >>= FCS_DBM_BLOOM_BIT_IDX_BITS)
+    {
+        const int bit_idx = (int)(bits & FCS_DBM_BLOOM_BIT_MASK);
+
+        if (! (block->words[bit_idx >> 6] & (((uint64_t)1) << (bit_idx & 63))))
+        {
+            bloom->num_definite_negatives++;
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+#undef FCS_DBM_BLOOM_BIT_MASK
+
+/*
+ * To be called when fcs_dbm_bloom__may_contain() returned TRUE but the
+ * store did not contain the key.
+ * */
+static GCC_INLINE void fcs_dbm_bloom__add_false_positive(
+    fcs_dbm_bloom_t * const bloom
+)
+{
+    bloom->num_false_positives++;
+}
+
+/*
+ * The false positive rate predicted from the fill ratio of the filter, in
+ * parts-per-million.
+ * */
+static GCC_INLINE long fcs_dbm_bloom__calc_expected_fpr_ppm(
+    const fcs_dbm_bloom_t * const bloom
+)
+{
+    const double fill = ((double)bloom->num_bits_set) /
+        ((double)bloom->num_blocks * FCS_DBM_BLOOM_BITS_IN_BLOCK);
+    double ret = 1000000.0;
+
+    for (int i = 0 ; i < bloom->num_hashes ; i++)
+    {
+        ret *= fill;
+    }
+
+    return (long)ret;
+}
+
+/*
+ * The false positive rate that was actually observed by the probes of
+ * keys that turned out not to be in the store, in parts-per-million.
+ * */
+static GCC_INLINE long fcs_dbm_bloom__calc_observed_fpr_ppm(
+    const fcs_dbm_bloom_t * const bloom
+)
+{
+    const long num_negatives =
+        bloom->num_definite_negatives + bloom->num_false_positives;
+
+    return (num_negatives
+        ? (long)((1000000.0 * bloom->num_false_positives) / num_negatives)
+        : 0
+    );
+}
+
+static GCC_INLINE void fcs_dbm_bloom__print_stats(
+    const fcs_dbm_bloom_t * const bloom,
+    FILE * const out_fh
+)
+{
+    if (! fcs_dbm_bloom__is_enabled(bloom))
+    {
+        return;
+    }
+    fprintf(out_fh, ">>>Bloom Stats: inserted=%ld blocks=%lu hashes=%d expected_fpr_ppm=%ld observed_fpr_ppm=%ld skipped=%ld\n",
+        bloom->num_inserted,
+        (unsigned long)bloom->num_blocks,
+        bloom->num_hashes,
+        fcs_dbm_bloom__calc_expected_fpr_ppm(bloom),
+        fcs_dbm_bloom__calc_observed_fpr_ppm(bloom),
+        bloom->num_definite_negatives
+    );
+}
+
+#define FCS_DBM_BLOOM_FILE_MAGIC "FCSBLM01"
+
+typedef struct
+{
+    char magic[8];
+    uint64_t num_blocks;
+    int64_t num_hashes, num_inserted, num_bits_set;
+} fcs_dbm_bloom_file_header_t;
+
+/*
+ * Returns TRUE on success. The filter is written to a temporary file which
+ * then replaces filename, so a crash leaves the previously saved filter in
+ * place.
+ * */
+static GCC_INLINE fcs_bool_t fcs_dbm_bloom__save(
+    const fcs_dbm_bloom_t * const bloom,
+    const char * const filename
+)
+{
+    fcs_dbm_bloom_file_header_t header;
+    memset(&header, '\0', sizeof(header));
+    memcpy(header.magic, FCS_DBM_BLOOM_FILE_MAGIC, sizeof(header.magic));
+    header.num_blocks = bloom->num_blocks;
+    header.num_hashes = bloom->num_hashes;
+    header.num_inserted = bloom->num_inserted;
+    header.num_bits_set = bloom->num_bits_set;
+
+    char * const temp_filename = SMALLOC(temp_filename, strlen(filename) + 5);
+    sprintf(temp_filename, "%s.tmp", filename);
+
+    FILE * const f = fopen(temp_filename, "wb");
+    if (! f)
+    {
+        free(temp_filename);
+        return FALSE;
+    }
+    fcs_bool_t ret =
+    (
+        (fwrite(&header, sizeof(header), 1, f) == 1)
+        &&
+        (fwrite(bloom->blocks, sizeof(bloom->blocks[0]), bloom->num_blocks, f)
+            == bloom->num_blocks)
+    );
+    ret = ((fclose(f) == 0) && ret && (rename(temp_filename, filename) == 0));
+    free(temp_filename);
+
+    return ret;
+}
+
+/*
+ * Returns TRUE if the filter was loaded, in which case it should be
+ * destroyed with fcs_dbm_bloom__destroy(). Otherwise, the filter
+ * is left uninitialised.
+ * */
+static GCC_INLINE fcs_bool_t fcs_dbm_bloom__load(
+    fcs_dbm_bloom_t * const bloom,
+    const char * const filename
+)
+{
+    fcs_dbm_bloom_file_header_t header;
+
+    FILE * const f = fopen(filename, "rb");
+    if (! f)
+    {
+        return FALSE;
+    }
+    if ((fread(&header, sizeof(header), 1, f) != 1)
+        || memcmp(header.magic, FCS_DBM_BLOOM_FILE_MAGIC, sizeof(header.magic))
+        || (header.num_blocks < 1)
+        || (header.num_hashes < 1)
+        || (header.num_hashes > FCS_DBM_BLOOM_MAX_NUM_HASHES))
+    {
+        fclose(f);
+        return FALSE;
+    }
+
+    bloom->num_blocks = header.num_blocks;
+    bloom->num_hashes = (int)header.num_hashes;
+    bloom->num_inserted = (long)header.num_inserted;
+    bloom->num_bits_set = (long)header.num_bits_set;
+    bloom->num_definite_negatives = bloom->num_false_positives = 0;
+    fcs_dbm_bloom__alloc_blocks(bloom);
+
+    if (fread(bloom->blocks, sizeof(bloom->blocks[0]), bloom->num_blocks, f)
+        != bloom->num_blocks)
+    {
+        fcs_dbm_bloom__destroy(bloom);
+        fclose(f);
+        return FALSE;
+    }
+    fclose(f);
+
+    return TRUE;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* FC_SOLVE__DBM_BLOOM_H */
@@ -106,6 +106,7 @@ static GCC_INLINE void cache_init(fcs_lru_cache_t * cache, long max_num_elements
     cache->recycle_bin = NULL;
     cache->count_elements_in_cache = 0;
     cache->max_num_elements_in_cache = max_num_elements_in_cache;
+    cache->num_hits = cache->num_misses = 0;
 }
 
 static GCC_INLINE fcs_bool_t cache_does_key_exist(fcs_lru_cache_t * cache, fcs_cache_key_t * key)
@@ -119,6 +120,7 @@ static GCC_INLINE fcs_bool_t cache_does_key_exist(fcs_lru_cache_t * cache, fcs_c
 
     if (! existing_key)
     {
+        cache->num_misses++;
         return FALSE;
     }
     else
@@ -126,6 +128,8 @@ static GCC_INLINE fcs_bool_t cache_does_key_exist(fcs_lru_cache_t * cache, fcs_c
         /* First - promote this key to the top of the cache. */
         fcs_cache_key_info_t * existing;
 
+        cache->num_hits++;
+
         existing = (fcs_cache_key_info_t *)existing_key;
 
         if (existing->higher_pri)
@@ -40,6 +40,7 @@ extern "C"
 
 #include "bool.h"
 #include "inline.h"
+#include "min_and_max.h"
 #include "state.h"
 #include "meta_alloc.h"
 #include "fcs_enums.h"
@@ -77,19 +78,34 @@ typedef struct fcs_derived_state_struct
 
 #ifdef INDIRECT_STACK_STATES
 
-#define COPY_INDIRECT_COLS() \
-{ \
-    for (int copy_col_idx=0 ; copy_col_idx < LOCAL_STACKS_NUM ; copy_col_idx++) \
-    { \
-        copy_stack_col = fcs_state_get_col((ptr_new_state->state.s), copy_col_idx); \
-        memcpy(&(ptr_new_state->indirect_stacks_buffer[copy_col_idx << 7]), copy_stack_col, fcs_col_len(copy_stack_col)+1); \
-        fcs_state_get_col((ptr_new_state->state.s), copy_col_idx) = &(ptr_new_state->indirect_stacks_buffer[copy_col_idx << 7]); \
-   } \
+/*
+ * The columns of a new state keep pointing into the columns of the state
+ * it was derived from, and a column is only copied into the own buffer of
+ * the state before it is modified. So the derived states must be
+ * discarded before the original state is.
+ * */
+static GCC_INLINE fcs_cards_column_t fc_solve_state_own_col(
+    fcs_state_t * const state,
+    char * const indirect_stacks_buffer,
+    const int col_idx
+)
+{
+    const fcs_cards_column_t col = fcs_state_get_col(*state, col_idx);
+    char * const own_col = &(indirect_stacks_buffer[col_idx << 7]);
+    if (col != own_col)
+    {
+        memcpy(own_col, col, fcs_col_len(col)+1);
+        fcs_state_get_col(*state, col_idx) = own_col;
+    }
+    return own_col;
 }
 
+#define OWN_COL(col_idx) \
+    fc_solve_state_own_col(&(new_state), ptr_new_state->indirect_stacks_buffer, (col_idx))
+
 #else
 
-#define COPY_INDIRECT_COLS() {}
+#define OWN_COL(col_idx) fcs_state_get_col(new_state, (col_idx))
 
 #endif
 
@@ -120,8 +136,6 @@ typedef struct fcs_derived_state_struct
         &(ptr_new_state->state), \
         init_state_kv_ptr \
     ); \
-        \
-    COPY_INDIRECT_COLS() \
 }
 
 static GCC_INLINE void fc_solve_add_to_irrev_moves_bitmask(
@@ -165,43 +179,65 @@ static GCC_INLINE void fc_solve_add_to_irrev_moves_bitmask(
 #define SEQS_ARE_BUILT_BY_RANK() (sequences_are_built_by == FCS_SEQ_BUILT_BY_RANK)
 #endif
 
-static GCC_INLINE int calc_foundation_to_put_card_on(
-        enum fcs_dbm_variant_type_t local_variant,
-        fcs_state_t * my_ptr_state,
-        fcs_card_t card
+/*
+ * Fills max_ranks with the highest rank of each suit that may be put in the
+ * foundations safely, because no card that may still be placed on top of
+ * it is left outside them.
+ * */
+static GCC_INLINE void calc_max_safe_ranks(
+        const enum fcs_dbm_variant_type_t local_variant,
+        const fcs_state_t * const my_ptr_state,
+        int * const max_ranks
         )
 {
-    int deck;
-
 #ifndef FCS_FREECELL_ONLY
     /* needed by the macros. */
     const int sequences_are_built_by = CALC_SEQUENCES_ARE_BUILT_BY();
 #endif
+    /* The lowest foundation of the suits of each parity (= colour). */
+    int min_by_parity[2] = {RANK_KING, RANK_KING};
 
-    for(deck=0;deck < INSTANCE_DECKS_NUM;deck++)
+    for (int found_idx = 0 ; found_idx < (INSTANCE_DECKS_NUM << 2) ; found_idx++)
     {
-        if (fcs_foundation_value(*my_ptr_state, (deck<<2)+fcs_card_suit(card)) == fcs_card_rank(card) - 1)
+        const int value = fcs_foundation_value(*my_ptr_state, found_idx);
+        int * const min_ptr = &(min_by_parity[found_idx & 0x1]);
+        if (value < *min_ptr)
         {
-            int other_deck_idx;
+            *min_ptr = value;
+        }
+    }
 
-            for (other_deck_idx = 0 ; other_deck_idx < (INSTANCE_DECKS_NUM << 2) ; other_deck_idx++)
-            {
-                if (fcs_foundation_value(*my_ptr_state, other_deck_idx)
-                        < fcs_card_rank(card) - 2 -
-                        (
-                            SEQS_ARE_BUILT_BY_RANK()
-                            ? 0
-                            : ((other_deck_idx&0x1) == (fcs_card_suit(card)&0x1))
-                        )
-                   )
-                {
-                    break;
-                }
-            }
-            if (other_deck_idx == (INSTANCE_DECKS_NUM << 2))
-            {
-                return (deck<<2)+fcs_card_suit(card);
-            }
+    for (int parity = 0 ; parity < 2 ; parity++)
+    {
+        const int max_rank =
+        (
+            SEQS_ARE_BUILT_BY_RANK()
+            ? (min(min_by_parity[0], min_by_parity[1]) + 2)
+            : min(min_by_parity[parity] + 3, min_by_parity[parity ^ 0x1] + 2)
+        );
+        max_ranks[parity] = max_ranks[parity + 2] = max_rank;
+    }
+}
+
+static GCC_INLINE int calc_foundation_to_put_card_on(
+        const fcs_state_t * const my_ptr_state,
+        const int * const max_ranks,
+        const fcs_card_t card
+        )
+{
+    const int rank = fcs_card_rank(card);
+    const int suit = fcs_card_suit(card);
+
+    if (rank > max_ranks[suit])
+    {
+        return -1;
+    }
+
+    for (int deck = 0 ; deck < INSTANCE_DECKS_NUM ; deck++)
+    {
+        if (fcs_foundation_value(*my_ptr_state, (deck<<2)+suit) == rank - 1)
+        {
+            return (deck<<2)+suit;
         }
     }
     return -1;
@@ -243,24 +279,32 @@ static GCC_INLINE fcs_fcc_moves_list_item_t * fc_solve_fcc_alloc_moves_list_item
                         )
 
 
-/* Returns the number of amortized irreversible moves performed. */
-static GCC_INLINE int horne_prune(
+/*
+ * Returns the number of amortized irreversible moves performed.
+ *
+ * If indirect_stacks_buffer is not NULL, the columns are copied into it
+ * before they are modified, as is done by OWN_COL().
+ * */
+static GCC_INLINE int horne_prune__with_buffer(
     const enum fcs_dbm_variant_type_t local_variant,
     fcs_state_keyval_pair_t * const init_state_kv_ptr,
     fcs_which_moves_bitmask_t * const which_irreversible_moves_bitmask,
     fcs_fcc_moves_seq_t * const moves_seq,
-    fcs_fcc_moves_seq_allocator_t * const allocator
+    fcs_fcc_moves_seq_allocator_t * const allocator,
+    char * const indirect_stacks_buffer
 )
 {
     fcs_fcc_move_t additional_moves[RANK_KING * 4 * DECKS_NUM];
     int count_moves_so_far = 0;
     int count_additional_irrev_moves = 0;
+    int max_ranks[4];
 
 #ifndef FCS_FREECELL_ONLY
     const int sequences_are_built_by = CALC_SEQUENCES_ARE_BUILT_BY();
 #endif
 
 #define the_state (init_state_kv_ptr->s)
+    calc_max_safe_ranks(local_variant, &the_state, max_ranks);
     int num_cards_moved;
     do {
         num_cards_moved = 0;
@@ -274,7 +318,7 @@ static GCC_INLINE int horne_prune(
                 const fcs_card_t card = fcs_col_get_card(col, cards_num-1);
                 const int dest_foundation =
                     calc_foundation_to_put_card_on(
-                        local_variant, &the_state, card
+                        &the_state, max_ranks, card
                     );
                 if (dest_foundation >= 0)
                 {
@@ -289,9 +333,18 @@ static GCC_INLINE int horne_prune(
                         ((! FROM_COL_IS_REVERSIBLE_MOVE()) ? 2 : 1)
                     );
 
+#ifdef INDIRECT_STACK_STATES
+                    if (indirect_stacks_buffer)
+                    {
+                        col = fc_solve_state_own_col(
+                            &the_state, indirect_stacks_buffer, stack_idx
+                        );
+                    }
+#endif
                     fcs_col_pop_top(col);
 
                     fcs_increment_foundation(the_state, dest_foundation);
+                    calc_max_safe_ranks(local_variant, &the_state, max_ranks);
 
                     additional_moves[count_moves_so_far++]
                         = MAKE_MOVE(COL2MOVE(stack_idx), FOUND2MOVE(dest_foundation));
@@ -306,7 +359,9 @@ static GCC_INLINE int horne_prune(
             if (fcs_card_is_valid(card))
             {
                 const int dest_foundation =
-                    calc_foundation_to_put_card_on(local_variant, &the_state, card);
+                    calc_foundation_to_put_card_on(
+                        &the_state, max_ranks, card
+                    );
                 if (dest_foundation >= 0)
                 {
                     num_cards_moved++;
@@ -318,6 +373,7 @@ static GCC_INLINE int horne_prune(
 
                     fcs_empty_freecell(the_state, fc);
                     fcs_increment_foundation(the_state, dest_foundation);
+                    calc_max_safe_ranks(local_variant, &the_state, max_ranks);
                     additional_moves[count_moves_so_far++]
                         = MAKE_MOVE(COL2MOVE(fc), FOUND2MOVE(dest_foundation));
                 }
@@ -377,6 +433,20 @@ static GCC_INLINE int horne_prune(
     return count_moves_so_far + count_additional_irrev_moves;
 }
 
+static GCC_INLINE int horne_prune(
+    const enum fcs_dbm_variant_type_t local_variant,
+    fcs_state_keyval_pair_t * const init_state_kv_ptr,
+    fcs_which_moves_bitmask_t * const which_irreversible_moves_bitmask,
+    fcs_fcc_moves_seq_t * const moves_seq,
+    fcs_fcc_moves_seq_allocator_t * const allocator
+)
+{
+    return horne_prune__with_buffer(
+        local_variant, init_state_kv_ptr, which_irreversible_moves_bitmask,
+        moves_seq, allocator, NULL
+    );
+}
+
 static GCC_INLINE fcs_bool_t instance_solver_thread_calc_derived_states(
     enum fcs_dbm_variant_type_t local_variant,
     fcs_state_keyval_pair_t * init_state_kv_ptr,
@@ -390,9 +460,6 @@ static GCC_INLINE fcs_bool_t instance_solver_thread_calc_derived_states(
     fcs_derived_state_t * ptr_new_state;
     int stack_idx, cards_num, ds;
     fcs_cards_column_t col, dest_col;
-#ifdef INDIRECT_STACK_STATES
-    fcs_cards_column_t copy_stack_col;
-#endif
     fcs_card_t card, dest_card;
     int deck, suit;
     int empty_fc_idx = -1;
@@ -441,7 +508,7 @@ static GCC_INLINE fcs_bool_t instance_solver_thread_calc_derived_states(
 
                     {
                         fcs_cards_column_t new_temp_col;
-                        new_temp_col = fcs_state_get_col(new_state, stack_idx);
+                        new_temp_col = OWN_COL(stack_idx);
                         fcs_col_pop_top(new_temp_col);
                     }
 
@@ -523,8 +590,8 @@ static GCC_INLINE fcs_bool_t instance_solver_thread_calc_derived_states(
                             fcs_cards_column_t new_src_col;
                             fcs_cards_column_t new_dest_col;
 
-                            new_src_col = fcs_state_get_col(new_state, stack_idx);
-                            new_dest_col = fcs_state_get_col(new_state, ds);
+                            new_src_col = OWN_COL(stack_idx);
+                            new_dest_col = OWN_COL(ds);
 
                             fcs_col_pop_top(new_src_col);
                             fcs_col_push_card(new_dest_col, card);
@@ -563,7 +630,7 @@ static GCC_INLINE fcs_bool_t instance_solver_thread_calc_derived_states(
                         {
                             fcs_cards_column_t new_dest_col;
 
-                            new_dest_col = fcs_state_get_col(new_state, ds);
+                            new_dest_col = OWN_COL(ds);
 
                             fcs_col_push_card(new_dest_col, card);
 
@@ -603,11 +670,11 @@ static GCC_INLINE fcs_bool_t instance_solver_thread_calc_derived_states(
                         fcs_cards_column_t new_src_col;
                         fcs_cards_column_t empty_stack_col;
 
-                        new_src_col = fcs_state_get_col(new_state, stack_idx);
+                        new_src_col = OWN_COL(stack_idx);
 
                         fcs_col_pop_top(new_src_col);
 
-                        empty_stack_col = fcs_state_get_col(new_state, empty_stack_idx);
+                        empty_stack_col = OWN_COL(empty_stack_idx);
                         fcs_col_push_card(empty_stack_col, card);
                     }
                     COMMIT_NEW_STATE(
@@ -633,7 +700,7 @@ static GCC_INLINE fcs_bool_t instance_solver_thread_calc_derived_states(
 
                 {
                     fcs_cards_column_t new_dest_col;
-                    new_dest_col = fcs_state_get_col(new_state, empty_stack_idx);
+                    new_dest_col = OWN_COL(empty_stack_idx);
                     fcs_col_push_card(new_dest_col, card);
                     fcs_empty_freecell(new_state, fc_idx);
                 }
@@ -663,7 +730,7 @@ static GCC_INLINE fcs_bool_t instance_solver_thread_calc_derived_states(
                     {
                         fcs_cards_column_t new_src_col;
 
-                        new_src_col = fcs_state_get_col(new_state, stack_idx);
+                        new_src_col = OWN_COL(stack_idx);
 
                         fcs_col_pop_top(new_src_col);
 
@@ -697,7 +764,13 @@ static GCC_INLINE fcs_bool_t instance_solver_thread_calc_derived_states(
                 +
                 (
                     perform_horne_prune
-                    ? horne_prune(local_variant, &(derived_iter->state), &(derived_iter->which_irreversible_moves_bitmask), NULL, NULL)
+                    ? horne_prune__with_buffer(local_variant, &(derived_iter->state), &(derived_iter->which_irreversible_moves_bitmask), NULL, NULL,
+#ifdef INDIRECT_STACK_STATES
+                        derived_iter->indirect_stacks_buffer
+#else
+                        NULL
+#endif
+                    )
                     : 0
                 )
             );
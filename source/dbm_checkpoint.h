@@ -0,0 +1,462 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * dbm_checkpoint.h - periodic checkpoints of the store, the queue and the
+ * counters of a DBM solver instance, and resuming from them.
+ *
+ * A checkpoint is taken while the workers are paused between items, by
+ * fork()ing: the child process writes its copy-on-write snapshot of the
+ * memory to the disk, while the parent resumes the workers immediately.
+ * So the pause does not depend on the size of the collection.
+ *
+ * Only dbm_fc_solver takes checkpoints, and only when it is built with the
+ * kaztree store over the libavl tree. The other builds and solvers reject
+ * the checkpoint options.
+ */
+#ifndef FC_SOLVE__DBM_CHECKPOINT_H
+#define FC_SOLVE__DBM_CHECKPOINT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+#include "inline.h"
+
+/*
+ * To be called by the solvers that cannot take checkpoints on each of their
+ * options, so the checkpoint options fail loudly instead of being ignored
+ * or taken for the board.
+ * */
+static GCC_INLINE void fcs_dbm_checkpoint__reject_option(
+    const char * const arg,
+    const char * const solver_name
+)
+{
+    if ((!strcmp(arg, "--checkpoint-path"))
+        || (!strcmp(arg, "--checkpoint-every"))
+        || (!strcmp(arg, "--resume-from")))
+    {
+        fprintf(stderr,
+            "%s is not supported by %s. Only dbm_fc_solver can take "
+            "checkpoints.\n", arg, solver_name);
+        exit(-1);
+    }
+}
+
+#if defined(FCS_DBM_WITHOUT_CACHES) && defined(FCS_DBM_USE_LIBAVL) && defined(FCS_DBM_RECORD_POINTER_REPR) && defined(FCS_DBM_USE_OFFLOADING_QUEUE)
+
+#define FCS_DBM_ENABLE_CHECKPOINTS 1
+
+#include <stdint.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "bool.h"
+#include "inline.h"
+#include "delta_states.h"
+#include "dbm_solver.h"
+#include "offloading_queue.h"
+
+#define FCS_DBM_CHECKPOINT_MAGIC "FCSCKP01"
+
+typedef struct
+{
+    char magic[8];
+    int64_t encoded_state_size;
+    int64_t count_num_processed, num_states_in_collection;
+    int64_t num_records, num_queue_items;
+    fcs_encoded_state_buffer_t first_key;
+} fcs_dbm_checkpoint_header_t;
+
+typedef struct
+{
+    fcs_encoded_state_buffer_t key, parent;
+    unsigned char has_parent, refcount;
+} fcs_dbm_checkpoint_record_t;
+
+typedef struct
+{
+    /* NULL if checkpoints are disabled. */
+    const char * path;
+    /* The number of processed items between checkpoints. */
+    long every;
+    fcs_bool_t is_pending;
+    pid_t writer_pid;
+} fcs_dbm_checkpointer_t;
+
+static GCC_INLINE void fcs_dbm_checkpointer__init(
+    fcs_dbm_checkpointer_t * const checkpointer,
+    const char * const path,
+    const long every
+)
+{
+    checkpointer->path = path;
+    checkpointer->every = every;
+    checkpointer->is_pending = FALSE;
+    checkpointer->writer_pid = 0;
+}
+
+/* Returns TRUE if the previous checkpoint is still being written. */
+static GCC_INLINE fcs_bool_t fcs_dbm_checkpointer__is_writing(
+    fcs_dbm_checkpointer_t * const checkpointer
+)
+{
+    if (checkpointer->writer_pid > 0)
+    {
+        if (waitpid(checkpointer->writer_pid, NULL, WNOHANG) == 0)
+        {
+            return TRUE;
+        }
+        checkpointer->writer_pid = 0;
+    }
+    return FALSE;
+}
+
+/*
+ * To be called after every extracted item. Makes a checkpoint pending,
+ * after which the workers should stop extracting items until it is taken.
+ * */
+static GCC_INLINE void fcs_dbm_checkpointer__count(
+    fcs_dbm_checkpointer_t * const checkpointer,
+    const long count_num_processed
+)
+{
+    if (checkpointer->path && (count_num_processed % checkpointer->every == 0)
+        && (! fcs_dbm_checkpointer__is_writing(checkpointer)))
+    {
+        checkpointer->is_pending = TRUE;
+    }
+}
+
+static GCC_INLINE void fcs_dbm_checkpoint__calc_page_link(
+    char * const buffer,
+    const char * const path,
+    const long page_index
+)
+{
+    sprintf(buffer, "%s.q%020lX", path, page_index);
+}
+
+/*
+ * Writes the snapshot. Runs in the forked child. The offloaded queue pages
+ * were hard-linked by the parent, because it may consume and delete them
+ * in the meanwhile.
+ * */
+static GCC_INLINE fcs_bool_t fcs_dbm_checkpoint__write(
+    const char * const path,
+    fcs_dbm_store_t store,
+    fcs_offloading_queue_t * const queue,
+    const fcs_encoded_state_buffer_t * const first_key,
+    const long count_num_processed,
+    const long num_states_in_collection
+)
+{
+    char temp_path[PATH_MAX], page_path[PATH_MAX];
+    dict_t * const tree = fc_solve_dbm_store_get_dict(store);
+    struct avl_traverser trav;
+    dict_key_t item;
+    fcs_dbm_checkpoint_header_t header;
+    fcs_dbm_checkpoint_record_t rec;
+    fcs_bool_t ret = TRUE;
+
+    snprintf(temp_path, sizeof(temp_path), "%s.temp", path);
+    FILE * const f = fopen(temp_path, "wb");
+    if (! f)
+    {
+        return FALSE;
+    }
+
+    memset(&header, '\0', sizeof(header));
+    memcpy(header.magic, FCS_DBM_CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.encoded_state_size = sizeof(fcs_encoded_state_buffer_t);
+    header.count_num_processed = count_num_processed;
+    header.num_states_in_collection = num_states_in_collection;
+    header.num_records = (int64_t)tree->avl_count;
+    header.num_queue_items = queue->num_items_in_queue;
+    header.first_key = *first_key;
+    ret &= (fwrite(&header, sizeof(header), 1, f) == 1);
+
+    memset(&rec, '\0', sizeof(rec));
+    avl_t_init(&trav, tree);
+    for (item = avl_t_first(&trav, tree) ; item ; item = avl_t_next(&trav))
+    {
+        fcs_dbm_record_t * const record = (fcs_dbm_record_t *)item;
+        fcs_dbm_record_t * const parent = fcs_dbm_record_get_parent_ptr(record);
+
+        rec.key = record->key;
+        if ((rec.has_parent = (parent != NULL)))
+        {
+            rec.parent = parent->key;
+        }
+        else
+        {
+            fcs_init_encoded_state(&(rec.parent));
+        }
+        rec.refcount = fcs_dbm_record_get_refcount(record);
+        ret &= (fwrite(&rec, sizeof(rec), 1, f) == 1);
+    }
+
+    /* The queue: the read page, the offloaded pages and the write page. */
+    {
+        const fcs_offloading_queue_page_t * const read_page =
+            &(queue->pages[queue->page_idx_to_read_from]);
+        const fcs_offloading_queue_page_t * const write_page =
+            &(queue->pages[queue->page_idx_to_write_to]);
+        fcs_offloading_queue_item_t * const page_items =
+            SMALLOC(page_items, queue->num_items_per_page);
+
+#define WRITE_QUEUE_ITEMS(items, start, end) \
+        for (int i = (start) ; i < (end) ; i++) \
+        { \
+            ret &= (fwrite(&(((const fcs_dbm_record_t *)(items)[i])->key), \
+                sizeof(fcs_encoded_state_buffer_t), 1, f) == 1); \
+        }
+        WRITE_QUEUE_ITEMS(((const fcs_offloading_queue_item_t *)read_page->data),
+            read_page->read_from_idx, read_page->write_to_idx);
+
+        if (write_page != read_page)
+        {
+            for (long page_index = read_page->page_index + 1 ;
+                page_index < write_page->page_index ; page_index++)
+            {
+                fcs_dbm_checkpoint__calc_page_link(page_path, path, page_index);
+                FILE * const page_f = fopen(page_path, "rb");
+                if (! page_f)
+                {
+                    ret = FALSE;
+                    break;
+                }
+                ret &= (fread(page_items, sizeof(page_items[0]),
+                    queue->num_items_per_page, page_f)
+                    == (size_t)queue->num_items_per_page);
+                fclose(page_f);
+                WRITE_QUEUE_ITEMS(page_items, 0, queue->num_items_per_page);
+            }
+            WRITE_QUEUE_ITEMS(((const fcs_offloading_queue_item_t *)write_page->data),
+                0, write_page->write_to_idx);
+        }
+#undef WRITE_QUEUE_ITEMS
+        free(page_items);
+    }
+
+    ret &= (fflush(f) == 0);
+    ret &= (fsync(fileno(f)) == 0);
+    ret &= (fclose(f) == 0);
+
+    /* Only replace the previous checkpoint by a complete one. */
+    return (ret && (rename(temp_path, path) == 0));
+}
+
+/*
+ * Takes a checkpoint. Should be called with the queue lock held and
+ * no items in the middle of being processed.
+ * */
+static GCC_INLINE void fcs_dbm_checkpointer__take(
+    fcs_dbm_checkpointer_t * const checkpointer,
+    fcs_dbm_store_t store,
+    fcs_offloading_queue_t * const queue,
+    const fcs_encoded_state_buffer_t * const first_key,
+    const long count_num_processed,
+    const long num_states_in_collection
+)
+{
+    char page_path[PATH_MAX], link_path[PATH_MAX];
+    const fcs_offloading_queue_page_t * const read_page =
+        &(queue->pages[queue->page_idx_to_read_from]);
+    const fcs_offloading_queue_page_t * const write_page =
+        &(queue->pages[queue->page_idx_to_write_to]);
+    long page_index;
+
+    checkpointer->is_pending = FALSE;
+
+    for (page_index = read_page->page_index + 1 ;
+        page_index < write_page->page_index ; page_index++)
+    {
+        fcs_offloading_queue_page_t page = *write_page;
+        page.page_index = page_index;
+        fcs_offloading_queue_page__calc_filename(&page, page_path,
+            queue->offload_dir_path);
+        fcs_dbm_checkpoint__calc_page_link(link_path, checkpointer->path,
+            page_index);
+        unlink(link_path);
+        if (link(page_path, link_path))
+        {
+            fprintf(stderr, "Could not link \"%s\" for the checkpoint.\n",
+                page_path);
+            return;
+        }
+    }
+
+    const pid_t pid = fork();
+    if (pid < 0)
+    {
+        fprintf(stderr, "%s\n", "Could not fork the checkpoint writer.");
+    }
+    else if (pid == 0)
+    {
+        const fcs_bool_t ok = fcs_dbm_checkpoint__write(
+            checkpointer->path, store, queue, first_key,
+            count_num_processed, num_states_in_collection
+        );
+        for (page_index = read_page->page_index + 1 ;
+            page_index < write_page->page_index ; page_index++)
+        {
+            fcs_dbm_checkpoint__calc_page_link(link_path, checkpointer->path,
+                page_index);
+            unlink(link_path);
+        }
+        if (! ok)
+        {
+            fprintf(stderr, "Could not write the checkpoint \"%s\".\n",
+                checkpointer->path);
+        }
+        _exit(ok ? 0 : 1);
+    }
+    else
+    {
+        checkpointer->writer_pid = pid;
+    }
+}
+
+/* Waits for the last checkpoint to be written. */
+static GCC_INLINE void fcs_dbm_checkpointer__finish(
+    fcs_dbm_checkpointer_t * const checkpointer
+)
+{
+    if (checkpointer->writer_pid > 0)
+    {
+        waitpid(checkpointer->writer_pid, NULL, 0);
+        checkpointer->writer_pid = 0;
+    }
+}
+
+static GCC_INLINE fcs_dbm_record_t * fcs_dbm_checkpoint__lookup(
+    dict_t * const tree,
+    const fcs_encoded_state_buffer_t * const key
+)
+{
+    fcs_dbm_record_t to_check;
+    memset(&to_check, '\0', sizeof(to_check));
+    to_check.key = *key;
+
+    return (fcs_dbm_record_t *)fc_solve_kaz_tree_lookup_value(tree, &to_check);
+}
+
+/*
+ * Restores a checkpoint into an empty store and queue. The work is
+ * proportional to the size of the checkpoint. Exits on errors.
+ * */
+static GCC_INLINE void fcs_dbm_checkpoint__restore(
+    const char * const path,
+    fcs_dbm_store_t store,
+    fcs_offloading_queue_t * const queue,
+    const fcs_encoded_state_buffer_t * const first_key,
+    long * const count_num_processed,
+    long * const num_states_in_collection,
+    long * const count_of_items_in_queue
+)
+{
+    fcs_dbm_checkpoint_header_t header;
+    fcs_dbm_checkpoint_record_t rec;
+    dict_t * const tree = fc_solve_dbm_store_get_dict(store);
+
+    FILE * const f = fopen(path, "rb");
+    if (! f)
+    {
+        fprintf(stderr, "Cannot open the checkpoint \"%s\".\n", path);
+        exit(-1);
+    }
+    if ((fread(&header, sizeof(header), 1, f) != 1)
+        || memcmp(header.magic, FCS_DBM_CHECKPOINT_MAGIC, sizeof(header.magic))
+        || (header.encoded_state_size != sizeof(fcs_encoded_state_buffer_t)))
+    {
+        fprintf(stderr, "\"%s\" is not a valid checkpoint.\n", path);
+        exit(-1);
+    }
+    if (memcmp(&(header.first_key), first_key, sizeof(*first_key)))
+    {
+        fprintf(stderr, "The checkpoint \"%s\" is of a different board.\n", path);
+        exit(-1);
+    }
+
+    /* First insert all the records and then link them to their parents. */
+    const long records_start = ftell(f);
+    for (int64_t i = 0 ; i < header.num_records ; i++)
+    {
+        if (fread(&rec, sizeof(rec), 1, f) != 1)
+        {
+            fprintf(stderr, "The checkpoint \"%s\" is truncated.\n", path);
+            exit(-1);
+        }
+        fc_solve_dbm_store_insert_key_value(store, &(rec.key), NULL, FALSE);
+    }
+    fseek(f, records_start, SEEK_SET);
+    for (int64_t i = 0 ; i < header.num_records ; i++)
+    {
+        if (fread(&rec, sizeof(rec), 1, f) != 1)
+        {
+            fprintf(stderr, "The checkpoint \"%s\" is truncated.\n", path);
+            exit(-1);
+        }
+        fcs_dbm_record_t * const record =
+            fcs_dbm_checkpoint__lookup(tree, &(rec.key));
+        fcs_dbm_record_set_parent_ptr(record,
+            (rec.has_parent ? fcs_dbm_checkpoint__lookup(tree, &(rec.parent)) : NULL)
+        );
+        fcs_dbm_record_set_refcount(record, rec.refcount);
+    }
+
+    for (int64_t i = 0 ; i < header.num_queue_items ; i++)
+    {
+        fcs_encoded_state_buffer_t key;
+        if (fread(&key, sizeof(key), 1, f) != 1)
+        {
+            fprintf(stderr, "The checkpoint \"%s\" is truncated.\n", path);
+            exit(-1);
+        }
+        const fcs_offloading_queue_item_t token =
+            (fcs_offloading_queue_item_t)fcs_dbm_checkpoint__lookup(tree, &key);
+        fcs_offloading_queue__insert(queue, &token);
+    }
+    fclose(f);
+
+    *count_num_processed = (long)header.count_num_processed;
+    *num_states_in_collection = (long)header.num_states_in_collection;
+    *count_of_items_in_queue = (long)header.num_queue_items;
+}
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* FC_SOLVE__DBM_CHECKPOINT_H */
@@ -0,0 +1,602 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * dbm_ddd.h - on-disk files of (state, parent) records for the delayed
+ * duplicate detection mode of depth_dbm_solver.c, in the style of
+ * Korf's "Delayed Duplicate Detection".
+ *
+ * A BFS layer is written to disk unsorted, then sorted and deduplicated
+ * by an external merge-sort (fcs_ddd__sort_unique()) and finally
+ * subtracted from the states that were already visited by a single
+ * streaming merge (fcs_ddd__subtract_and_merge()). All the I/O is
+ * sequential, except for the lookups of the solution's trace.
+ */
+#ifndef FC_SOLVE__DBM_DDD_H
+#define FC_SOLVE__DBM_DDD_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "config.h"
+#include "bool.h"
+#include "inline.h"
+#include "alloc_wrap.h"
+
+#include "delta_states.h"
+
+typedef struct
+{
+    fcs_encoded_state_buffer_t key;
+    /* Zeroed for the initial state. */
+    fcs_encoded_state_buffer_t parent;
+} fcs_ddd_record_t;
+
+/* The maximal number of runs that are merged at once. */
+#define FCS_DDD_MERGE_FAN_IN 64
+#define FCS_DDD_READ_BUF_RECORDS 4096
+#define FCS_DDD_PATH_MAX 1024
+
+static GCC_INLINE int fcs_ddd__compare_keys(
+    const fcs_encoded_state_buffer_t * const a,
+    const fcs_encoded_state_buffer_t * const b
+)
+{
+#ifdef FCS_DEBONDT_DELTA_STATES
+    return memcmp(a, b, sizeof(*a));
+#else
+    if (a->s[0] != b->s[0])
+    {
+        return ((a->s[0] < b->s[0]) ? -1 : 1);
+    }
+    return memcmp(a->s, b->s, a->s[0]+1);
+#endif
+}
+
+static GCC_INLINE int fcs_ddd__compare_records(const void * a, const void * b)
+{
+    return fcs_ddd__compare_keys(
+        &(((const fcs_ddd_record_t *)a)->key),
+        &(((const fcs_ddd_record_t *)b)->key)
+    );
+}
+
+static GCC_INLINE FILE * fcs_ddd__open(
+    const char * const path,
+    const char * const mode
+)
+{
+    FILE * const f = fopen(path, mode);
+    if (! f)
+    {
+        fprintf(stderr, "Could not open the DDD file \"%s\".\n", path);
+        exit(-1);
+    }
+    return f;
+}
+
+static GCC_INLINE void fcs_ddd__write(
+    FILE * const f,
+    const fcs_ddd_record_t * const records,
+    const size_t count
+)
+{
+    if (fwrite(records, sizeof(records[0]), count, f) != count)
+    {
+        fprintf(stderr, "%s\n", "Writing to a DDD file failed.");
+        exit(-1);
+    }
+}
+
+static GCC_INLINE off_t fcs_ddd__count_records(const char * const path)
+{
+    FILE * const f = fopen(path, "rb");
+    if (! f)
+    {
+        return 0;
+    }
+    fseeko(f, 0, SEEK_END);
+    const off_t ret = ftello(f) / (off_t)sizeof(fcs_ddd_record_t);
+    fclose(f);
+
+    return ret;
+}
+
+/* A buffered sequential reader of a records file. */
+typedef struct
+{
+    FILE * f;
+    fcs_ddd_record_t * buf;
+    size_t count, idx;
+    off_t remaining;
+} fcs_ddd_reader_t;
+
+static GCC_INLINE fcs_bool_t fcs_ddd_reader__fill(
+    fcs_ddd_reader_t * const reader
+)
+{
+    if (reader->idx < reader->count)
+    {
+        return TRUE;
+    }
+    size_t to_read = FCS_DDD_READ_BUF_RECORDS;
+    if ((off_t)to_read > reader->remaining)
+    {
+        to_read = (size_t)reader->remaining;
+    }
+    reader->count = (to_read
+        ? fread(reader->buf, sizeof(reader->buf[0]), to_read, reader->f)
+        : 0
+    );
+    reader->remaining -= (off_t)reader->count;
+    reader->idx = 0;
+
+    return (reader->count > 0);
+}
+
+/*
+ * Opens a reader of "num_records" records starting at record index "start".
+ * A negative num_records means "until the end of the file". A missing
+ * file is treated as an empty one.
+ * */
+static GCC_INLINE void fcs_ddd_reader__init(
+    fcs_ddd_reader_t * const reader,
+    const char * const path,
+    const off_t start,
+    const off_t num_records
+)
+{
+    reader->buf = SMALLOC(reader->buf, FCS_DDD_READ_BUF_RECORDS);
+    reader->count = reader->idx = 0;
+    if (! (reader->f = fopen(path, "rb")))
+    {
+        reader->remaining = 0;
+        return;
+    }
+    fseeko(reader->f, start * (off_t)sizeof(fcs_ddd_record_t), SEEK_SET);
+    reader->remaining = ((num_records < 0)
+        ? (fcs_ddd__count_records(path) - start)
+        : num_records
+    );
+}
+
+/* Returns NULL at the end of the file. */
+static GCC_INLINE const fcs_ddd_record_t * fcs_ddd_reader__peek(
+    fcs_ddd_reader_t * const reader
+)
+{
+    return (fcs_ddd_reader__fill(reader) ? &(reader->buf[reader->idx]) : NULL);
+}
+
+static GCC_INLINE const fcs_ddd_record_t * fcs_ddd_reader__next(
+    fcs_ddd_reader_t * const reader
+)
+{
+    return (fcs_ddd_reader__fill(reader) ? &(reader->buf[reader->idx++]) : NULL);
+}
+
+static GCC_INLINE void fcs_ddd_reader__destroy(
+    fcs_ddd_reader_t * const reader
+)
+{
+    if (reader->f)
+    {
+        fclose(reader->f);
+        reader->f = NULL;
+    }
+    free(reader->buf);
+    reader->buf = NULL;
+}
+
+/*
+ * Merges the sorted files in_paths into the sorted file out_path while
+ * keeping only the first record of every key. Returns the number of
+ * records written.
+ * */
+static GCC_INLINE off_t fcs_ddd__merge_unique(
+    char * * const in_paths,
+    const int num_in,
+    const char * const out_path
+)
+{
+    fcs_ddd_reader_t * const readers = SMALLOC(readers, num_in);
+    /* A binary min-heap of reader indexes. */
+    int * const heap = SMALLOC(heap, num_in);
+    int heap_len = 0;
+    off_t ret = 0;
+    fcs_ddd_record_t last;
+    FILE * const out = fcs_ddd__open(out_path, "wb");
+
+#define HEAP_KEY(i) (&(fcs_ddd_reader__peek(&(readers[heap[i]]))->key))
+#define HEAP_SWAP(i, j) { const int t = heap[i]; heap[i] = heap[j]; heap[j] = t; }
+    for (int i = 0 ; i < num_in ; i++)
+    {
+        fcs_ddd_reader__init(&(readers[i]), in_paths[i], 0, -1);
+        if (fcs_ddd_reader__peek(&(readers[i])))
+        {
+            int pos = heap_len++;
+            heap[pos] = i;
+            while (pos > 0
+                && fcs_ddd__compare_keys(HEAP_KEY(pos), HEAP_KEY((pos-1)/2)) < 0)
+            {
+                HEAP_SWAP(pos, (pos-1)/2);
+                pos = (pos-1)/2;
+            }
+        }
+    }
+
+    while (heap_len > 0)
+    {
+        const fcs_ddd_record_t * const rec =
+            fcs_ddd_reader__next(&(readers[heap[0]]));
+
+        if ((! ret) || fcs_ddd__compare_keys(&(rec->key), &(last.key)))
+        {
+            last = *rec;
+            fcs_ddd__write(out, &last, 1);
+            ret++;
+        }
+
+        if (! fcs_ddd_reader__peek(&(readers[heap[0]])))
+        {
+            heap[0] = heap[--heap_len];
+        }
+        /* Sift down. */
+        int pos = 0;
+        while (1)
+        {
+            const int left = pos*2+1, right = left+1;
+            int smallest = pos;
+            if (left < heap_len
+                && fcs_ddd__compare_keys(HEAP_KEY(left), HEAP_KEY(smallest)) < 0)
+            {
+                smallest = left;
+            }
+            if (right < heap_len
+                && fcs_ddd__compare_keys(HEAP_KEY(right), HEAP_KEY(smallest)) < 0)
+            {
+                smallest = right;
+            }
+            if (smallest == pos)
+            {
+                break;
+            }
+            HEAP_SWAP(pos, smallest);
+            pos = smallest;
+        }
+    }
+#undef HEAP_SWAP
+#undef HEAP_KEY
+
+    for (int i = 0 ; i < num_in ; i++)
+    {
+        fcs_ddd_reader__destroy(&(readers[i]));
+    }
+    free(readers);
+    free(heap);
+    fclose(out);
+
+    return ret;
+}
+
+typedef struct
+{
+    fcs_ddd_record_t * records;
+    size_t count;
+    /* Room for the suffixes appended to the tmp_prefix. */
+    char path[FCS_DDD_PATH_MAX + 32];
+    /* For the merge passes. */
+    char * * in_paths;
+    int num_in;
+} fcs_ddd_sort_job_t;
+
+static GCC_INLINE void * fcs_ddd__sort_run_thread(void * void_job)
+{
+    fcs_ddd_sort_job_t * const job = (fcs_ddd_sort_job_t *)void_job;
+
+    qsort(job->records, job->count, sizeof(job->records[0]),
+        fcs_ddd__compare_records);
+
+    FILE * const out = fcs_ddd__open(job->path, "wb");
+    for (size_t i = 0 ; i < job->count ; i++)
+    {
+        /* Deduplicate inside the run as well. */
+        if ((! i) || fcs_ddd__compare_records(
+            &(job->records[i-1]), &(job->records[i])))
+        {
+            fcs_ddd__write(out, &(job->records[i]), 1);
+        }
+    }
+    fclose(out);
+
+    return NULL;
+}
+
+static GCC_INLINE void * fcs_ddd__merge_run_thread(void * void_job)
+{
+    fcs_ddd_sort_job_t * const job = (fcs_ddd_sort_job_t *)void_job;
+
+    fcs_ddd__merge_unique(job->in_paths, job->num_in, job->path);
+
+    return NULL;
+}
+
+static GCC_INLINE void fcs_ddd__run_jobs(
+    void * (*cb)(void *),
+    fcs_ddd_sort_job_t * const jobs,
+    const int num_jobs
+)
+{
+    pthread_t * const ids = SMALLOC(ids, num_jobs);
+
+    for (int i = 0 ; i < num_jobs ; i++)
+    {
+        if (pthread_create(&(ids[i]), NULL, cb, &(jobs[i])))
+        {
+            fprintf(stderr, "DDD sort thread No. %d failed to start!\n", i);
+            exit(-1);
+        }
+    }
+    for (int i = 0 ; i < num_jobs ; i++)
+    {
+        pthread_join(ids[i], NULL);
+    }
+    free(ids);
+}
+
+/*
+ * Sorts and deduplicates the concatenation of the unsorted files in_paths
+ * into out_path using at most run_size records of RAM. The runs are sorted
+ * and merged by num_threads threads in parallel. tmp_prefix is used for
+ * the names of the temporary run files. Returns the number of unique
+ * records.
+ * */
+static GCC_INLINE off_t fcs_ddd__sort_unique(
+    char * * const in_paths,
+    const int num_in,
+    const char * const out_path,
+    const char * const tmp_prefix,
+    const size_t run_size,
+    const int num_threads
+)
+{
+    fcs_ddd_record_t * const records = SMALLOC(records, run_size);
+    fcs_ddd_sort_job_t * const jobs = SMALLOC(jobs, num_threads);
+    char * * run_paths = NULL;
+    int num_runs = 0, max_num_runs = 0;
+    int in_idx = 0;
+    FILE * in = NULL;
+    off_t ret;
+
+    /* Phase 1: split the input into sorted runs. */
+    while (1)
+    {
+        size_t count = 0;
+        while (count < run_size)
+        {
+            if (! in)
+            {
+                if (in_idx == num_in)
+                {
+                    break;
+                }
+                if (! (in = fopen(in_paths[in_idx++], "rb")))
+                {
+                    continue;
+                }
+            }
+            const size_t got = fread(records + count, sizeof(records[0]),
+                run_size - count, in);
+            count += got;
+            if (count < run_size)
+            {
+                fclose(in);
+                in = NULL;
+            }
+        }
+        if (! count)
+        {
+            break;
+        }
+
+        const size_t slice = (count + num_threads - 1) / num_threads;
+        int num_jobs = 0;
+        for (size_t start = 0 ; start < count ; start += slice)
+        {
+            fcs_ddd_sort_job_t * const job = &(jobs[num_jobs++]);
+            job->records = records + start;
+            job->count = ((count - start < slice) ? (count - start) : slice);
+            if (num_runs == max_num_runs)
+            {
+                run_paths = SREALLOC(run_paths, max_num_runs += 16);
+            }
+            snprintf(job->path, sizeof(job->path), "%s.run%d", tmp_prefix,
+                num_runs);
+            run_paths[num_runs++] = strdup(job->path);
+        }
+        fcs_ddd__run_jobs(fcs_ddd__sort_run_thread, jobs, num_jobs);
+    }
+    free(records);
+
+    /* Phase 2: merge the runs in passes until few enough are left. */
+    int pass = 0;
+    while (num_runs > FCS_DDD_MERGE_FAN_IN)
+    {
+        const int num_groups =
+            (num_runs + FCS_DDD_MERGE_FAN_IN - 1) / FCS_DDD_MERGE_FAN_IN;
+        char * * const new_run_paths = SMALLOC(new_run_paths, num_groups);
+
+        pass++;
+        for (int group = 0 ; group < num_groups ; group += num_threads)
+        {
+            int num_jobs = 0;
+            for ( ; (num_jobs < num_threads) && (group + num_jobs < num_groups)
+                ; num_jobs++)
+            {
+                const int g = group + num_jobs;
+                fcs_ddd_sort_job_t * const job = &(jobs[num_jobs]);
+                job->in_paths = run_paths + g * FCS_DDD_MERGE_FAN_IN;
+                job->num_in = (((g+1) * FCS_DDD_MERGE_FAN_IN <= num_runs)
+                    ? FCS_DDD_MERGE_FAN_IN
+                    : (num_runs - g * FCS_DDD_MERGE_FAN_IN)
+                );
+                snprintf(job->path, sizeof(job->path), "%s.pass%d.run%d",
+                    tmp_prefix, pass, g);
+                new_run_paths[g] = strdup(job->path);
+            }
+            fcs_ddd__run_jobs(fcs_ddd__merge_run_thread, jobs, num_jobs);
+        }
+
+        for (int i = 0 ; i < num_runs ; i++)
+        {
+            unlink(run_paths[i]);
+            free(run_paths[i]);
+        }
+        free(run_paths);
+        run_paths = new_run_paths;
+        num_runs = max_num_runs = num_groups;
+    }
+    free(jobs);
+
+    ret = fcs_ddd__merge_unique(run_paths, num_runs, out_path);
+
+    for (int i = 0 ; i < num_runs ; i++)
+    {
+        unlink(run_paths[i]);
+        free(run_paths[i]);
+    }
+    free(run_paths);
+
+    return ret;
+}
+
+/*
+ * Removes the records of the sorted file frontier_path whose keys are in
+ * the sorted file visited_path, and writes the remainder to
+ * out_frontier_path. out_visited_path receives the union of both.
+ * Returns the number of records in out_frontier_path.
+ * */
+static GCC_INLINE off_t fcs_ddd__subtract_and_merge(
+    const char * const frontier_path,
+    const char * const visited_path,
+    const char * const out_frontier_path,
+    const char * const out_visited_path
+)
+{
+    fcs_ddd_reader_t frontier, visited;
+    const fcs_ddd_record_t * f_rec, * v_rec;
+    FILE * const out_frontier = fcs_ddd__open(out_frontier_path, "wb");
+    FILE * const out_visited = fcs_ddd__open(out_visited_path, "wb");
+    off_t ret = 0;
+
+    fcs_ddd_reader__init(&frontier, frontier_path, 0, -1);
+    fcs_ddd_reader__init(&visited, visited_path, 0, -1);
+
+    while ((f_rec = fcs_ddd_reader__peek(&frontier)))
+    {
+        int cmp = -1;
+        while ((v_rec = fcs_ddd_reader__peek(&visited))
+            && ((cmp = fcs_ddd__compare_keys(&(v_rec->key), &(f_rec->key))) < 0))
+        {
+            fcs_ddd__write(out_visited, v_rec, 1);
+            fcs_ddd_reader__next(&visited);
+        }
+        if ((! v_rec) || (cmp > 0))
+        {
+            fcs_ddd__write(out_frontier, f_rec, 1);
+            fcs_ddd__write(out_visited, f_rec, 1);
+            ret++;
+        }
+        fcs_ddd_reader__next(&frontier);
+    }
+    while ((v_rec = fcs_ddd_reader__next(&visited)))
+    {
+        fcs_ddd__write(out_visited, v_rec, 1);
+    }
+
+    fcs_ddd_reader__destroy(&frontier);
+    fcs_ddd_reader__destroy(&visited);
+    fclose(out_frontier);
+    fclose(out_visited);
+
+    return ret;
+}
+
+/*
+ * Looks up key in the sorted file path using a binary search. Returns
+ * TRUE and fills *ret if it was found.
+ * */
+static GCC_INLINE fcs_bool_t fcs_ddd__lookup(
+    const char * const path,
+    const fcs_encoded_state_buffer_t * const key,
+    fcs_ddd_record_t * const ret
+)
+{
+    FILE * const f = fopen(path, "rb");
+    if (! f)
+    {
+        return FALSE;
+    }
+    off_t low = 0, high = fcs_ddd__count_records(path);
+
+    while (low < high)
+    {
+        const off_t mid = low + ((high - low) >> 1);
+        fseeko(f, mid * (off_t)sizeof(*ret), SEEK_SET);
+        if (fread(ret, sizeof(*ret), 1, f) != 1)
+        {
+            break;
+        }
+        const int cmp = fcs_ddd__compare_keys(&(ret->key), key);
+        if (cmp == 0)
+        {
+            fclose(f);
+            return TRUE;
+        }
+        else if (cmp < 0)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+    fclose(f);
+
+    return FALSE;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* FC_SOLVE__DBM_DDD_H */
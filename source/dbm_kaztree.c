@@ -1,6 +1,7 @@
 #include <sys/types.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <assert.h>
 
 #include "alloc_wrap.h"
 #include "dbm_solver.h"
@@ -15,6 +16,9 @@ typedef struct
 #ifndef FCS_LIBAVL_STORE_WHOLE_KEYS
     fcs_compact_allocator_t allocator;
 #endif
+#ifdef FCS_DBM_USE_BPTREE
+    void * * recycle_bin;
+#endif
 } dbm_t;
 
 void fc_solve_dbm_store_init(fcs_dbm_store_t * store, const char * path, void * * recycle_bin_ptr)
@@ -33,6 +37,9 @@ void fc_solve_dbm_store_init(fcs_dbm_store_t * store, const char * path, void *
         &(db->allocator), &(db->meta_alloc)
     );
 #endif
+#ifdef FCS_DBM_USE_BPTREE
+    db->recycle_bin = recycle_bin_ptr;
+#endif
 
     *store = (fcs_dbm_store_t)db;
     return;
@@ -45,6 +52,96 @@ dict_t * fc_solve_dbm_store_get_dict(
     return (((dbm_t *)store)->kaz_tree);
 }
 
+#ifndef FCS_LIBAVL_STORE_WHOLE_KEYS
+static GCC_INLINE fcs_dbm_record_t * alloc_record_to_check(
+    dbm_t * const db
+)
+{
+#ifdef FCS_DBM_USE_BPTREE
+    fcs_dbm_record_t * const recycled = (fcs_dbm_record_t *)(*(db->recycle_bin));
+    if (recycled)
+    {
+        *(db->recycle_bin) = FCS_DBM_RECORD_NEXT(recycled);
+        return recycled;
+    }
+#endif
+    return (fcs_dbm_record_t *)fcs_compact_alloc_ptr(&(db->allocator), sizeof(fcs_dbm_record_t));
+}
+#endif
+
+/*
+ * Inserts the record in to_check, which was allocated by
+ * alloc_record_to_check(). Returns the stored record, or NULL if the key
+ * already existed.
+ * */
+static GCC_INLINE fcs_dbm_record_t * insert_record(
+    dbm_t * const db,
+    fcs_dbm_record_t * const to_check,
+    fcs_dbm_record_t * const parent,
+    const fcs_bool_t should_modify_parent
+)
+{
+#ifdef FCS_DBM_USE_LIBAVL
+    /* avl_probe() returns the stored record, so there is no need for
+     * another descent to find it after it was inserted. */
+    const size_t count_before = db->kaz_tree->avl_count;
+    avl_key_t * const probed = avl_probe(db->kaz_tree, to_check);
+    const fcs_bool_t ret = (db->kaz_tree->avl_count != count_before);
+#else
+    const fcs_bool_t ret =
+        (fc_solve_kaz_tree_alloc_insert(db->kaz_tree, to_check) == NULL);
+#endif
+
+#ifndef FCS_LIBAVL_STORE_WHOLE_KEYS
+    if (! ret)
+    {
+#ifdef FCS_DBM_USE_BPTREE
+        /* It may have come from the recycle bin. */
+        fcs_dbm_record_recycle(to_check, db->recycle_bin);
+#else
+        fcs_compact_alloc_release(&(db->allocator));
+#endif
+    }
+#endif
+    if (ret)
+    {
+#ifdef FCS_EXPLICIT_REFCOUNT
+        if (should_modify_parent && parent)
+        {
+            fcs_dbm_record_increment_refcount(parent);
+        }
+#endif
+
+#ifdef FCS_DBM_USE_LIBAVL
+        return ((fcs_dbm_record_t *)AVL_KEY_PTR_PTR(probed));
+#elif !defined(FCS_LIBAVL_STORE_WHOLE_KEYS)
+        /* The tree keeps a pointer to the record itself. */
+        return to_check;
+#else
+        return ((fcs_dbm_record_t *)(fc_solve_kaz_tree_lookup_value(db->kaz_tree, to_check)));
+#endif
+    }
+    else
+    {
+        return NULL;
+    }
+}
+
+static GCC_INLINE void fill_record(
+    fcs_dbm_record_t * const to_check,
+    const fcs_encoded_state_buffer_t * const key,
+    fcs_dbm_record_t * const parent
+)
+{
+#ifdef FCS_DBM_RECORD_POINTER_REPR
+    to_check->key = *key;
+    fcs_dbm_record_set_parent_ptr(to_check, parent);
+#else
+    to_check->key = *key;
+    to_check->parent = parent->parent;
+#endif
+}
+
 /*
  * Returns TRUE if the key was added (it didn't already exist.)
  * */
@@ -72,39 +169,67 @@ fcs_dbm_record_t * fc_solve_dbm_store_insert_key_value(
 #ifdef FCS_LIBAVL_STORE_WHOLE_KEYS
     to_check = &record_on_stack;
 #else
-    to_check = (fcs_dbm_record_t *)fcs_compact_alloc_ptr(&(db->allocator), sizeof(*to_check));
+    to_check = alloc_record_to_check(db);
 #endif
 
-#ifdef FCS_DBM_RECORD_POINTER_REPR
-    to_check->key = *key;
-    fcs_dbm_record_set_parent_ptr(to_check, parent);
-#else
-    to_check->key = *key;
-    to_check->parent = parent->parent;
-#endif
-    fcs_bool_t ret =
-        (fc_solve_kaz_tree_alloc_insert(db->kaz_tree, to_check) == NULL);
+    fill_record(to_check, key, parent);
 
-#ifndef FCS_LIBAVL_STORE_WHOLE_KEYS
-    if (! ret)
+    return insert_record(db, to_check, parent, should_modify_parent);
+}
+
+void fc_solve_dbm_store_insert_key_values(
+    fcs_dbm_store_t store,
+    const int count,
+    const fcs_encoded_state_buffer_t * const * const keys,
+    fcs_dbm_record_t * const * const parents,
+    fcs_dbm_record_t * * const results,
+    const fcs_bool_t should_modify_parent
+)
+{
+    dbm_t * const db = (dbm_t *)store;
+    fcs_dbm_record_t records[FCS_DBM_STORE_MAX_BULK_COUNT];
+    int order[FCS_DBM_STORE_MAX_BULK_COUNT];
+
+    assert(count <= FCS_DBM_STORE_MAX_BULK_COUNT);
+
+    memset(records, '\0', sizeof(records[0]) * count);
+    /*
+     * A stable insertion sort of the batch, so the first occurrence of a
+     * recurring key is the one that gets inserted, like when inserting
+     * the keys in their original order.
+     * */
+    for (int i = 0 ; i < count ; i++)
     {
-        fcs_compact_alloc_release(&(db->allocator));
+        fill_record(&(records[i]), keys[i], parents[i]);
+        int j = i;
+        for ( ; (j > 0)
+            && (compare_records(&(records[order[j-1]]), &(records[i]), NULL) > 0)
+            ; j--)
+        {
+            order[j] = order[j-1];
+        }
+        order[j] = i;
     }
-#endif
-    if (ret)
+
+    const fcs_dbm_record_t * prev = NULL;
+    for (int k = 0 ; k < count ; k++)
     {
-#ifdef FCS_EXPLICIT_REFCOUNT
-        if (should_modify_parent && parent)
+        const int idx = order[k];
+        fcs_dbm_record_t * const rec = &(records[idx]);
+
+        if (prev && (! compare_records(prev, rec, NULL)))
         {
-            fcs_dbm_record_increment_refcount(parent);
+            results[idx] = NULL;
+            continue;
         }
+        prev = rec;
+#ifdef FCS_LIBAVL_STORE_WHOLE_KEYS
+        results[idx] = insert_record(db, rec, parents[idx], should_modify_parent);
+#else
+        fcs_dbm_record_t * const to_check = alloc_record_to_check(db);
+        *to_check = *rec;
+        results[idx] = insert_record(db, to_check, parents[idx], should_modify_parent);
 #endif
-
-        return ((fcs_dbm_record_t *)(fc_solve_kaz_tree_lookup_value(db->kaz_tree, to_check)));
-    }
-    else
-    {
-        return NULL;
     }
 }
 
@@ -39,6 +39,8 @@ typedef struct
 #endif
     fcs_compact_allocator_t states_values_to_keys_allocator;
     long count_elements_in_cache, max_num_elements_in_cache;
+    /* Statistics of the lookups. */
+    long num_hits, num_misses;
 
     fcs_cache_key_info_t * lowest_pri, * highest_pri;
 
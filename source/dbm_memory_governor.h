@@ -0,0 +1,184 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * dbm_memory_governor.h - keeps a DBM solver inside a memory budget.
+ *
+ * The governor is polled by the solver every few thousand items. It
+ * samples the resident set size of the process and tells the solver
+ * whether to shrink its caches (or stop if there is nothing left to
+ * shrink), or whether it may let them grow back.
+ */
+#ifndef FC_SOLVE__DBM_MEMORY_GOVERNOR_H
+#define FC_SOLVE__DBM_MEMORY_GOVERNOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "bool.h"
+#include "inline.h"
+
+/* The number of extracted items between two samples. */
+#define FCS_DBM_MEMORY_GOVERNOR_CHECK_EVERY 10000
+/* The caches may grow back once the usage drops below this percentage
+ * of the budget. */
+#define FCS_DBM_MEMORY_GOVERNOR_GROW_PERCENT 75
+
+enum fcs_dbm_memory_governor_decision
+{
+    FCS_DBM_MEMORY_KEEP = 0,
+    FCS_DBM_MEMORY_SHRINK,
+    FCS_DBM_MEMORY_GROW
+};
+
+typedef struct
+{
+    /* In bytes. 0 if the governor is disabled. */
+    long long budget;
+    long long last_usage;
+    /* How many times the caches were halved below their initial size. */
+    int num_shrinks;
+} fcs_dbm_memory_governor_t;
+
+/*
+ * Parses a size such as "4096", "512M" or "3G". Returns -1 if the string
+ * is not a valid positive size.
+ * */
+static GCC_INLINE long long fcs_dbm_memory_governor__parse_size(
+    const char * const s
+)
+{
+    char * end;
+    long long ret = strtoll(s, &end, 10);
+
+    if ((end == s) || (ret <= 0))
+    {
+        return -1;
+    }
+    switch (*end)
+    {
+        case 'G': case 'g':
+            ret <<= 10;
+            /* Fall through. */
+        case 'M': case 'm':
+            ret <<= 10;
+            /* Fall through. */
+        case 'K': case 'k':
+            ret <<= 10;
+            end++;
+            break;
+    }
+    return (*end ? -1 : ret);
+}
+
+/* Returns the resident set size of the process in bytes, or -1. */
+static GCC_INLINE long long fcs_dbm_memory_governor__get_usage(void)
+{
+    long long num_pages = -1, num_resident_pages;
+    FILE * const fh = fopen("/proc/self/statm", "r");
+
+    if (fh)
+    {
+        if (fscanf(fh, "%lld %lld", &num_pages, &num_resident_pages) == 2)
+        {
+            num_pages = num_resident_pages;
+        }
+        else
+        {
+            num_pages = -1;
+        }
+        fclose(fh);
+    }
+    return ((num_pages < 0) ? -1 : (num_pages * sysconf(_SC_PAGESIZE)));
+}
+
+static GCC_INLINE void fcs_dbm_memory_governor__init(
+    fcs_dbm_memory_governor_t * const governor,
+    const long long budget
+)
+{
+    governor->budget = budget;
+    governor->last_usage = 0;
+    governor->num_shrinks = 0;
+
+    if (budget && (fcs_dbm_memory_governor__get_usage() < 0))
+    {
+        fprintf(stderr, "%s\n",
+            "Cannot measure the memory usage - ignoring --memory-budget.");
+        governor->budget = 0;
+    }
+}
+
+/*
+ * Decides what to do given the current usage. can_shrink tells whether
+ * the caller has anything left to shrink - it is never asked to grow
+ * beyond the initial size.
+ * */
+static GCC_INLINE enum fcs_dbm_memory_governor_decision
+fcs_dbm_memory_governor__decide(
+    fcs_dbm_memory_governor_t * const governor,
+    const long long usage,
+    const fcs_bool_t can_shrink
+)
+{
+    governor->last_usage = usage;
+    if (usage > governor->budget)
+    {
+        if (can_shrink)
+        {
+            governor->num_shrinks++;
+        }
+        return FCS_DBM_MEMORY_SHRINK;
+    }
+    if (governor->num_shrinks && (usage * 100 <
+            governor->budget * FCS_DBM_MEMORY_GOVERNOR_GROW_PERCENT))
+    {
+        governor->num_shrinks--;
+        return FCS_DBM_MEMORY_GROW;
+    }
+    return FCS_DBM_MEMORY_KEEP;
+}
+
+/*
+ * To be called after every extracted item. Returns TRUE if a sample
+ * should be taken now.
+ * */
+static GCC_INLINE fcs_bool_t fcs_dbm_memory_governor__should_check(
+    const fcs_dbm_memory_governor_t * const governor,
+    const long count_num_processed
+)
+{
+    return (governor->budget
+        && (count_num_processed % FCS_DBM_MEMORY_GOVERNOR_CHECK_EVERY == 0));
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FC_SOLVE__DBM_MEMORY_GOVERNOR_H */
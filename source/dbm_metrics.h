@@ -0,0 +1,313 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * dbm_metrics.h - live metrics of the DBM and FCC solvers, exported as
+ * JSON lines.
+ *
+ * Every worker thread owns a slot, which only it writes to, so counting
+ * does not need a lock. The thread that holds the queue lock fills in the
+ * instance-wide gauges and exports a line once every interval, to a file
+ * or to a Unix domain socket ("unix:/path/to/socket").
+ */
+#ifndef FC_SOLVE__DBM_METRICS_H
+#define FC_SOLVE__DBM_METRICS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "bool.h"
+#include "inline.h"
+#include "alloc_wrap.h"
+#include "portable_time.h"
+
+/* A cache line, so the threads do not write to each other's lines. */
+#define FCS_DBM_METRICS_SLOT_SIZE 64
+/* The number of processed items between two looks at the clock. */
+#define FCS_DBM_METRICS_CHECK_EVERY 1000
+#define FCS_DBM_METRICS_DEFAULT_INTERVAL 10.0
+
+typedef union
+{
+    struct
+    {
+        long num_processed;
+        long long lock_wait_usecs;
+    };
+    char padding[FCS_DBM_METRICS_SLOT_SIZE];
+} fcs_dbm_metrics_slot_t;
+
+/*
+ * The instance-wide values of a sample. Fields which do not apply to
+ * a solver should be left at -1 (or NULL) and are not exported. E.g: the
+ * cache hits and misses are only exported by the solvers with an LRU
+ * cache - fcc_fc_solver and a dbm_fc_solver that was built with caches.
+ * */
+typedef struct
+{
+    long num_processed;
+    long num_states_in_collection;
+    long num_items_in_queue, num_items_in_memory;
+    long num_cache_hits, num_cache_misses;
+    int depth;
+    int num_depths;
+    const long * depth_counts;
+} fcs_dbm_metrics_sample_t;
+
+typedef struct
+{
+    /* NULL if the metrics are disabled. */
+    FILE * fh;
+    double interval;
+    int num_slots;
+    fcs_dbm_metrics_slot_t * slots;
+    double start_time, last_time;
+    long last_num_processed;
+} fcs_dbm_metrics_t;
+
+static GCC_INLINE double fcs_dbm_metrics__get_time(void)
+{
+    fcs_portable_time_t mytime;
+    FCS_GET_TIME(mytime);
+    return FCS_TIME_GET_SEC(mytime) + FCS_TIME_GET_USEC(mytime) * 1e-6;
+}
+
+static GCC_INLINE void fcs_dbm_metrics__init(fcs_dbm_metrics_t * const metrics)
+{
+    metrics->fh = NULL;
+    metrics->interval = FCS_DBM_METRICS_DEFAULT_INTERVAL;
+    metrics->num_slots = 0;
+    metrics->slots = NULL;
+    metrics->last_time = metrics->start_time = fcs_dbm_metrics__get_time();
+    metrics->last_num_processed = 0;
+}
+
+/* Starts exporting to path, which is a file name or "unix:" followed by
+ * the path of a listening socket. */
+static GCC_INLINE void fcs_dbm_metrics__open(
+    fcs_dbm_metrics_t * const metrics,
+    const char * const path,
+    const double interval
+)
+{
+    static const char unix_prefix[] = "unix:";
+    const size_t prefix_len = sizeof(unix_prefix) - 1;
+
+    if (! strncmp(path, unix_prefix, prefix_len))
+    {
+        struct sockaddr_un addr;
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+        memset(&addr, '\0', sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, path + prefix_len, sizeof(addr.sun_path) - 1);
+        if ((fd < 0)
+            || connect(fd, (struct sockaddr *)&addr, sizeof(addr))
+            || (! (metrics->fh = fdopen(fd, "w"))))
+        {
+            fprintf(stderr, "Cannot connect to the metrics socket '%s'.\n",
+                path + prefix_len);
+            exit(-1);
+        }
+    }
+    else if (! (metrics->fh = fopen(path, "a")))
+    {
+        fprintf(stderr, "Cannot open '%s' for the metrics.\n", path);
+        exit(-1);
+    }
+    metrics->interval = interval;
+}
+
+/* Should be called before the worker threads are started. */
+static GCC_INLINE void fcs_dbm_metrics__alloc_slots(
+    fcs_dbm_metrics_t * const metrics,
+    const int num_slots
+)
+{
+    if (num_slots > metrics->num_slots)
+    {
+        metrics->slots = SREALLOC(metrics->slots, num_slots);
+        memset(metrics->slots + metrics->num_slots, '\0',
+            sizeof(metrics->slots[0]) * (num_slots - metrics->num_slots));
+        metrics->num_slots = num_slots;
+    }
+}
+
+static GCC_INLINE void fcs_dbm_metrics__add_processed(
+    fcs_dbm_metrics_slot_t * const slot,
+    const long num
+)
+{
+    __atomic_store_n(&(slot->num_processed), slot->num_processed + num,
+        __ATOMIC_RELAXED);
+}
+
+static GCC_INLINE void fcs_dbm_metrics__add_lock_wait(
+    fcs_dbm_metrics_slot_t * const slot,
+    const double secs
+)
+{
+    __atomic_store_n(&(slot->lock_wait_usecs),
+        slot->lock_wait_usecs + (long long)(secs * 1e6), __ATOMIC_RELAXED);
+}
+
+/* Acquires the lock while timing how long it took, if the metrics are
+ * enabled. */
+#define FCS_DBM_METRICS_LOCK(metrics, slot, lock) \
+    { \
+        if ((metrics)->fh) \
+        { \
+            const double lock_start_time = fcs_dbm_metrics__get_time(); \
+            FCS_LOCK(lock); \
+            fcs_dbm_metrics__add_lock_wait((slot), \
+                fcs_dbm_metrics__get_time() - lock_start_time); \
+        } \
+        else \
+        { \
+            FCS_LOCK(lock); \
+        } \
+    }
+
+static GCC_INLINE fcs_bool_t fcs_dbm_metrics__is_interval_over(
+    const fcs_dbm_metrics_t * const metrics
+)
+{
+    return (metrics->fh
+        && (fcs_dbm_metrics__get_time() - metrics->last_time
+            >= metrics->interval));
+}
+
+/* Returns TRUE if a sample should be exported now. To be called after
+ * every processed item. */
+static GCC_INLINE fcs_bool_t fcs_dbm_metrics__is_due(
+    const fcs_dbm_metrics_t * const metrics,
+    const long count_num_processed
+)
+{
+    return ((count_num_processed % FCS_DBM_METRICS_CHECK_EVERY == 0)
+        && fcs_dbm_metrics__is_interval_over(metrics));
+}
+
+static GCC_INLINE void fcs_dbm_metrics__export(
+    fcs_dbm_metrics_t * const metrics,
+    const fcs_dbm_metrics_sample_t * const sample
+)
+{
+    FILE * const fh = metrics->fh;
+    const double now = fcs_dbm_metrics__get_time();
+    const double delta_time = now - metrics->last_time;
+    long long lock_wait_usecs = 0;
+
+    if (! fh)
+    {
+        return;
+    }
+    fprintf(fh, "{\"time\":%.6f,\"elapsed\":%.3f,\"processed\":%ld,"
+        "\"states_per_sec\":%.1f",
+        now, now - metrics->start_time, sample->num_processed,
+        ((delta_time > 0)
+            ? ((sample->num_processed - metrics->last_num_processed)
+                / delta_time)
+            : 0.0)
+    );
+    if (sample->num_states_in_collection >= 0)
+    {
+        fprintf(fh, ",\"states_in_collection\":%ld",
+            sample->num_states_in_collection);
+    }
+    if (sample->num_items_in_queue >= 0)
+    {
+        fprintf(fh, ",\"queue_items\":%ld,\"queue_items_in_memory\":%ld,"
+            "\"queue_items_offloaded\":%ld",
+            sample->num_items_in_queue, sample->num_items_in_memory,
+            sample->num_items_in_queue - sample->num_items_in_memory
+        );
+    }
+    if (sample->num_cache_hits >= 0)
+    {
+        const long num_lookups =
+            sample->num_cache_hits + sample->num_cache_misses;
+        fprintf(fh, ",\"cache_hits\":%ld,\"cache_misses\":%ld,"
+            "\"cache_hit_rate\":%.4f",
+            sample->num_cache_hits, sample->num_cache_misses,
+            (num_lookups ? ((double)sample->num_cache_hits / num_lookups)
+                : 0.0)
+        );
+    }
+    if (sample->depth >= 0)
+    {
+        fprintf(fh, ",\"depth\":%d", sample->depth);
+    }
+    if (sample->depth_counts && sample->num_depths)
+    {
+        fprintf(fh, ",\"depth_counts\":[");
+        for (int depth = 0 ; depth < sample->num_depths ; depth++)
+        {
+            fprintf(fh, "%s%ld", (depth ? "," : ""),
+                sample->depth_counts[depth]);
+        }
+        fprintf(fh, "]");
+    }
+    fprintf(fh, ",\"threads\":[");
+    for (int i = 0 ; i < metrics->num_slots ; i++)
+    {
+        fprintf(fh, "%s%ld", (i ? "," : ""),
+            __atomic_load_n(&(metrics->slots[i].num_processed),
+                __ATOMIC_RELAXED));
+        lock_wait_usecs += __atomic_load_n(
+            &(metrics->slots[i].lock_wait_usecs), __ATOMIC_RELAXED);
+    }
+    fprintf(fh, "],\"lock_wait_sec\":%.6f}\n", lock_wait_usecs * 1e-6);
+    fflush(fh);
+
+    metrics->last_time = now;
+    metrics->last_num_processed = sample->num_processed;
+}
+
+static GCC_INLINE void fcs_dbm_metrics__destroy(
+    fcs_dbm_metrics_t * const metrics
+)
+{
+    if (metrics->fh)
+    {
+        fclose(metrics->fh);
+        metrics->fh = NULL;
+    }
+    free(metrics->slots);
+    metrics->slots = NULL;
+    metrics->num_slots = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FC_SOLVE__DBM_METRICS_H */
@@ -0,0 +1,436 @@
+/*
+ * dbm_mmap_hash.c - a DBM store backend without external dependencies. It
+ * is an open-addressed hash table of encoded state -> parent that lives in
+ * a memory-mapped file.
+ *
+ * The table is grown by doubling, which is done by sequentially rewriting
+ * it into a new file that is then renamed over the old one. The file is
+ * synced at the end of every offload of the pre-cache, and a file that was
+ * not closed cleanly is validated and rebuilt when it is opened, so a
+ * crash loses at most the states of the last batch.
+ */
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "alloc_wrap.h"
+#include "dbm_solver.h"
+#include "generic_tree.h"
+
+#define MMAP_HASH_MAGIC "FCSMHT01"
+#define MMAP_HASH_HEADER_SIZE 4096
+#define MMAP_HASH_INITIAL_CAPACITY (1 << 16)
+/* Grow once the table is more than 7/10 full. */
+#define MMAP_HASH_MAX_LOAD(capacity) (((capacity) / 10) * 7)
+
+typedef struct
+{
+    char magic[8];
+    uint64_t slot_size;
+    uint64_t capacity;
+    uint64_t count;
+    uint64_t is_clean;
+} mmap_hash_header_t;
+
+typedef struct
+{
+    fcs_encoded_state_buffer_t key;
+    fcs_encoded_state_buffer_t parent;
+    /* 0 for an empty slot and a checksum of the rest otherwise. */
+    uint64_t check;
+} mmap_hash_slot_t;
+
+typedef struct
+{
+    char * path;
+    int fd;
+    size_t map_size;
+    unsigned char * map;
+    mmap_hash_header_t * header;
+    mmap_hash_slot_t * slots;
+} dbm_t;
+
+static GCC_INLINE uint64_t mmap_hash_calc_hash(
+    const fcs_encoded_state_buffer_t * const key
+)
+{
+    /* FNV-1a followed by the splitmix64 finalizer. */
+    uint64_t h = 0xCBF29CE484222325ULL;
+
+    for (size_t i = 0 ; i < sizeof(key->s) ; i++)
+    {
+        h ^= key->s[i];
+        h *= 0x100000001B3ULL;
+    }
+    h ^= h >> 30;
+    h *= 0xBF58476D1CE4E5B9ULL;
+    h ^= h >> 27;
+    h *= 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+
+    return h;
+}
+
+static GCC_INLINE uint64_t mmap_hash_calc_check(
+    const mmap_hash_slot_t * const slot
+)
+{
+    return ((mmap_hash_calc_hash(&(slot->key))
+        ^ (mmap_hash_calc_hash(&(slot->parent)) * 31)) | 1);
+}
+
+static GCC_INLINE fcs_bool_t mmap_hash_slot_is_valid(
+    const mmap_hash_slot_t * const slot
+)
+{
+    return (slot->check && (slot->check == mmap_hash_calc_check(slot)));
+}
+
+static void mmap_hash_die(const char * const msg, const char * const path)
+{
+    fprintf(stderr, "%s \"%s\".\n", msg, path);
+    exit(-1);
+}
+
+/* Opens and maps a table file of "capacity" slots. */
+static void mmap_hash_map(
+    dbm_t * const db,
+    const char * const path,
+    const uint64_t capacity,
+    const fcs_bool_t create
+)
+{
+    db->map_size = MMAP_HASH_HEADER_SIZE
+        + (size_t)capacity * sizeof(mmap_hash_slot_t);
+
+    if ((db->fd = open(path, (create ? (O_RDWR|O_CREAT|O_TRUNC) : O_RDWR),
+        0644)) < 0)
+    {
+        mmap_hash_die("Cannot open the DBM hash file", path);
+    }
+    if (create && ftruncate(db->fd, (off_t)db->map_size))
+    {
+        mmap_hash_die("Cannot resize the DBM hash file", path);
+    }
+    db->map = mmap(NULL, db->map_size, PROT_READ|PROT_WRITE, MAP_SHARED,
+        db->fd, 0);
+    if (db->map == MAP_FAILED)
+    {
+        mmap_hash_die("Cannot map the DBM hash file", path);
+    }
+    db->header = (mmap_hash_header_t *)db->map;
+    db->slots = (mmap_hash_slot_t *)(db->map + MMAP_HASH_HEADER_SIZE);
+
+    if (create)
+    {
+        memcpy(db->header->magic, MMAP_HASH_MAGIC, sizeof(db->header->magic));
+        db->header->slot_size = sizeof(mmap_hash_slot_t);
+        db->header->capacity = capacity;
+        db->header->count = 0;
+        db->header->is_clean = 0;
+    }
+}
+
+static void mmap_hash_unmap(dbm_t * const db)
+{
+    munmap(db->map, db->map_size);
+    close(db->fd);
+    db->map = NULL;
+    db->header = NULL;
+    db->slots = NULL;
+}
+
+/* Syncs the slots before the header so the header never runs ahead. */
+static void mmap_hash_sync(dbm_t * const db)
+{
+    if (msync(db->map + MMAP_HASH_HEADER_SIZE,
+        db->map_size - MMAP_HASH_HEADER_SIZE, MS_SYNC)
+        || msync(db->map, MMAP_HASH_HEADER_SIZE, MS_SYNC))
+    {
+        mmap_hash_die("Cannot sync the DBM hash file", db->path);
+    }
+}
+
+/* Returns the slot of key, or the empty slot where it should go. */
+static GCC_INLINE mmap_hash_slot_t * mmap_hash_find_slot(
+    const dbm_t * const db,
+    const fcs_encoded_state_buffer_t * const key,
+    const uint64_t hash
+)
+{
+    const uint64_t mask = db->header->capacity - 1;
+    uint64_t idx = hash & mask;
+
+    while (1)
+    {
+        mmap_hash_slot_t * const slot = &(db->slots[idx]);
+        if ((! slot->check) || (! memcmp(&(slot->key), key, sizeof(*key))))
+        {
+            return slot;
+        }
+        idx = ((idx + 1) & mask);
+    }
+}
+
+/* Returns TRUE if the key was added. */
+static GCC_INLINE fcs_bool_t mmap_hash_insert(
+    dbm_t * const db,
+    const fcs_encoded_state_buffer_t * const key,
+    const fcs_encoded_state_buffer_t * const parent,
+    const uint64_t hash
+)
+{
+    mmap_hash_slot_t * const slot = mmap_hash_find_slot(db, key, hash);
+
+    if (slot->check)
+    {
+        return FALSE;
+    }
+    slot->key = *key;
+    slot->parent = *parent;
+    slot->check = mmap_hash_calc_check(slot);
+    db->header->count++;
+
+    return TRUE;
+}
+
+/*
+ * Rewrites the valid slots of the table into a new file of new_capacity
+ * slots, and renames it over the old one.
+ * */
+static void mmap_hash_rebuild(dbm_t * const db, const uint64_t new_capacity)
+{
+    dbm_t new_db;
+    char * const new_path = SMALLOC(new_path, strlen(db->path) + 10);
+
+    sprintf(new_path, "%s.new", db->path);
+    new_db.path = db->path;
+    mmap_hash_map(&new_db, new_path, new_capacity, TRUE);
+
+    const uint64_t capacity = db->header->capacity;
+    for (uint64_t i = 0 ; i < capacity ; i++)
+    {
+        const mmap_hash_slot_t * const slot = &(db->slots[i]);
+        if (mmap_hash_slot_is_valid(slot))
+        {
+            mmap_hash_insert(&new_db, &(slot->key), &(slot->parent),
+                mmap_hash_calc_hash(&(slot->key)));
+        }
+    }
+    mmap_hash_sync(&new_db);
+    mmap_hash_unmap(db);
+
+    if (rename(new_path, db->path))
+    {
+        mmap_hash_die("Cannot rename the new DBM hash file", new_path);
+    }
+    free(new_path);
+
+    db->fd = new_db.fd;
+    db->map_size = new_db.map_size;
+    db->map = new_db.map;
+    db->header = new_db.header;
+    db->slots = new_db.slots;
+}
+
+static void mmap_hash_reserve(dbm_t * const db, const uint64_t num_to_add)
+{
+    uint64_t capacity = db->header->capacity;
+
+    while (db->header->count + num_to_add > MMAP_HASH_MAX_LOAD(capacity))
+    {
+        capacity <<= 1;
+    }
+    if (capacity != db->header->capacity)
+    {
+        mmap_hash_rebuild(db, capacity);
+    }
+}
+
+void fc_solve_dbm_store_init(fcs_dbm_store_t * store, const char * path, void * * recycle_bin_ptr)
+{
+    dbm_t * const db = SMALLOC1(db);
+    mmap_hash_header_t header;
+
+    db->path = strdup(path);
+
+    const int fd = open(path, O_RDONLY);
+    const fcs_bool_t exists = ((fd >= 0)
+        && (read(fd, &header, sizeof(header)) == (ssize_t)sizeof(header))
+        && (! memcmp(header.magic, MMAP_HASH_MAGIC, sizeof(header.magic)))
+        && (header.slot_size == sizeof(mmap_hash_slot_t))
+    );
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+    if (! exists)
+    {
+        mmap_hash_map(db, path, MMAP_HASH_INITIAL_CAPACITY, TRUE);
+    }
+    else
+    {
+        mmap_hash_map(db, path, header.capacity, FALSE);
+        if (! header.is_clean)
+        {
+            /* Get rid of the slots that were torn by the crash. */
+            mmap_hash_rebuild(db, header.capacity);
+        }
+    }
+    /* Marked as clean again by fc_solve_dbm_store_destroy(). */
+    db->header->is_clean = 0;
+    mmap_hash_sync(db);
+
+    *store = (fcs_dbm_store_t)db;
+}
+
+fcs_bool_t fc_solve_dbm_store_does_key_exist(
+    fcs_dbm_store_t store,
+    const unsigned char * key_raw
+)
+{
+    const dbm_t * const db = (const dbm_t *)store;
+    const fcs_encoded_state_buffer_t * const key =
+        (const fcs_encoded_state_buffer_t *)key_raw;
+
+    return (mmap_hash_find_slot(db, key, mmap_hash_calc_hash(key))->check != 0);
+}
+
+fcs_bool_t fc_solve_dbm_store_lookup_parent(
+    fcs_dbm_store_t store,
+    const unsigned char * const key_raw,
+    unsigned char * const parent
+)
+{
+    const dbm_t * const db = (const dbm_t *)store;
+    const fcs_encoded_state_buffer_t * const key =
+        (const fcs_encoded_state_buffer_t *)key_raw;
+    const mmap_hash_slot_t * const slot =
+        mmap_hash_find_slot(db, key, mmap_hash_calc_hash(key));
+
+    if (! slot->check)
+    {
+        return FALSE;
+    }
+    *(fcs_encoded_state_buffer_t *)parent = slot->parent;
+
+    return TRUE;
+}
+
+#ifndef FCS_DBM_WITHOUT_CACHES
+
+typedef struct
+{
+    uint64_t hash;
+    const fcs_pre_cache_key_val_pair_t * kv;
+} mmap_hash_batch_item_t;
+
+static int mmap_hash_compare_batch_items(const void * void_a, const void * void_b)
+{
+    const uint64_t a = ((const mmap_hash_batch_item_t *)void_a)->hash;
+    const uint64_t b = ((const mmap_hash_batch_item_t *)void_b)->hash;
+
+    return ((a < b) ? -1 : (a > b) ? 1 : 0);
+}
+
+/*
+ * The pre-cache is inserted as one batch: the table is grown only once,
+ * and the keys are inserted in the order of their slots so the pages are
+ * written sequentially.
+ * */
+void fc_solve_dbm_store_offload_pre_cache(
+    fcs_dbm_store_t store,
+    fcs_pre_cache_t * const pre_cache
+)
+{
+    dbm_t * const db = (dbm_t *)store;
+    dict_t * const kaz_tree = pre_cache->kaz_tree;
+    size_t count = 0;
+    mmap_hash_batch_item_t * const batch =
+        SMALLOC(batch, pre_cache->count_elements + 1);
+
+#define ADD_TO_BATCH(item) \
+    { \
+        batch[count].kv = (const fcs_pre_cache_key_val_pair_t *)(item); \
+        batch[count].hash = mmap_hash_calc_hash(&(batch[count].kv->key)); \
+        count++; \
+    }
+#ifdef FCS_DBM_USE_LIBAVL
+    struct avl_traverser trav;
+    dict_key_t item;
+
+    avl_t_init(&trav, kaz_tree);
+    for (item = avl_t_first(&trav, kaz_tree) ; item ; item = avl_t_next(&trav))
+    {
+        if (count == (size_t)pre_cache->count_elements)
+        {
+            break;
+        }
+        ADD_TO_BATCH(item);
+    }
+#elif defined(FCS_DBM_USE_BPTREE)
+    fcs_bp_tree_iter_t iter;
+
+    for (dict_key_t item = fc_solve_bp_tree_iter_first(kaz_tree, &iter) ;
+        item ; item = fc_solve_bp_tree_iter_next(&iter))
+    {
+        if (count == (size_t)pre_cache->count_elements)
+        {
+            break;
+        }
+        ADD_TO_BATCH(item);
+    }
+#else
+    for (dnode_t * node = fc_solve_kaz_tree_first(kaz_tree);
+            node ;
+            node = fc_solve_kaz_tree_next(kaz_tree, node)
+            )
+    {
+        if (count == (size_t)pre_cache->count_elements)
+        {
+            break;
+        }
+        ADD_TO_BATCH(node->dict_key);
+    }
+#endif
+#undef ADD_TO_BATCH
+
+    mmap_hash_reserve(db, count);
+
+    const uint64_t mask = db->header->capacity - 1;
+    for (size_t i = 0 ; i < count ; i++)
+    {
+        batch[i].hash &= mask;
+    }
+    qsort(batch, count, sizeof(batch[0]), mmap_hash_compare_batch_items);
+
+    for (size_t i = 0 ; i < count ; i++)
+    {
+        mmap_hash_insert(db, &(batch[i].kv->key), &(batch[i].kv->parent),
+            batch[i].hash);
+    }
+    free(batch);
+
+    mmap_hash_sync(db);
+}
+
+#endif
+
+extern void fc_solve_dbm_store_destroy(fcs_dbm_store_t store)
+{
+    dbm_t * const db = (dbm_t *)store;
+
+    mmap_hash_sync(db);
+    db->header->is_clean = 1;
+    mmap_hash_sync(db);
+    mmap_hash_unmap(db);
+    free(db->path);
+    free(db);
+}
@@ -0,0 +1,468 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * dbm_partition.h - the building blocks of partitioned_dbm_solver.c: the
+ * hash partitioning of the encoded states, a per-partition store that
+ * keeps the parents as keys (because they may belong to other processes)
+ * and message channels over Unix domain sockets.
+ */
+#ifndef FC_SOLVE__DBM_PARTITION_H
+#define FC_SOLVE__DBM_PARTITION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include "config.h"
+#include "bool.h"
+#include "inline.h"
+#include "alloc_wrap.h"
+#include "meta_alloc.h"
+#include "delta_states.h"
+
+typedef struct
+{
+    fcs_encoded_state_buffer_t key, parent;
+} fcs_dbm_partition_record_t;
+
+static GCC_INLINE uint64_t fcs_dbm_partition__hash(
+    const fcs_encoded_state_buffer_t * const key
+)
+{
+    /* FNV-1a followed by the splitmix64 finalizer. */
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0 ; i < sizeof(*key) ; i++)
+    {
+        h ^= key->s[i];
+        h *= 1099511628211ULL;
+    }
+    h ^= (h >> 30);
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= (h >> 27);
+    h *= 0x94d049bb133111ebULL;
+    h ^= (h >> 31);
+
+    return h;
+}
+
+/* The low bits select the partition and the high bits the slot in it. */
+static GCC_INLINE int fcs_dbm_partition__calc_owner(
+    const fcs_encoded_state_buffer_t * const key,
+    const int num_partitions
+)
+{
+    return (int)(fcs_dbm_partition__hash(key) % (uint64_t)num_partitions);
+}
+
+static GCC_INLINE fcs_bool_t fcs_dbm_partition__is_null_key(
+    const fcs_encoded_state_buffer_t * const key
+)
+{
+    for (size_t i = 0 ; i < sizeof(*key) ; i++)
+    {
+        if (key->s[i])
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/*
+ * The store of a partition: the records never move once allocated, so
+ * pointers to them can be used as the tokens of the offloading queue.
+ * */
+typedef struct
+{
+    fcs_meta_compact_allocator_t meta_alloc;
+    fcs_compact_allocator_t allocator;
+    fcs_dbm_partition_record_t * * slots;
+    size_t num_slots, count;
+} fcs_dbm_partition_store_t;
+
+static GCC_INLINE void fcs_dbm_partition_store__init(
+    fcs_dbm_partition_store_t * const store
+)
+{
+    fc_solve_meta_compact_allocator_init(&(store->meta_alloc));
+    fc_solve_compact_allocator_init(&(store->allocator), &(store->meta_alloc));
+    store->num_slots = 1024;
+    store->count = 0;
+    store->slots = calloc(store->num_slots, sizeof(store->slots[0]));
+}
+
+static GCC_INLINE void fcs_dbm_partition_store__destroy(
+    fcs_dbm_partition_store_t * const store
+)
+{
+    free(store->slots);
+    store->slots = NULL;
+    fc_solve_compact_allocator_finish(&(store->allocator));
+    fc_solve_meta_compact_allocator_finish(&(store->meta_alloc));
+}
+
+static GCC_INLINE fcs_dbm_partition_record_t * * fcs_dbm_partition_store__find_slot(
+    fcs_dbm_partition_record_t * * const slots,
+    const size_t num_slots,
+    const fcs_encoded_state_buffer_t * const key
+)
+{
+    size_t idx = (size_t)(fcs_dbm_partition__hash(key) >> 32) & (num_slots - 1);
+
+    while (slots[idx] && memcmp(&(slots[idx]->key), key, sizeof(*key)))
+    {
+        idx = ((idx + 1) & (num_slots - 1));
+    }
+
+    return &(slots[idx]);
+}
+
+static GCC_INLINE fcs_dbm_partition_record_t * fcs_dbm_partition_store__lookup(
+    fcs_dbm_partition_store_t * const store,
+    const fcs_encoded_state_buffer_t * const key
+)
+{
+    return *fcs_dbm_partition_store__find_slot(store->slots, store->num_slots, key);
+}
+
+/*
+ * Returns the new record, or NULL if the key was already present.
+ * */
+static GCC_INLINE fcs_dbm_partition_record_t * fcs_dbm_partition_store__insert(
+    fcs_dbm_partition_store_t * const store,
+    const fcs_dbm_partition_record_t * const rec
+)
+{
+    fcs_dbm_partition_record_t * * slot =
+        fcs_dbm_partition_store__find_slot(store->slots, store->num_slots,
+            &(rec->key));
+
+    if (*slot)
+    {
+        return NULL;
+    }
+
+    /* Keep the load factor below 1/2. */
+    if ((store->count + 1) * 2 > store->num_slots)
+    {
+        const size_t new_num_slots = (store->num_slots << 1);
+        fcs_dbm_partition_record_t * * const new_slots =
+            calloc(new_num_slots, sizeof(new_slots[0]));
+
+        for (size_t i = 0 ; i < store->num_slots ; i++)
+        {
+            if (store->slots[i])
+            {
+                *fcs_dbm_partition_store__find_slot(new_slots, new_num_slots,
+                    &(store->slots[i]->key)) = store->slots[i];
+            }
+        }
+        free(store->slots);
+        store->slots = new_slots;
+        store->num_slots = new_num_slots;
+
+        slot = fcs_dbm_partition_store__find_slot(store->slots,
+            store->num_slots, &(rec->key));
+    }
+
+    *slot = (fcs_dbm_partition_record_t *)
+        fcs_compact_alloc_ptr(&(store->allocator), sizeof(**slot));
+    **slot = *rec;
+    store->count++;
+
+    return *slot;
+}
+
+/* The messages that are passed between the coordinator and the workers. */
+enum fcs_dbm_partition_msg_type_t
+{
+    /* Records of states that are owned by the destination worker. */
+    FCS_DBM_PARTITION_MSG_STATES,
+    /* The worker ran out of work after handling "count" STATES messages. */
+    FCS_DBM_PARTITION_MSG_IDLE,
+    /* The key of the record is a solved state. */
+    FCS_DBM_PARTITION_MSG_SOLVED,
+    /* Stop expanding states and only answer queries. */
+    FCS_DBM_PARTITION_MSG_HALT,
+    /* Asks for the parent of a key and answers with a PARENT message. */
+    FCS_DBM_PARTITION_MSG_QUERY,
+    FCS_DBM_PARTITION_MSG_PARENT,
+    /* Terminate, after replying with a STATS message. */
+    FCS_DBM_PARTITION_MSG_STOP,
+    /* "count" is the number of states; the record holds nothing. */
+    FCS_DBM_PARTITION_MSG_STATS,
+};
+
+typedef struct
+{
+    int32_t type;
+    /* The owner of the records of a STATES message. */
+    int32_t partition;
+    /* The number of records that follow, except for IDLE and STATS. */
+    int64_t count;
+    int64_t num_processed;
+} fcs_dbm_partition_msg_header_t;
+
+typedef struct
+{
+    unsigned char * data;
+    size_t start, end, max_size;
+} fcs_dbm_partition_buffer_t;
+
+static GCC_INLINE void fcs_dbm_partition_buffer__init(
+    fcs_dbm_partition_buffer_t * const buffer
+)
+{
+    buffer->max_size = 64 * 1024;
+    buffer->data = SMALLOC(buffer->data, buffer->max_size);
+    buffer->start = buffer->end = 0;
+}
+
+static GCC_INLINE void fcs_dbm_partition_buffer__reserve(
+    fcs_dbm_partition_buffer_t * const buffer,
+    const size_t num_bytes
+)
+{
+    if (buffer->start > 0)
+    {
+        memmove(buffer->data, buffer->data + buffer->start,
+            buffer->end - buffer->start);
+        buffer->end -= buffer->start;
+        buffer->start = 0;
+    }
+    if (buffer->end + num_bytes > buffer->max_size)
+    {
+        while (buffer->end + num_bytes > buffer->max_size)
+        {
+            buffer->max_size <<= 1;
+        }
+        buffer->data = SREALLOC(buffer->data, buffer->max_size);
+    }
+}
+
+/*
+ * A bidirectional channel over a non-blocking stream socket. Outgoing
+ * messages are buffered, so a peer that is busy sending never blocks us.
+ * */
+typedef struct
+{
+    int fd;
+    fcs_bool_t is_eof;
+    fcs_dbm_partition_buffer_t in, out;
+} fcs_dbm_partition_channel_t;
+
+static GCC_INLINE void fcs_dbm_partition_channel__init(
+    fcs_dbm_partition_channel_t * const channel,
+    const int fd
+)
+{
+    channel->fd = fd;
+    channel->is_eof = FALSE;
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    fcs_dbm_partition_buffer__init(&(channel->in));
+    fcs_dbm_partition_buffer__init(&(channel->out));
+}
+
+static GCC_INLINE void fcs_dbm_partition_channel__destroy(
+    fcs_dbm_partition_channel_t * const channel
+)
+{
+    close(channel->fd);
+    free(channel->in.data);
+    free(channel->out.data);
+}
+
+static GCC_INLINE void fcs_dbm_partition_channel__send(
+    fcs_dbm_partition_channel_t * const channel,
+    const enum fcs_dbm_partition_msg_type_t type,
+    const int partition,
+    const int64_t count,
+    const int64_t num_processed,
+    const fcs_dbm_partition_record_t * const records,
+    const size_t num_records
+)
+{
+    const fcs_dbm_partition_msg_header_t header = {.type = type,
+        .partition = partition, .count = count,
+        .num_processed = num_processed,
+    };
+    fcs_dbm_partition_buffer_t * const out = &(channel->out);
+    const size_t records_size = sizeof(records[0]) * num_records;
+
+    fcs_dbm_partition_buffer__reserve(out, sizeof(header) + records_size);
+    memcpy(out->data + out->end, &header, sizeof(header));
+    out->end += sizeof(header);
+    if (records_size)
+    {
+        memcpy(out->data + out->end, records, records_size);
+        out->end += records_size;
+    }
+}
+
+static GCC_INLINE fcs_bool_t fcs_dbm_partition_channel__has_output(
+    const fcs_dbm_partition_channel_t * const channel
+)
+{
+    return (channel->out.end > channel->out.start);
+}
+
+/* Writes as much of the pending output as the socket accepts. */
+static GCC_INLINE void fcs_dbm_partition_channel__write(
+    fcs_dbm_partition_channel_t * const channel
+)
+{
+    fcs_dbm_partition_buffer_t * const out = &(channel->out);
+
+    while (out->end > out->start)
+    {
+        const ssize_t ret = write(channel->fd, out->data + out->start,
+            out->end - out->start);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                return;
+            }
+            fprintf(stderr, "Error writing to a channel: %s.\n", strerror(errno));
+            exit(-1);
+        }
+        out->start += (size_t)ret;
+    }
+    out->start = out->end = 0;
+}
+
+/* Reads whatever is available. */
+static GCC_INLINE void fcs_dbm_partition_channel__read(
+    fcs_dbm_partition_channel_t * const channel
+)
+{
+    fcs_dbm_partition_buffer_t * const in = &(channel->in);
+
+    while (1)
+    {
+        fcs_dbm_partition_buffer__reserve(in, 64 * 1024);
+        const ssize_t ret = read(channel->fd, in->data + in->end,
+            in->max_size - in->end);
+        if (ret < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                return;
+            }
+            fprintf(stderr, "Error reading from a channel: %s.\n", strerror(errno));
+            exit(-1);
+        }
+        if (ret == 0)
+        {
+            channel->is_eof = TRUE;
+            return;
+        }
+        in->end += (size_t)ret;
+    }
+}
+
+/*
+ * Extracts the next complete message, if there is one. "records" remain
+ * valid until the next call to a function of the channel.
+ * */
+static GCC_INLINE fcs_bool_t fcs_dbm_partition_channel__next(
+    fcs_dbm_partition_channel_t * const channel,
+    fcs_dbm_partition_msg_header_t * const header,
+    const fcs_dbm_partition_record_t * * const records,
+    size_t * const num_records
+)
+{
+    fcs_dbm_partition_buffer_t * const in = &(channel->in);
+    const size_t avail = in->end - in->start;
+
+    if (avail < sizeof(*header))
+    {
+        return FALSE;
+    }
+    memcpy(header, in->data + in->start, sizeof(*header));
+    *num_records = ((header->type == FCS_DBM_PARTITION_MSG_IDLE)
+        || (header->type == FCS_DBM_PARTITION_MSG_STATS))
+        ? 0 : (size_t)header->count;
+    const size_t size = sizeof(*header) + sizeof(**records) * (*num_records);
+    if (avail < size)
+    {
+        return FALSE;
+    }
+    *records = (const fcs_dbm_partition_record_t *)
+        (in->data + in->start + sizeof(*header));
+    in->start += size;
+
+    return TRUE;
+}
+
+/* Waits until the channel is readable, or writable if it has output. */
+static GCC_INLINE void fcs_dbm_partition_channel__wait(
+    fcs_dbm_partition_channel_t * const channel,
+    const int timeout
+)
+{
+    struct pollfd pfd = {.fd = channel->fd, .events = POLLIN};
+    if (fcs_dbm_partition_channel__has_output(channel))
+    {
+        pfd.events |= POLLOUT;
+    }
+    poll(&pfd, 1, timeout);
+}
+
+/* Blocks until all the pending output was written. */
+static GCC_INLINE void fcs_dbm_partition_channel__flush(
+    fcs_dbm_partition_channel_t * const channel
+)
+{
+    fcs_dbm_partition_channel__write(channel);
+    while (fcs_dbm_partition_channel__has_output(channel))
+    {
+        struct pollfd pfd = {.fd = channel->fd, .events = POLLOUT};
+        poll(&pfd, 1, -1);
+        fcs_dbm_partition_channel__write(channel);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* FC_SOLVE__DBM_PARTITION_H */
@@ -49,8 +49,10 @@ static int fc_solve_compare_pre_cache_keys(
 
 static GCC_INLINE void pre_cache_init(fcs_pre_cache_t * pre_cache_ptr, fcs_meta_compact_allocator_t * meta_alloc)
 {
+    pre_cache_ptr->tree_recycle_bin = NULL;
     pre_cache_ptr->kaz_tree =
-        fc_solve_kaz_tree_create(fc_solve_compare_pre_cache_keys, NULL, meta_alloc);
+        fc_solve_kaz_tree_create(fc_solve_compare_pre_cache_keys, NULL,
+            meta_alloc, &(pre_cache_ptr->tree_recycle_bin));
 
     fc_solve_compact_allocator_init(&(pre_cache_ptr->kv_allocator), meta_alloc);
     pre_cache_ptr->kv_recycle_bin = NULL;
@@ -125,6 +127,24 @@ static GCC_INLINE void cache_populate_from_pre_cache(
             '\0'
         );
     }
+#elif defined(FCS_DBM_USE_BPTREE)
+    fcs_bp_tree_iter_t iter;
+
+    for (
+        dict_key_t item = fc_solve_bp_tree_iter_first(pre_cache->kaz_tree, &iter)
+            ;
+        item
+            ;
+        item = fc_solve_bp_tree_iter_next(&iter)
+        )
+    {
+        cache_insert(
+            cache,
+            &(((fcs_pre_cache_key_val_pair_t *)(item))->key),
+            NULL,
+            '\0'
+        );
+    }
 #else
     dnode_t * node;
     dict_t * kaz_tree;
@@ -138,7 +158,9 @@ static GCC_INLINE void cache_populate_from_pre_cache(
     {
         cache_insert(
             cache,
-            &(((fcs_pre_cache_key_val_pair_t *)(node->dict_key))->key)
+            &(((fcs_pre_cache_key_val_pair_t *)(node->dict_key))->key),
+            NULL,
+            '\0'
         );
     }
 #endif
@@ -160,6 +182,12 @@ static GCC_INLINE void pre_cache_offload_and_destroy(
 
 #ifndef FCS_DBM_CACHE_ONLY
 
+/* A solver may define it to act before the pre-cache is offloaded into the
+ * store. */
+#ifndef INSTANCE_BEFORE_PRE_CACHE_OFFLOAD
+#define INSTANCE_BEFORE_PRE_CACHE_OFFLOAD(instance)
+#endif
+
 static GCC_INLINE void pre_cache_offload_and_reset(
     fcs_pre_cache_t * const pre_cache,
     const fcs_dbm_store_t store,
@@ -190,6 +218,13 @@ static GCC_INLINE void instance_check_key(
 #endif
 );
 
+#ifdef FCS_DBM_CHECK_KEYS_IN_BULK
+static GCC_INLINE void instance_enqueue_new_record(
+    fcs_dbm_solver_instance_t * const instance,
+    fcs_dbm_record_t * token
+);
+#endif
+
 static GCC_INLINE void instance_check_multiple_keys(
     fcs_dbm_solver_thread_t * thread,
     fcs_dbm_solver_instance_t * instance,
@@ -204,6 +239,34 @@ static GCC_INLINE void instance_check_multiple_keys(
     {
         return;
     }
+#ifdef FCS_DBM_CHECK_KEYS_IN_BULK
+    const fcs_encoded_state_buffer_t * keys[FCS_DBM_STORE_MAX_BULK_COUNT];
+    fcs_dbm_record_t * parents[FCS_DBM_STORE_MAX_BULK_COUNT];
+    fcs_dbm_record_t * tokens[FCS_DBM_STORE_MAX_BULK_COUNT];
+
+    FCS_LOCK(instance->storage_lock);
+    while (list)
+    {
+        int count = 0;
+        for (; list && (count < FCS_DBM_STORE_MAX_BULK_COUNT) ;
+            list = list->next, count++)
+        {
+            keys[count] = &(list->key);
+            parents[count] = list->parent;
+        }
+        fc_solve_dbm_store_insert_key_values(
+            instance->store, count, keys, parents, tokens, TRUE
+        );
+        /* Enqueue the new states in the order of the list. */
+        for (int i = 0 ; i < count ; i++)
+        {
+            if (tokens[i])
+            {
+                instance_enqueue_new_record(instance, tokens[i]);
+            }
+        }
+    }
+#else
     FCS_LOCK(instance->storage_lock);
     for (; list ; list = list->next)
     {
@@ -222,6 +285,7 @@ static GCC_INLINE void instance_check_multiple_keys(
 #ifndef FCS_DBM_CACHE_ONLY
     if (instance->pre_cache.count_elements >= instance->pre_cache_max_count)
     {
+        INSTANCE_BEFORE_PRE_CACHE_OFFLOAD(instance);
         pre_cache_offload_and_reset(
             &(instance->pre_cache),
             instance->store,
@@ -230,6 +294,7 @@ static GCC_INLINE void instance_check_multiple_keys(
         );
     }
 #endif
+#endif
 #endif
     FCS_UNLOCK(instance->storage_lock);
 }
@@ -298,6 +363,32 @@ static GCC_INLINE void instance_debug_out_state(
 #define instance_debug_out_state(instance, key) {}
 #endif
 
+#if (!defined(FCS_DBM_WITHOUT_CACHES)) && (!defined(FCS_DBM_CACHE_ONLY))
+/* Looks up the parent of a state that was not offloaded yet, or else in
+ * the store. */
+static GCC_INLINE fcs_bool_t instance_lookup_parent(
+    fcs_dbm_solver_instance_t * const instance,
+    const fcs_encoded_state_buffer_t * const key,
+    fcs_encoded_state_buffer_t * const parent
+    )
+{
+    fcs_pre_cache_key_val_pair_t to_check;
+    const fcs_pre_cache_key_val_pair_t * existing;
+
+    to_check.key = *key;
+    existing = (const fcs_pre_cache_key_val_pair_t *)
+        fc_solve_kaz_tree_lookup_value(instance->pre_cache.kaz_tree, &to_check);
+
+    if (existing)
+    {
+        *parent = existing->parent;
+        return TRUE;
+    }
+
+    return fc_solve_dbm_store_lookup_parent(instance->store, key->s, parent->s);
+}
+#endif
+
 static void calc_trace(
     fcs_dbm_solver_instance_t * const instance,
     fcs_dbm_record_t * const ptr_initial_record,
@@ -310,11 +401,11 @@ static void calc_trace(
     int trace_max_num = GROW_BY;
     fcs_encoded_state_buffer_t * trace = SMALLOC(trace, trace_max_num);
     fcs_encoded_state_buffer_t * key_ptr = trace;
+#ifdef FCS_DBM_WITHOUT_CACHES
     fcs_dbm_record_t * record = ptr_initial_record;
 
     while (record)
     {
-#if 1
         *(key_ptr) = record->key;
         if ((++trace_num) == trace_max_num)
         {
@@ -323,8 +414,36 @@ static void calc_trace(
         }
         record = fcs_dbm_record_get_parent_ptr(record);
         key_ptr++;
-#endif
     }
+#else
+    /* The parents are kept by value, and the initial state has a null
+     * one. */
+    fcs_encoded_state_buffer_t null_key, parent;
+    fcs_init_encoded_state(&null_key);
+
+    *(key_ptr) = ptr_initial_record->key;
+    parent = ptr_initial_record->parent;
+    while (1)
+    {
+        if ((++trace_num) == trace_max_num)
+        {
+            trace = SREALLOC(trace, trace_max_num += GROW_BY);
+            key_ptr = &(trace[trace_num-1]);
+        }
+        key_ptr++;
+        if (! memcmp(&parent, &null_key, sizeof(parent)))
+        {
+            break;
+        }
+        *(key_ptr) = parent;
+        if (! instance_lookup_parent(instance, key_ptr, &parent))
+        {
+            fprintf(stderr, "%s\n",
+                "The parent of a state of the trace was not found.");
+            exit(-1);
+        }
+    }
+#endif
 #undef GROW_BY
     *ptr_trace_num = trace_num;
     *ptr_trace = trace;
@@ -30,6 +30,14 @@
  */
 
 #include "dbm_solver_head.h"
+#ifndef FCS_DBM_WITHOUT_CACHES
+#ifndef FCS_DBM_CACHE_ONLY
+#include "dbm_bloom.h"
+#endif
+#endif
+#include "dbm_checkpoint.h"
+#include "dbm_memory_governor.h"
+#include "dbm_metrics.h"
 
 typedef struct
 {
@@ -37,6 +45,12 @@ typedef struct
 #ifndef FCS_DBM_WITHOUT_CACHES
 #ifndef FCS_DBM_CACHE_ONLY
     fcs_pre_cache_t pre_cache;
+    /* Filters out most of the store lookups of states that were never
+     * inserted. Persisted alongside the store, if enabled. */
+    fcs_dbm_bloom_t bloom;
+    char * bloom_path;
+    /* The number of lookups that reached the store. */
+    long num_store_lookups;
 #endif
     fcs_lru_cache_t cache;
 #endif
@@ -45,6 +59,16 @@ typedef struct
 #endif
 
     long pre_cache_max_count;
+#ifndef FCS_DBM_WITHOUT_CACHES
+    /* The limits given on the command line, which the memory governor
+     * will not exceed when letting the caches grow back. */
+    long initial_pre_cache_max_count, initial_cache_max_count;
+#endif
+    fcs_dbm_memory_governor_t memory_governor;
+    /* Set when the budget was exceeded and the instance stops after
+     * taking a final checkpoint. */
+    fcs_bool_t memory_exceeded;
+    fcs_dbm_metrics_t metrics;
     /* The queue */
 
     fcs_lock_t queue_lock;
@@ -52,30 +76,104 @@ typedef struct
     long max_count_of_items_in_queue;
     fcs_bool_t queue_solution_was_found;
     enum TERMINATE_REASON should_terminate;
-#ifdef FCS_DBM_WITHOUT_CACHES
     fcs_dbm_record_t * queue_solution_ptr;
-#else
-    fcs_encoded_state_buffer_t queue_solution;
-#endif
     fcs_meta_compact_allocator_t meta_alloc;
     int queue_num_extracted_and_processed;
     fcs_offloading_queue_t queue;
+#ifndef FCS_DBM_WITHOUT_CACHES
+    /* The copies of the records that are in the queue or being processed. */
+    fcs_compact_allocator_t queue_records_allocator;
+    fcs_dbm_record_t * queue_records_recycle_bin;
+#endif
 #ifdef FCS_DBM_USE_OFFLOADING_QUEUE
     const char * offload_dir_path;
 #endif
     fcs_encoded_state_buffer_t first_key;
     long num_states_in_collection;
+#ifdef FCS_DBM_ENABLE_CHECKPOINTS
+    fcs_dbm_checkpointer_t checkpointer;
+#endif
     FILE * out_fh;
     void * tree_recycle_bin;
     enum fcs_dbm_variant_type_t variant;
 } fcs_dbm_solver_instance_t;
 
+#ifndef FCS_DBM_WITHOUT_CACHES
+#ifndef FCS_DBM_CACHE_ONLY
+/*
+ * To be called before the pre-cache is offloaded into the store, so the
+ * saved filter will contain every state of the store.
+ * */
+static GCC_INLINE void instance_save_bloom(
+    fcs_dbm_solver_instance_t * const instance
+    )
+{
+    if (instance->bloom_path
+        && (! fcs_dbm_bloom__save(&(instance->bloom), instance->bloom_path)))
+    {
+        fprintf(stderr, "Could not save the Bloom filter to \"%s\".\n",
+            instance->bloom_path);
+    }
+}
+#define INSTANCE_BEFORE_PRE_CACHE_OFFLOAD(instance) instance_save_bloom(instance)
+#endif
+#endif
+
+#define CHECK_KEY_CALC_DEPTH() 0
+
+#ifdef FCS_DBM_WITHOUT_CACHES
+/* Insert the keys of every derived states list into the store at once. */
+#define FCS_DBM_CHECK_KEYS_IN_BULK 1
+#endif
+
+#include "dbm_procs.h"
+
+#ifndef FCS_DBM_WITHOUT_CACHES
+/*
+ * The records of the store are not kept in memory with caches, so the queue
+ * holds copies of them, which are released once they were processed.
+ * Should be called with the queue lock held.
+ * */
+static GCC_INLINE fcs_dbm_record_t * instance_copy_queue_record(
+    fcs_dbm_solver_instance_t * const instance,
+    const fcs_dbm_record_t * const record
+    )
+{
+    fcs_dbm_record_t * copy;
+
+    if ((copy = instance->queue_records_recycle_bin))
+    {
+        instance->queue_records_recycle_bin = FCS_DBM_RECORD_NEXT(copy);
+    }
+    else
+    {
+        copy = (fcs_dbm_record_t *)fcs_compact_alloc_ptr(
+            &(instance->queue_records_allocator), sizeof(*copy)
+        );
+    }
+    *copy = *record;
+
+    return copy;
+}
+
+static GCC_INLINE void instance_release_queue_record(
+    fcs_dbm_solver_instance_t * const instance,
+    fcs_dbm_record_t * const record
+    )
+{
+    FCS_DBM_RECORD_NEXT(record) = instance->queue_records_recycle_bin;
+    instance->queue_records_recycle_bin = record;
+}
+#endif
+
 static GCC_INLINE void instance_init(
     fcs_dbm_solver_instance_t * instance,
     enum fcs_dbm_variant_type_t local_variant,
     long pre_cache_max_count,
     long caches_delta,
     const char * dbm_store_path,
+    long bloom_expected_num_states,
+    const char * bloom_name,
     long max_count_of_items_in_queue,
     long iters_delta_limit,
     const char * offload_dir_path,
@@ -96,6 +194,12 @@ static GCC_INLINE void instance_init(
     fcs_offloading_queue__init(&(instance->queue), NUM_ITEMS_PER_PAGE, instance->offload_dir_path = offload_dir_path, 0);
 #else
     fcs_offloading_queue__init(&(instance->queue), &(instance->meta_alloc));
+#endif
+#ifndef FCS_DBM_WITHOUT_CACHES
+    fc_solve_compact_allocator_init(
+        &(instance->queue_records_allocator), &(instance->meta_alloc)
+    );
+    instance->queue_records_recycle_bin = NULL;
 #endif
     instance->queue_solution_was_found = FALSE;
     instance->should_terminate = DONT_TERMINATE;
@@ -113,12 +217,39 @@ static GCC_INLINE void instance_init(
     }
     instance->count_of_items_in_queue = 0;
     instance->max_count_of_items_in_queue = max_count_of_items_in_queue;
+#ifdef FCS_DBM_ENABLE_CHECKPOINTS
+    fcs_dbm_checkpointer__init(&(instance->checkpointer), NULL, 0);
+#endif
+    fcs_dbm_memory_governor__init(&(instance->memory_governor), 0);
+    instance->memory_exceeded = FALSE;
+    fcs_dbm_metrics__init(&(instance->metrics));
 
 #ifndef FCS_DBM_WITHOUT_CACHES
 #ifndef FCS_DBM_CACHE_ONLY
     pre_cache_init (&(instance->pre_cache), &(instance->meta_alloc));
+    instance->bloom_path = NULL;
+    if (bloom_expected_num_states > 0)
+    {
+        /* Every instance has a filter of its own. */
+        instance->bloom_path = SMALLOC(instance->bloom_path,
+            strlen(dbm_store_path) + strlen(bloom_name) + 2);
+        sprintf(instance->bloom_path, "%s.%s", dbm_store_path, bloom_name);
+    }
+    /* The filter is saved before every offload of the pre-cache into the
+     * store, so a filter that was saved by a previous run covers all the
+     * states that it put in the store - even if it crashed. */
+    if (! (instance->bloom_path
+        && fcs_dbm_bloom__load(&(instance->bloom), instance->bloom_path)))
+    {
+        fcs_dbm_bloom__init(&(instance->bloom),
+            (instance->bloom_path ? bloom_expected_num_states : 0),
+            FCS_DBM_BLOOM_DEFAULT_BITS_PER_STATE);
+    }
+    instance->num_store_lookups = 0;
 #endif
-    instance->pre_cache_max_count = pre_cache_max_count;
+    instance->initial_pre_cache_max_count =
+        instance->pre_cache_max_count = pre_cache_max_count;
+    instance->initial_cache_max_count = pre_cache_max_count + caches_delta;
     cache_init (&(instance->cache), pre_cache_max_count+caches_delta, &(instance->meta_alloc));
 #endif
 #ifndef FCS_DBM_CACHE_ONLY
@@ -138,6 +269,13 @@ static GCC_INLINE void instance_recycle(
 #else
     fcs_offloading_queue__init(&(instance->queue), &(instance->meta_alloc));
 #endif
+#ifndef FCS_DBM_WITHOUT_CACHES
+    fc_solve_compact_allocator_finish(&(instance->queue_records_allocator));
+    fc_solve_compact_allocator_init(
+        &(instance->queue_records_allocator), &(instance->meta_alloc)
+    );
+    instance->queue_records_recycle_bin = NULL;
+#endif
 
     instance->should_terminate = DONT_TERMINATE;
     instance->queue_num_extracted_and_processed = 0;
@@ -151,15 +289,23 @@ static GCC_INLINE void instance_destroy(
     )
 {
     fcs_offloading_queue__destroy(&(instance->queue));
+#ifndef FCS_DBM_WITHOUT_CACHES
+    fc_solve_compact_allocator_finish(&(instance->queue_records_allocator));
+#endif
+    fcs_dbm_metrics__destroy(&(instance->metrics));
 
 #ifndef FCS_DBM_WITHOUT_CACHES
 
 #ifndef FCS_DBM_CACHE_ONLY
+    instance_save_bloom(instance);
     pre_cache_offload_and_destroy(
         &(instance->pre_cache),
         instance->store,
         &(instance->cache)
     );
+    fcs_dbm_bloom__destroy(&(instance->bloom));
+    free(instance->bloom_path);
+    instance->bloom_path = NULL;
 #endif
 
     cache_destroy(&(instance->cache));
@@ -177,9 +323,50 @@ static GCC_INLINE void instance_destroy(
     FCS_DESTROY_LOCK(instance->storage_lock);
 }
 
-#define CHECK_KEY_CALC_DEPTH() 0
+static GCC_INLINE void instance_enqueue_new_record(
+    fcs_dbm_solver_instance_t * const instance,
+    fcs_dbm_record_t * token
+)
+{
+    FCS_LOCK(instance->queue_lock);
+#ifndef FCS_DBM_WITHOUT_CACHES
+    token = instance_copy_queue_record(instance, token);
+#endif
 
-#include "dbm_procs.h"
+    instance->count_of_items_in_queue++;
+    instance->num_states_in_collection++;
+
+    instance_debug_out_state(instance, &(token->key));
+
+    fcs_offloading_queue__insert(
+        &(instance->queue),
+        ((fcs_offloading_queue_item_t *)(&token))
+        );
+    instance->count_of_items_in_queue++;
+    FCS_UNLOCK(instance->queue_lock);
+}
+
+#ifndef FCS_DBM_WITHOUT_CACHES
+#ifndef FCS_DBM_CACHE_ONLY
+static GCC_INLINE fcs_bool_t instance_store_does_key_exist(
+    fcs_dbm_solver_instance_t * instance,
+    fcs_encoded_state_buffer_t * key
+)
+{
+    if (! fcs_dbm_bloom__may_contain(&(instance->bloom), key))
+    {
+        return FALSE;
+    }
+    instance->num_store_lookups++;
+    if (fc_solve_dbm_store_does_key_exist(instance->store, key->s))
+    {
+        return TRUE;
+    }
+    fcs_dbm_bloom__add_false_positive(&(instance->bloom));
+    return FALSE;
+}
+#endif
+#endif
 
 static GCC_INLINE void instance_check_key(
     fcs_dbm_solver_thread_t * thread,
@@ -219,7 +406,7 @@ static GCC_INLINE void instance_check_key(
     }
 #endif
 #ifndef FCS_DBM_CACHE_ONLY
-    else if (fc_solve_dbm_store_does_key_exist(instance->store, key->s))
+    else if (instance_store_does_key_exist(instance, key))
     {
         cache_insert(cache, key, NULL, '\0');
         return;
@@ -236,28 +423,120 @@ static GCC_INLINE void instance_check_key(
 
 #ifndef FCS_DBM_WITHOUT_CACHES
 #ifndef FCS_DBM_CACHE_ONLY
-        pre_cache_insert(pre_cache, key, parent);
+        fcs_dbm_record_t record;
+        fcs_dbm_record_t * const token = &record;
+
+        record.key = *key;
+        record.parent = parent->key;
+        pre_cache_insert(pre_cache, &(record.key), &(record.parent));
+        fcs_dbm_bloom__insert(&(instance->bloom), key);
 #else
         cache_key = cache_insert(cache, key, moves_to_parent, move);
 #endif
 #endif
 
         /* Now insert it into the queue. */
+        instance_enqueue_new_record(instance, token);
+    }
+}
 
-        FCS_LOCK(instance->queue_lock);
+/* The smallest pre-cache the governor shrinks to, as enforced for
+ * --pre-cache-max-count. */
+#define FCS_DBM_MIN_PRE_CACHE_MAX_COUNT 1000
 
-        instance->count_of_items_in_queue++;
-        instance->num_states_in_collection++;
+/*
+ * Samples the memory usage and acts on the governor's decision. Should be
+ * called with the queue lock held.
+ *
+ * With caches, the pre-cache and the LRU cache are halved when over budget,
+ * and let grow back when the usage has dropped. The store itself cannot shrink,
+ * so once there is nothing left to shrink - which is always the case
+ * without caches, where the queue keeps only two pages in memory anyway -
+ * the instance stops, after taking a final checkpoint if checkpoints are
+ * enabled, so it can be resumed on a machine with more memory.
+ * */
+static GCC_INLINE void instance_govern_memory(
+    fcs_dbm_solver_instance_t * const instance,
+    FILE * const out_fh
+)
+{
+    fcs_dbm_memory_governor_t * const governor = &(instance->memory_governor);
+    const long long usage = fcs_dbm_memory_governor__get_usage();
+#ifndef FCS_DBM_WITHOUT_CACHES
+    const fcs_bool_t can_shrink =
+        (instance->pre_cache_max_count > FCS_DBM_MIN_PRE_CACHE_MAX_COUNT);
+#else
+    const fcs_bool_t can_shrink = FALSE;
+#endif
 
-        instance_debug_out_state(instance, &(token->key));
+    switch (fcs_dbm_memory_governor__decide(governor, usage, can_shrink))
+    {
+        case FCS_DBM_MEMORY_KEEP:
+            break;
 
-        fcs_offloading_queue__insert(
-            &(instance->queue),
-            ((fcs_offloading_queue_item_t *)(&token))
+        case FCS_DBM_MEMORY_SHRINK:
+#ifndef FCS_DBM_WITHOUT_CACHES
+            if (can_shrink)
+            {
+                instance->pre_cache_max_count = max(
+                    instance->pre_cache_max_count >> 1,
+                    FCS_DBM_MIN_PRE_CACHE_MAX_COUNT
+                );
+                /* Evicted entries are reused, so a lower limit stops the
+                 * cache from growing further. The pre-cache is offloaded
+                 * by the next worker that checks its keys against the new
+                 * limit - the storage lock cannot be taken here, with the
+                 * queue lock held. */
+                instance->cache.max_num_elements_in_cache = max(
+                    instance->cache.max_num_elements_in_cache >> 1,
+                    FCS_DBM_MIN_PRE_CACHE_MAX_COUNT
+                );
+                fprintf(out_fh, ">>>Memory: usage=%lld budget=%lld ; "
+                    "Shrinking the caches to pre-cache=%ld cache=%ld\n",
+                    usage, governor->budget, instance->pre_cache_max_count,
+                    instance->cache.max_num_elements_in_cache
+                );
+                break;
+            }
+#endif
+            fprintf(out_fh, ">>>Memory: usage=%lld budget=%lld ; "
+                "Nothing left to shrink - stopping.\n",
+                usage, governor->budget
             );
-        instance->count_of_items_in_queue++;
-        FCS_UNLOCK(instance->queue_lock);
+            governor->budget = 0;
+#ifdef FCS_DBM_ENABLE_CHECKPOINTS
+            if (instance->checkpointer.path)
+            {
+                fcs_dbm_checkpointer__finish(&(instance->checkpointer));
+                instance->checkpointer.is_pending = TRUE;
+                instance->memory_exceeded = TRUE;
+            }
+            else
+#endif
+            {
+                instance->should_terminate = MEMORY_TERMINATE;
+            }
+            break;
+
+        case FCS_DBM_MEMORY_GROW:
+#ifndef FCS_DBM_WITHOUT_CACHES
+            instance->pre_cache_max_count = min(
+                instance->pre_cache_max_count << 1,
+                instance->initial_pre_cache_max_count
+            );
+            instance->cache.max_num_elements_in_cache = min(
+                instance->cache.max_num_elements_in_cache << 1,
+                instance->initial_cache_max_count
+            );
+            fprintf(out_fh, ">>>Memory: usage=%lld budget=%lld ; "
+                "Growing the caches to pre-cache=%ld cache=%ld\n",
+                usage, governor->budget, instance->pre_cache_max_count,
+                instance->cache.max_num_elements_in_cache
+            );
+#endif
+            break;
     }
+    fflush(out_fh);
 }
 
 
@@ -265,8 +544,39 @@ struct fcs_dbm_solver_thread_struct
 {
     fcs_dbm_solver_instance_t * instance;
     fc_solve_delta_stater_t * delta_stater;
+    fcs_dbm_metrics_slot_t * metrics_slot;
 };
 
+/* Should be called with the queue lock held. */
+static void instance_export_metrics(
+    fcs_dbm_solver_instance_t * const instance
+)
+{
+    fcs_dbm_metrics_sample_t sample;
+
+    if (! instance->metrics.fh)
+    {
+        return;
+    }
+
+    sample.num_processed = instance->count_num_processed;
+    sample.num_states_in_collection = instance->num_states_in_collection;
+    sample.num_items_in_queue = instance->queue.num_items_in_queue;
+    sample.num_items_in_memory =
+        fcs_offloading_queue__count_items_in_memory(&(instance->queue));
+#ifndef FCS_DBM_WITHOUT_CACHES
+    sample.num_cache_hits = instance->cache.num_hits;
+    sample.num_cache_misses = instance->cache.num_misses;
+#else
+    sample.num_cache_hits = sample.num_cache_misses = -1;
+#endif
+    sample.depth = -1;
+    sample.num_depths = 0;
+    sample.depth_counts = NULL;
+
+    fcs_dbm_metrics__export(&(instance->metrics), &sample);
+}
+
 typedef struct {
     fcs_dbm_solver_thread_t * thread;
 } thread_arg_t;
@@ -306,15 +616,44 @@ static void * instance_run_solver_thread(void * void_arg)
     while (1)
     {
         /* First of all extract an item. */
-        FCS_LOCK(instance->queue_lock);
+        FCS_DBM_METRICS_LOCK(&(instance->metrics), thread->metrics_slot,
+            instance->queue_lock);
 
         if (prev_item)
         {
             instance->queue_num_extracted_and_processed--;
+#ifndef FCS_DBM_WITHOUT_CACHES
+            instance_release_queue_record(instance, token);
+#endif
         }
 
+#ifdef FCS_DBM_ENABLE_CHECKPOINTS
+        if (instance->checkpointer.is_pending
+            && (! instance->queue_num_extracted_and_processed))
+        {
+            fcs_dbm_checkpointer__take(
+                &(instance->checkpointer), instance->store, &(instance->queue),
+                &(instance->first_key), instance->count_num_processed,
+                instance->num_states_in_collection
+            );
+            if (instance->memory_exceeded)
+            {
+                instance->should_terminate = MEMORY_TERMINATE;
+            }
+        }
+#endif
+
         if ((should_terminate = instance->should_terminate) == DONT_TERMINATE)
         {
+#ifdef FCS_DBM_ENABLE_CHECKPOINTS
+            if (instance->checkpointer.is_pending)
+            {
+                /* Wait for the other threads to finish their items, so
+                 * the checkpoint will be consistent. */
+                item = NULL;
+            }
+            else
+#endif
             if (instance->count_of_items_in_queue >= instance->max_count_of_items_in_queue)
             {
                 instance->should_terminate = should_terminate = QUEUE_TERMINATE;
@@ -330,15 +669,34 @@ static void * instance_run_solver_thread(void * void_arg)
 
                 instance->count_of_items_in_queue--;
                 instance->queue_num_extracted_and_processed++;
+                fcs_dbm_metrics__add_processed(thread->metrics_slot, 1);
                 if (++instance->count_num_processed % 100000 == 0)
                 {
                     instance_print_stats(instance, out_fh);
                 }
+                if (fcs_dbm_metrics__is_due(&(instance->metrics),
+                    instance->count_num_processed))
+                {
+                    instance_export_metrics(instance);
+                }
                 if (instance->count_num_processed >=
                     instance->max_count_num_processed)
                 {
                     instance->should_terminate = should_terminate = MAX_ITERS_TERMINATE;
                 }
+                else
+                {
+#ifdef FCS_DBM_ENABLE_CHECKPOINTS
+                    fcs_dbm_checkpointer__count(&(instance->checkpointer),
+                        instance->count_num_processed);
+#endif
+                    if (fcs_dbm_memory_governor__should_check(
+                        &(instance->memory_governor),
+                        instance->count_num_processed))
+                    {
+                        instance_govern_memory(instance, out_fh);
+                    }
+                }
             }
             else
             {
@@ -408,28 +766,17 @@ static void * instance_run_solver_thread(void * void_arg)
             FCS_LOCK(instance->queue_lock);
             instance->should_terminate = SOLUTION_FOUND_TERMINATE;
             instance->queue_solution_was_found = TRUE;
-#ifdef FCS_DBM_WITHOUT_CACHES
             instance->queue_solution_ptr = token;
-#else
-            instance->queue_solution = item->key;
-#endif
             FCS_UNLOCK(instance->queue_lock);
             break;
         }
 
         /* Encode all the states. */
-        for (fcs_derived_state_t * derived_iter = derived_list;
-                derived_iter ;
-                derived_iter = derived_iter->next
-        )
-        {
-            fcs_init_and_encode_state(
-                delta_stater,
-                local_variant,
-                &(derived_iter->state),
-                &(derived_iter->key)
-            );
-        }
+        fcs_init_and_encode_derived_states(
+            delta_stater,
+            local_variant,
+            derived_list
+        );
 
         instance_check_multiple_keys(thread, instance, derived_list
 #ifdef FCS_DBM_CACHE_ONLY
@@ -480,7 +827,11 @@ static fcs_bool_t populate_instance_with_intermediate_input_line(
     int hex_digits;
     fcs_kv_state_t kv_init, kv_running;
     fcs_encoded_state_buffer_t running_key;
+#ifdef FCS_DBM_WITHOUT_CACHES
     fcs_dbm_record_t * running_parent;
+#else
+    fcs_dbm_record_t running_record;
+#endif
     fcs_state_keyval_pair_t running_state;
     fcs_dbm_record_t * token = NULL;
 #ifdef FCS_DBM_CACHE_ONLY
@@ -539,19 +890,21 @@ static fcs_bool_t populate_instance_with_intermediate_input_line(
     /* The NULL parent and move for indicating this is the initial
      * state. */
     fcs_init_and_encode_state(delta, local_variant, &(running_state), &running_key);
-    running_parent = NULL;
 
 #ifdef FCS_DBM_CACHE_ONLY
     running_moves = NULL;
 #endif
 #ifndef FCS_DBM_WITHOUT_CACHES
 #ifndef FCS_DBM_CACHE_ONLY
-    pre_cache_insert(&(instance->pre_cache), &(running_key), &running_parent);
+    running_record.key = running_key;
+    fcs_init_encoded_state(&(running_record.parent));
+    pre_cache_insert(&(instance->pre_cache), &(running_record.key), &(running_record.parent));
+    fcs_dbm_bloom__insert(&(instance->bloom), &(running_key));
 #else
     cache_insert(&(instance->cache), &(running_key), running_moves, '\0');
 #endif
 #else
-    running_parent = fc_solve_dbm_store_insert_key_value(instance->store, &(running_key), running_parent, TRUE);
+    running_parent = fc_solve_dbm_store_insert_key_value(instance->store, &(running_key), NULL, TRUE);
 #endif
     instance->num_states_in_collection++;
 
@@ -645,7 +998,10 @@ static fcs_bool_t populate_instance_with_intermediate_input_line(
 
 #ifndef FCS_DBM_WITHOUT_CACHES
 #ifndef FCS_DBM_CACHE_ONLY
-        pre_cache_insert(&(instance->pre_cache), &(running_key), &running_parent);
+        running_record.parent = running_record.key;
+        running_record.key = running_key;
+        pre_cache_insert(&(instance->pre_cache), &(running_record.key), &(running_record.parent));
+        fcs_dbm_bloom__insert(&(instance->bloom), &(running_key));
 #else
         running_moves = (cache_insert(&(instance->cache), &(running_key), running_moves, move))->moves_to_key;
 #endif
@@ -699,6 +1055,9 @@ static fcs_bool_t populate_instance_with_intermediate_input_line(
                );
         exit(-1);
     }
+#if (!defined(FCS_DBM_WITHOUT_CACHES)) && (!defined(FCS_DBM_CACHE_ONLY))
+    token = instance_copy_queue_record(instance, &running_record);
+#endif
     fcs_offloading_queue__insert(&(instance->queue), (const fcs_offloading_queue_item_t *)(&token));
     instance->count_of_items_in_queue++;
 
@@ -726,6 +1085,7 @@ static void instance_run_all_threads(
 #endif
 
     threads = SMALLOC(threads, num_threads);
+    fcs_dbm_metrics__alloc_slots(&(instance->metrics), num_threads);
 
     TRACE0("instance_run_all_threads start");
 
@@ -753,6 +1113,7 @@ static void instance_run_all_threads(
                 , FCS_SEQ_BUILT_BY_ALTERNATE_COLOR
 #endif
             );
+        threads[i].thread.metrics_slot = &(instance->metrics.slots[i]);
         threads[i].arg.thread = &(threads[i].thread);
         check = pthread_create(
             &(threads[i].id),
@@ -970,6 +1331,14 @@ static fcs_bool_t handle_and_destroy_instance_solution(
 
     TRACE0("handle_and_destroy_instance_solution start");
     instance_print_stats(instance, out_fh);
+    instance_export_metrics(instance);
+#ifndef FCS_DBM_WITHOUT_CACHES
+#ifndef FCS_DBM_CACHE_ONLY
+    fprintf(out_fh, ">>>Store Stats: lookups=%ld\n",
+        instance->num_store_lookups);
+    fcs_dbm_bloom__print_stats(&(instance->bloom), out_fh);
+#endif
+#endif
 
     if (instance->queue_solution_was_found)
     {
@@ -1080,6 +1449,10 @@ static fcs_bool_t handle_and_destroy_instance_solution(
         {
             fprintf(out_fh, "Reached Max-or-more iterations of %ld.\n", instance->max_count_num_processed);
         }
+        else if (instance->should_terminate == MEMORY_TERMINATE)
+        {
+            fprintf(out_fh, "%s\n", "Exceeded the memory budget.");
+        }
     }
     else
     {
@@ -1097,6 +1470,7 @@ int main(int argc, char * argv[])
 {
     long pre_cache_max_count;
     long caches_delta;
+    long bloom_expected_num_states = 0;
     long max_count_of_items_in_queue = LONG_MAX;
     long iters_delta_limit = -1;
     long start_line = 1;
@@ -1105,6 +1479,11 @@ int main(int argc, char * argv[])
     int arg;
     const char * filename = NULL, * out_filename = NULL,
           * intermediate_input_filename = NULL, * offload_dir_path = NULL;
+    const char * checkpoint_path = NULL, * resume_from_path = NULL;
+    long checkpoint_every = 1000000;
+    long long memory_budget = 0;
+    const char * metrics_path = NULL;
+    double metrics_interval = FCS_DBM_METRICS_DEFAULT_INTERVAL;
     FILE * fh = NULL, * out_fh = NULL, * intermediate_in_fh = NULL;
     char user_state[USER_STATE_SIZE];
     fc_solve_delta_stater_t * delta;
@@ -1179,6 +1558,21 @@ int main(int argc, char * argv[])
             }
             dbm_store_path = argv[arg];
         }
+        else if (!strcmp(argv[arg], "--bloom-expected-states"))
+        {
+            arg++;
+            if (arg == argc)
+            {
+                fprintf(stderr, "--bloom-expected-states came without an argument.\n");
+                exit(-1);
+            }
+            bloom_expected_num_states = atol(argv[arg]);
+            if (bloom_expected_num_states < 1)
+            {
+                fprintf(stderr, "--bloom-expected-states must be at least 1.\n");
+                exit(-1);
+            }
+        }
         else if (!strcmp(argv[arg], "--max-count-of-items-in-queue"))
         {
             arg++;
@@ -1239,6 +1633,82 @@ int main(int argc, char * argv[])
             }
             offload_dir_path = argv[arg];
         }
+        else if (!strcmp(argv[arg], "--checkpoint-path"))
+        {
+            arg++;
+            if (arg == argc)
+            {
+                fprintf(stderr, "--checkpoint-path came without an argument.\n");
+                exit(-1);
+            }
+            checkpoint_path = argv[arg];
+        }
+        else if (!strcmp(argv[arg], "--checkpoint-every"))
+        {
+            arg++;
+            if (arg == argc)
+            {
+                fprintf(stderr, "--checkpoint-every came without an argument.\n");
+                exit(-1);
+            }
+            checkpoint_every = atol(argv[arg]);
+            if (checkpoint_every < 1)
+            {
+                fprintf(stderr, "--checkpoint-every must be at least 1.\n");
+                exit(-1);
+            }
+        }
+        else if (!strcmp(argv[arg], "--memory-budget"))
+        {
+            arg++;
+            if (arg == argc)
+            {
+                fprintf(stderr, "--memory-budget came without an argument.\n");
+                exit(-1);
+            }
+            memory_budget = fcs_dbm_memory_governor__parse_size(argv[arg]);
+            if (memory_budget < 0)
+            {
+                fprintf(stderr, "%s\n",
+                    "--memory-budget must be a size such as 4096, 512M or 3G.");
+                exit(-1);
+            }
+        }
+        else if (!strcmp(argv[arg], "--metrics-output"))
+        {
+            arg++;
+            if (arg == argc)
+            {
+                fprintf(stderr, "--metrics-output came without an argument.\n");
+                exit(-1);
+            }
+            metrics_path = argv[arg];
+        }
+        else if (!strcmp(argv[arg], "--metrics-interval"))
+        {
+            arg++;
+            if (arg == argc)
+            {
+                fprintf(stderr, "--metrics-interval came without an argument.\n");
+                exit(-1);
+            }
+            metrics_interval = atof(argv[arg]);
+            if (metrics_interval <= 0)
+            {
+                fprintf(stderr, "--metrics-interval must be positive.\n");
+                exit(-1);
+            }
+        }
+        else if (!strcmp(argv[arg], "--resume-from"))
+        {
+            arg++;
+            if (arg == argc)
+            {
+                fprintf(stderr, "--resume-from came without an argument.\n");
+                exit(-1);
+            }
+            resume_from_path = argv[arg];
+        }
         else
         {
             break;
@@ -1306,6 +1776,24 @@ int main(int argc, char * argv[])
 #endif
     );
 
+#ifdef FCS_DBM_ENABLE_CHECKPOINTS
+    if ((checkpoint_path || resume_from_path) && intermediate_input_filename)
+    {
+        fprintf(stderr, "%s\n",
+            "Checkpoints are not supported with --intermediate-input.");
+        exit(-1);
+    }
+#else
+    if (checkpoint_path || resume_from_path)
+    {
+        fprintf(stderr, "%s\n",
+            "Checkpoints are not supported by this build. They require the "
+            "kaztree store over the libavl tree.");
+        exit(-1);
+    }
+    (void)checkpoint_every;
+#endif
+
     if (intermediate_input_filename)
     {
         intermediate_in_fh = fopen(intermediate_input_filename, "rt");
@@ -1329,12 +1817,13 @@ int main(int argc, char * argv[])
         fcs_dbm_solver_instance_t limit_instance;
 
         instance_init(&queue_instance, local_variant, pre_cache_max_count, caches_delta,
-                      dbm_store_path, max_count_of_items_in_queue,
+                      dbm_store_path, bloom_expected_num_states, "queue.bloom",
+                      max_count_of_items_in_queue,
                       -1, offload_dir_path, out_fh);
 
         instance_init(
             &limit_instance, local_variant, pre_cache_max_count, caches_delta,
-            dbm_store_path, LONG_MAX,
+            dbm_store_path, bloom_expected_num_states, "limit.bloom", LONG_MAX,
             iters_delta_limit, offload_dir_path, out_fh
             );
 
@@ -1462,8 +1951,16 @@ int main(int argc, char * argv[])
         fcs_encoded_state_buffer_t parent_state_enc;
 
         instance_init(&instance, local_variant, pre_cache_max_count, caches_delta,
-                      dbm_store_path, max_count_of_items_in_queue,
+                      dbm_store_path, bloom_expected_num_states, "bloom",
+                      max_count_of_items_in_queue,
                       iters_delta_limit, offload_dir_path, out_fh);
+        fcs_dbm_memory_governor__init(&(instance.memory_governor),
+            memory_budget);
+        if (metrics_path)
+        {
+            fcs_dbm_metrics__open(&(instance.metrics), metrics_path,
+                metrics_interval);
+        }
 
         key_ptr = &(instance.first_key);
         fcs_init_and_encode_state(delta, local_variant, &(init_state), KEY_PTR());
@@ -1475,18 +1972,53 @@ int main(int argc, char * argv[])
 #ifndef FCS_DBM_WITHOUT_CACHES
 #ifndef FCS_DBM_CACHE_ONLY
         pre_cache_insert(&(instance.pre_cache), KEY_PTR(), &parent_state_enc);
+        fcs_dbm_bloom__insert(&(instance.bloom), KEY_PTR());
+        {
+            fcs_dbm_record_t first_record;
+            first_record.key = *KEY_PTR();
+            first_record.parent = parent_state_enc;
+            token = instance_copy_queue_record(&instance, &first_record);
+        }
 #else
         cache_insert(&(instance.cache), KEY_PTR(), NULL, '\0');
 #endif
 #else
-        token = fc_solve_dbm_store_insert_key_value(instance.store, KEY_PTR(), NULL, TRUE);
+#ifdef FCS_DBM_ENABLE_CHECKPOINTS
+        fcs_dbm_checkpointer__init(&(instance.checkpointer),
+            checkpoint_path, checkpoint_every);
+        if (resume_from_path)
+        {
+            fcs_dbm_checkpoint__restore(resume_from_path, instance.store,
+                &(instance.queue), KEY_PTR(), &(instance.count_num_processed),
+                &(instance.num_states_in_collection),
+                &(instance.count_of_items_in_queue)
+            );
+            if (iters_delta_limit >= 0)
+            {
+                instance.max_count_num_processed =
+                    instance.count_num_processed + iters_delta_limit;
+            }
+        }
+        else
+#endif
+        {
+            token = fc_solve_dbm_store_insert_key_value(instance.store, KEY_PTR(), NULL, TRUE);
+        }
 #endif
 
-        fcs_offloading_queue__insert(&(instance.queue), (fcs_offloading_queue_item_t *)&token);
-        instance.num_states_in_collection++;
-        instance.count_of_items_in_queue++;
+#if defined(FCS_DBM_ENABLE_CHECKPOINTS)
+        if (! resume_from_path)
+#endif
+        {
+            fcs_offloading_queue__insert(&(instance.queue), (fcs_offloading_queue_item_t *)&token);
+            instance.num_states_in_collection++;
+            instance.count_of_items_in_queue++;
+        }
 
         instance_run_all_threads(&instance, &init_state, NUM_THREADS());
+#ifdef FCS_DBM_ENABLE_CHECKPOINTS
+        fcs_dbm_checkpointer__finish(&(instance.checkpointer));
+#endif
         handle_and_destroy_instance_solution(&instance, out_fh, delta);
     }
 
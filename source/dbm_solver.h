@@ -34,6 +34,7 @@ typedef struct {
     dict_t * kaz_tree;
     fcs_compact_allocator_t kv_allocator;
     fcs_pre_cache_key_val_pair_t * kv_recycle_bin;
+    void * tree_recycle_bin;
     long count_elements;
 } fcs_pre_cache_t;
 #endif
@@ -61,6 +62,23 @@ fcs_dbm_record_t * fc_solve_dbm_store_insert_key_value(
     const fcs_bool_t should_modify_parent
     );
 
+#define FCS_DBM_STORE_MAX_BULK_COUNT 64
+
+/*
+ * Inserts up to FCS_DBM_STORE_MAX_BULK_COUNT keys at once, in sorted order,
+ * so the descents share their upper nodes. results[i] is set to what
+ * fc_solve_dbm_store_insert_key_value() would have returned for keys[i]
+ * had the keys been inserted one by one in their original order.
+ * */
+void fc_solve_dbm_store_insert_key_values(
+    fcs_dbm_store_t store,
+    const int count,
+    const fcs_encoded_state_buffer_t * const * const keys,
+    fcs_dbm_record_t * const * const parents,
+    fcs_dbm_record_t * * const results,
+    const fcs_bool_t should_modify_parent
+    );
+
 #ifndef FCS_DBM_WITHOUT_CACHES
 void fc_solve_dbm_store_offload_pre_cache(
     fcs_dbm_store_t store,
@@ -70,6 +88,30 @@ void fc_solve_dbm_store_offload_pre_cache(
 
 void fc_solve_dbm_store_destroy(fcs_dbm_store_t store);
 
+/* A record in a recycle bin keeps the next one in the place of its key. */
+#define FCS_DBM_RECORD_NEXT(rec) (*(fcs_dbm_record_t * *)(&((rec)->key)))
+
+#ifdef FCS_DBM_USE_BPTREE
+/*
+ * With the B+tree, the mark-and-sweep of the solvers puts the records that
+ * are no longer needed in the recycle bin that was passed to
+ * fc_solve_dbm_store_init(), and the stores reuse them. A recycled record
+ * is marked by a refcount that is never reached otherwise, so it will not
+ * be recycled twice.
+ * */
+#define FCS_DBM_RECORD_RECYCLED_REFCOUNT 0xFF
+
+static GCC_INLINE void fcs_dbm_record_recycle(
+    fcs_dbm_record_t * const rec,
+    void * * const recycle_bin
+    )
+{
+    FCS_DBM_RECORD_NEXT(rec) = (fcs_dbm_record_t *)(*recycle_bin);
+    *recycle_bin = rec;
+    fcs_dbm_record_set_refcount(rec, FCS_DBM_RECORD_RECYCLED_REFCOUNT);
+}
+#endif
+
 typedef struct fcs_dbm_queue_item_struct
 {
     fcs_encoded_state_buffer_t key;
@@ -88,7 +130,8 @@ enum TERMINATE_REASON
     DONT_TERMINATE = 0,
     QUEUE_TERMINATE,
     MAX_ITERS_TERMINATE,
-    SOLUTION_FOUND_TERMINATE
+    SOLUTION_FOUND_TERMINATE,
+    MEMORY_TERMINATE
 };
 
 #define MAX_FCC_DEPTH (RANK_KING * 4 * DECKS_NUM * 2)
@@ -70,7 +70,14 @@ extern "C"
 #include "dbm_solver.h"
 #include "dbm_cache.h"
 
+/*
+ * The offloaded queue holds pointers to the records of the store, which
+ * only stay in memory without caches. With caches, the queue holds copies
+ * of the records and is kept in memory.
+ * */
+#ifdef FCS_DBM_WITHOUT_CACHES
 #define FCS_DBM_USE_OFFLOADING_QUEUE
+#endif
 
 #include "offloading_queue.h"
 
@@ -0,0 +1,131 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * dbm_tree_bench.c - a benchmark of the lookups and insertions of
+ * encoded states in the trees that can back the DBM solvers: the B+tree
+ * of bp_tree.c , libavl's AVL tree and kaz_tree.c's red-black tree.
+ *
+ * Usage: dbm_tree_bench [num_keys]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alloc_wrap.h"
+#include "portable_time.h"
+#include "bp_tree.h"
+#include "avl.h"
+#include "kaz_tree.h"
+
+static int compare_keys(
+    const void * const a, const void * const b, void * const context
+)
+{
+    return memcmp(a, b, sizeof(fcs_encoded_state_buffer_t));
+}
+
+static GCC_INLINE double get_time(void)
+{
+    fcs_portable_time_t mytime;
+    FCS_GET_TIME(mytime);
+    return FCS_TIME_GET_SEC(mytime) + FCS_TIME_GET_USEC(mytime) * 1e-6;
+}
+
+/* Keys that look like encoded states: a length byte and random data. */
+static void fill_keys(
+    fcs_encoded_state_buffer_t * const keys, const long count,
+    unsigned long seed
+)
+{
+    memset(keys, '\0', sizeof(keys[0]) * count);
+    for (long i = 0 ; i < count ; i++)
+    {
+        for (int j = 1 ; j < (int)sizeof(keys[i]) ; j++)
+        {
+            seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+            keys[i].s[j] = (unsigned char)(seed >> 40);
+        }
+        keys[i].s[0] = sizeof(keys[i]) - 1;
+    }
+}
+
+#define BENCH(name, ops) \
+    { \
+        double start = get_time(); \
+        long found = 0; \
+        for (long i = 0 ; i < num_keys ; i++) \
+        { \
+            found += ((ops) != NULL); \
+        } \
+        printf("%-8s %-14s %8.3fs (%ld non-NULL)\n", tree_name, name, \
+            get_time() - start, found); \
+    }
+
+int main(int argc, char * argv[])
+{
+    const long num_keys = ((argc > 1) ? atol(argv[1]) : 1000000);
+    fcs_encoded_state_buffer_t * const keys = SMALLOC(keys, num_keys);
+    fcs_encoded_state_buffer_t * const missing = SMALLOC(missing, num_keys);
+    fcs_meta_compact_allocator_t meta_alloc;
+
+    fill_keys(keys, num_keys, 24);
+    fill_keys(missing, num_keys, 1941);
+    fc_solve_meta_compact_allocator_init(&meta_alloc);
+
+    {
+        const char * const tree_name = "bptree";
+        fcs_bp_tree_t * const tree = fc_solve_bp_tree_create(&meta_alloc);
+        BENCH("insert", fc_solve_bp_tree_insert(tree, &(keys[i])));
+        BENCH("lookup", fc_solve_bp_tree_lookup(tree, &(keys[i])));
+        BENCH("lookup-miss", fc_solve_bp_tree_lookup(tree, &(missing[i])));
+        fc_solve_bp_tree_destroy(tree);
+    }
+
+    {
+        const char * const tree_name = "libavl";
+        void * recycle_bin = NULL;
+        struct avl_table * const tree =
+            avl_create(compare_keys, NULL, &meta_alloc, &recycle_bin);
+        BENCH("insert", avl_insert(tree, &(keys[i])));
+        BENCH("lookup", avl_find(tree, &(keys[i])));
+        BENCH("lookup-miss", avl_find(tree, &(missing[i])));
+        avl_destroy(tree, NULL);
+    }
+
+    {
+        const char * const tree_name = "kaztree";
+        dict_t * const tree =
+            fc_solve_kaz_tree_create(compare_keys, NULL, &meta_alloc);
+        BENCH("insert", fc_solve_kaz_tree_alloc_insert(tree, &(keys[i])));
+        BENCH("lookup", fc_solve_kaz_tree_lookup_value(tree, &(keys[i])));
+        BENCH("lookup-miss", fc_solve_kaz_tree_lookup_value(tree, &(missing[i])));
+        fc_solve_kaz_tree_destroy(tree);
+    }
+
+    fc_solve_meta_compact_allocator_finish(&meta_alloc);
+    free(keys);
+    free(missing);
+
+    return 0;
+}
@@ -46,26 +46,31 @@
 #include "dbm_common.h"
 #endif
 
-static const int fc_solve_get_column_orig_num_cards(
-        fc_solve_delta_stater_t * const self,
+static GCC_INLINE const fcs_bool_t fc_solve_delta_stater_is_parent_card(
+        const fc_solve_delta_stater_t * const self,
+        const fcs_card_t child,
+        const fcs_card_t parent
+        )
+{
+    return
+        ((self->parent_cards_masks[(fcs_uchar_t)fcs_card2char(child)]
+          >> fcs_card2char(parent)) & 0x1);
+}
+
+static GCC_INLINE const int fc_solve_get_column_orig_num_cards(
+        const fc_solve_delta_stater_t * const self,
         const fcs_const_cards_column_t col
         )
 {
     int num_cards;
-#ifndef FCS_FREECELL_ONLY
-    int sequences_are_built_by;
-#endif
-
 
-#ifndef FCS_FREECELL_ONLY
-    sequences_are_built_by = self->sequences_are_built_by;
-#endif
     for (num_cards = fcs_col_len(col); num_cards >= 2; num_cards--)
     {
-        fcs_card_t child_card = fcs_col_get_card(col, num_cards-1);
-        fcs_card_t parent_card = fcs_col_get_card(col, num_cards-2);
-
-        if (!fcs_is_parent_card(child_card, parent_card))
+        if (! fc_solve_delta_stater_is_parent_card(
+            self,
+            fcs_col_get_card(col, num_cards-1),
+            fcs_col_get_card(col, num_cards-2)
+        ))
         {
             break;
         }
@@ -74,6 +79,28 @@ static const int fc_solve_get_column_orig_num_cards(
     return ((num_cards >= 2) ? num_cards : 0);
 }
 
+static void fc_solve_delta_stater__init_parent_cards_masks(
+        fc_solve_delta_stater_t * const self
+        )
+{
+#ifndef FCS_FREECELL_ONLY
+    const int sequences_are_built_by = self->sequences_are_built_by;
+#endif
+
+    for (int child = 0 ; child < FCS_DELTA_STATER_NUM_CARD_CHARS ; child++)
+    {
+        uint64_t mask = 0;
+        for (int parent = 0 ; parent < FCS_DELTA_STATER_NUM_CARD_CHARS ; parent++)
+        {
+            if (fcs_is_parent_card(fcs_char2card(child), fcs_char2card(parent)))
+            {
+                mask |= (((uint64_t)1) << parent);
+            }
+        }
+        self->parent_cards_masks[child] = mask;
+    }
+}
+
 static fc_solve_delta_stater_t * fc_solve_delta_stater_alloc(
         fcs_state_t * init_state,
         int num_columns,
@@ -97,6 +124,26 @@ static fc_solve_delta_stater_t * fc_solve_delta_stater_alloc(
 
     self->_init_state = init_state;
 
+    fc_solve_delta_stater__init_parent_cards_masks(self);
+
+    for (col_idx = 0 ; col_idx < num_columns; col_idx++)
+    {
+        fcs_const_cards_column_t col = fcs_state_get_col(*init_state, col_idx);
+        const int col_len = fcs_col_len(col);
+        fcs_uchar_t (* const min_ranks)[4] = self->orig_min_ranks[col_idx];
+
+        memset(min_ranks[0], 14, sizeof(min_ranks[0]));
+        for (int i = 0 ; i < col_len ; i++)
+        {
+            const fcs_card_t card = fcs_col_get_card(col, i);
+            memcpy(min_ranks[i+1], min_ranks[i], sizeof(min_ranks[i]));
+            if (fcs_card_rank(card) < min_ranks[i+1][fcs_card_suit(card)])
+            {
+                min_ranks[i+1][fcs_card_suit(card)] = fcs_card_rank(card);
+            }
+        }
+    }
+
     max_num_cards = 0;
     for (col_idx = 0 ; col_idx < num_columns; col_idx++)
     {
@@ -144,9 +191,9 @@ typedef struct
         COL_TYPE_ENTIRELY_NON_ORIG,
         COL_TYPE_HAS_ORIG
     } type;
-    fcs_uchar_t enc[4];
-    fcs_uchar_t * end;
-    int bit_in_char_idx;
+    /* The bits of the encoding of the column, starting from bit 0. */
+    fc_solve_bit_data_t enc;
+    int num_bits;
 } fc_solve_column_encoding_composite_t;
 
 static GCC_INLINE void fc_solve_get_column_encoding_composite(
@@ -171,15 +218,15 @@ static GCC_INLINE void fc_solve_get_column_encoding_composite(
         num_cards_in_seq--;
     }
 
-    /* Prepare the encoding. */
-    fc_solve_bit_writer_t bit_w;
-    fc_solve_bit_writer_init(&bit_w, ret->enc);
-
-    fc_solve_bit_writer_write(&bit_w,
-            self->bits_per_orig_cards_in_column, num_orig_cards
-            );
+    /*
+     * Build the whole encoding in one word, so it can be written with a
+     * single fc_solve_bit_writer_write() call.
+     * */
+    fc_solve_bit_data_t enc = num_orig_cards;
+    int num_bits = self->bits_per_orig_cards_in_column;
 
-    fc_solve_bit_writer_write(&bit_w, 4, num_derived_cards);
+    enc |= (((fc_solve_bit_data_t)num_derived_cards) << num_bits);
+    num_bits += 4;
 
 #ifdef DEBUG_STATES
     if (fc_solve_card_compare(init_card, fc_solve_empty_card))
@@ -187,22 +234,22 @@ static GCC_INLINE void fc_solve_get_column_encoding_composite(
     if (!(init_card == fc_solve_empty_card))
 #endif
     {
-        fc_solve_bit_writer_write(&bit_w, 6, fcs_card2char(init_card));
+        enc |= (((fc_solve_bit_data_t)fcs_card2char(init_card)) << num_bits);
+        num_bits += 6;
     }
 
     for (int i=col_len-num_cards_in_seq ; i<col_len; i++)
     {
 #define GET_SUIT_BIT(card) (( (fcs_card_suit(card)) & 0x2 ) >> 1 )
 
-        fc_solve_bit_writer_write(&bit_w,
-                1, GET_SUIT_BIT(fcs_col_get_card(col, i))
-        );
+        enc |= (((fc_solve_bit_data_t)GET_SUIT_BIT(fcs_col_get_card(col, i)))
+            << (num_bits++));
 
 #undef GET_SUIT_BIT
     }
 
-    ret->end = bit_w.current;
-    ret->bit_in_char_idx = bit_w.bit_in_char_idx;
+    ret->enc = enc;
+    ret->num_bits = num_bits;
 
     /* Calculate the type. */
     ret->type =
@@ -222,30 +269,27 @@ static GCC_INLINE void fc_solve_get_freecells_encoding(
     const fcs_state_t * const derived = self->_derived_state;
     const typeof(self->num_freecells) num_freecells = self->num_freecells;
 
-    fcs_card_t freecells[MAX_NUM_FREECELLS];
-    for (int i=0 ; i < num_freecells ; i++)
-    {
-        freecells[i] = fcs_freecell_card(*derived, i);
-    }
+    int freecells[MAX_NUM_FREECELLS];
 
-    /* Sort the freecells using selection-sort. */
+    /* Sort the freecells using insertion-sort. */
     for (int i=0 ; i < num_freecells ; i++)
     {
-        int min_idx = i;
-        for (int j=i+1 ; j < num_freecells ; j++)
+        const int card_char = fcs_card2char(fcs_freecell_card(*derived, i));
+        int j;
+        for (j = i ; (j > 0) && (freecells[j-1] > card_char) ; j--)
         {
-            if (fcs_card2char(freecells[j]) < fcs_card2char(freecells[min_idx]))
-            {
-                min_idx = j;
-            }
+            freecells[j] = freecells[j-1];
         }
-        fc_solve_bit_writer_write(bit_w, 6,
-            fcs_card2char(
-                (min_idx != i)
-                ? (freecells[min_idx] = freecells[i])
-                : freecells[i])
-        );
+        freecells[j] = card_char;
+    }
+
+    /* All the freecells take at most 6*8 bits, so write them at once. */
+    fc_solve_bit_data_t enc = 0;
+    for (int i=num_freecells-1 ; i >= 0 ; i--)
+    {
+        enc = ((enc << 6) | ((fc_solve_bit_data_t)freecells[i]));
     }
+    fc_solve_bit_writer_write(bit_w, 6 * num_freecells, enc);
 }
 
 static void fc_solve_delta_stater_encode_composite(
@@ -368,15 +412,10 @@ static void fc_solve_delta_stater_encode_composite(
     fc_solve_get_freecells_encoding(self, bit_w);
     for ( i=0 ; i < num_columns ; i++)
     {
-        fc_solve_column_encoding_composite_t * col_enc;
-        fcs_uchar_t * enc;
+        const fc_solve_column_encoding_composite_t * const col_enc =
+            (cols + cols_indexes[i]);
 
-        col_enc = (cols + cols_indexes[i]);
-        for (enc = col_enc->enc ; enc < col_enc->end ; enc++)
-        {
-            fc_solve_bit_writer_write(bit_w, NUM_BITS_IN_BYTES, (*enc));
-        }
-        fc_solve_bit_writer_write(bit_w, col_enc->bit_in_char_idx, (*enc));
+        fc_solve_bit_writer_write(bit_w, col_enc->num_bits, col_enc->enc);
     }
 }
 
@@ -395,9 +434,13 @@ static void fc_solve_delta_stater_decode(
     int foundations[4] = {14,14,14,14};
     /* Read the Freecells. */
 
+    fc_solve_bit_data_t freecells =
+        fc_solve_bit_reader_read(bit_r, 6 * num_freecells);
+
     for ( int i=0 ; i < num_freecells ; i++)
     {
-        const fcs_card_t card = fcs_char2card(fc_solve_bit_reader_read(bit_r, 6));
+        const fcs_card_t card = fcs_char2card(freecells & 0x3F);
+        freecells >>= 6;
 #ifdef DEBUG_STATES
         if (fc_solve_card_compare(card, fc_solve_empty_card))
 #else
@@ -419,11 +462,22 @@ static void fc_solve_delta_stater_decode(
 
         fcs_const_cards_column_t orig_col = fcs_state_get_col(*_init_state, col_idx);
 
+        {
+            const fcs_uchar_t * const min_ranks =
+                self->orig_min_ranks[col_idx][num_orig_cards];
+
+            for (int i = 0 ; i < 4 ; i++)
+            {
+                if (min_ranks[i] < foundations[i])
+                {
+                    foundations[i] = min_ranks[i];
+                }
+            }
+        }
+
         for (int i = 0 ; i < num_orig_cards ; i++)
         {
-            const fcs_card_t card = fcs_col_get_card(orig_col, i);
-            PROCESS_CARD(card);
-            fcs_col_push_card(col, card);
+            fcs_col_push_card(col, fcs_col_get_card(orig_col, i));
         }
 
         const int num_derived_cards =
@@ -442,10 +496,14 @@ static void fc_solve_delta_stater_decode(
         if (num_cards_in_seq)
         {
             fcs_card_t last_card = fcs_col_get_card(col, fcs_col_len(col)-1);
+            /* The suit bits of the whole sequence are read at once. */
+            fc_solve_bit_data_t suit_bits =
+                fc_solve_bit_reader_read(bit_r, num_cards_in_seq);
 
             for ( int i = 0 ; i < num_cards_in_seq ; i++)
             {
-                const int suit_bit = fc_solve_bit_reader_read(bit_r, 1);
+                const int suit_bit = (int)(suit_bits & 0x1);
+                suit_bits >>= 1;
                 const fcs_card_t new_card = fcs_make_card(
                     fcs_card_rank(last_card)-1,
                     ((suit_bit << 1) |
@@ -494,9 +552,9 @@ static GCC_INLINE void fc_solve_delta_stater_decode_into_state_proto(
 }
 
 #ifdef INDIRECT_STACK_STATES
-#define fc_solve_delta_stater_decode_into_state(delta_stater, enc_state, state_ptr, indirect_stacks_buffer) fc_solve_delta_stater_decode_into_state_proto(delta_stater, enc_state, state_ptr, indirect_stacks_buffer)
+#define fc_solve_delta_stater_decode_into_state(delta_stater, enc_state, state_ptr, indirect_stacks_buffer) fc_solve_delta_stater_decode_into_state_proto(local_variant, delta_stater, enc_state, state_ptr, indirect_stacks_buffer)
 #else
-#define fc_solve_delta_stater_decode_into_state(delta_stater, enc_state, state_ptr, indirect_stacks_buffer) fc_solve_delta_stater_decode_into_state_proto(delta_stater, enc_state, state_ptr)
+#define fc_solve_delta_stater_decode_into_state(delta_stater, enc_state, state_ptr, indirect_stacks_buffer) fc_solve_delta_stater_decode_into_state_proto(local_variant, delta_stater, enc_state, state_ptr)
 #endif
 
 static GCC_INLINE void fc_solve_delta_stater_encode_into_buffer(
@@ -515,9 +573,10 @@ static GCC_INLINE void fc_solve_delta_stater_encode_into_buffer(
 }
 
 static GCC_INLINE void fcs_init_and_encode_state(
-    fc_solve_delta_stater_t * delta_stater,
-    fcs_state_keyval_pair_t * state,
-    fcs_encoded_state_buffer_t * enc_state
+    fc_solve_delta_stater_t * const delta_stater,
+    const enum fcs_dbm_variant_type_t local_variant,
+    fcs_state_keyval_pair_t * const state,
+    fcs_encoded_state_buffer_t * const enc_state
 )
 {
     fcs_init_encoded_state(enc_state);
@@ -163,6 +163,9 @@ typedef struct
 
 #endif
 
+/* The cards fit in 6 bits. */
+#define FCS_DELTA_STATER_NUM_CARD_CHARS 64
+
 typedef struct
 {
 #ifndef FCS_FREECELL_ONLY
@@ -172,6 +175,19 @@ typedef struct
     int num_columns;
     fcs_state_t * _init_state, * _derived_state;
     int bits_per_orig_cards_in_column;
+    /*
+     * Lookup tables that are filled by fc_solve_delta_stater_alloc() :
+     *
+     * Bit p of parent_cards_masks[c] is set if the card whose char is p
+     * is a parent of the card whose char is c.
+     * */
+    uint64_t parent_cards_masks[FCS_DELTA_STATER_NUM_CARD_CHARS];
+    /*
+     * The lowest rank of each suit among the first n cards of each column
+     * of the initial state, which is what the decoder needs to recover
+     * the foundations.
+     * */
+    unsigned char orig_min_ranks[MAX_NUM_STACKS][MAX_NUM_CARDS_IN_A_STACK+1][4];
 } fc_solve_delta_stater_t;
 
 static GCC_INLINE void fcs_init_encoded_state(fcs_encoded_state_buffer_t * enc_state)
@@ -52,6 +52,30 @@ extern "C" {
 #define fc_solve_delta_stater_free(a) fc_solve_debondt_delta_stater_free(a)
 #endif
 
+#include "dbm_calc_derived.h"
+
+/*
+ * Encodes the keys of all the states in a list of derived states, which
+ * is what the DBM solvers do after calculating the derived states of a
+ * position.
+ * */
+static GCC_INLINE void fcs_init_and_encode_derived_states(
+    fc_solve_delta_stater_t * const delta_stater,
+    const enum fcs_dbm_variant_type_t local_variant,
+    fcs_derived_state_t * derived_list
+)
+{
+    for ( ; derived_list ; derived_list = derived_list->next)
+    {
+        fcs_init_and_encode_state(
+            delta_stater,
+            local_variant,
+            &(derived_list->state),
+            &(derived_list->key)
+        );
+    }
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -32,7 +32,16 @@
  *
  */
 
+/* The mark-and-sweep of the old depths walks the records of the store,
+ * which are only kept in memory without caches. */
+#ifndef FCS_DBM_WITHOUT_CACHES
+#error depth_dbm_solver.c requires the kaztree store (FCS_DBM_WITHOUT_CACHES).
+#endif
+
 #include "dbm_solver_head.h"
+#include "dbm_ddd.h"
+#include "dbm_metrics.h"
+#include "dbm_checkpoint.h"
 
 typedef struct
 {
@@ -74,6 +83,10 @@ typedef struct
     FILE * out_fh;
     fcs_encoded_state_buffer_t first_key;
     enum fcs_dbm_variant_type_t variant;
+    /* For the delayed duplicate detection mode. */
+    fcs_bool_t use_ddd;
+    fcs_encoded_state_buffer_t ddd_solution;
+    fcs_dbm_metrics_t metrics;
 } fcs_dbm_solver_instance_t;
 
 static GCC_INLINE void instance_init(
@@ -91,6 +104,7 @@ static GCC_INLINE void instance_init(
     fcs_dbm_collection_by_depth_t * coll;
 
     instance->variant = local_variant;
+    instance->use_ddd = FALSE;
     instance->curr_depth = 0;
     FCS_INIT_LOCK(instance->global_lock);
     instance->offload_dir_path = offload_dir_path;
@@ -113,6 +127,7 @@ static GCC_INLINE void instance_init(
     }
     instance->count_of_items_in_queue = 0;
     instance->tree_recycle_bin = NULL;
+    fcs_dbm_metrics__init(&(instance->metrics));
 
     FCS_INIT_LOCK(instance->storage_lock);
     for (depth = 0 ; depth < MAX_FCC_DEPTH ; depth++)
@@ -176,6 +191,7 @@ static GCC_INLINE void instance_destroy(
     int depth;
     fcs_dbm_collection_by_depth_t * coll;
 
+    fcs_dbm_metrics__destroy(&(instance->metrics));
     for (depth = 0 ; depth < MAX_FCC_DEPTH ; depth++)
     {
         coll = &(instance->colls_by_depth[depth]);
@@ -301,8 +317,49 @@ struct fcs_dbm_solver_thread_struct
     fcs_dbm_solver_instance_t * instance;
     fc_solve_delta_stater_t * delta_stater;
     fcs_meta_compact_allocator_t thread_meta_alloc;
+    fcs_dbm_metrics_slot_t * metrics_slot;
 };
 
+/*
+ * The depth counts are the number of states that were queued for every
+ * depth so far. Should be called with the queue lock held.
+ * */
+static void instance_export_metrics(
+    fcs_dbm_solver_instance_t * const instance
+)
+{
+    fcs_dbm_metrics_sample_t sample;
+    long depth_counts[MAX_FCC_DEPTH];
+
+    if (! instance->metrics.fh)
+    {
+        return;
+    }
+
+    sample.num_processed = instance->count_num_processed;
+    sample.num_states_in_collection = instance->num_states_in_collection;
+    sample.num_items_in_queue = sample.num_items_in_memory = 0;
+    sample.num_depths = 0;
+    for (int depth = 0 ; depth < MAX_FCC_DEPTH ; depth++)
+    {
+        const fcs_offloading_queue_t * const queue =
+            &(instance->colls_by_depth[depth].queue);
+        sample.num_items_in_queue += queue->num_items_in_queue;
+        sample.num_items_in_memory +=
+            fcs_offloading_queue__count_items_in_memory(queue);
+        if ((depth_counts[depth] = queue->num_inserted))
+        {
+            sample.num_depths = depth + 1;
+        }
+    }
+    sample.num_cache_hits = sample.num_cache_misses = -1;
+    sample.depth = ((instance->curr_depth < MAX_FCC_DEPTH)
+        ? instance->curr_depth : -1);
+    sample.depth_counts = depth_counts;
+
+    fcs_dbm_metrics__export(&(instance->metrics), &sample);
+}
+
 typedef struct {
     fcs_dbm_solver_thread_t * thread;
 } thread_arg_t;
@@ -358,7 +415,8 @@ static void * instance_run_solver_thread(void * void_arg)
     while (1)
     {
         /* First of all extract an item. */
-        FCS_LOCK(coll->queue_lock);
+        FCS_DBM_METRICS_LOCK(&(instance->metrics), thread->metrics_slot,
+            coll->queue_lock);
 
         if (prev_item)
         {
@@ -375,10 +433,16 @@ static void * instance_run_solver_thread(void * void_arg)
                 item = &physical_item;
                 instance->count_of_items_in_queue--;
                 instance->queue_num_extracted_and_processed++;
+                fcs_dbm_metrics__add_processed(thread->metrics_slot, 1);
                 if (++instance->count_num_processed % 100000 == 0)
                 {
                     instance_print_stats(instance, out_fh);
                 }
+                if (fcs_dbm_metrics__is_due(&(instance->metrics),
+                    instance->count_num_processed))
+                {
+                    instance_export_metrics(instance);
+                }
                 if (instance->count_num_processed >=
                     instance->max_count_num_processed)
                 {
@@ -462,18 +526,11 @@ static void * instance_run_solver_thread(void * void_arg)
         }
 
         /* Encode all the states. */
-        for (derived_iter = derived_list;
-                derived_iter ;
-                derived_iter = derived_iter->next
-        )
-        {
-            fcs_init_and_encode_state(
-                delta_stater,
-                local_variant,
-                &(derived_iter->state),
-                &(derived_iter->key)
-            );
-        }
+        fcs_init_and_encode_derived_states(
+            delta_stater,
+            local_variant,
+            derived_list
+        );
 
         instance_check_multiple_keys(thread, instance, derived_list
 #ifdef FCS_DBM_CACHE_ONLY
@@ -532,6 +589,7 @@ static void instance_run_all_threads(
 #endif
 
     threads = SMALLOC(threads, num_threads);
+    fcs_dbm_metrics__alloc_slots(&(instance->metrics), num_threads);
 
     TRACE0("instance_run_all_threads start");
 
@@ -562,6 +620,7 @@ static void instance_run_all_threads(
         fc_solve_meta_compact_allocator_init(
             &(threads[i].thread.thread_meta_alloc)
         );
+        threads[i].thread.metrics_slot = &(instance->metrics.slots[i]);
         threads[i].arg.thread = &(threads[i].thread);
     }
 
@@ -600,6 +659,45 @@ static void instance_run_all_threads(
          * the old states, some of which are no longer of interest.
          * */
         {
+#ifdef FCS_DBM_USE_BPTREE
+            dict_t * const kaz_tree = fc_solve_dbm_store_get_dict(
+                instance->colls_by_depth[instance->curr_depth].store
+            );
+            fcs_bp_tree_iter_t iter;
+            const size_t items_count = kaz_tree->count;
+            size_t idx = 0;
+
+            TRACE1("Start mark-and-sweep cleanup for curr_depth=%d\n", instance->curr_depth);
+            for (
+                fcs_dbm_record_t * item = fc_solve_bp_tree_iter_first(kaz_tree, &iter)
+                ;
+                item
+                ;
+                item = fc_solve_bp_tree_iter_next(&iter)
+            )
+            {
+                fcs_dbm_record_t * ancestor = item;
+                while (fcs_dbm_record_get_refcount(ancestor) == 0)
+                {
+                    fcs_dbm_record_t * const parent =
+                        fcs_dbm_record_get_parent_ptr(ancestor);
+
+                    fcs_dbm_record_recycle(ancestor, &(instance->tree_recycle_bin));
+
+                    if (!(ancestor = parent))
+                    {
+                        break;
+                    }
+                    fcs_dbm_record_decrement_refcount(ancestor);
+                }
+                if (((++idx) % 100000) == 0)
+                {
+                    fprintf(out_fh, "Mark+Sweep Progress - %ld/%ld\n",
+                        ((long)idx), ((long)items_count));
+                }
+            }
+            TRACE1("Finish mark-and-sweep cleanup for curr_depth=%d\n", instance->curr_depth);
+#else
             dict_t * kaz_tree;
             struct avl_traverser trav;
             dict_key_t item;
@@ -652,6 +750,7 @@ static void instance_run_all_threads(
                 }
             }
             TRACE1("Finish mark-and-sweep cleanup for curr_depth=%d\n", instance->curr_depth);
+#endif
         }
         instance->curr_depth++;
     }
@@ -674,6 +773,389 @@ static void instance_run_all_threads(
     return;
 }
 
+
+/*
+ * The delayed duplicate detection (DDD) mode: instead of looking up every
+ * derived state in the in-memory store, every BFS layer of the current
+ * depth is collected in per-thread unsorted files, which are then sorted,
+ * deduplicated and subtracted from the already visited states of that
+ * depth using dbm_ddd.h. Only the records of the current layer are being
+ * read at any time, so the RAM usage is bound by --ddd-run-size.
+ * */
+
+#define DDD_PATH(buf, kind, depth, idx) \
+    snprintf((buf), sizeof(buf), "%s/ddd.%s.%d.%d", \
+        instance->offload_dir_path, (kind), (depth), (idx))
+
+typedef struct {
+    fcs_dbm_solver_instance_t * instance;
+    fc_solve_delta_stater_t * delta_stater;
+    fcs_meta_compact_allocator_t thread_meta_alloc;
+    int thread_idx;
+    off_t start, count;
+    pthread_t id;
+    fcs_dbm_metrics_slot_t * metrics_slot;
+} ddd_thread_t;
+
+static void * instance_run_ddd_thread(void * void_arg)
+{
+    ddd_thread_t * const thread = (ddd_thread_t *)void_arg;
+    fcs_dbm_solver_instance_t * const instance = thread->instance;
+    const enum fcs_dbm_variant_type_t local_variant = instance->variant;
+    const int curr_depth = instance->curr_depth;
+    FILE * const out_fh = instance->out_fh;
+    fcs_derived_state_t * derived_list = NULL, * derived_list_recycle_bin = NULL,
+                        * derived_iter;
+    fcs_compact_allocator_t derived_list_allocator;
+    fcs_state_keyval_pair_t state;
+    fcs_ddd_reader_t reader;
+    const fcs_ddd_record_t * rec;
+    fcs_ddd_record_t new_rec;
+    char path[FCS_DDD_PATH_MAX];
+    FILE * * const out_fhs = SMALLOC(out_fhs, MAX_FCC_DEPTH);
+    DECLARE_IND_BUF_T(indirect_stacks_buffer)
+
+    memset(out_fhs, '\0', sizeof(out_fhs[0]) * MAX_FCC_DEPTH);
+    fc_solve_compact_allocator_init(&(derived_list_allocator), &(thread->thread_meta_alloc));
+
+    DDD_PATH(path, "frontier", curr_depth, 0);
+    fcs_ddd_reader__init(&reader, path, thread->start, thread->count);
+
+    while ((rec = fcs_ddd_reader__next(&reader)))
+    {
+        FCS_DBM_METRICS_LOCK(&(instance->metrics), thread->metrics_slot,
+            instance->global_lock);
+        if (instance->should_terminate != DONT_TERMINATE)
+        {
+            FCS_UNLOCK(instance->global_lock);
+            break;
+        }
+        fcs_dbm_metrics__add_processed(thread->metrics_slot, 1);
+        if (++instance->count_num_processed % 100000 == 0)
+        {
+            instance_print_stats(instance, out_fh);
+        }
+        if (fcs_dbm_metrics__is_due(&(instance->metrics),
+            instance->count_num_processed))
+        {
+            instance_export_metrics(instance);
+        }
+        if (instance->count_num_processed >= instance->max_count_num_processed)
+        {
+            instance->should_terminate = MAX_ITERS_TERMINATE;
+        }
+        FCS_UNLOCK(instance->global_lock);
+
+        fc_solve_delta_stater_decode_into_state(
+            thread->delta_stater,
+            rec->key.s,
+            &state,
+            indirect_stacks_buffer
+        );
+
+        if (instance_solver_thread_calc_derived_states(
+            local_variant,
+            &state,
+            NULL,
+            &derived_list,
+            &derived_list_recycle_bin,
+            &derived_list_allocator,
+            TRUE
+        ))
+        {
+            FCS_LOCK(instance->global_lock);
+            instance->should_terminate = SOLUTION_FOUND_TERMINATE;
+            instance->queue_solution_was_found = TRUE;
+            instance->ddd_solution = rec->key;
+            FCS_UNLOCK(instance->global_lock);
+            break;
+        }
+
+        new_rec.parent = rec->key;
+        for (derived_iter = derived_list;
+                derived_iter ;
+                derived_iter = derived_iter->next
+        )
+        {
+            const int depth = curr_depth +
+                derived_iter->num_non_reversible_moves_including_prune;
+
+            if (depth >= MAX_FCC_DEPTH)
+            {
+                continue;
+            }
+            fcs_init_and_encode_state(
+                thread->delta_stater,
+                local_variant,
+                &(derived_iter->state),
+                &(new_rec.key)
+            );
+            if (! out_fhs[depth])
+            {
+                DDD_PATH(path, ((depth == curr_depth) ? "next" : "incoming"),
+                    depth, thread->thread_idx);
+                out_fhs[depth] = fcs_ddd__open(path, "ab");
+            }
+            fcs_ddd__write(out_fhs[depth], &new_rec, 1);
+        }
+
+        /* Now recycle the derived_list */
+        while (derived_list)
+        {
+#define derived_list_next derived_iter
+            derived_list_next = derived_list->next;
+            derived_list->next = derived_list_recycle_bin;
+            derived_list_recycle_bin = derived_list;
+            derived_list = derived_list_next;
+#undef derived_list_next
+        }
+    }
+
+    for (int depth = 0 ; depth < MAX_FCC_DEPTH ; depth++)
+    {
+        if (out_fhs[depth])
+        {
+            fclose(out_fhs[depth]);
+        }
+    }
+    free(out_fhs);
+    fcs_ddd_reader__destroy(&reader);
+    fc_solve_compact_allocator_finish(&(derived_list_allocator));
+
+    return NULL;
+}
+
+/*
+ * Sorts and deduplicates the per-thread files of kind at depth into
+ * the "sorted" file of that depth, and deletes them.
+ * */
+static void instance_ddd_sort_thread_files(
+    fcs_dbm_solver_instance_t * instance,
+    const char * kind,
+    int num_threads,
+    size_t run_size
+)
+{
+    const int depth = instance->curr_depth;
+    char * * const in_paths = SMALLOC(in_paths, num_threads);
+    char out_path[FCS_DDD_PATH_MAX], tmp_prefix[FCS_DDD_PATH_MAX];
+
+    for (int i = 0 ; i < num_threads ; i++)
+    {
+        char path[FCS_DDD_PATH_MAX];
+        DDD_PATH(path, kind, depth, i);
+        in_paths[i] = strdup(path);
+    }
+    DDD_PATH(out_path, "sorted", depth, 0);
+    DDD_PATH(tmp_prefix, "tmp", depth, 0);
+
+    fcs_ddd__sort_unique(in_paths, num_threads, out_path, tmp_prefix,
+        run_size, num_threads);
+
+    for (int i = 0 ; i < num_threads ; i++)
+    {
+        unlink(in_paths[i]);
+        free(in_paths[i]);
+    }
+    free(in_paths);
+}
+
+static void instance_run_ddd(
+    fcs_dbm_solver_instance_t * instance,
+    fcs_state_keyval_pair_t * init_state,
+    int num_threads,
+    size_t run_size
+)
+{
+    FILE * out_fh = instance->out_fh;
+    ddd_thread_t * const threads = SMALLOC(threads, num_threads);
+    char path[FCS_DDD_PATH_MAX], visited_path[FCS_DDD_PATH_MAX],
+         frontier_path[FCS_DDD_PATH_MAX], new_visited_path[FCS_DDD_PATH_MAX];
+
+#ifndef FCS_FREECELL_ONLY
+    const enum fcs_dbm_variant_type_t local_variant = instance->variant;
+#endif
+
+    TRACE0("instance_run_ddd start");
+    fcs_dbm_metrics__alloc_slots(&(instance->metrics), num_threads);
+    for (int i = 0 ; i < num_threads ; i++)
+    {
+        threads[i].instance = instance;
+        threads[i].thread_idx = i;
+        threads[i].metrics_slot = &(instance->metrics.slots[i]);
+        threads[i].delta_stater =
+            fc_solve_delta_stater_alloc(
+                &(init_state->s),
+                STACKS_NUM,
+                FREECELLS_NUM
+#ifndef FCS_FREECELL_ONLY
+                , ((local_variant == FCS_DBM_VARIANT_BAKERS_DOZEN)
+                   ? FCS_SEQ_BUILT_BY_RANK
+                   : FCS_SEQ_BUILT_BY_ALTERNATE_COLOR)
+#endif
+            );
+        fc_solve_meta_compact_allocator_init(
+            &(threads[i].thread_meta_alloc)
+        );
+    }
+
+    {
+        fcs_ddd_record_t first;
+        first.key = instance->first_key;
+        fcs_init_encoded_state(&(first.parent));
+        DDD_PATH(path, "incoming", 0, 0);
+        FILE * const f = fcs_ddd__open(path, "wb");
+        fcs_ddd__write(f, &first, 1);
+        fclose(f);
+    }
+
+    for ( ; instance->curr_depth < MAX_FCC_DEPTH ; instance->curr_depth++)
+    {
+        const int depth = instance->curr_depth;
+        int layer = 0;
+
+        DDD_PATH(visited_path, "visited", depth, 0);
+        DDD_PATH(new_visited_path, "visited.new", depth, 0);
+        DDD_PATH(frontier_path, "frontier", depth, 0);
+
+        instance_ddd_sort_thread_files(instance, "incoming", num_threads, run_size);
+        while (1)
+        {
+            DDD_PATH(path, "sorted", depth, 0);
+            const off_t frontier_count = fcs_ddd__subtract_and_merge(
+                path, visited_path, frontier_path, new_visited_path
+            );
+            unlink(path);
+            rename(new_visited_path, visited_path);
+
+            if (! frontier_count)
+            {
+                unlink(frontier_path);
+                break;
+            }
+            instance->num_states_in_collection += (long)frontier_count;
+            fprintf(out_fh, "DDD depth=%d layer=%d frontier=%ld\n",
+                depth, layer++, (long)frontier_count);
+            fflush(out_fh);
+
+            const off_t slice = (frontier_count + num_threads - 1) / num_threads;
+            for (int i = 0 ; i < num_threads ; i++)
+            {
+                threads[i].start = slice * i;
+                threads[i].count = ((threads[i].start < frontier_count)
+                    ? ((frontier_count - threads[i].start < slice)
+                        ? (frontier_count - threads[i].start) : slice)
+                    : 0
+                );
+                if (pthread_create(&(threads[i].id), NULL,
+                    instance_run_ddd_thread, &(threads[i])))
+                {
+                    fprintf(stderr,
+                            "Worker Thread No. %d Initialization failed!\n",
+                            i
+                           );
+                    exit(-1);
+                }
+            }
+            for (int i = 0 ; i < num_threads ; i++)
+            {
+                pthread_join(threads[i].id, NULL);
+            }
+            unlink(frontier_path);
+
+            if (instance->should_terminate != DONT_TERMINATE)
+            {
+                break;
+            }
+            instance_ddd_sort_thread_files(instance, "next", num_threads, run_size);
+        }
+        if (instance->should_terminate != DONT_TERMINATE)
+        {
+            break;
+        }
+    }
+
+    for (int i = 0 ; i < num_threads ; i++)
+    {
+        fc_solve_delta_stater_free(threads[i].delta_stater);
+        fc_solve_meta_compact_allocator_finish(
+            &(threads[i].thread_meta_alloc)
+        );
+    }
+    free(threads);
+
+    TRACE0("instance_run_ddd end");
+}
+
+/* Looks the parents up in the "visited" files. */
+static void instance_ddd_calc_trace(
+    fcs_dbm_solver_instance_t * const instance,
+    fcs_encoded_state_buffer_t * * const ptr_trace,
+    int * const ptr_trace_num
+)
+{
+#define GROW_BY 100
+    int trace_num = 0;
+    int trace_max_num = GROW_BY;
+    fcs_encoded_state_buffer_t * trace = SMALLOC(trace, trace_max_num);
+    fcs_encoded_state_buffer_t key = instance->ddd_solution;
+    int depth = instance->curr_depth;
+    char path[FCS_DDD_PATH_MAX];
+    fcs_ddd_record_t rec;
+
+    while (1)
+    {
+        trace[trace_num] = key;
+        if ((++trace_num) == trace_max_num)
+        {
+            trace = SREALLOC(trace, trace_max_num += GROW_BY);
+        }
+        if (! fcs_ddd__compare_keys(&key, &(instance->first_key)))
+        {
+            break;
+        }
+        /* The parent of a state is never deeper than it. */
+        for ( ; depth >= 0 ; depth--)
+        {
+            DDD_PATH(path, "visited", depth, 0);
+            if (fcs_ddd__lookup(path, &key, &rec))
+            {
+                break;
+            }
+        }
+        if (depth < 0)
+        {
+            fprintf(stderr, "%s\n", "Failed to find a state in the DDD files. Terminating.");
+            exit(-1);
+        }
+        key = rec.parent;
+    }
+#undef GROW_BY
+    *ptr_trace_num = trace_num;
+    *ptr_trace = trace;
+}
+
+static void instance_ddd_cleanup(
+    fcs_dbm_solver_instance_t * const instance,
+    const int num_threads
+)
+{
+    char path[FCS_DDD_PATH_MAX];
+
+    for (int depth = 0 ; depth < MAX_FCC_DEPTH ; depth++)
+    {
+        DDD_PATH(path, "visited", depth, 0);
+        unlink(path);
+        for (int i = 0 ; i < num_threads ; i++)
+        {
+            DDD_PATH(path, "incoming", depth, i);
+            unlink(path);
+            DDD_PATH(path, "next", depth, i);
+            unlink(path);
+        }
+    }
+}
+
 #ifdef FCS_DEBONDT_DELTA_STATES
 
 static int compare_enc_states(
@@ -800,7 +1282,14 @@ static void trace_solution(
     fflush (out_fh);
     /* Now trace the solution */
 
-    calc_trace(instance, instance->queue_solution_ptr, &trace, &trace_num);
+    if (instance->use_ddd)
+    {
+        instance_ddd_calc_trace(instance, &trace, &trace_num);
+    }
+    else
+    {
+        calc_trace(instance, instance->queue_solution_ptr, &trace, &trace_num);
+    }
 
     fc_solve_init_locs(&locs);
 
@@ -858,6 +1347,7 @@ static fcs_bool_t handle_and_destroy_instance_solution(
 
     TRACE0("handle_and_destroy_instance_solution start");
     instance_print_stats(instance, out_fh);
+    instance_export_metrics(instance);
 
     if (instance->queue_solution_was_found)
     {
@@ -890,6 +1380,8 @@ int main(int argc, char * argv[])
     long pre_cache_max_count;
     long caches_delta;
     long iters_delta_limit = -1;
+    fcs_bool_t use_ddd = FALSE;
+    long ddd_run_size = 4000000;
 #if 0
     long start_line = 1;
 #endif
@@ -903,6 +1395,8 @@ int main(int argc, char * argv[])
     fc_solve_delta_stater_t * delta;
     fcs_dbm_record_t * token;
     enum fcs_dbm_variant_type_t local_variant;
+    const char * metrics_path = NULL;
+    double metrics_interval = FCS_DBM_METRICS_DEFAULT_INTERVAL;
 
     fcs_state_keyval_pair_t init_state;
 #if 0
@@ -1006,6 +1500,25 @@ int main(int argc, char * argv[])
             }
             iters_delta_limit = atol(argv[arg]);
         }
+        else if (!strcmp(argv[arg], "--ddd"))
+        {
+            use_ddd = TRUE;
+        }
+        else if (!strcmp(argv[arg], "--ddd-run-size"))
+        {
+            arg++;
+            if (arg == argc)
+            {
+                fprintf(stderr, "--ddd-run-size came without an argument.\n");
+                exit(-1);
+            }
+            ddd_run_size = atol(argv[arg]);
+            if (ddd_run_size < 1000)
+            {
+                fprintf(stderr, "--ddd-run-size must be at least 1,000.\n");
+                exit(-1);
+            }
+        }
         else if (!strcmp(argv[arg], "-o"))
         {
             arg++;
@@ -1016,6 +1529,31 @@ int main(int argc, char * argv[])
             }
             out_filename = argv[arg];
         }
+        else if (!strcmp(argv[arg], "--metrics-output"))
+        {
+            arg++;
+            if (arg == argc)
+            {
+                fprintf(stderr, "--metrics-output came without an argument.\n");
+                exit(-1);
+            }
+            metrics_path = argv[arg];
+        }
+        else if (!strcmp(argv[arg], "--metrics-interval"))
+        {
+            arg++;
+            if (arg == argc)
+            {
+                fprintf(stderr, "--metrics-interval came without an argument.\n");
+                exit(-1);
+            }
+            metrics_interval = atof(argv[arg]);
+            if (metrics_interval <= 0)
+            {
+                fprintf(stderr, "--metrics-interval must be positive.\n");
+                exit(-1);
+            }
+        }
         else if (!strcmp(argv[arg], "--offload-dir-path"))
         {
             arg++;
@@ -1028,6 +1566,7 @@ int main(int argc, char * argv[])
         }
         else
         {
+            fcs_dbm_checkpoint__reject_option(argv[arg], "depth_dbm_fc_solver");
             break;
         }
     }
@@ -1043,6 +1582,12 @@ int main(int argc, char * argv[])
         exit(-1);
     }
 
+    if (use_ddd && (! offload_dir_path))
+    {
+        fprintf (stderr, "%s\n", "--ddd requires --offload-dir-path.");
+        exit(-1);
+    }
+
     if (out_filename)
     {
         out_fh = fopen(out_filename, "at");
@@ -1105,31 +1650,47 @@ int main(int argc, char * argv[])
         instance_init(&instance, local_variant, pre_cache_max_count, caches_delta,
                       dbm_store_path, iters_delta_limit, offload_dir_path,
                       out_fh);
+        if (metrics_path)
+        {
+            fcs_dbm_metrics__open(&(instance.metrics), metrics_path,
+                metrics_interval);
+        }
 
         key_ptr = &(instance.first_key);
         fcs_init_and_encode_state(delta, local_variant, &(init_state), KEY_PTR());
 
-        /* The NULL parent_state_enc and move for indicating this is the
-         * initial state. */
-        fcs_init_encoded_state(&(parent_state_enc));
+        if (use_ddd)
+        {
+            instance.use_ddd = TRUE;
+            instance_run_ddd(&instance, &init_state, num_threads,
+                (size_t)ddd_run_size);
+            handle_and_destroy_instance_solution(&instance, out_fh, delta);
+            instance_ddd_cleanup(&instance, num_threads);
+        }
+        else
+        {
+            /* The NULL parent_state_enc and move for indicating this is the
+             * initial state. */
+            fcs_init_encoded_state(&(parent_state_enc));
 
 #ifndef FCS_DBM_WITHOUT_CACHES
 #ifndef FCS_DBM_CACHE_ONLY
-        pre_cache_insert(&(instance.pre_cache), KEY_PTR(), &parent_state_enc);
+            pre_cache_insert(&(instance.pre_cache), KEY_PTR(), &parent_state_enc);
 #else
-        cache_insert(&(instance.cache), KEY_PTR(), NULL, '\0');
+            cache_insert(&(instance.cache), KEY_PTR(), NULL, '\0');
 #endif
 #else
-        token = fc_solve_dbm_store_insert_key_value(instance.colls_by_depth[0].store, KEY_PTR(), NULL, TRUE);
+            token = fc_solve_dbm_store_insert_key_value(instance.colls_by_depth[0].store, KEY_PTR(), NULL, TRUE);
 #endif
 
-        fcs_offloading_queue__insert(&(instance.colls_by_depth[0].queue),
-            (const fcs_offloading_queue_item_t *)(&token));
-        instance.num_states_in_collection++;
-        instance.count_of_items_in_queue++;
+            fcs_offloading_queue__insert(&(instance.colls_by_depth[0].queue),
+                (const fcs_offloading_queue_item_t *)(&token));
+            instance.num_states_in_collection++;
+            instance.count_of_items_in_queue++;
 
-        instance_run_all_threads(&instance, &init_state, NUM_THREADS());
-        handle_and_destroy_instance_solution(&instance, out_fh, delta);
+            instance_run_all_threads(&instance, &init_state, NUM_THREADS());
+            handle_and_destroy_instance_solution(&instance, out_fh, delta);
+        }
     }
 
     fc_solve_delta_stater_free(delta);
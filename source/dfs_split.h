@@ -0,0 +1,178 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * dfs_split.h - the subtrees' claims table that lets several Soft-DFS
+ * workers, each with its own instance, split the search of one deal.
+ *
+ * All the workers traverse the states above the split depth, and the
+ * states at the split depth are claimed by the first worker that reaches
+ * them, which then explores their entire sub-tree, while the rest of the
+ * workers skip them and proceed to the next sibling. A worker that is done
+ * with its subtree thus picks up the next unclaimed one at the shallowest
+ * split frame.
+ *
+ * The claims are keyed by a hash of the contents of the state (and not its
+ * pointers or the order in which it was reached), so they agree between
+ * instances that use different collections and shuffle their tests
+ * differently. The table is lock-free and of a fixed size - once it is
+ * full, new subtrees are explored by everyone, which is wasteful but not
+ * incorrect.
+ */
+#ifndef FC_SOLVE__DFS_SPLIT_H
+#define FC_SOLVE__DFS_SPLIT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdlib.h>
+
+#include "inline.h"
+#include "bool.h"
+#include "state.h"
+#include "transposition_table.h"
+
+typedef unsigned long long fcs_dfs_split_key_t;
+
+typedef struct
+{
+    /* The depth of the claimed states. 1 means the children of the
+     * initial state. */
+    int depth;
+    unsigned long slots_mask;
+    fcs_dfs_split_key_t * slots;
+    /* Set once one of the workers has solved the deal. */
+    fcs_bool_t is_solved;
+} fcs_dfs_split_t;
+
+#define FCS_DFS_SPLIT_DEFAULT_NUM_SLOTS (1 << 16)
+
+static GCC_INLINE void fc_solve_dfs_split_init(
+    fcs_dfs_split_t * const split,
+    const int depth,
+    const unsigned long num_slots
+)
+{
+    unsigned long size = 1;
+    while (size < num_slots)
+    {
+        size <<= 1;
+    }
+    split->depth = depth;
+    split->slots_mask = size - 1;
+    split->slots = calloc(size, sizeof(split->slots[0]));
+    split->is_solved = FALSE;
+}
+
+static GCC_INLINE void fc_solve_dfs_split_free(fcs_dfs_split_t * const split)
+{
+    free(split->slots);
+    split->slots = NULL;
+}
+
+static GCC_INLINE fcs_dfs_split_key_t fc_solve_dfs_split_calc_key(
+    const fcs_state_t * const state,
+    const int soft_thread_id,
+    const int stacks_num,
+    const int freecells_num,
+    const int decks_num
+)
+{
+    unsigned char buffer[MAX_NUM_STACKS * (MAX_NUM_CARDS_IN_A_STACK + 1)
+        + MAX_NUM_FREECELLS + MAX_NUM_DECKS * 4 + 1];
+    unsigned char * b = buffer;
+
+    *(b++) = (unsigned char)soft_thread_id;
+    for (int i = 0 ; i < stacks_num ; i++)
+    {
+        const fcs_const_cards_column_t col = fcs_state_get_col(*state, i);
+        const int col_len = fcs_col_len(col);
+        *(b++) = (unsigned char)col_len;
+        for (int c = 0 ; c < col_len ; c++)
+        {
+            *(b++) = (unsigned char)fcs_card2char(fcs_col_get_card(col, c));
+        }
+    }
+    for (int i = 0 ; i < freecells_num ; i++)
+    {
+        *(b++) = (unsigned char)fcs_card2char(fcs_freecell_card(*state, i));
+    }
+    for (int i = 0 ; i < (decks_num << 2) ; i++)
+    {
+        *(b++) = (unsigned char)fcs_foundation_value(*state, i);
+    }
+
+    const fcs_dfs_split_key_t key = fc_solve_tt_hash(buffer, b - buffer);
+    /* 0 marks a vacant slot. */
+    return (key ? key : 1);
+}
+
+/*
+ * Returns TRUE if the caller should explore the subtree of the state
+ * with this key - either because it has just claimed it, or because the
+ * table is full.
+ * */
+static GCC_INLINE fcs_bool_t fc_solve_dfs_split_claim(
+    fcs_dfs_split_t * const split,
+    const fcs_dfs_split_key_t key
+)
+{
+    unsigned long idx = (unsigned long)key;
+    for (unsigned long i = 0 ; i <= split->slots_mask ; i++, idx++)
+    {
+        fcs_dfs_split_key_t * const slot = &(split->slots[idx & split->slots_mask]);
+        fcs_dfs_split_key_t expected = 0;
+        if (__atomic_compare_exchange_n(slot, &expected, key, FALSE,
+            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+        {
+            return TRUE;
+        }
+        if (expected == key)
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+static GCC_INLINE fcs_bool_t fc_solve_dfs_split_is_solved(
+    const fcs_dfs_split_t * const split
+)
+{
+    return __atomic_load_n(&(split->is_solved), __ATOMIC_ACQUIRE);
+}
+
+static GCC_INLINE void fc_solve_dfs_split_mark_as_solved(
+    fcs_dfs_split_t * const split
+)
+{
+    __atomic_store_n(&(split->is_solved), TRUE, __ATOMIC_RELEASE);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FC_SOLVE__DFS_SPLIT_H */
@@ -0,0 +1,717 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * endgame_db.h - a database of the single deck endgames with up to
+ * max_cards cards outside the foundations, which tells whether each of
+ * them is solvable, so the scans can discard the dead ends among them
+ * without exploring them.
+ *
+ * The remaining cards of each suit are those above its foundation, so a
+ * position is identified by the number of the remaining cards of every
+ * suit (its composition) and by what is directly beneath every card: a
+ * freecell, the bottom of a column, or another card. This ranking ignores
+ * the order of the columns and of the freecells, so it is canonical, and
+ * it is a perfect hash into the (k+1)^k entries of the compositions with
+ * k cards (some of which, like the cycles, are not positions at all).
+ *
+ * The database is generated by retrograde analysis from the empty
+ * position up (see endgame_db_gen.c), with a single bit per entry, and is
+ * memory-mapped when it is loaded. It is only valid for the variant it
+ * was generated for.
+ */
+#ifndef FC_SOLVE__ENDGAME_DB_H
+#define FC_SOLVE__ENDGAME_DB_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef WIN32
+#include <sys/mman.h>
+#endif
+
+#include "alloc_wrap.h"
+#include "inline.h"
+#include "bool.h"
+#include "fcs_enums.h"
+#include "state.h"
+
+/* The database of 8 cards would take about 900MB. */
+#define FCS_ENDGAME_DB_MAX_CARDS 7
+#define FCS_ENDGAME_DB_NUM_SUITS 4
+#define FCS_ENDGAME_DB_MAGIC "FCSEGDB1"
+
+/* What can be beneath a card, besides another card. */
+#define FCS_ENDGAME_DB_FREECELL (-2)
+#define FCS_ENDGAME_DB_BOTTOM (-1)
+
+enum
+{
+    FCS_ENDGAME_DB_NOT_COVERED = -1,
+    FCS_ENDGAME_DB_UNSOLVABLE = 0,
+    FCS_ENDGAME_DB_SOLVABLE = 1
+};
+
+typedef struct
+{
+    int max_cards;
+    int freecells_num;
+    int stacks_num;
+    int sequences_are_built_by;
+    int empty_stacks_fill;
+} fcs_endgame_db_params_t;
+
+typedef struct
+{
+    char magic[8];
+    fcs_endgame_db_params_t params;
+    int reserved;
+} fcs_endgame_db_file_header_t;
+
+typedef struct
+{
+    fcs_endgame_db_params_t params;
+    /* The bit offset of every composition, indexed by
+     * fc_solve_endgame_db__calc_composition_idx(). */
+    unsigned long long * offsets;
+    unsigned long long num_bits;
+    /* The bits, or NULL if the database was not loaded. */
+    unsigned char * bits;
+    /* What was mapped (or allocated) to hold the bits. */
+    void * mapped;
+    size_t mapped_len;
+} fcs_endgame_db_t;
+
+static GCC_INLINE int fc_solve_endgame_db__calc_composition_idx(
+    const int max_cards,
+    const int * const counts
+)
+{
+    int idx = 0;
+    for (int s = 0 ; s < FCS_ENDGAME_DB_NUM_SUITS ; s++)
+    {
+        idx = idx * (max_cards + 1) + counts[s];
+    }
+    return idx;
+}
+
+static GCC_INLINE unsigned long long fc_solve_endgame_db__calc_num_entries(
+    const int num_cards
+)
+{
+    unsigned long long ret = 1;
+    for (int i = 0 ; i < num_cards ; i++)
+    {
+        ret *= (unsigned long long)(num_cards + 1);
+    }
+    return ret;
+}
+
+/*
+ * Advances counts to the next composition with the same number of cards
+ * (in lexicographic order). Returns FALSE after the last one.
+ * */
+static GCC_INLINE fcs_bool_t fc_solve_endgame_db__next_composition(
+    int * const counts
+)
+{
+    /* Move one card from the last non-empty suit (other than the last
+     * suit) to the suit after it, and gather the rest after it too. */
+    const int last = FCS_ENDGAME_DB_NUM_SUITS - 1;
+    int s = last - 1;
+    while ((s >= 0) && (counts[s] == 0))
+    {
+        s--;
+    }
+    if (s < 0)
+    {
+        return FALSE;
+    }
+    const int rest = counts[last];
+    counts[last] = 0;
+    counts[s]--;
+    counts[s+1] = rest + 1;
+    return TRUE;
+}
+
+static GCC_INLINE void fc_solve_endgame_db__first_composition(
+    int * const counts,
+    const int num_cards
+)
+{
+    for (int s = 0 ; s < FCS_ENDGAME_DB_NUM_SUITS ; s++)
+    {
+        counts[s] = 0;
+    }
+    counts[0] = num_cards;
+}
+
+static GCC_INLINE void fc_solve_endgame_db__init(
+    fcs_endgame_db_t * const db,
+    const fcs_endgame_db_params_t * const params
+)
+{
+    db->params = *params;
+    const int max_cards = params->max_cards;
+    int counts[FCS_ENDGAME_DB_NUM_SUITS];
+    fc_solve_endgame_db__first_composition(counts, max_cards);
+    db->offsets = SMALLOC(db->offsets,
+        fc_solve_endgame_db__calc_composition_idx(max_cards, counts) + 1);
+    db->num_bits = 0;
+    for (int k = 0 ; k <= max_cards ; k++)
+    {
+        const unsigned long long num_entries =
+            fc_solve_endgame_db__calc_num_entries(k);
+        fc_solve_endgame_db__first_composition(counts, k);
+        do
+        {
+            db->offsets[fc_solve_endgame_db__calc_composition_idx(
+                max_cards, counts)] = db->num_bits;
+            db->num_bits += num_entries;
+        } while (fc_solve_endgame_db__next_composition(counts));
+    }
+    db->bits = NULL;
+    db->mapped = NULL;
+    db->mapped_len = 0;
+}
+
+static GCC_INLINE size_t fc_solve_endgame_db__calc_bits_len(
+    const fcs_endgame_db_t * const db
+)
+{
+    return (size_t)((db->num_bits + 7) >> 3);
+}
+
+static GCC_INLINE void fc_solve_endgame_db__free(fcs_endgame_db_t * const db)
+{
+    if (db->mapped)
+    {
+#ifndef WIN32
+        munmap(db->mapped, db->mapped_len);
+#else
+        free(db->mapped);
+#endif
+    }
+    else
+    {
+        free(db->bits);
+    }
+    free(db->offsets);
+    db->offsets = NULL;
+    db->bits = NULL;
+    db->mapped = NULL;
+}
+
+static GCC_INLINE fcs_bool_t fc_solve_endgame_db__get_bit(
+    const fcs_endgame_db_t * const db,
+    const unsigned long long bit
+)
+{
+    return ((db->bits[bit >> 3] >> (bit & 0x7)) & 0x1);
+}
+
+static GCC_INLINE void fc_solve_endgame_db__set_bit(
+    fcs_endgame_db_t * const db,
+    const unsigned long long bit
+)
+{
+    db->bits[bit >> 3] |= (unsigned char)(1 << (bit & 0x7));
+}
+
+/*
+ * The cards of a composition are numbered by suit, and inside each suit
+ * from the lowest rank, which is the next one to be put in the foundation.
+ * */
+static GCC_INLINE void fc_solve_endgame_db__calc_bases(
+    const int * const counts,
+    int * const bases
+)
+{
+    int base = 0;
+    for (int s = 0 ; s < FCS_ENDGAME_DB_NUM_SUITS ; s++)
+    {
+        bases[s] = base;
+        base += counts[s];
+    }
+}
+
+static GCC_INLINE void fc_solve_endgame_db__get_card(
+    const int * const counts,
+    const int * const bases,
+    const int card,
+    int * const rank,
+    int * const suit
+)
+{
+    int s = FCS_ENDGAME_DB_NUM_SUITS - 1;
+    while (bases[s] > card)
+    {
+        s--;
+    }
+    *suit = s;
+    *rank = 14 - counts[s] + (card - bases[s]);
+}
+
+/*
+ * beneath[i] is either FCS_ENDGAME_DB_FREECELL, FCS_ENDGAME_DB_BOTTOM or
+ * the card beneath card i.
+ * */
+static GCC_INLINE unsigned long long fc_solve_endgame_db__rank(
+    const int num_cards,
+    const int * const beneath
+)
+{
+    unsigned long long idx = 0;
+    for (int i = num_cards - 1 ; i >= 0 ; i--)
+    {
+        const int b = beneath[i];
+        idx = idx * (unsigned long long)(num_cards + 1)
+            + (unsigned long long)((b < 0) ? (b + 2) : ((b < i) ? (b + 2) : (b + 1)));
+    }
+    return idx;
+}
+
+static GCC_INLINE void fc_solve_endgame_db__unrank(
+    const int num_cards,
+    unsigned long long idx,
+    int * const beneath
+)
+{
+    for (int i = 0 ; i < num_cards ; i++)
+    {
+        const int code = (int)(idx % (unsigned long long)(num_cards + 1));
+        idx /= (unsigned long long)(num_cards + 1);
+        beneath[i] = ((code < 2) ? (code - 2) : ((code - 2 < i) ? (code - 2) : (code - 1)));
+    }
+}
+
+/*
+ * Returns whether beneath[] is a position of the variant, and fills
+ * is_covered[].
+ * */
+static GCC_INLINE fcs_bool_t fc_solve_endgame_db__is_valid(
+    const fcs_endgame_db_params_t * const params,
+    const int num_cards,
+    const int * const beneath,
+    fcs_bool_t * const is_covered
+)
+{
+    int num_freecells = 0, num_columns = 0;
+    for (int i = 0 ; i < num_cards ; i++)
+    {
+        is_covered[i] = FALSE;
+    }
+    for (int i = 0 ; i < num_cards ; i++)
+    {
+        const int b = beneath[i];
+        if (b == FCS_ENDGAME_DB_FREECELL)
+        {
+            num_freecells++;
+        }
+        else if (b == FCS_ENDGAME_DB_BOTTOM)
+        {
+            num_columns++;
+        }
+        else
+        {
+            if (is_covered[b] || (beneath[b] == FCS_ENDGAME_DB_FREECELL))
+            {
+                return FALSE;
+            }
+            is_covered[b] = TRUE;
+        }
+    }
+    if ((num_freecells > params->freecells_num)
+        || (num_columns > params->stacks_num))
+    {
+        return FALSE;
+    }
+    /* Every card has to rest on the bottom of a column eventually. */
+    for (int i = 0 ; i < num_cards ; i++)
+    {
+        int b = beneath[i];
+        for (int steps = 0 ; b >= 0 ; steps++)
+        {
+            if (steps == num_cards)
+            {
+                return FALSE;
+            }
+            b = beneath[b];
+        }
+    }
+    return TRUE;
+}
+
+static GCC_INLINE fcs_bool_t fc_solve_endgame_db__is_parent(
+    const fcs_endgame_db_params_t * const params,
+    const int child_rank, const int child_suit,
+    const int parent_rank, const int parent_suit
+)
+{
+    return ((child_rank + 1 == parent_rank) &&
+        ((params->sequences_are_built_by == FCS_SEQ_BUILT_BY_RANK)
+         || ((params->sequences_are_built_by == FCS_SEQ_BUILT_BY_SUIT)
+             ? (child_suit == parent_suit)
+             : ((child_suit & 0x1) != (parent_suit & 0x1))
+            )
+        )
+    );
+}
+
+/*
+ * Returns whether one of the moves of the position leads to a position
+ * that is already known to be solvable. The positions with one card less
+ * must have been generated before.
+ * */
+static GCC_INLINE fcs_bool_t fc_solve_endgame_db__has_winning_move(
+    fcs_endgame_db_t * const db,
+    int * const counts,
+    const int num_cards,
+    int * const beneath,
+    const fcs_bool_t * const is_covered
+)
+{
+    const fcs_endgame_db_params_t * const params = &(db->params);
+    int bases[FCS_ENDGAME_DB_NUM_SUITS];
+    fc_solve_endgame_db__calc_bases(counts, bases);
+    const unsigned long long offset = db->offsets[
+        fc_solve_endgame_db__calc_composition_idx(params->max_cards, counts)];
+
+    int num_freecells = 0, num_columns = 0;
+    for (int i = 0 ; i < num_cards ; i++)
+    {
+        num_freecells += (beneath[i] == FCS_ENDGAME_DB_FREECELL);
+        num_columns += (beneath[i] == FCS_ENDGAME_DB_BOTTOM);
+    }
+
+#define CHECK_MOVE() \
+    { \
+        const fcs_bool_t is_solvable = fc_solve_endgame_db__get_bit(db, \
+            offset + fc_solve_endgame_db__rank(num_cards, beneath)); \
+        beneath[t] = old_beneath; \
+        if (is_solvable) \
+        { \
+            return TRUE; \
+        } \
+    }
+
+    for (int t = 0 ; t < num_cards ; t++)
+    {
+        if (is_covered[t])
+        {
+            continue;
+        }
+        int rank, suit;
+        fc_solve_endgame_db__get_card(counts, bases, t, &rank, &suit);
+        const int old_beneath = beneath[t];
+
+        if (t == bases[suit])
+        {
+            /* To the foundation. */
+            if (num_cards == 1)
+            {
+                return TRUE;
+            }
+            int next_beneath[FCS_ENDGAME_DB_MAX_CARDS];
+            for (int i = 0, j = 0 ; i < num_cards ; i++)
+            {
+                if (i != t)
+                {
+                    const int b = beneath[i];
+                    next_beneath[j++] = (b > t) ? (b - 1) : b;
+                }
+            }
+            counts[suit]--;
+            const fcs_bool_t is_solvable = fc_solve_endgame_db__get_bit(db,
+                db->offsets[fc_solve_endgame_db__calc_composition_idx(
+                    params->max_cards, counts)]
+                + fc_solve_endgame_db__rank(num_cards - 1, next_beneath));
+            counts[suit]++;
+            if (is_solvable)
+            {
+                return TRUE;
+            }
+        }
+
+        if ((old_beneath != FCS_ENDGAME_DB_FREECELL)
+            && (num_freecells < params->freecells_num))
+        {
+            beneath[t] = FCS_ENDGAME_DB_FREECELL;
+            CHECK_MOVE();
+        }
+
+        if ((old_beneath != FCS_ENDGAME_DB_BOTTOM)
+            && (num_columns < params->stacks_num)
+            && ((params->empty_stacks_fill == FCS_ES_FILLED_BY_ANY_CARD)
+                || ((params->empty_stacks_fill == FCS_ES_FILLED_BY_KINGS_ONLY)
+                    && (rank == 13))))
+        {
+            beneath[t] = FCS_ENDGAME_DB_BOTTOM;
+            CHECK_MOVE();
+        }
+
+        for (int p = 0 ; p < num_cards ; p++)
+        {
+            if ((p == t) || is_covered[p] || (p == old_beneath)
+                || (beneath[p] == FCS_ENDGAME_DB_FREECELL))
+            {
+                continue;
+            }
+            int parent_rank, parent_suit;
+            fc_solve_endgame_db__get_card(counts, bases, p,
+                &parent_rank, &parent_suit);
+            if (fc_solve_endgame_db__is_parent(params, rank, suit,
+                parent_rank, parent_suit))
+            {
+                beneath[t] = p;
+                CHECK_MOVE();
+            }
+        }
+    }
+#undef CHECK_MOVE
+
+    return FALSE;
+}
+
+/*
+ * Generates the database in memory. In every composition, the positions
+ * with a move to the foundation that leads to a solvable position are
+ * marked first, and then the positions with a move to a position that was
+ * marked, until no more positions are marked.
+ * */
+static GCC_INLINE void fc_solve_endgame_db__generate(fcs_endgame_db_t * const db)
+{
+    const fcs_endgame_db_params_t * const params = &(db->params);
+    const size_t bits_len = fc_solve_endgame_db__calc_bits_len(db);
+    db->bits = SMALLOC(db->bits, bits_len);
+    memset(db->bits, '\0', bits_len);
+
+    int counts[FCS_ENDGAME_DB_NUM_SUITS];
+    int beneath[FCS_ENDGAME_DB_MAX_CARDS];
+    fcs_bool_t is_covered[FCS_ENDGAME_DB_MAX_CARDS];
+
+    /* The empty position is solved. */
+    fc_solve_endgame_db__set_bit(db, 0);
+
+    for (int k = 1 ; k <= params->max_cards ; k++)
+    {
+        const unsigned long long num_entries =
+            fc_solve_endgame_db__calc_num_entries(k);
+        unsigned long long * const positions =
+            SMALLOC(positions, num_entries);
+
+        fc_solve_endgame_db__first_composition(counts, k);
+        do
+        {
+            const unsigned long long offset = db->offsets[
+                fc_solve_endgame_db__calc_composition_idx(
+                    params->max_cards, counts)];
+            unsigned long long num_positions = 0;
+            for (unsigned long long idx = 0 ; idx < num_entries ; idx++)
+            {
+                fc_solve_endgame_db__unrank(k, idx, beneath);
+                if (fc_solve_endgame_db__is_valid(params, k, beneath, is_covered))
+                {
+                    positions[num_positions++] = idx;
+                }
+            }
+
+            fcs_bool_t was_changed = TRUE;
+            while (was_changed)
+            {
+                was_changed = FALSE;
+                /* The solved positions are removed from the list. */
+                unsigned long long num_left = 0;
+                for (unsigned long long i = 0 ; i < num_positions ; i++)
+                {
+                    const unsigned long long idx = positions[i];
+                    fc_solve_endgame_db__unrank(k, idx, beneath);
+                    fc_solve_endgame_db__is_valid(params, k, beneath, is_covered);
+                    if (fc_solve_endgame_db__has_winning_move(
+                        db, counts, k, beneath, is_covered))
+                    {
+                        fc_solve_endgame_db__set_bit(db, offset + idx);
+                        was_changed = TRUE;
+                    }
+                    else
+                    {
+                        positions[num_left++] = idx;
+                    }
+                }
+                num_positions = num_left;
+            }
+        } while (fc_solve_endgame_db__next_composition(counts));
+
+        free(positions);
+    }
+}
+
+static GCC_INLINE fcs_bool_t fc_solve_endgame_db__write(
+    const fcs_endgame_db_t * const db,
+    const char * const filename
+)
+{
+    FILE * const f = fopen(filename, "wb");
+    if (! f)
+    {
+        return FALSE;
+    }
+    fcs_endgame_db_file_header_t header;
+    memset(&header, '\0', sizeof(header));
+    memcpy(header.magic, FCS_ENDGAME_DB_MAGIC, sizeof(header.magic));
+    header.params = db->params;
+    const size_t bits_len = fc_solve_endgame_db__calc_bits_len(db);
+    const fcs_bool_t ret =
+        ((fwrite(&header, sizeof(header), 1, f) == 1)
+         && (fwrite(db->bits, 1, bits_len, f) == bits_len));
+    return ((fclose(f) == 0) && ret);
+}
+
+/*
+ * Loads the database from filename. Returns NULL on success or an error
+ * message.
+ * */
+static GCC_INLINE const char * fc_solve_endgame_db__load(
+    fcs_endgame_db_t * const db,
+    const char * const filename
+)
+{
+    FILE * const f = fopen(filename, "rb");
+    if (! f)
+    {
+        return "Could not open the endgame database.";
+    }
+    fcs_endgame_db_file_header_t header;
+    if ((fread(&header, sizeof(header), 1, f) != 1)
+        || memcmp(header.magic, FCS_ENDGAME_DB_MAGIC, sizeof(header.magic))
+        || (header.params.max_cards < 0)
+        || (header.params.max_cards > FCS_ENDGAME_DB_MAX_CARDS))
+    {
+        fclose(f);
+        return "The file is not an endgame database.";
+    }
+    fc_solve_endgame_db__init(db, &(header.params));
+    const size_t bits_len = fc_solve_endgame_db__calc_bits_len(db);
+    fseek(f, 0, SEEK_END);
+    if ((size_t)ftell(f) != sizeof(header) + bits_len)
+    {
+        fclose(f);
+        fc_solve_endgame_db__free(db);
+        return "The endgame database is truncated.";
+    }
+
+    db->mapped_len = sizeof(header) + bits_len;
+#ifndef WIN32
+    db->mapped = mmap(NULL, db->mapped_len, PROT_READ, MAP_SHARED, fileno(f), 0);
+    if (db->mapped == MAP_FAILED)
+    {
+        db->mapped = NULL;
+    }
+#else
+    db->mapped = malloc(db->mapped_len);
+    fseek(f, 0, SEEK_SET);
+    if (db->mapped &&
+        (fread(db->mapped, 1, db->mapped_len, f) != db->mapped_len))
+    {
+        free(db->mapped);
+        db->mapped = NULL;
+    }
+#endif
+    fclose(f);
+    if (! db->mapped)
+    {
+        fc_solve_endgame_db__free(db);
+        return "Could not map the endgame database.";
+    }
+    db->bits = ((unsigned char *)db->mapped) + sizeof(header);
+
+    return NULL;
+}
+
+/*
+ * Looks up a single deck state. Returns FCS_ENDGAME_DB_NOT_COVERED if it
+ * has too many cards outside the foundations.
+ * */
+static GCC_INLINE int fc_solve_endgame_db__lookup_state(
+    const fcs_endgame_db_t * const db,
+    const fcs_state_t * const state,
+    const int freecells_num,
+    const int stacks_num
+)
+{
+    int counts[FCS_ENDGAME_DB_NUM_SUITS];
+    int num_cards = 0;
+    for (int s = 0 ; s < FCS_ENDGAME_DB_NUM_SUITS ; s++)
+    {
+        num_cards += (counts[s] = 13 - fcs_foundation_value(*state, s));
+    }
+    if (num_cards > db->params.max_cards)
+    {
+        return FCS_ENDGAME_DB_NOT_COVERED;
+    }
+
+    int bases[FCS_ENDGAME_DB_NUM_SUITS];
+    fc_solve_endgame_db__calc_bases(counts, bases);
+#define CARD_IDX(card) \
+    (bases[fcs_card_suit(card)] + fcs_card_rank(card) \
+        - (14 - counts[fcs_card_suit(card)]))
+
+    int beneath[FCS_ENDGAME_DB_MAX_CARDS];
+    for (int c = 0 ; c < stacks_num ; c++)
+    {
+        const fcs_const_cards_column_t col = fcs_state_get_col(*state, c);
+        const int col_len = fcs_col_len(col);
+        int prev = FCS_ENDGAME_DB_BOTTOM;
+        for (int i = 0 ; i < col_len ; i++)
+        {
+            const int card_idx = CARD_IDX(fcs_col_get_card(col, i));
+            beneath[card_idx] = prev;
+            prev = card_idx;
+        }
+    }
+    for (int f = 0 ; f < freecells_num ; f++)
+    {
+        const fcs_card_t card = fcs_freecell_card(*state, f);
+        if (! fcs_card_is_empty(card))
+        {
+            beneath[CARD_IDX(card)] = FCS_ENDGAME_DB_FREECELL;
+        }
+    }
+#undef CARD_IDX
+
+    return fc_solve_endgame_db__get_bit(db,
+        db->offsets[fc_solve_endgame_db__calc_composition_idx(
+            db->params.max_cards, counts)]
+        + fc_solve_endgame_db__rank(num_cards, beneath));
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FC_SOLVE__ENDGAME_DB_H */
@@ -0,0 +1,154 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ *  endgame_db_gen.c - generates the endgame database of a variant (see
+ *  endgame_db.h and the --endgame-db option in USAGE.txt).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "endgame_db.h"
+
+static void print_help(void)
+{
+    printf("\n%s",
+"freecell-solver-endgame-db-gen [--max-cards n] [--freecells-num n]\n"
+"   [--stacks-num n] [--sequences-are-built-by alternate_color|suit|rank]\n"
+"   [--empty-stacks-filled-by any|kings|none] -o filename\n"
+"\n"
+"Generates the database of the single deck endgames of the variant with up\n"
+"to n cards outside the foundations, which fc-solve's --endgame-db option\n"
+"loads. The variant's options are those of fc-solve, and default to\n"
+"Freecell's, but the database of Freecell itself is of little use, because\n"
+"all its positions with up to 12 cards outside the foundations are\n"
+"solvable.\n"
+"\n"
+"--max-cards n\n"
+"     The most cards outside the foundations (default: 6, at most 7).\n"
+"-o filename\n"
+"     Writes the database to filename.\n"
+          );
+}
+
+int main(int argc, char * argv[])
+{
+    fcs_endgame_db_params_t params = {
+        .max_cards = 6,
+        .freecells_num = 4,
+        .stacks_num = 8,
+        .sequences_are_built_by = FCS_SEQ_BUILT_BY_ALTERNATE_COLOR,
+        .empty_stacks_fill = FCS_ES_FILLED_BY_ANY_CARD,
+    };
+    const char * output_filename = NULL;
+
+    for (int arg = 1 ; arg < argc ; arg++)
+    {
+        if ((!strcmp(argv[arg], "--help")) || (!strcmp(argv[arg], "-h")))
+        {
+            print_help();
+            exit(0);
+        }
+        if (arg + 1 == argc)
+        {
+            fprintf(stderr, "Unknown option or no argument for %s!\n", argv[arg]);
+            print_help();
+            exit(-1);
+        }
+        const char * const val = argv[arg + 1];
+        if (!strcmp(argv[arg], "--max-cards"))
+        {
+            params.max_cards = atoi(val);
+        }
+        else if (!strcmp(argv[arg], "--freecells-num"))
+        {
+            params.freecells_num = atoi(val);
+        }
+        else if (!strcmp(argv[arg], "--stacks-num"))
+        {
+            params.stacks_num = atoi(val);
+        }
+        else if (!strcmp(argv[arg], "--sequences-are-built-by"))
+        {
+            params.sequences_are_built_by =
+                ((!strcmp(val, "suit")) ? FCS_SEQ_BUILT_BY_SUIT
+                 : (!strcmp(val, "rank")) ? FCS_SEQ_BUILT_BY_RANK
+                 : FCS_SEQ_BUILT_BY_ALTERNATE_COLOR);
+        }
+        else if (!strcmp(argv[arg], "--empty-stacks-filled-by"))
+        {
+            params.empty_stacks_fill =
+                ((!strcmp(val, "kings")) ? FCS_ES_FILLED_BY_KINGS_ONLY
+                 : (!strcmp(val, "none")) ? FCS_ES_FILLED_BY_NONE
+                 : FCS_ES_FILLED_BY_ANY_CARD);
+        }
+        else if (!strcmp(argv[arg], "-o"))
+        {
+            output_filename = val;
+        }
+        else
+        {
+            fprintf(stderr, "Unknown option %s!\n", argv[arg]);
+            print_help();
+            exit(-1);
+        }
+        arg++;
+    }
+
+    if (! output_filename)
+    {
+        fprintf(stderr, "%s", "No output file was specified!\n");
+        print_help();
+        exit(-1);
+    }
+    if ((params.max_cards < 1) || (params.max_cards > FCS_ENDGAME_DB_MAX_CARDS)
+        || (params.freecells_num < 0) || (params.stacks_num < 1))
+    {
+        fprintf(stderr, "--max-cards must be between 1 and %d, and there must"
+            " be at least one stack.\n", FCS_ENDGAME_DB_MAX_CARDS);
+        exit(-1);
+    }
+
+    fcs_endgame_db_t db;
+    fc_solve_endgame_db__init(&db, &params);
+    fc_solve_endgame_db__generate(&db);
+
+    unsigned long long num_solvable = 0;
+    for (unsigned long long bit = 0 ; bit < db.num_bits ; bit++)
+    {
+        num_solvable += fc_solve_endgame_db__get_bit(&db, bit);
+    }
+
+    if (! fc_solve_endgame_db__write(&db, output_filename))
+    {
+        fprintf(stderr, "Could not write \"%s\"!\n", output_filename);
+        exit(-1);
+    }
+    printf("Wrote %llu entries (%llu of them solvable positions) to \"%s\".\n",
+        db.num_bits, num_solvable, output_filename);
+
+    fc_solve_endgame_db__free(&db);
+
+    return 0;
+}
@@ -35,6 +35,7 @@ extern "C"
 #endif
 
 #include <assert.h>
+#include <pthread.h>
 #include "config.h"
 
 #include "bool.h"
@@ -105,6 +106,153 @@ static GCC_INLINE void fc_solve_fcc_release_moves_seq(
     moves_seq->count = -1;
 }
 
+/*
+ * A state that was derived from one of the positions in the current
+ * level of the breadth-first search, and was not traversed before that
+ * level.
+ * */
+typedef struct
+{
+    fcs_encoded_state_buffer_t key;
+    /* The index of the parent in the level. */
+    int parent_idx;
+    unsigned char move;
+    fcs_bool_t is_reversible;
+} fcs_fcc_brfs_derived_t;
+
+/*
+ * Each thread expands a contiguous range of the level into its own buffer,
+ * so merging the buffers in the order of the threads yields the derived
+ * states in the same order as a single-threaded scan.
+ * */
+typedef struct
+{
+    enum fcs_dbm_variant_type_t local_variant;
+    fc_solve_delta_stater_t * delta_stater;
+    fcs_compact_allocator_t derived_list_allocator;
+    fcs_derived_state_t * derived_list_recycle_bin;
+    /* Only looked up while the level is being expanded. */
+    dict_t * traversed_states;
+    fcs_dbm_queue_item_t * * level;
+    int start_idx, end_idx;
+    fcs_fcc_brfs_derived_t * derived;
+    int num_derived, max_num_derived;
+    pthread_t id;
+} fcs_fcc_brfs_thread_t;
+
+/* Levels smaller than that are expanded by the calling thread alone. */
+#define FCS_FCC_BRFS_MIN_ITEMS_PER_THREAD 128
+
+static GCC_INLINE void fcs_fcc_brfs_thread__init(
+    fcs_fcc_brfs_thread_t * const thread,
+    const enum fcs_dbm_variant_type_t local_variant,
+    fcs_state_keyval_pair_t * const init_state,
+    dict_t * const traversed_states,
+    fcs_meta_compact_allocator_t * const meta_alloc
+)
+{
+    thread->local_variant = local_variant;
+    thread->delta_stater = fc_solve_delta_stater_alloc(
+        &(init_state->s),
+        STACKS_NUM,
+        FREECELLS_NUM
+#ifndef FCS_FREECELL_ONLY
+        , FCS_SEQ_BUILT_BY_ALTERNATE_COLOR
+#endif
+    );
+    fc_solve_compact_allocator_init(&(thread->derived_list_allocator), meta_alloc);
+    thread->derived_list_recycle_bin = NULL;
+    thread->traversed_states = traversed_states;
+    thread->derived = NULL;
+    thread->num_derived = thread->max_num_derived = 0;
+}
+
+static GCC_INLINE void fcs_fcc_brfs_thread__destroy(
+    fcs_fcc_brfs_thread_t * const thread
+)
+{
+    fc_solve_delta_stater_free(thread->delta_stater);
+    fc_solve_compact_allocator_finish(&(thread->derived_list_allocator));
+    free(thread->derived);
+}
+
+static void * fcs_fcc_brfs_thread__expand(void * const void_thread)
+{
+    fcs_fcc_brfs_thread_t * const thread = (fcs_fcc_brfs_thread_t *)void_thread;
+    const enum fcs_dbm_variant_type_t local_variant = thread->local_variant;
+    fc_solve_delta_stater_t * const delta_stater = thread->delta_stater;
+    fcs_state_keyval_pair_t state;
+    DECLARE_IND_BUF_T(indirect_stacks_buffer)
+
+    thread->num_derived = 0;
+    for (int idx = thread->start_idx ; idx < thread->end_idx ; idx++)
+    {
+        fcs_derived_state_t * derived_list = NULL;
+
+        fc_solve_delta_stater_decode_into_state(
+            delta_stater,
+            thread->level[idx]->key.s,
+            &(state),
+            indirect_stacks_buffer
+        );
+
+        instance_solver_thread_calc_derived_states(
+            local_variant,
+            &state,
+            NULL,
+            &derived_list,
+            &(thread->derived_list_recycle_bin),
+            &(thread->derived_list_allocator),
+            /* Horne's Prune should be disabled because that interferes
+             * with the FCC-depth. */
+            FALSE
+        );
+
+        while (derived_list)
+        {
+            fcs_derived_state_t * const next_derived = derived_list->next;
+
+            if (thread->num_derived == thread->max_num_derived)
+            {
+                thread->derived = SREALLOC(
+                    thread->derived,
+                    thread->max_num_derived += 256
+                );
+            }
+            fcs_fcc_brfs_derived_t * const out =
+                &(thread->derived[thread->num_derived]);
+
+            fcs_init_and_encode_state(
+                delta_stater,
+                local_variant,
+                &(derived_list->state),
+                &(out->key)
+            );
+            out->is_reversible =
+                (derived_list->core_irreversible_moves_count == 0);
+
+            /*
+             * The traversed states only grow, so a state that is already
+             * there would be skipped by the merge as well.
+             * */
+            if (! (out->is_reversible
+                && fc_solve_kaz_tree_lookup_value(
+                    thread->traversed_states, &(out->key))))
+            {
+                out->parent_idx = idx;
+                out->move = derived_list->move;
+                thread->num_derived++;
+            }
+
+            derived_list->next = thread->derived_list_recycle_bin;
+            thread->derived_list_recycle_bin = derived_list;
+            derived_list = next_derived;
+        }
+    }
+
+    return NULL;
+}
+
 static void perform_FCC_brfs(
     enum fcs_dbm_variant_type_t local_variant,
     /* The first state in the game, from which all states are encoded. */
@@ -114,18 +262,10 @@ static void perform_FCC_brfs(
     /* The moves leading up to the state.
      * */
     const fcs_fcc_moves_seq_t * const start_state_moves_seq,
-#if 0
-    /* [Output]: FCC start points.
-     * */
-    fcs_FCC_start_points_list_t * fcc_start_points,
-    /* [Input/Output]: make sure the fcc_start_points don't repeat themselves,
-     * in the same FCC-based-depth.
-     * */
-    dict_t * do_next_fcc_start_points_exist,
-#else
     /*
      * [Output] a callback to add a point to the next_start_points,
-     * and its context.
+     * and its context. It is always called from the calling thread, and
+     * in the same order as by a single-threaded scan.
      */
     fcs_bool_t (*add_start_point)(
         fcs_encoded_state_buffer_t * enc_state,
@@ -135,7 +275,6 @@ static void perform_FCC_brfs(
         void * context
     ),
     void * add_start_point_context,
-#endif
     /* [Output]: Is the min_by_sorting new.
      * */
     fcs_bool_t * is_min_by_sorting_new,
@@ -160,22 +299,24 @@ static void perform_FCC_brfs(
     fcs_fcc_moves_seq_allocator_t * moves_list_allocator,
     /* [Input/Output]: The meta allocator - needed to allocate and free
      * the compact allocators. */
-    fcs_meta_compact_allocator_t * meta_alloc
+    fcs_meta_compact_allocator_t * meta_alloc,
+    /* [Input]: The maximal number of threads that expand each level of the
+     * FCC. */
+    const int max_num_threads
 )
 {
     void * tree_recycle_bin = NULL;
-    fcs_dbm_queue_item_t * queue_head, * queue_tail, * queue_recycle_bin, * new_item, * extracted_item;
-    fcs_compact_allocator_t queue_allocator, derived_list_allocator;
-    fcs_derived_state_t * derived_list, * derived_list_recycle_bin,
-                        * derived_iter, * next_derived_iter;
+    fcs_dbm_queue_item_t * queue_recycle_bin, * new_item, * start_item;
+    fcs_compact_allocator_t queue_allocator;
     dict_t * traversed_states;
-    fc_solve_delta_stater_t * delta_stater;
-    fcs_state_keyval_pair_t state;
     fcs_bool_t running_min_was_assigned = FALSE;
     fcs_encoded_state_buffer_t running_min;
     long num_new_positions;
-
-    DECLARE_IND_BUF_T(indirect_stacks_buffer)
+    /* The current and the next levels of the breadth-first search. */
+    fcs_dbm_queue_item_t * * level, * * next_level;
+    int level_len, next_level_len, max_level_len, max_next_level_len;
+    fcs_fcc_brfs_thread_t * threads;
+    int num_threads_inited;
 
     /* Some sanity checks. */
 #ifndef NDEBUG
@@ -185,25 +326,23 @@ static void perform_FCC_brfs(
     assert(min_by_sorting);
     assert(does_min_by_sorting_exist);
     assert(does_state_exist_in_any_FCC_cache);
+    assert(max_num_threads >= 1);
 #endif
 
     /* Initialize the queue_allocator. */
     fc_solve_compact_allocator_init( &(queue_allocator), meta_alloc );
-    fc_solve_compact_allocator_init( &(derived_list_allocator), meta_alloc );
     queue_recycle_bin = NULL;
 
-    /* TODO : maybe pass delta_stater as an argument  */
-    delta_stater = fc_solve_delta_stater_alloc(
-        &(init_state->s),
-        STACKS_NUM,
-        FREECELLS_NUM
-#ifndef FCS_FREECELL_ONLY
-        , FCS_SEQ_BUILT_BY_ALTERNATE_COLOR
-#endif
-    );
-
     traversed_states = fc_solve_kaz_tree_create(fc_solve_compare_encoded_states, NULL, meta_alloc, &tree_recycle_bin);
 
+    /* The other threads are initialized when the first level that is large
+     * enough for them is reached. */
+    threads = SMALLOC(threads, max_num_threads);
+    /* TODO : maybe pass delta_stater as an argument  */
+    fcs_fcc_brfs_thread__init(&(threads[0]), local_variant, init_state,
+        traversed_states, meta_alloc);
+    num_threads_inited = 1;
+
     new_item =
         (fcs_dbm_queue_item_t *)
         fcs_compact_alloc_ptr(
@@ -211,14 +350,17 @@ static void perform_FCC_brfs(
             sizeof(*new_item)
         );
 
+    start_item = new_item;
     new_item->key = start_state;
     new_item->next = NULL;
     new_item->moves_seq.count = 0;
     new_item->moves_seq.moves_list = NULL;
 
-    queue_head = queue_tail = new_item;
-
-    derived_list_recycle_bin = NULL;
+    max_level_len = max_next_level_len = 64;
+    level = SMALLOC(level, max_level_len);
+    next_level = SMALLOC(next_level, max_next_level_len);
+    level[0] = new_item;
+    level_len = 1;
 
     *out_num_new_positions = num_new_positions = 0;
 
@@ -227,188 +369,178 @@ static void perform_FCC_brfs(
         &(new_item->key)
     );
 
-    /* Extract an item from the queue. */
-    while ((extracted_item = queue_head))
+    while (level_len)
     {
-        num_new_positions++;
-        if (! (queue_head = extracted_item->next) )
-        {
-            queue_tail = NULL;
-        }
+        /*
+         * Handle the min_by_sorting scan. It only involves the cache, so it
+         * can be done for the whole level before expanding it.
+         * */
+        int num_to_expand = level_len;
+        fcs_bool_t is_min_in_cache = FALSE;
 
-        /* Handle the min_by_sorting scan. */
-        if ((! running_min_was_assigned) ||
-            (memcmp(&(extracted_item->key), &running_min,
-                    sizeof(running_min)) < 0)
-        )
+        for (int idx = 0 ; idx < level_len ; idx++)
         {
-            running_min_was_assigned = TRUE;
-            running_min = extracted_item->key;
-            if (cache_does_key_exist(
-                    does_state_exist_in_any_FCC_cache,
-                    &(running_min)
-                    ))
-            {
-                *is_min_by_sorting_new = FALSE;
-                goto free_resources;
-            }
-            else
+            fcs_dbm_queue_item_t * const extracted_item = level[idx];
+
+            num_new_positions++;
+            if ((! running_min_was_assigned) ||
+                (memcmp(&(extracted_item->key), &running_min,
+                        sizeof(running_min)) < 0)
+            )
             {
-                cache_insert(does_state_exist_in_any_FCC_cache, &(running_min), NULL, '\0');
+                running_min_was_assigned = TRUE;
+                running_min = extracted_item->key;
+                if (cache_does_key_exist(
+                        does_state_exist_in_any_FCC_cache,
+                        &(running_min)
+                        ))
+                {
+                    /* The items before it are still expanded, so the
+                     * start points are the same as those of a
+                     * single-threaded scan. */
+                    is_min_in_cache = TRUE;
+                    num_to_expand = idx;
+                    break;
+                }
+                else
+                {
+                    cache_insert(does_state_exist_in_any_FCC_cache, &(running_min), NULL, '\0');
+                }
             }
         }
 
-        /* Calculate the derived list. */
-        derived_list = NULL;
-
-        /* Handle item. */
-        fc_solve_delta_stater_decode_into_state(
-            delta_stater,
-            extracted_item->key.s,
-            &(state),
-            indirect_stacks_buffer
-        );
-
-#if 0
-        char * state_as_str =
-                fc_solve_state_as_string(
-#ifdef FCS_RCS_STATES
-                        &(state.s),
-                        &(state.info),
-#else
-                        &state,
-#endif
-                        &locs,
-                        FREECELLS_NUM,
-                        STACKS_NUM,
-                        DECKS_NUM,
-                        1,
-                        0,
-                        1
-                );
-
-        printf("Checking = <<<\n%s\n>>>\n", state_as_str);
-
-        free(state_as_str);
-#endif
-
-        instance_solver_thread_calc_derived_states(
-            local_variant,
-            &state,
-            NULL,
-            &derived_list,
-            &derived_list_recycle_bin,
-            &derived_list_allocator,
-            /* Horne's Prune should be disabled because that interferes
-             * with the FCC-depth. */
-            FALSE
-        );
-
-
-        /* Allocate a spare 'new_item'. */
-        if (queue_recycle_bin)
+        /* Expand the level. */
+        int num_threads = num_to_expand / FCS_FCC_BRFS_MIN_ITEMS_PER_THREAD;
+        if (num_threads > max_num_threads)
         {
-            new_item = queue_recycle_bin;
-            queue_recycle_bin = queue_recycle_bin->next;
+            num_threads = max_num_threads;
         }
-        else
+        else if (num_threads < 1)
         {
-            new_item =
-                (fcs_dbm_queue_item_t *)
-                fcs_compact_alloc_ptr(
-                    &(queue_allocator),
-                    sizeof(*new_item)
-                );
+            num_threads = 1;
+        }
+        for ( ; num_threads_inited < num_threads ; num_threads_inited++)
+        {
+            fcs_fcc_brfs_thread__init(&(threads[num_threads_inited]),
+                local_variant, init_state, traversed_states, meta_alloc);
+        }
+        for (int t = 0 ; t < num_threads ; t++)
+        {
+            threads[t].level = level;
+            threads[t].start_idx = (int)((long)num_to_expand * t / num_threads);
+            threads[t].end_idx = (int)((long)num_to_expand * (t+1) / num_threads);
+        }
+        for (int t = 1 ; t < num_threads ; t++)
+        {
+            if (pthread_create(&(threads[t].id), NULL,
+                fcs_fcc_brfs_thread__expand, &(threads[t])))
+            {
+                fprintf(stderr, "Cannot create a thread for the FCC scan.\n");
+                exit(-1);
+            }
+        }
+        fcs_fcc_brfs_thread__expand(&(threads[0]));
+        for (int t = 1 ; t < num_threads ; t++)
+        {
+            pthread_join(threads[t].id, NULL);
         }
 
-        /* Enqueue the new elements to the queue. */
-        for (derived_iter = derived_list;
-                derived_iter ;
-                derived_iter = next_derived_iter
-        )
+        /* Merge the derived states in order. */
+        next_level_len = 0;
+        for (int t = 0 ; t < num_threads ; t++)
         {
-            fcs_bool_t is_reversible = (derived_iter->core_irreversible_moves_count == 0);
-            unsigned char extra_move;
+            for (int i = 0 ; i < threads[t].num_derived ; i++)
+            {
+                fcs_fcc_brfs_derived_t * const derived = &(threads[t].derived[i]);
+                fcs_dbm_queue_item_t * const extracted_item =
+                    level[derived->parent_idx];
+                const fcs_bool_t is_reversible = derived->is_reversible;
+                const unsigned char extra_move = derived->move;
+
+                if (!
+                    (
+                        is_reversible
+                        ?  (fc_solve_kaz_tree_lookup_value(
+                           traversed_states,
+                           &(derived->key)
+                           ) != NULL)
+                       : add_start_point(
+                           &(derived->key),
+                           start_state_moves_seq,
+                           &(extracted_item->moves_seq),
+                           extra_move,
+                           add_start_point_context
+                       )
+                    )
+                    && is_reversible
+                )
+                {
+                    fcs_fcc_moves_list_item_t * moves_list, * * end_moves_iter;
+                    int pos_in_moves;
+                    fcs_encoded_state_buffer_t * key_to_add;
 
+                    /* Allocate a new item. */
+                    if (queue_recycle_bin)
+                    {
+                        new_item = queue_recycle_bin;
+                        queue_recycle_bin = queue_recycle_bin->next;
+                    }
+                    else
+                    {
+                        new_item =
+                            (fcs_dbm_queue_item_t *)
+                            fcs_compact_alloc_ptr(
+                                &(queue_allocator),
+                                sizeof(*new_item)
+                            );
+                    }
+                    new_item->key = derived->key;
 
-            fcs_init_and_encode_state(
-                delta_stater,
-                local_variant,
-                &(derived_iter->state),
-                &(new_item->key)
-            );
+                    key_to_add =
+                        fcs_compact_alloc_ptr(
+                            &(traversed_states->dict_allocator),
+                            sizeof(*key_to_add)
+                        );
+                    *key_to_add = new_item->key;
 
-            extra_move = derived_iter->move;
-
-            if (!
-                (
-                    is_reversible
-                    ?  (fc_solve_kaz_tree_lookup_value(
-                       traversed_states,
-                       &(new_item->key)
-                       ) != NULL)
-                   : add_start_point(
-                       &(new_item->key),
-                       start_state_moves_seq,
-                       &(extracted_item->moves_seq),
-                       extra_move,
-                       add_start_point_context
-                   )
-                )
-            )
-            {
-                fcs_fcc_moves_list_item_t * moves_list, * * end_moves_iter;
-                int pos_in_moves;
-                fcs_encoded_state_buffer_t * key_to_add;
-
-                key_to_add =
-                    fcs_compact_alloc_ptr(
-                        &(traversed_states->dict_allocator),
-                        sizeof(*key_to_add)
-                    );
-                *key_to_add = new_item->key;
-
-                if (is_reversible)
-                {
                     fc_solve_kaz_tree_alloc_insert(
                         traversed_states,
                         key_to_add
                         );
-                }
 
-                /* Fill in the moves. */
-                end_moves_iter = &(moves_list);
-                pos_in_moves = 0;
+                    /* Fill in the moves. */
+                    end_moves_iter = &(moves_list);
+                    pos_in_moves = 0;
 
-                if (is_reversible)
-                {
-                    int copy_from_idx;
-                    fcs_fcc_moves_list_item_t const * copy_from_iter =
-                        extracted_item->moves_seq.moves_list;
-
-                    for(
-                        copy_from_idx = 0
-                        ;
-                        copy_from_idx < extracted_item->moves_seq.count
-                        ;
-                       )
                     {
-                        if (pos_in_moves % FCS_FCC_NUM_MOVES_IN_ITEM == 0)
-                        {
-                            (*end_moves_iter) = fc_solve_fcc_alloc_moves_list_item(moves_list_allocator);
-                        }
-                        (*end_moves_iter)->data.s[
-                            pos_in_moves % FCS_FCC_NUM_MOVES_IN_ITEM
-                            ] = copy_from_iter->data.s[
-                            copy_from_idx % FCS_FCC_NUM_MOVES_IN_ITEM
-                            ];
-                        if ((++pos_in_moves) % FCS_FCC_NUM_MOVES_IN_ITEM == 0)
-                        {
-                            end_moves_iter = &((*end_moves_iter)->next);
-                        }
-                        if ((++copy_from_idx) % FCS_FCC_NUM_MOVES_IN_ITEM == 0)
+                        int copy_from_idx;
+                        fcs_fcc_moves_list_item_t const * copy_from_iter =
+                            extracted_item->moves_seq.moves_list;
+
+                        for(
+                            copy_from_idx = 0
+                            ;
+                            copy_from_idx < extracted_item->moves_seq.count
+                            ;
+                           )
                         {
-                            copy_from_iter = copy_from_iter->next;
+                            if (pos_in_moves % FCS_FCC_NUM_MOVES_IN_ITEM == 0)
+                            {
+                                (*end_moves_iter) = fc_solve_fcc_alloc_moves_list_item(moves_list_allocator);
+                            }
+                            (*end_moves_iter)->data.s[
+                                pos_in_moves % FCS_FCC_NUM_MOVES_IN_ITEM
+                                ] = copy_from_iter->data.s[
+                                copy_from_idx % FCS_FCC_NUM_MOVES_IN_ITEM
+                                ];
+                            if ((++pos_in_moves) % FCS_FCC_NUM_MOVES_IN_ITEM == 0)
+                            {
+                                end_moves_iter = &((*end_moves_iter)->next);
+                            }
+                            if ((++copy_from_idx) % FCS_FCC_NUM_MOVES_IN_ITEM == 0)
+                            {
+                                copy_from_iter = copy_from_iter->next;
+                            }
                         }
                     }
 
@@ -424,58 +556,54 @@ static void perform_FCC_brfs(
                     new_item->moves_seq.count = pos_in_moves;
                     new_item->moves_seq.moves_list = moves_list;
 
-                    /* Enqueue the item in the queue. */
-                    new_item->next = NULL;
-                    if (queue_tail)
+                    /* Enqueue the item in the next level. */
+                    if (next_level_len == max_next_level_len)
                     {
-                        queue_tail = queue_tail->next = new_item;
+                        next_level = SREALLOC(next_level,
+                            max_next_level_len <<= 1);
                     }
-                    else
-                    {
-                        queue_head = queue_tail = new_item;
-                    }
-                }
-
-                /*
-                 * Allocate a new new_item.
-                 *
-                 * Note: we need to allocate it for both reversibles
-                 * and non-reversible moves because pointers to their keys are
-                 * kept inside the dict_t-s.
-                 * */
-                if (queue_recycle_bin)
-                {
-                    new_item = queue_recycle_bin;
-                    queue_recycle_bin = queue_recycle_bin->next;
-                }
-                else
-                {
-                    new_item =
-                        (fcs_dbm_queue_item_t *)
-                        fcs_compact_alloc_ptr(
-                            &(queue_allocator),
-                            sizeof(*new_item)
-                        );
+                    next_level[next_level_len++] = new_item;
                 }
             }
+        }
+
+        /* Clean up the resources of the expanded items. We no longer need
+         * them because we are interested only in those of the derived
+         * items. The start item is kept, because its key is in
+         * traversed_states.
+         * */
+        for (int idx = 0 ; idx < num_to_expand ; idx++)
+        {
+            fcs_dbm_queue_item_t * const extracted_item = level[idx];
 
-            /* Recycle derived_iter.  */
-            next_derived_iter = derived_iter->next;
-            derived_iter->next = derived_list_recycle_bin;
-            derived_list_recycle_bin = derived_iter;
+            fc_solve_fcc_release_moves_seq(
+                &(extracted_item->moves_seq),
+                moves_list_allocator
+            );
+            if (extracted_item != start_item)
+            {
+                extracted_item->next = queue_recycle_bin;
+                queue_recycle_bin = extracted_item;
+            }
         }
 
-        /* We always hold one new_item spare, so let's recycle it now. */
-        new_item->next = queue_recycle_bin;
-        queue_recycle_bin = new_item;
+        if (is_min_in_cache)
+        {
+            *is_min_by_sorting_new = FALSE;
+            goto free_resources;
+        }
 
-        /* Clean up the extracted_item's resources. We no longer need them
-         * because we are interested only in those of the derived items.
-         * */
-        fc_solve_fcc_release_moves_seq(
-            &(extracted_item->moves_seq),
-            moves_list_allocator
-        );
+        {
+            fcs_dbm_queue_item_t * * const swap_level = level;
+            level = next_level;
+            next_level = swap_level;
+        }
+        {
+            const int swap_len = max_level_len;
+            max_level_len = max_next_level_len;
+            max_next_level_len = swap_len;
+        }
+        level_len = next_level_len;
     }
 
     if ((*is_min_by_sorting_new =
@@ -492,9 +620,14 @@ static void perform_FCC_brfs(
 
     /* Free the allocated resources. */
 free_resources:
+    for (int t = 0 ; t < num_threads_inited ; t++)
+    {
+        fcs_fcc_brfs_thread__destroy(&(threads[t]));
+    }
+    free(threads);
+    free(level);
+    free(next_level);
     fc_solve_compact_allocator_finish(&(queue_allocator));
-    fc_solve_compact_allocator_finish(&(derived_list_allocator));
-    fc_solve_delta_stater_free(delta_stater);
     fc_solve_kaz_tree_destroy(traversed_states);
 }
 
@@ -182,7 +182,8 @@ DLLEXPORT int fc_solve_user_INTERNAL_find_fcc_start_points(
         &does_state_exist_in_any_FCC_cache,
         out_num_new_positions,
         &moves_list_allocator,
-        &meta_alloc
+        &meta_alloc,
+        1
     );
 
     iter = start_points_list.list;
@@ -401,7 +402,8 @@ DLLEXPORT int fc_solve_user_INTERNAL_is_fcc_new(
             &does_state_exist_in_any_FCC_cache,
             &num_new_positions_temp,
             &moves_list_allocator,
-            &meta_alloc
+            &meta_alloc,
+            1
         );
     }
 
@@ -55,6 +55,8 @@
 
 #include "dbm_lru_cache.h"
 #include "fcc_brfs.h"
+#include "dbm_metrics.h"
+#include "dbm_checkpoint.h"
 
 typedef struct fcs_fully_connected_component_struct
 {
@@ -108,6 +110,13 @@ typedef struct {
     long num_FCCs_processed_for_depth;
     long num_unique_FCCs_for_depth;
     enum fcs_dbm_variant_type_t variant;
+    int num_threads;
+    fcs_dbm_metrics_t metrics;
+    /* The cache is reset at every depth, so its statistics are summed
+     * here. */
+    long num_cache_hits, num_cache_misses;
+    int num_depths_reached;
+    long num_FCCs_by_depth[MAX_FCC_DEPTH];
 } fcs_dbm_solver_instance_t;
 
 static GCC_INLINE void instance_init(
@@ -116,6 +125,7 @@ static GCC_INLINE void instance_init(
     long max_processed_positions_count,
     long positions_milestone_step,
     long FCCs_per_depth_milestone_step,
+    int num_threads,
     FILE * out_fh
 )
 {
@@ -124,14 +134,21 @@ static GCC_INLINE void instance_init(
     instance->max_processed_positions_count = max_processed_positions_count;
     instance->positions_milestone_step = positions_milestone_step;
     instance->FCCs_per_depth_milestone_step = FCCs_per_depth_milestone_step;
+    instance->num_threads = num_threads;
     instance->out_fh = out_fh;
+    fcs_dbm_metrics__init(&(instance->metrics));
+    fcs_dbm_metrics__alloc_slots(&(instance->metrics), 1);
+    instance->num_cache_hits = instance->num_cache_misses = 0;
+    instance->num_depths_reached = 0;
+    memset(instance->num_FCCs_by_depth, '\0',
+        sizeof(instance->num_FCCs_by_depth));
 }
 
 static GCC_INLINE void instance_destroy(
     fcs_dbm_solver_instance_t * instance
     )
 {
-    return;
+    fcs_dbm_metrics__destroy(&(instance->metrics));
 }
 
 typedef struct {
@@ -255,6 +272,27 @@ static void instance_time_printf(
     fflush(fh);
 }
 
+/* The depth counts are the number of FCCs that were processed for every
+ * depth. */
+static void instance_export_metrics(
+    fcs_dbm_solver_instance_t * const instance
+)
+{
+    fcs_dbm_metrics_sample_t sample;
+    const fcs_lru_cache_t * const cache = &(instance->solver_state.cache);
+
+    sample.num_processed = instance->count_num_processed;
+    sample.num_states_in_collection = -1;
+    sample.num_items_in_queue = sample.num_items_in_memory = -1;
+    sample.num_cache_hits = instance->num_cache_hits + cache->num_hits;
+    sample.num_cache_misses = instance->num_cache_misses + cache->num_misses;
+    sample.depth = instance->num_depths_reached - 1;
+    sample.num_depths = instance->num_depths_reached;
+    sample.depth_counts = instance->num_FCCs_by_depth;
+
+    fcs_dbm_metrics__export(&(instance->metrics), &sample);
+}
+
 #define STEP (instance->positions_milestone_step)
 
 static GCC_INLINE void instance_print_processed_FCCs(
@@ -415,7 +453,8 @@ static fcc_status_t instance_run_solver(
                 cache,
                 &num_new_positions,
                 moves_list_allocator,
-                meta_alloc
+                meta_alloc,
+                instance->num_threads
             );
 
             start_point_iter = next_start_points_list.list;
@@ -431,10 +470,21 @@ static fcc_status_t instance_run_solver(
             {
                 instance_print_processed_FCCs(instance);
             }
+            instance->num_FCCs_by_depth[curr_depth] =
+                instance->num_FCCs_processed_for_depth;
+            instance->num_depths_reached = curr_depth + 1;
 
             if (num_new_positions)
             {
-                if ((instance->count_num_processed += num_new_positions) >= next_count_num_processed_landmark)
+                fcs_dbm_metrics__add_processed(
+                    &(instance->metrics.slots[0]), num_new_positions
+                );
+                instance->count_num_processed += num_new_positions;
+                if (fcs_dbm_metrics__is_interval_over(&(instance->metrics)))
+                {
+                    instance_export_metrics(instance);
+                }
+                if (instance->count_num_processed >= next_count_num_processed_landmark)
                 {
                     instance_print_reached(instance);
                     next_count_num_processed_landmark = instance->count_num_processed;
@@ -643,6 +693,8 @@ fcc_loop_cleanup:
         /* -> Refresh the cache, because it may hold pointers that are
          * out-of-date.
          * */
+        instance->num_cache_hits += cache->num_hits;
+        instance->num_cache_misses += cache->num_misses;
         cache_destroy(cache);
         cache_init (cache, max_num_elements_in_cache, meta_alloc);
         /*
@@ -696,6 +748,8 @@ int main(int argc, char * argv[])
     fcs_fcc_moves_seq_allocator_t moves_list_allocator;
     fcs_compact_allocator_t moves_list_compact_alloc;
     fcs_meta_compact_allocator_t meta_alloc;
+    const char * metrics_path = NULL;
+    double metrics_interval = FCS_DBM_METRICS_DEFAULT_INTERVAL;
     DECLARE_IND_BUF_T(init_indirect_stacks_buffer)
 
     local_variant = FCS_DBM_VARIANT_2FC_FREECELL;
@@ -761,6 +815,31 @@ int main(int argc, char * argv[])
             }
             FCCs_per_depth_milestone_step = atol(argv[arg]);
         }
+        else if (!strcmp(argv[arg], "--metrics-output"))
+        {
+            arg++;
+            if (arg == argc)
+            {
+                fprintf(stderr, "--metrics-output came without an argument.\n");
+                exit(-1);
+            }
+            metrics_path = argv[arg];
+        }
+        else if (!strcmp(argv[arg], "--metrics-interval"))
+        {
+            arg++;
+            if (arg == argc)
+            {
+                fprintf(stderr, "--metrics-interval came without an argument.\n");
+                exit(-1);
+            }
+            metrics_interval = atof(argv[arg]);
+            if (metrics_interval <= 0)
+            {
+                fprintf(stderr, "--metrics-interval must be positive.\n");
+                exit(-1);
+            }
+        }
         else if (!strcmp(argv[arg], "--num-threads"))
         {
             arg++;
@@ -778,6 +857,7 @@ int main(int argc, char * argv[])
         }
         else
         {
+            fcs_dbm_checkpoint__reject_option(argv[arg], "fcc_fc_solver");
             break;
         }
     }
@@ -814,8 +894,14 @@ int main(int argc, char * argv[])
         max_processed_positions_count,
         positions_milestone_step,
         FCCs_per_depth_milestone_step,
+        num_threads,
         out_fh
     );
+    if (metrics_path)
+    {
+        fcs_dbm_metrics__open(&(instance.metrics), metrics_path,
+            metrics_interval);
+    }
     fh = fopen(filename, "r");
     if (fh == NULL)
     {
@@ -919,6 +1005,7 @@ int main(int argc, char * argv[])
         &instance,
         "{FINAL} Reached %li positions in total.\n", instance.count_num_processed
         );
+    instance_export_metrics(&instance);
 
     instance_destroy(&instance);
 
@@ -96,6 +96,7 @@ enum
 #define FCS_METHOD_OPTIMIZE 4
 #define FCS_METHOD_RANDOM_DFS 5
 #define FCS_METHOD_PATSOLVE 6
+#define FCS_METHOD_OPTIMAL_A_STAR 7
 
 #define FCS_NUM_BEFS_WEIGHTS 6
 
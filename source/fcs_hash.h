@@ -192,14 +192,20 @@ static GCC_INLINE void fc_solve_hash_free(
     hash->entries = NULL;
 }
 
-static GCC_INLINE void fc_solve_hash_foreach(
+/*
+ * Like fc_solve_hash_foreach() only goes over the buckets in the range
+ * [start, end), so a sweep over a large hash can be split into several
+ * steps.
+ * */
+static GCC_INLINE void fc_solve_hash_foreach_in_range(
     fc_solve_hash_t * const hash,
+    const int start,
+    const int end,
     const fcs_bool_t (*should_delete_ptr)(void * const key, void * const context),
     void * const context
     )
 {
-    const typeof(hash->size) size = hash->size;
-    for (int i = 0 ; i < size ; i++)
+    for (int i = start ; i < end ; i++)
     {
         fc_solve_hash_symlink_item_t * * item = &(hash->entries[i].first_item);
         while ((*item) != NULL)
@@ -224,6 +230,17 @@ static GCC_INLINE void fc_solve_hash_foreach(
     }
 }
 
+static GCC_INLINE void fc_solve_hash_foreach(
+    fc_solve_hash_t * const hash,
+    const fcs_bool_t (*should_delete_ptr)(void * const key, void * const context),
+    void * const context
+    )
+{
+    fc_solve_hash_foreach_in_range(
+        hash, 0, hash->size, should_delete_ptr, context
+    );
+}
+
 #ifdef __cplusplus
 }
 #endif
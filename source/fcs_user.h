@@ -263,6 +263,63 @@ DLLEXPORT extern void freecell_solver_set_stored_states_trimming_limit(
     long max_num_states
     );
 
+DLLEXPORT extern void freecell_solver_user_set_transposition_table_size(
+    void * user_instance,
+    long num_entries
+    );
+
+/*
+ * dfs_split is a pointer to an fcs_dfs_split_t (see dfs_split.h) that is
+ * shared with the other instances that solve the same board.
+ * */
+DLLEXPORT extern void freecell_solver_user_set_dfs_split(
+    void * user_instance,
+    void * dfs_split
+    );
+
+/*
+ * Loads the endgame database from filename (see endgame_db_gen.c). It is
+ * ignored if it was generated for a different variant.
+ * */
+DLLEXPORT extern int freecell_solver_user_set_endgame_db(
+    void * user_instance,
+    const char * filename,
+    char * * error_string
+    );
+
+/*
+ * Loads the pattern database of the optimal A* scans from filename (see
+ * pattern_db_gen.c).
+ * */
+DLLEXPORT extern int freecell_solver_user_set_pattern_db(
+    void * user_instance,
+    const char * filename,
+    char * * error_string
+    );
+
+/*
+ * Opens (or creates) the persistent solution cache in filename. The boards
+ * that are found there are answered without solving them, and the
+ * solutions of the others are appended to it. config_id identifies the
+ * configuration of the solver (e.g: its command line), and the solutions
+ * are only shared by the instances with the same config_id and variant.
+ * */
+DLLEXPORT extern int freecell_solver_user_set_solution_cache(
+    void * user_instance,
+    const char * filename,
+    const char * config_id,
+    char * * error_string
+    );
+
+/*
+ * Sets the config_id of the solution cache after it was opened - e.g: once
+ * the whole command line was parsed.
+ * */
+DLLEXPORT extern void freecell_solver_user_set_solution_cache_config_id(
+    void * user_instance,
+    const char * config_id
+    );
+
 DLLEXPORT extern int freecell_solver_user_next_soft_thread(
     void * user_instance
     );
@@ -379,6 +436,11 @@ DLLEXPORT extern int freecell_solver_user_set_pruning(
     char * * error_string
     );
 
+DLLEXPORT extern void freecell_solver_user_set_adaptive_tests_order(
+    void * user_instance,
+    long interval
+    );
+
 DLLEXPORT extern int freecell_solver_user_set_cache_limit(
     void * user_instance,
     long limit
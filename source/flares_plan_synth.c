@@ -0,0 +1,286 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ *  flares_plan_synth.c - synthesises a flares plan (see --flares-plan in
+ *  USAGE.txt) out of the binary outputs of
+ *  freecell-solver-range-parallel-solve, each of which records the
+ *  iterations one of the flares needs to solve the boards when it is
+ *  run on its own, e.g:
+ *
+ *      freecell-solver-range-parallel-solve 1 1000 1000 \
+ *          --binary-output-to foo.bin --total-iterations-limit 100000 \
+ *          [fc-solve arguments] --flares-plan "RunIndef:foo"
+ *
+ *  See also:
+ *      - flares_plan_synth.h
+ *      - befs_weights_tuner.c
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alloc_wrap.h"
+#include "portable_int64.h"
+#include "bool.h"
+
+#include "flares_plan_synth.h"
+
+static void print_help(void)
+{
+    printf("\n%s",
+"freecell-solver-flares-plan-synth [--quota-unit q] [--percentile p]\n"
+"   flare_name binary_output_file [flare_name binary_output_file ...]\n"
+"\n"
+"Synthesises a flares plan out of the iterations each flare needs to solve\n"
+"the boards of a training set, as recorded by the --binary-output-to\n"
+"option of freecell-solver-range-parallel-solve when run with\n"
+"--flares-plan \"RunIndef:flare_name\". All the files must start at the\n"
+"same board.\n"
+"\n"
+"--quota-unit q\n"
+"     The quotas of the plan are multiples of q (default: 100).\n"
+"--percentile p\n"
+"     Minimise the iterations of the board at the p-th percentile instead\n"
+"     of the total iterations.\n"
+          );
+}
+
+static int read_int(FILE * f, int * dest)
+{
+    unsigned char buffer[4];
+
+    if (fread(buffer, 1, 4, f) != 4)
+    {
+        return 1;
+    }
+    *dest = (buffer[0]+((buffer[1]+((buffer[2]+((buffer[3])<<8))<<8))<<8));
+
+    return 0;
+}
+
+/*
+ * Reads the iterations of a binary output to *iters and returns the
+ * number of boards. The intractable (-1) and unsolved (-2) boards are
+ * both read as -1.
+ * */
+static int read_binary_output(
+    const char * const filename,
+    int * const start_board,
+    long * * const iters
+)
+{
+    FILE * const f = fopen(filename, "rb");
+    if (! f)
+    {
+        fprintf(stderr, "Could not open \"%s\" for reading!\n", filename);
+        exit(-1);
+    }
+    int end_board, limit;
+    if (read_int(f, start_board) || read_int(f, &end_board)
+        || read_int(f, &limit))
+    {
+        fprintf(stderr, "\"%s\" is too short to deduce the configuration!\n",
+            filename);
+        exit(-1);
+    }
+
+    int num_boards = 0;
+    int max_num_boards = 1024;
+    *iters = SMALLOC(*iters, max_num_boards);
+    int val;
+    while (! read_int(f, &val))
+    {
+        if (num_boards == max_num_boards)
+        {
+            max_num_boards <<= 1;
+            *iters = SREALLOC(*iters, max_num_boards);
+        }
+        (*iters)[num_boards++] = ((val < 0) ? -1 : val);
+    }
+    fclose(f);
+
+    return num_boards;
+}
+
+static void print_summary(
+    const char * const title,
+    const fcs_flares_plan_synth_table_t * const table,
+    const fcs_flares_plan_synth_plan_t * const plan,
+    const double percentile
+)
+{
+    long * const board_iters = SMALLOC(board_iters, table->num_boards);
+    const fcs_int64_t total =
+        fc_solve_flares_plan_synth__eval(table, plan, board_iters);
+    int num_solved = 0;
+    for (int b = 0 ; b < table->num_boards ; b++)
+    {
+        num_solved += (board_iters[b] >= 0);
+    }
+    const long at_percentile =
+        fc_solve_flares_plan_synth__get_percentile(
+            board_iters, table->num_boards, percentile);
+
+    printf("%s: solved %d out of %d boards with " FCS_INT64_FORMAT
+        " iterations ; %g%% of the boards took ",
+        title, num_solved, table->num_boards, total, percentile);
+    if (at_percentile < 0)
+    {
+        printf("%s", "more than the plan\n");
+    }
+    else
+    {
+        printf("%ld iterations or less\n", at_percentile);
+    }
+    free(board_iters);
+}
+
+int main(int argc, char * argv[])
+{
+    long quota_unit = 100;
+    double percentile = 0;
+
+    int arg = 1;
+    for (; arg < argc ; arg++)
+    {
+        if ((!strcmp(argv[arg], "--quota-unit"))
+            || (!strcmp(argv[arg], "--percentile")))
+        {
+            if (arg + 1 == argc)
+            {
+                fprintf(stderr, "%s came without an argument!\n", argv[arg]);
+                print_help();
+                exit(-1);
+            }
+            if (argv[arg][2] == 'q')
+            {
+                quota_unit = atol(argv[++arg]);
+            }
+            else
+            {
+                percentile = atof(argv[++arg]);
+            }
+        }
+        else if ((!strcmp(argv[arg], "--help")) || (!strcmp(argv[arg], "-h")))
+        {
+            print_help();
+            exit(0);
+        }
+        else
+        {
+            break;
+        }
+    }
+    if ((quota_unit <= 0) || (percentile < 0) || (percentile > 100))
+    {
+        fprintf(stderr, "%s", "The quota unit must be greater than 0 and the"
+            " percentile between 0 and 100.\n");
+        exit(-1);
+    }
+    if ((arg == argc) || ((argc - arg) % 2 != 0))
+    {
+        fprintf(stderr, "%s", "Expecting pairs of flare names and files!\n");
+        print_help();
+        exit(-1);
+    }
+
+    fcs_flares_plan_synth_table_t table;
+    table.num_flares = (argc - arg) / 2;
+    table.num_boards = -1;
+    char * * const names = argv + arg;
+    long * * const flares_iters = SMALLOC(flares_iters, table.num_flares);
+    int first_start_board = 0;
+    for (int f = 0 ; f < table.num_flares ; f++)
+    {
+        int start_board;
+        const int num_boards =
+            read_binary_output(names[f * 2 + 1], &start_board, &flares_iters[f]);
+        if (f == 0)
+        {
+            first_start_board = start_board;
+        }
+        else if (start_board != first_start_board)
+        {
+            fprintf(stderr, "\"%s\" does not start at board No. %d!\n",
+                names[f * 2 + 1], first_start_board);
+            exit(-1);
+        }
+        /* Only the boards that all the flares went over are used. */
+        if ((table.num_boards < 0) || (num_boards < table.num_boards))
+        {
+            table.num_boards = num_boards;
+        }
+    }
+    if (table.num_boards == 0)
+    {
+        fprintf(stderr, "%s", "There are no boards to train on!\n");
+        exit(-1);
+    }
+
+    table.iters = SMALLOC(table.iters, table.num_flares * table.num_boards);
+    for (int f = 0 ; f < table.num_flares ; f++)
+    {
+        memcpy(&(FCS_FLARES_PLAN_SYNTH_ITERS(&table, f, 0)), flares_iters[f],
+            sizeof(table.iters[0]) * table.num_boards);
+        free(flares_iters[f]);
+    }
+    free(flares_iters);
+
+    fcs_flares_plan_synth_plan_t plan;
+    fc_solve_flares_plan_synth(&table, quota_unit, percentile, &plan);
+
+    printf("%s", "--flares-plan \"");
+    for (int i = 0 ; i < plan.num_items ; i++)
+    {
+        printf("%sRun:%ld@%s,CP:", (i ? "," : ""), plan.items[i].quota,
+            names[plan.items[i].flare * 2]);
+    }
+    printf("%s", "\"\n");
+
+    const double summary_percentile = ((percentile > 0) ? percentile : 90);
+    print_summary("The plan", &table, &plan, summary_percentile);
+
+    /* Compare it to running each of the flares on its own. */
+    for (int f = 0 ; f < table.num_flares ; f++)
+    {
+        fcs_flares_plan_synth_item_t item = {.flare = f, .quota = 0};
+        for (int b = 0 ; b < table.num_boards ; b++)
+        {
+            const long iters = FCS_FLARES_PLAN_SYNTH_ITERS(&table, f, b);
+            if (iters > item.quota)
+            {
+                item.quota = iters;
+            }
+        }
+        const fcs_flares_plan_synth_plan_t single = {.items = &item, .num_items = 1};
+        char title[1024];
+        snprintf(title, sizeof(title), "Flare \"%s\" on its own", names[f * 2]);
+        print_summary(title, &table, &single, summary_percentile);
+    }
+
+    free(plan.items);
+    free(table.iters);
+
+    return 0;
+}
@@ -0,0 +1,395 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * flares_plan_synth.h - synthesises a flares plan out of the iterations
+ * each flare needs to solve the boards of a training set when run on its
+ * own (see freecell-solver-range-parallel-solve's --binary-output-to).
+ *
+ * Since the flares are resumed between the items of the plan, a board is
+ * solved by the first item in which the iterations allotted so far to one
+ * of the flares reach the iterations it needs. The plan is built greedily
+ * (as in the classic meta-scan/atomic quotas optimisation): each item
+ * extends the flare, by a multiple of the quota unit, that solves the
+ * most boards per iteration spent on all the boards that are still
+ * unsolved.
+ */
+#ifndef FC_SOLVE__FLARES_PLAN_SYNTH_H
+#define FC_SOLVE__FLARES_PLAN_SYNTH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdlib.h>
+
+#include "alloc_wrap.h"
+#include "portable_int64.h"
+#include "inline.h"
+#include "bool.h"
+
+typedef struct
+{
+    int num_flares;
+    int num_boards;
+    /*
+     * iters[flare * num_boards + board] is the number of iterations the
+     * flare needs to solve the board, or -1 if it did not solve it.
+     * */
+    long * iters;
+} fcs_flares_plan_synth_table_t;
+
+typedef struct
+{
+    int flare;
+    long quota;
+} fcs_flares_plan_synth_item_t;
+
+typedef struct
+{
+    fcs_flares_plan_synth_item_t * items;
+    int num_items;
+} fcs_flares_plan_synth_plan_t;
+
+#define FCS_FLARES_PLAN_SYNTH_ITERS(table, flare, board) \
+    ((table)->iters[(flare) * (table)->num_boards + (board)])
+
+typedef struct
+{
+    long iters;
+    int board;
+} fcs_flares_plan_synth_board_t;
+
+static GCC_INLINE int fc_solve_flares_plan_synth__compare_boards(
+    const void * const a,
+    const void * const b
+)
+{
+    const long ia = ((const fcs_flares_plan_synth_board_t *)a)->iters;
+    const long ib = ((const fcs_flares_plan_synth_board_t *)b)->iters;
+    return ((ia < ib) ? -1 : (ia > ib) ? 1 : 0);
+}
+
+/*
+ * Builds the plan greedily. Until percentile_target boards are solved, the
+ * items are chosen by the boards they solve per iteration of the plan
+ * (which is what the boards at that percentile pay), and then by the boards
+ * they solve per iteration spent on all the unsolved boards.
+ * */
+static GCC_INLINE void fc_solve_flares_plan_synth__greedy(
+    const fcs_flares_plan_synth_table_t * const table,
+    const long quota_unit,
+    const int percentile_target,
+    fcs_flares_plan_synth_plan_t * const plan
+)
+{
+    const int num_flares = table->num_flares;
+    const int num_boards = table->num_boards;
+
+    /* The boards each flare solves, sorted by their iterations. */
+    fcs_flares_plan_synth_board_t * const sorted =
+        SMALLOC(sorted, num_flares * num_boards + 1);
+    int * const num_sorted = SMALLOC(num_sorted, num_flares + 1);
+    for (int f = 0 ; f < num_flares ; f++)
+    {
+        fcs_flares_plan_synth_board_t * const flare_sorted =
+            &(sorted[f * num_boards]);
+        num_sorted[f] = 0;
+        for (int b = 0 ; b < num_boards ; b++)
+        {
+            const long iters = FCS_FLARES_PLAN_SYNTH_ITERS(table, f, b);
+            if (iters >= 0)
+            {
+                flare_sorted[num_sorted[f]].iters = iters;
+                flare_sorted[num_sorted[f]].board = b;
+                num_sorted[f]++;
+            }
+        }
+        qsort(flare_sorted, num_sorted[f], sizeof(flare_sorted[0]),
+            fc_solve_flares_plan_synth__compare_boards);
+    }
+
+    fcs_bool_t * const is_solved = SMALLOC(is_solved, num_boards + 1);
+    for (int b = 0 ; b < num_boards ; b++)
+    {
+        is_solved[b] = FALSE;
+    }
+    long * const allotted = SMALLOC(allotted, num_flares + 1);
+    for (int f = 0 ; f < num_flares ; f++)
+    {
+        allotted[f] = 0;
+    }
+
+    int num_solved = 0;
+    int max_num_items = 16;
+    plan->items = SMALLOC(plan->items, max_num_items);
+    plan->num_items = 0;
+
+    while (TRUE)
+    {
+        const fcs_bool_t minimise_length = (num_solved < percentile_target);
+        int best_flare = -1;
+        long best_extension = 0;
+        double best_ratio = 0;
+
+        for (int f = 0 ; f < num_flares ; f++)
+        {
+            const fcs_flares_plan_synth_board_t * const flare_sorted =
+                &(sorted[f * num_boards]);
+            int num_newly_solved = 0;
+            fcs_int64_t newly_solved_cost = 0;
+
+            /* Only the extensions that end at a multiple of the quota unit
+             * right after the iterations of a board are worth checking,
+             * because the cost grows with no more boards being solved in
+             * between. */
+            for (int i = 0 ; i < num_sorted[f] ; )
+            {
+                if (is_solved[flare_sorted[i].board])
+                {
+                    i++;
+                    continue;
+                }
+                const long remaining = flare_sorted[i].iters - allotted[f];
+                const long extension = ((remaining > quota_unit)
+                    ? ((remaining + quota_unit - 1) / quota_unit * quota_unit)
+                    : quota_unit
+                );
+                for ( ; i < num_sorted[f] ; i++)
+                {
+                    if (is_solved[flare_sorted[i].board])
+                    {
+                        continue;
+                    }
+                    const long nb_remaining = flare_sorted[i].iters - allotted[f];
+                    if (nb_remaining > extension)
+                    {
+                        break;
+                    }
+                    num_newly_solved++;
+                    newly_solved_cost += nb_remaining;
+                }
+                const double cost =
+                    (minimise_length
+                     ? (double)extension
+                     : (double)(newly_solved_cost +
+                         (fcs_int64_t)(num_boards - num_solved - num_newly_solved)
+                         * extension)
+                    );
+                const double ratio = num_newly_solved / cost;
+                if (ratio > best_ratio)
+                {
+                    best_ratio = ratio;
+                    best_flare = f;
+                    best_extension = extension;
+                }
+            }
+        }
+
+        if (best_flare < 0)
+        {
+            break;
+        }
+
+        const long * const best_iters =
+            &(FCS_FLARES_PLAN_SYNTH_ITERS(table, best_flare, 0));
+        for (int b = 0 ; b < num_boards ; b++)
+        {
+            if ((! is_solved[b]) && (best_iters[b] >= 0)
+                && (best_iters[b] <= allotted[best_flare] + best_extension))
+            {
+                is_solved[b] = TRUE;
+                num_solved++;
+            }
+        }
+        allotted[best_flare] += best_extension;
+
+        if ((plan->num_items > 0)
+            && (plan->items[plan->num_items-1].flare == best_flare))
+        {
+            plan->items[plan->num_items-1].quota += best_extension;
+        }
+        else
+        {
+            if (plan->num_items == max_num_items)
+            {
+                max_num_items <<= 1;
+                plan->items = SREALLOC(plan->items, max_num_items);
+            }
+            plan->items[plan->num_items].flare = best_flare;
+            plan->items[plan->num_items].quota = best_extension;
+            plan->num_items++;
+        }
+    }
+
+    free(sorted);
+    free(num_sorted);
+    free(is_solved);
+    free(allotted);
+}
+
+/*
+ * Runs the plan on the boards of the table, with a checkpoint after
+ * every item, and puts the iterations of every board in board_iters
+ * (or -1 if the plan did not solve it). Returns the total iterations of
+ * the solved boards.
+ * */
+static GCC_INLINE fcs_int64_t fc_solve_flares_plan_synth__eval(
+    const fcs_flares_plan_synth_table_t * const table,
+    const fcs_flares_plan_synth_plan_t * const plan,
+    long * const board_iters
+)
+{
+    long * const allotted = SMALLOC(allotted, table->num_flares + 1);
+    fcs_int64_t total = 0;
+
+    for (int b = 0 ; b < table->num_boards ; b++)
+    {
+        for (int f = 0 ; f < table->num_flares ; f++)
+        {
+            allotted[f] = 0;
+        }
+        long iters = 0;
+        board_iters[b] = -1;
+        for (int i = 0 ; i < plan->num_items ; i++)
+        {
+            const int f = plan->items[i].flare;
+            const long quota = plan->items[i].quota;
+            const long needed = FCS_FLARES_PLAN_SYNTH_ITERS(table, f, b);
+            if ((needed >= 0) && (needed <= allotted[f] + quota))
+            {
+                board_iters[b] = iters + (needed - allotted[f]);
+                total += board_iters[b];
+                break;
+            }
+            iters += quota;
+            allotted[f] += quota;
+        }
+    }
+
+    free(allotted);
+
+    return total;
+}
+
+static GCC_INLINE int fc_solve_flares_plan_synth__compare_board_iters(
+    const void * const a,
+    const void * const b
+)
+{
+    const long ia = *(const long *)a;
+    const long ib = *(const long *)b;
+    /* The unsolved boards come last. */
+    if ((ia < 0) || (ib < 0))
+    {
+        return ((ia < 0) - (ib < 0));
+    }
+    return ((ia < ib) ? -1 : (ia > ib) ? 1 : 0);
+}
+
+static GCC_INLINE int fc_solve_flares_plan_synth__calc_percentile_target(
+    const int num_boards,
+    const double percentile
+)
+{
+    return (int)(percentile * num_boards / 100 + 0.999);
+}
+
+/*
+ * Returns the iterations of the board at the percentile, or -1 if it was
+ * not solved. Sorts board_iters.
+ * */
+static GCC_INLINE long fc_solve_flares_plan_synth__get_percentile(
+    long * const board_iters,
+    const int num_boards,
+    const double percentile
+)
+{
+    qsort(board_iters, num_boards, sizeof(board_iters[0]),
+        fc_solve_flares_plan_synth__compare_board_iters);
+    const int idx = fc_solve_flares_plan_synth__calc_percentile_target(
+        num_boards, percentile) - 1;
+    return board_iters[(idx < 0) ? 0 : idx];
+}
+
+/*
+ * Computes the plan for the table. The quotas are multiples of quota_unit.
+ *
+ * If percentile is greater than 0, the plan minimises the iterations of
+ * the board at the percentile (out of the greedy plan for it and the one
+ * for the total iterations), and otherwise the total iterations.
+ *
+ * The plan ends when none of the flares can solve any more of the boards
+ * and the caller should free plan->items.
+ * */
+static GCC_INLINE void fc_solve_flares_plan_synth(
+    const fcs_flares_plan_synth_table_t * const table,
+    const long quota_unit,
+    const double percentile,
+    fcs_flares_plan_synth_plan_t * const plan
+)
+{
+    fc_solve_flares_plan_synth__greedy(table, quota_unit, 0, plan);
+    if (percentile <= 0)
+    {
+        return;
+    }
+
+    fcs_flares_plan_synth_plan_t percentile_plan;
+    fc_solve_flares_plan_synth__greedy(table, quota_unit,
+        fc_solve_flares_plan_synth__calc_percentile_target(
+            table->num_boards, percentile),
+        &percentile_plan);
+
+    long * const board_iters = SMALLOC(board_iters, table->num_boards);
+    long results[2];
+    fcs_int64_t totals[2];
+    const fcs_flares_plan_synth_plan_t * const plans[2] =
+        {plan, &percentile_plan};
+    for (int i = 0 ; i < 2 ; i++)
+    {
+        totals[i] =
+            fc_solve_flares_plan_synth__eval(table, plans[i], board_iters);
+        results[i] = fc_solve_flares_plan_synth__get_percentile(
+            board_iters, table->num_boards, percentile);
+    }
+    free(board_iters);
+
+    const int cmp = fc_solve_flares_plan_synth__compare_board_iters(
+        &results[1], &results[0]);
+    if ((cmp < 0) || ((cmp == 0) && (totals[1] < totals[0])))
+    {
+        free(plan->items);
+        *plan = percentile_plan;
+    }
+    else
+    {
+        free(percentile_plan.items);
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FC_SOLVE__FLARES_PLAN_SYNTH_H */
@@ -44,6 +44,23 @@ typedef void * dict_key_t;
 #define fc_solve_kaz_tree_delete_by_value(tree, value) avl_delete(tree, value)
 #define fc_solve_kaz_tree_alloc_insert(tree, value) avl_insert(tree, value)
 #define dict_allocator avl_allocator
+#elif defined(FCS_DBM_USE_BPTREE)
+
+#include "bp_tree.h"
+
+/*
+ * The B+tree is keyed on the encoded state at the start of the items,
+ * which is what all the comparators of the DBM trees compare.
+ * */
+typedef fcs_bp_tree_t dict_t;
+typedef void * dict_key_t;
+#define fc_solve_kaz_tree_destroy(tree) fc_solve_bp_tree_destroy(tree)
+/* The B+tree frees its own nodes, so the recycle bin of the callers is
+ * not used. */
+#define fc_solve_kaz_tree_create(comparator, context, meta, recycle_bin_ptr) ((void)(comparator), (void)(recycle_bin_ptr), fc_solve_bp_tree_create(meta))
+#define fc_solve_kaz_tree_lookup_value(tree, value) fc_solve_bp_tree_lookup(tree, value)
+#define fc_solve_kaz_tree_delete_by_value(tree, value) fc_solve_bp_tree_delete(tree, value)
+#define fc_solve_kaz_tree_alloc_insert(tree, value) fc_solve_bp_tree_insert(tree, value)
 #else
 
 #include "inline.h"
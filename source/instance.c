@@ -326,6 +326,7 @@ void fc_solve_init_soft_thread(
     soft_thread->name[0] = '\0';
 
     soft_thread->enable_pruning = FALSE;
+    soft_thread->adaptive_tests_order_interval = 0;
 
 #ifndef FCS_DISABLE_PATSOLVE
     soft_thread->pats_scan = NULL;
@@ -736,6 +737,17 @@ void fc_solve_finish_instance( fc_solve_instance_t * const instance )
 #endif
 
     instance->num_states_in_collection = 0;
+    instance->active_num_states_in_collection = 0;
+
+    /* The vacant states were allocated from the compact allocator, which
+     * is recycled along with the instance. */
+    instance->list_of_vacant_states = NULL;
+    instance->trimming.is_active = FALSE;
+    free(instance->trimming.dead_ends);
+    instance->trimming.dead_ends = NULL;
+    instance->trimming.num_dead_ends = instance->trimming.max_num_dead_ends = 0;
+    instance->trimming.next_trim_at = 0;
+    fc_solve_tt_free(&(instance->transposition_table));
 
 #if (FCS_STATE_STORAGE == FCS_STATE_STORAGE_DB_FILE)
     instance->db->close(instance->db,0);
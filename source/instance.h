@@ -114,6 +114,10 @@ extern "C" {
 #endif
 
 #include "pqueue.h"
+#include "transposition_table.h"
+#include "dfs_split.h"
+#include "endgame_db.h"
+#include "pattern_db.h"
 
 #include "meta_alloc.h"
 
@@ -440,6 +444,19 @@ typedef struct {
     pq_rating_t rating;
 } fcs_rating_with_index_t;
 
+/*
+ * The statistics of a test for the adaptive tests order (see
+ * --adaptive-tests-order in USAGE.txt). Every derived state of the test
+ * that the Soft-DFS entered is counted once - as a reward if the scan
+ * went FCS_ADAPTIVE_TESTS_ORDER_PLIES deeper below it, and as a failure
+ * if it backtracked from it before that.
+ * */
+typedef struct {
+    fcs_int_limit_t num_pulls, num_rewards;
+} fcs_adaptive_test_stats_t;
+
+#define FCS_ADAPTIVE_TESTS_ORDER_PLIES 4
+
 typedef struct
 {
     fcs_collectible_state_t * state;
@@ -452,6 +469,15 @@ typedef struct
     char * positions_by_rank;
     fcs_game_limit_t num_vacant_stacks;
     fcs_game_limit_t num_vacant_freecells;
+    /*
+     * For the adaptive tests order: the order of the tests of
+     * tests_list_index as of when this state started them, the statistics
+     * of the test that generated derived_states_list, and the statistics
+     * of the test that generated this state, until it is counted.
+     * */
+    unsigned char adaptive_tests_order[FCS_MOVE_FUNCS_NUM];
+    fcs_adaptive_test_stats_t * derived_states_test_stats;
+    fcs_adaptive_test_stats_t * test_stats;
 } fcs_soft_dfs_stack_item_t;
 
 enum
@@ -475,6 +501,13 @@ enum
      * */
     FCS_SOFT_THREAD_IS_FINISHED = (1 << 2),
 
+    /*
+     * A flag that indicates if this BeFS scan is the optimal A* scan, which
+     * rates the states by their depth plus the lower bound of the pattern
+     * database.
+     * */
+    FCS_SOFT_THREAD_OPTIMAL_A_STAR = (1 << 3),
+
 };
 
 typedef struct {
@@ -482,6 +515,13 @@ typedef struct {
     int num_tests;
     int shuffling_type;
     fc_solve_state_weighting_t weighting;
+    /*
+     * The statistics of the tests and their current order (by the UCB1
+     * bandit policy), or NULL if the tests are run in their given order.
+     * */
+    fcs_adaptive_test_stats_t * adaptive_stats;
+    unsigned char * adaptive_order;
+    fcs_int_limit_t adaptive_ranked_at;
 } fcs_tests_list_t;
 
 typedef struct {
@@ -671,6 +711,12 @@ struct fc_solve_soft_thread_struct
      * */
     fcs_bool_t enable_pruning;
 
+    /*
+     * The number of iterations between the re-orderings of the Soft-DFS
+     * tests by their statistics, or 0 to run them in their given order.
+     * */
+    fcs_int_limit_t adaptive_tests_order_interval;
+
 #ifndef FCS_DISABLE_PATSOLVE
     /*
      * The patsolve soft_thread that is associated with this soft_thread.
@@ -679,6 +725,32 @@ struct fc_solve_soft_thread_struct
 #endif
 };
 
+/*
+ * The state of an incremental trimming of the states collection, which
+ * sweeps the collection for dead end states in several steps - see
+ * free_states() in scans_impl.h .
+ * */
+typedef struct
+{
+    fcs_bool_t is_active;
+    /* The next bucket of the states hash to sweep. */
+    int next_bucket;
+    /*
+     * The dead end states that were removed from the collection in this
+     * trimming, and will be recycled once the scans no longer refer to
+     * them.
+     * */
+    fcs_collectible_state_t * * dead_ends;
+    fcs_int_limit_t num_dead_ends, max_num_dead_ends;
+    /*
+     * If a trimming left the collection above its low-water mark, the next
+     * trimming is put off until the collection reaches this size, so
+     * trimmings that free little are not repeated on every iteration.
+     * 0 if the next trimming starts at the trimming limit.
+     * */
+    fcs_int_limit_t next_trim_at;
+} fcs_states_trimming_t;
+
 struct fc_solve_instance_struct
 {
 #if (FCS_STATE_STORAGE == FCS_STATE_STORAGE_INDIRECT)
@@ -771,6 +843,31 @@ struct fc_solve_instance_struct
 #endif
 
     fcs_collectible_state_t * list_of_vacant_states;
+    fcs_states_trimming_t trimming;
+    /*
+     * Remembers the dead ends that were trimmed, so they will not be
+     * explored again. Its size is set by transposition_table_size .
+     * */
+    fcs_transposition_table_t transposition_table;
+    long transposition_table_size;
+    /*
+     * The claims table that is shared with the other Soft-DFS workers
+     * that solve the same deal, or NULL if this instance works alone.
+     * It is owned by the caller.
+     * */
+    fcs_dfs_split_t * dfs_split;
+    /*
+     * The endgame database, which is owned by the instance, and the most
+     * cards outside the foundations of the states it is probed for, or
+     * -1 if it was not loaded or was generated for a different variant.
+     * */
+    fcs_endgame_db_t endgame_db;
+    int endgame_db_max_cards;
+    /*
+     * The pattern database of the optimal A* scans, which is owned by
+     * the instance.
+     * */
+    fcs_pattern_db_t pattern_db;
     /*
      * Storing using Berkeley DB is not operational for some reason so
      * pay no attention to it for the while
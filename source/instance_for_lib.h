@@ -115,6 +115,19 @@ static GCC_INLINE void fc_solve_alloc_instance(fc_solve_instance_t * const insta
     instance->instance_tests_order.groups = NULL;
 
     instance->list_of_vacant_states = NULL;
+    instance->trimming.is_active = FALSE;
+    instance->trimming.dead_ends = NULL;
+    instance->trimming.num_dead_ends = instance->trimming.max_num_dead_ends = 0;
+    instance->trimming.next_trim_at = 0;
+    instance->transposition_table.entries = NULL;
+    instance->transposition_table_size = 0;
+    instance->dfs_split = NULL;
+    instance->endgame_db.offsets = NULL;
+    instance->endgame_db.bits = NULL;
+    instance->endgame_db.mapped = NULL;
+    instance->endgame_db_max_cards = -1;
+    instance->pattern_db.values = NULL;
+    instance->pattern_db.mapped = NULL;
 
 
     STRUCT_CLEAR_FLAG(instance, FCS_RUNTIME_OPT_TESTS_ORDER_WAS_SET );
@@ -515,6 +528,33 @@ static GCC_INLINE void fc_solve_start_instance_process_with_board(
 
     instance->state_copy_ptr = state_copy_ptr;
 
+    fc_solve_tt_init(
+        &(instance->transposition_table),
+        instance->transposition_table_size
+    );
+
+    {
+        const fcs_endgame_db_params_t * const params =
+            &(instance->endgame_db.params);
+        instance->endgame_db_max_cards =
+            ((instance->endgame_db.bits
+              && (INSTANCE_DECKS_NUM == 1)
+              && (params->freecells_num == INSTANCE_FREECELLS_NUM)
+              && (params->stacks_num == INSTANCE_STACKS_NUM)
+              && (params->sequences_are_built_by ==
+                  GET_INSTANCE_SEQUENCES_ARE_BUILT_BY(instance))
+#ifdef FCS_FREECELL_ONLY
+              && (params->empty_stacks_fill == FCS_ES_FILLED_BY_ANY_CARD)
+#else
+              && (params->empty_stacks_fill == INSTANCE_EMPTY_STACKS_FILL)
+              && (! INSTANCE_UNLIMITED_SEQUENCE_MOVE)
+#endif
+             )
+             ? params->max_cards
+             : -1
+            );
+    }
+
     /* Initialize the data structure that will manage the state collection */
 #if (FCS_STATE_STORAGE == FCS_STATE_STORAGE_LIBREDBLACK_TREE)
     instance->tree = rbinit(
@@ -727,6 +767,8 @@ static GCC_INLINE void fc_solve_release_tests_list(
                 i++)
             {
                 free (lists[i].tests);
+                free (lists[i].adaptive_stats);
+                free (lists[i].adaptive_order);
             }
             free (lists);
         }
@@ -785,6 +827,8 @@ static GCC_INLINE void fc_solve_free_instance(fc_solve_instance_t * const instan
     }
 #endif
     fc_solve_free_tests_order( &(instance->instance_tests_order) );
+    fc_solve_endgame_db__free( &(instance->endgame_db) );
+    fc_solve_pattern_db__free( &(instance->pattern_db) );
     if (STRUCT_QUERY_FLAG(instance, FCS_RUNTIME_OPT_TESTS_ORDER_WAS_SET))
     {
         fc_solve_free_tests_order( &(instance->opt_tests_order) );
@@ -1042,6 +1086,7 @@ static GCC_INLINE void fc_solve_soft_thread_init_soft_dfs(
 
     DFS_VAR(soft_thread, soft_dfs_info)[0].state
         = FCS_STATE_keyval_pair_to_collectible(instance->state_copy_ptr);
+    DFS_VAR(soft_thread, soft_dfs_info)[0].test_stats = NULL;
 
     fc_solve_rand_init(
             &(DFS_VAR(soft_thread, rand_gen)),
@@ -1105,6 +1150,23 @@ static GCC_INLINE void fc_solve_soft_thread_init_soft_dfs(
                     ? tests_order_groups[group_idx].shuffling_type
                     : FCS_NO_SHUFFLING;
 
+                /* Only the tests that are run one at a time can be
+                 * reordered. */
+                if ((soft_thread->adaptive_tests_order_interval > 0)
+                    && (tests_list_struct_ptr->shuffling_type == FCS_NO_SHUFFLING)
+                    && (num > 1) && (num <= FCS_MOVE_FUNCS_NUM))
+                {
+                    tests_list_struct_ptr->adaptive_stats =
+                        SMALLOC(tests_list_struct_ptr->adaptive_stats, num);
+                    tests_list_struct_ptr->adaptive_order =
+                        SMALLOC(tests_list_struct_ptr->adaptive_order, num);
+                }
+                else
+                {
+                    tests_list_struct_ptr->adaptive_stats = NULL;
+                    tests_list_struct_ptr->adaptive_order = NULL;
+                }
+
                 if (tests_list_struct_ptr->shuffling_type == FCS_WEIGHTING)
                 {
                     tests_list_struct_ptr->weighting =
@@ -1126,6 +1188,35 @@ static GCC_INLINE void fc_solve_soft_thread_init_soft_dfs(
         }
     }
 
+    /* The adaptive tests order is learned anew for every board. */
+    {
+        const fcs_tests_by_depth_array_t * const arr_ptr =
+            &(DFS_VAR(soft_thread, tests_by_depth_array));
+
+        for (int unit_idx = 0 ; unit_idx < arr_ptr->num_units ; unit_idx++)
+        {
+            const fcs_tests_list_of_lists * const tests_list_of_lists =
+                &(arr_ptr->by_depth_units[unit_idx].tests);
+
+            for (int i = 0 ; i < tests_list_of_lists->num_lists ; i++)
+            {
+                fcs_tests_list_t * const tests_list =
+                    &(tests_list_of_lists->lists[i]);
+
+                if (tests_list->adaptive_stats)
+                {
+                    for (int t = 0 ; t < tests_list->num_tests ; t++)
+                    {
+                        tests_list->adaptive_stats[t].num_pulls =
+                            tests_list->adaptive_stats[t].num_rewards = 0;
+                        tests_list->adaptive_order[t] = (unsigned char)t;
+                    }
+                    tests_list->adaptive_ranked_at = 0;
+                }
+            }
+        }
+    }
+
     return;
 }
 
@@ -49,6 +49,7 @@
 #include "alloc_wrap.h"
 
 #include "str_utils.h"
+#include "solution_cache.h"
 
 #define FCS_MAX_FLARE_NAME_LEN 30
 
@@ -184,6 +185,19 @@ typedef struct
     char * error_string;
 
     fcs_meta_compact_allocator_t meta_alloc;
+
+    /* See freecell_solver_user_set_solution_cache(). */
+    fcs_solution_cache_t solution_cache;
+    unsigned long long solution_cache_config_id_digest;
+    /*
+     * Whether the solution of the board that is being solved should be
+     * stored in the cache once it is found, under solution_cache_key, and
+     * the locations of the stacks and the freecells of its canonized
+     * initial state.
+     * */
+    fcs_bool_t solution_cache_should_store;
+    fcs_solution_cache_key_t solution_cache_key;
+    fcs_state_locs_struct_t solution_cache_locs;
 } fcs_user_t;
 
 
@@ -249,6 +263,10 @@ static void user_initialize(
 
     user->error_string = NULL;
 
+    fc_solve_solution_cache__init(&(user->solution_cache));
+    user->solution_cache_config_id_digest = 0;
+    user->solution_cache_should_store = FALSE;
+
     user_next_instance(user);
 
     return;
@@ -728,6 +746,8 @@ static GCC_INLINE char * duplicate_string_while_adding_a_trailing_newline(
 #undef TRAILING_CHAR
 #undef MY_MARGIN
 
+static fcs_bool_t user_lookup_cached_solution(fcs_user_t * const user);
+
 int DLLEXPORT freecell_solver_user_solve_board(
     void * const api_instance,
     const char * const state_as_string
@@ -756,6 +776,11 @@ int DLLEXPORT freecell_solver_user_solve_board(
         return FCS_STATE_FLARES_PLAN_ERROR;
     }
 
+    if (user_lookup_cached_solution(user))
+    {
+        return (user->ret_code = FCS_STATE_WAS_SOLVED);
+    }
+
     return freecell_solver_user_resume_solution(api_instance);
 }
 
@@ -975,6 +1000,151 @@ static GCC_INLINE const flare_iters_quota_t normalize_iters_quota(
     return max(i, 0);
 }
 
+/*
+ * Looks the board up in the solution cache, and if it is there, makes
+ * the first flare of the first instance hold its solution, as if it
+ * solved it. Otherwise, arranges for the solution to be stored once it is
+ * found.
+ * */
+static fcs_bool_t user_lookup_cached_solution(fcs_user_t * const user)
+{
+    user->solution_cache_should_store = FALSE;
+
+    if (! fc_solve_solution_cache__is_loaded(&(user->solution_cache)))
+    {
+        return FALSE;
+    }
+
+    fcs_instance_item_t * const instance_item =
+        get_current_instance_item(user);
+    fcs_flare_item_t * const flare = &(instance_item->flares[0]);
+#if (!(defined(HARD_CODED_NUM_FREECELLS) && defined(HARD_CODED_NUM_STACKS) && defined(HARD_CODED_NUM_DECKS) && defined(FCS_FREECELL_ONLY)))
+    fc_solve_instance_t * const instance = &(flare->obj);
+#endif
+
+    fcs_card_t validity_card;
+    if ((! fc_solve_initial_user_state_to_c(
+            user->state_string_copy,
+            &(user->state),
+            INSTANCE_FREECELLS_NUM,
+            INSTANCE_STACKS_NUM,
+            INSTANCE_DECKS_NUM,
+            user->indirect_stacks_buffer
+        ))
+        ||
+        (fc_solve_check_state_validity(
+            &(user->state),
+            INSTANCE_FREECELLS_NUM,
+            INSTANCE_STACKS_NUM,
+            INSTANCE_DECKS_NUM,
+            &validity_card
+        ) != FCS_STATE_VALIDITY__OK)
+    )
+    {
+        /* Let the solver report the error. */
+        return FALSE;
+    }
+
+    fc_solve_init_locs(&(user->initial_state_locs));
+    user->state_locs = user->initial_state_locs;
+
+    fcs_kv_state_t state_pass = FCS_STATE_keyval_pair_to_kv(&(user->state));
+    {
+        fcs_kv_state_t pass = FCS_STATE_keyval_pair_to_kv(&(user->running_state));
+
+        fcs_duplicate_kv_state(&pass, &state_pass);
+    }
+    {
+        fcs_kv_state_t initial_pass = FCS_STATE_keyval_pair_to_kv(&(user->initial_non_canonized_state));
+
+        fcs_duplicate_kv_state(&initial_pass, &state_pass);
+    }
+
+    fc_solve_canonize_state_with_locs(
+        &state_pass,
+        &(user->state_locs),
+        INSTANCE_FREECELLS_NUM,
+        INSTANCE_STACKS_NUM
+    );
+
+    unsigned long long config_digest = user->solution_cache_config_id_digest;
+    config_digest = fc_solve_solution_cache__mix_digest(config_digest,
+        INSTANCE_FREECELLS_NUM);
+    config_digest = fc_solve_solution_cache__mix_digest(config_digest,
+        INSTANCE_STACKS_NUM);
+    config_digest = fc_solve_solution_cache__mix_digest(config_digest,
+        INSTANCE_DECKS_NUM);
+    config_digest = fc_solve_solution_cache__mix_digest(config_digest,
+        GET_INSTANCE_SEQUENCES_ARE_BUILT_BY(instance));
+#ifndef FCS_FREECELL_ONLY
+    config_digest = fc_solve_solution_cache__mix_digest(config_digest,
+        INSTANCE_EMPTY_STACKS_FILL);
+    config_digest = fc_solve_solution_cache__mix_digest(config_digest,
+        (INSTANCE_UNLIMITED_SEQUENCE_MOVE ? 1 : 0));
+#endif
+
+    user->solution_cache_key = fc_solve_solution_cache__calc_key(
+        &(user->state.s),
+        INSTANCE_FREECELLS_NUM,
+        INSTANCE_STACKS_NUM,
+        INSTANCE_DECKS_NUM,
+        config_digest
+    );
+    user->solution_cache_locs = user->state_locs;
+
+    fcs_moves_sequence_t moves_seq;
+    if (! fc_solve_solution_cache__lookup(
+        &(user->solution_cache), &(user->solution_cache_key), &moves_seq))
+    {
+        user->solution_cache_should_store = TRUE;
+        return FALSE;
+    }
+
+    fc_solve_solution_cache__renumber_moves(
+        moves_seq.moves, moves_seq.num_moves,
+        &(user->solution_cache_locs), FALSE
+    );
+
+    if (flare->moves_seq.moves)
+    {
+        free(flare->moves_seq.moves);
+    }
+    flare->moves_seq = moves_seq;
+    flare->next_move = 0;
+    flare->was_solution_traced = TRUE;
+    flare->obj_stats = calc_initial_stats_t();
+    instance_item->minimal_solution_flare_idx = 0;
+    user->active_flare = flare;
+    user->init_num_checked_states = flare->obj_stats;
+    user->trace_solution_state_locs = user->state_locs;
+
+    return TRUE;
+}
+
+static void user_store_cached_solution(fcs_user_t * const user)
+{
+    user->solution_cache_should_store = FALSE;
+
+    fcs_instance_item_t const * instance_item =
+        get_current_instance_item(user);
+    fcs_flare_item_t * const flare =
+        &(instance_item->flares[instance_item->minimal_solution_flare_idx]);
+
+    trace_flare_solution(user, flare);
+
+    const int num_moves = flare->moves_seq.num_moves;
+    fcs_move_t * const moves = SMALLOC(moves, num_moves + 1);
+    memcpy(moves, flare->moves_seq.moves, sizeof(moves[0]) * num_moves);
+    fc_solve_solution_cache__renumber_moves(
+        moves, num_moves, &(user->solution_cache_locs), TRUE
+    );
+    fc_solve_solution_cache__store(
+        &(user->solution_cache), &(user->solution_cache_key),
+        moves, num_moves
+    );
+    free(moves);
+}
+
 int DLLEXPORT freecell_solver_user_resume_solution(
     void * const api_instance
     )
@@ -1286,10 +1456,17 @@ int DLLEXPORT freecell_solver_user_resume_solution(
         (ret == FCS_STATE_IS_NOT_SOLVEABLE)
     );
 
-    return
-    (
-        user->all_instances_were_suspended ? FCS_STATE_SUSPEND_PROCESS : ret
-    );
+    if (user->all_instances_were_suspended)
+    {
+        return FCS_STATE_SUSPEND_PROCESS;
+    }
+
+    if ((ret == FCS_STATE_WAS_SOLVED) && user->solution_cache_should_store)
+    {
+        user_store_cached_solution(user);
+    }
+
+    return ret;
 }
 
 static GCC_INLINE fcs_flare_item_t * const calc_moves_flare(
@@ -1430,6 +1607,8 @@ static void user_free_resources(
     }
 
     fc_solve_meta_compact_allocator_finish(&(user->meta_alloc));
+
+    fc_solve_solution_cache__free(&(user->solution_cache));
 }
 
 void DLLEXPORT freecell_solver_user_free(
@@ -1526,6 +1705,14 @@ void DLLEXPORT freecell_solver_user_set_solving_method(
         return freecell_solver_user_set_solving_method(api_instance, FCS_METHOD_SOFT_DFS);
     }
 
+    STRUCT_CLEAR_FLAG(soft_thread, FCS_SOFT_THREAD_OPTIMAL_A_STAR);
+    if (method == FCS_METHOD_OPTIMAL_A_STAR)
+    {
+        freecell_solver_user_set_solving_method(api_instance, FCS_METHOD_A_STAR);
+        STRUCT_TURN_ON_FLAG(soft_thread, FCS_SOFT_THREAD_OPTIMAL_A_STAR);
+        return;
+    }
+
     switch ((soft_thread->method = method))
     {
         case FCS_METHOD_RANDOM_DFS:
@@ -2177,6 +2364,107 @@ DLLEXPORT extern void freecell_solver_set_stored_states_trimming_limit(
 
 }
 
+DLLEXPORT extern void freecell_solver_user_set_transposition_table_size(
+    void * const api_instance,
+    const long num_entries
+    )
+{
+    fcs_user_t * const user = (fcs_user_t *)api_instance;
+
+    user->active_flare->obj.transposition_table_size = num_entries;
+
+    return;
+}
+
+DLLEXPORT extern void freecell_solver_user_set_dfs_split(
+    void * const api_instance,
+    void * const dfs_split
+    )
+{
+    fcs_user_t * const user = (fcs_user_t *)api_instance;
+
+    user->active_flare->obj.dfs_split = (fcs_dfs_split_t *)dfs_split;
+
+    return;
+}
+
+DLLEXPORT extern int freecell_solver_user_set_endgame_db(
+    void * const api_instance,
+    const char * const filename,
+    char * * const error_string
+    )
+{
+    fcs_user_t * const user = (fcs_user_t *)api_instance;
+    fcs_endgame_db_t * const endgame_db = &(user->active_flare->obj.endgame_db);
+
+    fc_solve_endgame_db__free(endgame_db);
+    const char * const error = fc_solve_endgame_db__load(endgame_db, filename);
+    if (error)
+    {
+        *error_string = strdup(error);
+        return 1;
+    }
+
+    *error_string = NULL;
+    return 0;
+}
+
+DLLEXPORT extern int freecell_solver_user_set_pattern_db(
+    void * const api_instance,
+    const char * const filename,
+    char * * const error_string
+    )
+{
+    fcs_user_t * const user = (fcs_user_t *)api_instance;
+    fcs_pattern_db_t * const pattern_db = &(user->active_flare->obj.pattern_db);
+
+    fc_solve_pattern_db__free(pattern_db);
+    const char * const error = fc_solve_pattern_db__load(pattern_db, filename);
+    if (error)
+    {
+        *error_string = strdup(error);
+        return 1;
+    }
+
+    *error_string = NULL;
+    return 0;
+}
+
+DLLEXPORT extern int freecell_solver_user_set_solution_cache(
+    void * const api_instance,
+    const char * const filename,
+    const char * const config_id,
+    char * * const error_string
+    )
+{
+    fcs_user_t * const user = (fcs_user_t *)api_instance;
+
+    fc_solve_solution_cache__free(&(user->solution_cache));
+    const char * const error =
+        fc_solve_solution_cache__load(&(user->solution_cache), filename);
+    if (error)
+    {
+        *error_string = strdup(error);
+        return 1;
+    }
+    user->solution_cache_config_id_digest =
+        fc_solve_solution_cache__hash_string(config_id ? config_id : "");
+
+    *error_string = NULL;
+    return 0;
+}
+
+DLLEXPORT extern void freecell_solver_user_set_solution_cache_config_id(
+    void * const api_instance,
+    const char * const config_id
+    )
+{
+    fcs_user_t * const user = (fcs_user_t *)api_instance;
+
+    user->solution_cache_config_id_digest =
+        fc_solve_solution_cache__hash_string(config_id ? config_id : "");
+}
+
 int DLLEXPORT freecell_solver_user_next_soft_thread(
     void * const api_instance
     )
@@ -2324,6 +2612,7 @@ void DLLEXPORT freecell_solver_user_recycle(
     {
         recycle_instance(user, i);
     }
+    user->solution_cache_should_store = FALSE;
     /*
      * Removing because we are still interested to keep the current iterations
      * limit.
@@ -2393,6 +2682,18 @@ extern int DLLEXPORT freecell_solver_user_set_pruning(
     return 0;
 }
 
+DLLEXPORT extern void freecell_solver_user_set_adaptive_tests_order(
+    void * const api_instance,
+    const long interval
+    )
+{
+    fcs_user_t * const user = (fcs_user_t *)api_instance;
+
+    user->soft_thread->adaptive_tests_order_interval = max(interval, 0);
+
+    return;
+}
+
 
 void DLLEXPORT freecell_solver_user_set_reparent_states(
     void * const api_instance,
@@ -245,6 +245,7 @@ help_screen_t help_screens[] = {
 "        \"a-star\" - Best-First-Search\n"
 "        \"bfs\" - Breadth-First Search\n"
 "        \"dfs\" - Depth-First Search (default)\n"
+"        \"optimal-a-star\" - A* that finds the shortest solutions\n"
 "        \"random-dfs\" - A randomized DFS\n"
 "        \"soft-dfs\" - \"Soft\" DFS\n"
 "\n"
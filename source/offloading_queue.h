@@ -148,6 +148,13 @@ static GCC_INLINE void fcs_offloading_queue__insert(
     return;
 }
 
+static GCC_INLINE long fcs_offloading_queue__count_items_in_memory(
+    const fcs_offloading_queue_t * const queue
+)
+{
+    return queue->num_items_in_queue;
+}
+
 /* Implement the standard in-memory queue as a linked list. */
 #else
 
@@ -422,6 +429,24 @@ static GCC_INLINE fcs_bool_t fcs_offloading_queue__extract(
     return TRUE;
 }
 
+/* The rest of the items are in the page files on the disk. */
+static GCC_INLINE long fcs_offloading_queue__count_items_in_memory(
+    const fcs_offloading_queue_t * const queue
+)
+{
+    const fcs_offloading_queue_page_t * const read_page =
+        &(queue->pages[queue->page_idx_to_read_from]);
+    const fcs_offloading_queue_page_t * const write_page =
+        &(queue->pages[queue->page_idx_to_write_to]);
+    long ret = read_page->write_to_idx - read_page->read_from_idx;
+
+    if (write_page != read_page)
+    {
+        ret += write_page->write_to_idx;
+    }
+    return ret;
+}
+
 #endif
 
 #ifdef __cplusplus
@@ -0,0 +1,335 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ *  parallel_dfs_solver.c - solves a single board using several POSIX
+ *  threads, each running its own Soft-DFS instance, which split the
+ *  search among themselves by claiming subtrees (see dfs_split.h).
+ *
+ *  See also:
+ *      - threaded_range_solver.c
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "alloc_wrap.h"
+#include "portable_int64.h"
+
+#include "fcs_user.h"
+#include "fcs_cl.h"
+#include "unused.h"
+#include "inline.h"
+#include "bool.h"
+#include "min_and_max.h"
+#include "dfs_split.h"
+#include "output_to_file.h"
+
+static void print_help(void)
+{
+    printf("\n%s",
+"freecell-solver-parallel-dfs-solve [--num-workers n] [--split-depth depth]\n"
+"   [--iters-step step] [--total-iterations-limit limit]\n"
+"   [fc-solve Arguments...] board_file\n"
+"\n"
+"Solves a single board using several Soft-DFS workers in parallel.\n"
+"\n"
+"--num-workers n\n"
+"     The number of threads to use (default: 4).\n"
+"--split-depth depth\n"
+"     The depth of the states whose subtrees are divided among the\n"
+"     workers (default: 1 = the children of the initial state).\n"
+"--iters-step step\n"
+"     How often (in iterations) does every worker check whether the board\n"
+"     was solved by another one (default: 1000).\n"
+"--total-iterations-limit  limit\n"
+"     Limits each worker for up to 'limit' iterations.\n"
+          );
+}
+
+#define USER_STATE_SIZE 1024
+
+typedef struct {
+    int argc;
+    char * * argv;
+    int arg;
+    char user_state[USER_STATE_SIZE];
+    fcs_int_limit_t iters_step;
+    fcs_int_limit_t total_iterations_limit;
+    fcs_dfs_split_t split;
+} context_t;
+
+static context_t context = {.arg = 1, .iters_step = 1000, .total_iterations_limit = -1};
+
+typedef struct {
+    void * instance;
+    int ret;
+} worker_t;
+
+static void * worker_thread(void * const void_worker)
+{
+    worker_t * const worker = (worker_t *)void_worker;
+    void * const instance = worker->instance = freecell_solver_user_alloc();
+    worker->ret = FCS_STATE_IS_NOT_SOLVEABLE;
+
+    {
+        int arg = context.arg;
+        char * error_string;
+        switch(
+            freecell_solver_user_cmd_line_parse_args(
+                instance,
+                context.argc,
+                (const char * *)(void *)context.argv,
+                arg,
+                NULL,
+                NULL,
+                NULL,
+                &error_string,
+                &arg
+            )
+        )
+        {
+            case FCS_CMD_LINE_UNRECOGNIZED_OPTION:
+            {
+                fprintf(stderr, "Unknown option: %s", context.argv[arg]);
+                exit(-1);
+            }
+            break;
+
+            case FCS_CMD_LINE_PARAM_WITH_NO_ARG:
+            {
+                fprintf(stderr, "The command line parameter \"%s\" requires an argument"
+                    " and was not supplied with one.\n", context.argv[arg]);
+                exit(-1);
+            }
+            break;
+
+            case FCS_CMD_LINE_ERROR_IN_ARG:
+            {
+                if (error_string != NULL)
+                {
+                    fprintf(stderr, "%s", error_string);
+                    free(error_string);
+                }
+                exit(-1);
+            }
+            break;
+        }
+    }
+    freecell_solver_user_set_dfs_split(instance, &(context.split));
+
+    /* Resume the scan in steps, so the worker will stop soon after
+     * another one has solved the board. */
+    fcs_int_limit_t limit = context.iters_step;
+    if (context.total_iterations_limit >= 0)
+    {
+        limit = min(limit, context.total_iterations_limit);
+    }
+    freecell_solver_user_limit_iterations_long(instance, limit);
+    int ret = freecell_solver_user_solve_board(instance, context.user_state);
+    while ((ret == FCS_STATE_SUSPEND_PROCESS)
+        && (! fc_solve_dfs_split_is_solved(&(context.split)))
+        && ((context.total_iterations_limit < 0)
+            || (limit < context.total_iterations_limit)))
+    {
+        limit += context.iters_step;
+        if (context.total_iterations_limit >= 0)
+        {
+            limit = min(limit, context.total_iterations_limit);
+        }
+        freecell_solver_user_limit_iterations_long(instance, limit);
+        ret = freecell_solver_user_resume_solution(instance);
+    }
+
+    if (ret == FCS_STATE_WAS_SOLVED)
+    {
+        fc_solve_dfs_split_mark_as_solved(&(context.split));
+    }
+    worker->ret = ret;
+
+    return NULL;
+}
+
+static GCC_INLINE void read_arg_value(
+    const int argc, char * argv[], const char * const name
+)
+{
+    context.arg++;
+    if (context.arg == argc)
+    {
+        fprintf(stderr, "%s came without an argument!\n", name);
+        print_help();
+        exit(-1);
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    int num_workers = 4;
+    int split_depth = 1;
+
+    for (;context.arg < argc; context.arg++)
+    {
+        if (!strcmp(argv[context.arg], "--num-workers"))
+        {
+            read_arg_value(argc, argv, "--num-workers");
+            num_workers = atoi(argv[context.arg]);
+        }
+        else if (!strcmp(argv[context.arg], "--split-depth"))
+        {
+            read_arg_value(argc, argv, "--split-depth");
+            split_depth = atoi(argv[context.arg]);
+        }
+        else if (!strcmp(argv[context.arg], "--iters-step"))
+        {
+            read_arg_value(argc, argv, "--iters-step");
+            context.iters_step = atol(argv[context.arg]);
+        }
+        else if (!strcmp(argv[context.arg], "--total-iterations-limit"))
+        {
+            read_arg_value(argc, argv, "--total-iterations-limit");
+            context.total_iterations_limit = atol(argv[context.arg]);
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if (context.arg >= argc)
+    {
+        fprintf(stderr, "No board file was specified!\n");
+        print_help();
+        exit(-1);
+    }
+    if ((num_workers <= 0) || (split_depth <= 0) || (context.iters_step <= 0))
+    {
+        fprintf(stderr, "--num-workers, --split-depth and --iters-step must be"
+            " greater than 0.\n");
+        print_help();
+        exit(-1);
+    }
+
+    /* The last argument is the board, and the rest are passed to the
+     * workers. */
+    const char * const filename = argv[argc-1];
+    FILE * const file = fopen(filename, "r");
+    if (file == NULL)
+    {
+        fprintf(stderr,
+            "Could not open file \"%s\" for input. Exiting.\n",
+            filename
+        );
+        exit(-1);
+    }
+    memset(context.user_state, '\0', sizeof(context.user_state));
+    fread(context.user_state, sizeof(context.user_state[0]), USER_STATE_SIZE-1, file);
+    fclose(file);
+
+    context.argc = argc - 1;
+    context.argv = argv;
+
+    fc_solve_dfs_split_init(&(context.split), split_depth,
+        FCS_DFS_SPLIT_DEFAULT_NUM_SLOTS);
+
+    pthread_t * const threads = SMALLOC(threads, num_workers);
+    worker_t * const workers = SMALLOC(workers, num_workers);
+
+    for ( int idx = 0 ; idx < num_workers ; idx++)
+    {
+        const int check = pthread_create(
+            &threads[idx],
+            NULL,
+            worker_thread,
+            &workers[idx]
+        );
+        if (check)
+        {
+            fprintf(stderr,
+                "Worker Thread No. %d Initialization failed with error %d!\n",
+                idx, check
+            );
+            exit(-1);
+        }
+    }
+
+    /* Wait for all threads to finish. */
+    for( int idx = 0 ; idx < num_workers ; idx++)
+    {
+        pthread_join(threads[idx], NULL);
+    }
+
+    /*
+     * The board is solved if any of the workers solved it, and is
+     * unsolvable only if all of them exhausted their share of it.
+     * */
+    int winner = -1;
+    int ret = FCS_STATE_IS_NOT_SOLVEABLE;
+    fcs_int64_t total_num_iters = 0;
+    for( int idx = 0 ; idx < num_workers ; idx++)
+    {
+        total_num_iters +=
+            freecell_solver_user_get_num_times_long(workers[idx].instance);
+        if (workers[idx].ret == FCS_STATE_WAS_SOLVED)
+        {
+            if (winner < 0)
+            {
+                winner = idx;
+            }
+        }
+        else if (workers[idx].ret != FCS_STATE_IS_NOT_SOLVEABLE)
+        {
+            ret = FCS_STATE_SUSPEND_PROCESS;
+        }
+    }
+
+    fc_solve_display_information_context_t debug_context;
+    init_debug_context(&debug_context);
+    debug_context.display_moves = TRUE;
+    debug_context.display_states = FALSE;
+    debug_context.show_exceeded_limits = TRUE;
+
+    fc_solve_output_result_to_file(
+        stdout,
+        workers[max(winner, 0)].instance,
+        ((winner >= 0) ? FCS_STATE_WAS_SOLVED : ret),
+        &debug_context
+    );
+    if (winner >= 0)
+    {
+        printf("Solved by worker No. %d.\n", winner);
+    }
+    printf("Total number of states checked by all workers is %li.\n",
+        (long)total_num_iters);
+
+    for( int idx = 0 ; idx < num_workers ; idx++)
+    {
+        freecell_solver_user_free(workers[idx].instance);
+    }
+    free(workers);
+    free(threads);
+    fc_solve_dfs_split_free(&(context.split));
+
+    return 0;
+}
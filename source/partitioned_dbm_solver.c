@@ -0,0 +1,963 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * partitioned_dbm_solver.c - a DBM solver that hash-partitions the
+ * encoded states among several worker processes. Every worker owns the
+ * store and the offloading queue of its partition, and the derived states
+ * that belong to other partitions are forwarded in batches, over Unix
+ * domain sockets, through a coordinator process. The coordinator also
+ * detects the global termination and traces the solution back across
+ * the partitions.
+ */
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+/* The partitions are kept in memory, whatever the store of the other DBM
+ * solvers is. */
+#ifndef FCS_DBM_WITHOUT_CACHES
+#define FCS_DBM_WITHOUT_CACHES 1
+#endif
+
+#include "dbm_solver_head.h"
+#include "dbm_partition.h"
+#include "dbm_move_to_string.h"
+#include "dbm_checkpoint.h"
+
+#define NUM_ITEMS_PER_PAGE (128 * 1024)
+/* The maximal number of records in a single STATES message. */
+#define BATCH_SIZE 4096
+
+typedef struct
+{
+    int idx, num_workers;
+    enum fcs_dbm_variant_type_t variant;
+    fc_solve_delta_stater_t * delta_stater;
+    fcs_dbm_partition_store_t store;
+    fcs_offloading_queue_t queue;
+    fcs_dbm_partition_channel_t channel;
+    /* The outgoing batches, one for every partition. */
+    fcs_dbm_partition_record_t * * batches;
+    int * batch_counts;
+    long num_processed, num_states_msgs_received, num_states_msgs_at_idle;
+    fcs_bool_t is_halted, should_stop;
+} fcs_dbm_partition_worker_t;
+
+static GCC_INLINE void worker_send_batch(
+    fcs_dbm_partition_worker_t * const worker,
+    const int partition
+)
+{
+    if (worker->batch_counts[partition])
+    {
+        fcs_dbm_partition_channel__send(&(worker->channel),
+            FCS_DBM_PARTITION_MSG_STATES, partition,
+            worker->batch_counts[partition], worker->num_processed,
+            worker->batches[partition], worker->batch_counts[partition]
+        );
+        worker->batch_counts[partition] = 0;
+    }
+}
+
+static GCC_INLINE void worker_add(
+    fcs_dbm_partition_worker_t * const worker,
+    const fcs_dbm_partition_record_t * const rec
+)
+{
+    const int owner =
+        fcs_dbm_partition__calc_owner(&(rec->key), worker->num_workers);
+
+    if (owner == worker->idx)
+    {
+        const fcs_dbm_partition_record_t * const new_rec =
+            fcs_dbm_partition_store__insert(&(worker->store), rec);
+        if (new_rec)
+        {
+            const fcs_offloading_queue_item_t token =
+                (fcs_offloading_queue_item_t)new_rec;
+            fcs_offloading_queue__insert(&(worker->queue), &token);
+        }
+    }
+    else
+    {
+        worker->batches[owner][worker->batch_counts[owner]++] = *rec;
+        if (worker->batch_counts[owner] == BATCH_SIZE)
+        {
+            worker_send_batch(worker, owner);
+        }
+    }
+}
+
+static void worker_handle_messages(
+    fcs_dbm_partition_worker_t * const worker
+)
+{
+    fcs_dbm_partition_msg_header_t header;
+    const fcs_dbm_partition_record_t * records;
+    size_t num_records;
+
+    fcs_dbm_partition_channel__read(&(worker->channel));
+    if (worker->channel.is_eof)
+    {
+        /* The coordinator is gone. */
+        exit(-1);
+    }
+
+    while (fcs_dbm_partition_channel__next(&(worker->channel), &header,
+        &records, &num_records))
+    {
+        switch (header.type)
+        {
+        case FCS_DBM_PARTITION_MSG_STATES:
+            worker->num_states_msgs_received++;
+            if (! worker->is_halted)
+            {
+                for (size_t i = 0 ; i < num_records ; i++)
+                {
+                    worker_add(worker, &(records[i]));
+                }
+            }
+            break;
+
+        case FCS_DBM_PARTITION_MSG_HALT:
+            worker->is_halted = TRUE;
+            break;
+
+        case FCS_DBM_PARTITION_MSG_QUERY:
+            {
+                const fcs_dbm_partition_record_t * const rec =
+                    fcs_dbm_partition_store__lookup(&(worker->store),
+                        &(records[0].key));
+                if (! rec)
+                {
+                    fprintf(stderr, "Partition %d does not have a queried state.\n",
+                        worker->idx);
+                    exit(-1);
+                }
+                fcs_dbm_partition_channel__send(&(worker->channel),
+                    FCS_DBM_PARTITION_MSG_PARENT, worker->idx, 1, 0, rec, 1);
+            }
+            break;
+
+        case FCS_DBM_PARTITION_MSG_STOP:
+            worker->should_stop = TRUE;
+            break;
+        }
+    }
+}
+
+/* Returns TRUE if the state was solved. */
+static GCC_INLINE fcs_bool_t worker_expand(
+    fcs_dbm_partition_worker_t * const worker,
+    const fcs_dbm_partition_record_t * const token,
+    fcs_derived_state_t * * const derived_list_recycle_bin,
+    fcs_compact_allocator_t * const derived_list_allocator
+)
+{
+    const enum fcs_dbm_variant_type_t local_variant = worker->variant;
+    fcs_state_keyval_pair_t state;
+    fcs_derived_state_t * derived_list = NULL;
+    fcs_dbm_partition_record_t rec;
+    DECLARE_IND_BUF_T(indirect_stacks_buffer)
+
+    fc_solve_delta_stater_decode_into_state(
+        worker->delta_stater,
+        token->key.s,
+        &state,
+        indirect_stacks_buffer
+    );
+
+    if (instance_solver_thread_calc_derived_states(
+        local_variant,
+        &state,
+        NULL,
+        &derived_list,
+        derived_list_recycle_bin,
+        derived_list_allocator,
+        TRUE
+    ))
+    {
+        return TRUE;
+    }
+
+    rec.parent = token->key;
+    while (derived_list)
+    {
+        fcs_derived_state_t * const derived_list_next = derived_list->next;
+
+        fcs_init_and_encode_state(
+            worker->delta_stater,
+            local_variant,
+            &(derived_list->state),
+            &(rec.key)
+        );
+        worker_add(worker, &rec);
+
+        derived_list->next = *derived_list_recycle_bin;
+        *derived_list_recycle_bin = derived_list;
+        derived_list = derived_list_next;
+    }
+
+    return FALSE;
+}
+
+static void worker_run(
+    fcs_dbm_partition_worker_t * const worker,
+    const char * const offload_dir_path
+)
+{
+    fcs_meta_compact_allocator_t meta_alloc;
+    fcs_compact_allocator_t derived_list_allocator;
+    fcs_derived_state_t * derived_list_recycle_bin = NULL;
+
+    fc_solve_meta_compact_allocator_init(&meta_alloc);
+    fc_solve_compact_allocator_init(&derived_list_allocator, &meta_alloc);
+    fcs_dbm_partition_store__init(&(worker->store));
+    fcs_offloading_queue__init(&(worker->queue), NUM_ITEMS_PER_PAGE,
+        offload_dir_path, worker->idx);
+    worker->batches = SMALLOC(worker->batches, worker->num_workers);
+    worker->batch_counts = SMALLOC(worker->batch_counts, worker->num_workers);
+    for (int i = 0 ; i < worker->num_workers ; i++)
+    {
+        worker->batches[i] = SMALLOC(worker->batches[i], BATCH_SIZE);
+        worker->batch_counts[i] = 0;
+    }
+    worker->num_processed = worker->num_states_msgs_received = 0;
+    worker->num_states_msgs_at_idle = -1;
+    worker->is_halted = worker->should_stop = FALSE;
+
+    while (1)
+    {
+        worker_handle_messages(worker);
+        if (worker->should_stop)
+        {
+            break;
+        }
+
+        if ((! worker->is_halted) && worker->queue.num_items_in_queue)
+        {
+            fcs_offloading_queue_item_t token;
+            for (int i = 0 ; (i < BATCH_SIZE)
+                && fcs_offloading_queue__extract(&(worker->queue), &token) ; i++)
+            {
+                worker->num_processed++;
+                if (worker_expand(worker,
+                    (const fcs_dbm_partition_record_t *)token,
+                    &derived_list_recycle_bin, &derived_list_allocator))
+                {
+                    worker->is_halted = TRUE;
+                    fcs_dbm_partition_channel__send(&(worker->channel),
+                        FCS_DBM_PARTITION_MSG_SOLVED, worker->idx, 1, 0,
+                        (const fcs_dbm_partition_record_t *)token, 1);
+                    break;
+                }
+            }
+            fcs_dbm_partition_channel__write(&(worker->channel));
+        }
+        else
+        {
+            if ((! worker->is_halted) && (worker->num_states_msgs_at_idle
+                    != worker->num_states_msgs_received))
+            {
+                /* The STATES messages must precede the IDLE one. */
+                for (int i = 0 ; i < worker->num_workers ; i++)
+                {
+                    worker_send_batch(worker, i);
+                }
+                fcs_dbm_partition_channel__send(&(worker->channel),
+                    FCS_DBM_PARTITION_MSG_IDLE, worker->idx,
+                    worker->num_states_msgs_received, worker->num_processed,
+                    NULL, 0);
+                worker->num_states_msgs_at_idle =
+                    worker->num_states_msgs_received;
+            }
+            fcs_dbm_partition_channel__flush(&(worker->channel));
+            fcs_dbm_partition_channel__wait(&(worker->channel), -1);
+        }
+    }
+
+    fcs_dbm_partition_channel__send(&(worker->channel),
+        FCS_DBM_PARTITION_MSG_STATS, worker->idx, (int64_t)worker->store.count,
+        worker->num_processed, NULL, 0);
+    fcs_dbm_partition_channel__flush(&(worker->channel));
+    fcs_dbm_partition_channel__destroy(&(worker->channel));
+
+    for (int i = 0 ; i < worker->num_workers ; i++)
+    {
+        free(worker->batches[i]);
+    }
+    free(worker->batches);
+    free(worker->batch_counts);
+    fcs_offloading_queue__destroy(&(worker->queue));
+    fcs_dbm_partition_store__destroy(&(worker->store));
+    fc_solve_compact_allocator_finish(&derived_list_allocator);
+    fc_solve_meta_compact_allocator_finish(&meta_alloc);
+}
+
+typedef struct
+{
+    int num_workers;
+    pid_t * pids;
+    fcs_dbm_partition_channel_t * channels;
+    struct pollfd * pfds;
+    /* For the termination detection. */
+    int64_t * num_states_msgs_sent, * num_states_msgs_at_idle;
+    long * num_processed, * num_states;
+    fcs_bool_t * is_idle, * has_stats;
+    long last_reported_num_processed;
+    FILE * out_fh;
+    fcs_bool_t solution_was_found;
+    fcs_encoded_state_buffer_t solution;
+    /* The reply to the pending QUERY. */
+    fcs_bool_t has_parent;
+    fcs_encoded_state_buffer_t parent;
+} fcs_dbm_partition_coordinator_t;
+
+static void coordinator_pump(
+    fcs_dbm_partition_coordinator_t * const coord
+)
+{
+    for (int i = 0 ; i < coord->num_workers ; i++)
+    {
+        /* Negative descriptors are ignored by poll(). */
+        coord->pfds[i].fd = (coord->channels[i].is_eof ? -1 : coord->channels[i].fd);
+        coord->pfds[i].events = POLLIN
+            | (fcs_dbm_partition_channel__has_output(&(coord->channels[i]))
+                ? POLLOUT : 0);
+        coord->pfds[i].revents = 0;
+    }
+    poll(coord->pfds, coord->num_workers, 1000);
+
+    for (int i = 0 ; i < coord->num_workers ; i++)
+    {
+        fcs_dbm_partition_channel_t * const channel = &(coord->channels[i]);
+        if (coord->pfds[i].revents & POLLOUT)
+        {
+            fcs_dbm_partition_channel__write(channel);
+        }
+        if (coord->pfds[i].revents & (POLLIN | POLLHUP))
+        {
+            fcs_dbm_partition_channel__read(channel);
+        }
+    }
+
+    for (int i = 0 ; i < coord->num_workers ; i++)
+    {
+        fcs_dbm_partition_msg_header_t header;
+        const fcs_dbm_partition_record_t * records;
+        size_t num_records;
+
+        while (fcs_dbm_partition_channel__next(&(coord->channels[i]),
+            &header, &records, &num_records))
+        {
+            switch (header.type)
+            {
+            case FCS_DBM_PARTITION_MSG_STATES:
+                coord->num_processed[i] = header.num_processed;
+                if (! coord->solution_was_found)
+                {
+                    const int dest = header.partition;
+                    fcs_dbm_partition_channel__send(&(coord->channels[dest]),
+                        FCS_DBM_PARTITION_MSG_STATES, dest, header.count, 0,
+                        records, num_records);
+                    coord->num_states_msgs_sent[dest]++;
+                    coord->is_idle[dest] = FALSE;
+                }
+                break;
+
+            case FCS_DBM_PARTITION_MSG_IDLE:
+                coord->is_idle[i] = TRUE;
+                coord->num_states_msgs_at_idle[i] = header.count;
+                coord->num_processed[i] = header.num_processed;
+                break;
+
+            case FCS_DBM_PARTITION_MSG_SOLVED:
+                if (! coord->solution_was_found)
+                {
+                    coord->solution_was_found = TRUE;
+                    coord->solution = records[0].key;
+                    for (int w = 0 ; w < coord->num_workers ; w++)
+                    {
+                        fcs_dbm_partition_channel__send(&(coord->channels[w]),
+                            FCS_DBM_PARTITION_MSG_HALT, w, 0, 0, NULL, 0);
+                    }
+                }
+                break;
+
+            case FCS_DBM_PARTITION_MSG_PARENT:
+                coord->has_parent = TRUE;
+                coord->parent = records[0].parent;
+                break;
+
+            case FCS_DBM_PARTITION_MSG_STATS:
+                coord->has_stats[i] = TRUE;
+                coord->num_states[i] = (long)header.count;
+                coord->num_processed[i] = header.num_processed;
+                break;
+            }
+        }
+        if (coord->channels[i].is_eof && (! coord->has_stats[i]))
+        {
+            fprintf(stderr, "Worker %d has terminated prematurely.\n", i);
+            exit(-1);
+        }
+    }
+
+    for (int i = 0 ; i < coord->num_workers ; i++)
+    {
+        if (! coord->channels[i].is_eof)
+        {
+            fcs_dbm_partition_channel__write(&(coord->channels[i]));
+        }
+    }
+
+    {
+        long total_processed = 0;
+        for (int i = 0 ; i < coord->num_workers ; i++)
+        {
+            total_processed += coord->num_processed[i];
+        }
+        if (total_processed / 100000 > coord->last_reported_num_processed / 100000)
+        {
+            fcs_portable_time_t mytime;
+            FCS_GET_TIME(mytime);
+            fprintf (coord->out_fh, "Reached %ld ; Time: %li.%.6li\n",
+                total_processed,
+                FCS_TIME_GET_SEC(mytime),
+                FCS_TIME_GET_USEC(mytime)
+            );
+            fflush(coord->out_fh);
+            coord->last_reported_num_processed = total_processed;
+        }
+    }
+}
+
+/*
+ * All the workers are idle and have handled all the states that were sent
+ * to them. Since a worker only sends states while it is busy, and they
+ * arrive before its IDLE message, no more work can appear.
+ * */
+static GCC_INLINE fcs_bool_t coordinator_is_exhausted(
+    const fcs_dbm_partition_coordinator_t * const coord
+)
+{
+    for (int i = 0 ; i < coord->num_workers ; i++)
+    {
+        if ((! coord->is_idle[i]) || (coord->num_states_msgs_at_idle[i]
+            != coord->num_states_msgs_sent[i]))
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+static void coordinator_calc_trace(
+    fcs_dbm_partition_coordinator_t * const coord,
+    fcs_encoded_state_buffer_t * * const ptr_trace,
+    int * const ptr_trace_num
+)
+{
+    int trace_num = 0, trace_max_num = 128;
+    fcs_encoded_state_buffer_t * trace = SMALLOC(trace, trace_max_num);
+
+    trace[trace_num++] = coord->solution;
+    while (1)
+    {
+        fcs_dbm_partition_record_t query;
+        const int owner = fcs_dbm_partition__calc_owner(
+            &(trace[trace_num-1]), coord->num_workers);
+
+        query.key = trace[trace_num-1];
+        fcs_init_encoded_state(&(query.parent));
+        coord->has_parent = FALSE;
+        fcs_dbm_partition_channel__send(&(coord->channels[owner]),
+            FCS_DBM_PARTITION_MSG_QUERY, owner, 1, 0, &query, 1);
+        while (! coord->has_parent)
+        {
+            coordinator_pump(coord);
+        }
+        if (fcs_dbm_partition__is_null_key(&(coord->parent)))
+        {
+            break;
+        }
+        if (trace_num == trace_max_num)
+        {
+            trace = SREALLOC(trace, trace_max_num += 128);
+        }
+        trace[trace_num++] = coord->parent;
+    }
+
+    *ptr_trace = trace;
+    *ptr_trace_num = trace_num;
+}
+
+static unsigned char get_move_from_parent_to_child(
+    const enum fcs_dbm_variant_type_t local_variant,
+    fc_solve_delta_stater_t * const delta,
+    const fcs_encoded_state_buffer_t parent,
+    const fcs_encoded_state_buffer_t child
+)
+{
+    fcs_meta_compact_allocator_t meta_alloc;
+    fcs_compact_allocator_t derived_list_allocator;
+    fcs_encoded_state_buffer_t got_child;
+    fcs_state_keyval_pair_t parent_state;
+    fcs_derived_state_t * derived_list = NULL, * derived_list_recycle_bin = NULL,
+                        * derived_iter;
+    unsigned char move_to_return;
+    DECLARE_IND_BUF_T(indirect_stacks_buffer)
+
+    fc_solve_meta_compact_allocator_init(&meta_alloc);
+    fc_solve_compact_allocator_init(&derived_list_allocator, &meta_alloc);
+    fc_solve_delta_stater_decode_into_state(
+        delta,
+        parent.s,
+        &parent_state,
+        indirect_stacks_buffer
+    );
+
+    instance_solver_thread_calc_derived_states(
+        local_variant,
+        &parent_state,
+        NULL,
+        &derived_list,
+        &derived_list_recycle_bin,
+        &derived_list_allocator,
+        TRUE
+    );
+
+    for (derived_iter = derived_list;
+            derived_iter ;
+            derived_iter = derived_iter->next
+    )
+    {
+        fcs_init_and_encode_state(
+            delta,
+            local_variant,
+            &(derived_iter->state),
+            &got_child
+        );
+
+        if (! memcmp(&got_child, &child, sizeof(child)))
+        {
+            break;
+        }
+    }
+
+    if (! derived_iter)
+    {
+        fprintf(stderr, "%s\n", "Failed to find move. Terminating.");
+        exit(-1);
+    }
+    move_to_return = derived_iter->move;
+
+    fc_solve_compact_allocator_finish(&derived_list_allocator);
+    fc_solve_meta_compact_allocator_finish(&meta_alloc);
+
+    return move_to_return;
+}
+
+static void trace_solution(
+    fcs_dbm_partition_coordinator_t * const coord,
+    const enum fcs_dbm_variant_type_t local_variant,
+    FILE * const out_fh,
+    fc_solve_delta_stater_t * const delta
+)
+{
+    fcs_encoded_state_buffer_t * trace;
+    int trace_num;
+    fcs_state_keyval_pair_t state;
+    char move_buffer[500];
+    fcs_state_locs_struct_t locs;
+    DECLARE_IND_BUF_T(indirect_stacks_buffer)
+
+    fprintf (out_fh, "%s\n", "Success!");
+    fflush (out_fh);
+
+    coordinator_calc_trace(coord, &trace, &trace_num);
+
+    fc_solve_init_locs(&locs);
+
+    for (int i = trace_num-1 ; i >= 0 ; i--)
+    {
+        unsigned char move = 0;
+        fc_solve_delta_stater_decode_into_state(
+            delta,
+            trace[i].s,
+            &state,
+            indirect_stacks_buffer
+        );
+        if (i > 0)
+        {
+            move = get_move_from_parent_to_child(
+                local_variant, delta, trace[i], trace[i-1]
+            );
+        }
+
+        char * const state_as_str =
+            fc_solve_state_as_string(
+                &(state.s),
+                &locs,
+                FREECELLS_NUM,
+                STACKS_NUM,
+                DECKS_NUM,
+                1,
+                0,
+                1
+            );
+
+        fprintf(out_fh, "--------\n%s\n==\n%s\n",
+                state_as_str,
+                (i > 0 )
+                ? move_to_string(move, move_buffer)
+                : "END"
+               );
+        fflush (out_fh);
+
+        free(state_as_str);
+    }
+    free (trace);
+}
+
+static void coordinator_print_stats(
+    const fcs_dbm_partition_coordinator_t * const coord,
+    FILE * const out_fh
+)
+{
+    long total_processed = 0, total_states = 0;
+    fcs_portable_time_t mytime;
+
+    for (int i = 0 ; i < coord->num_workers ; i++)
+    {
+        fprintf(out_fh, ">>>Partition %d: processed=%ld states=%ld\n",
+            i, coord->num_processed[i], coord->num_states[i]);
+        total_processed += coord->num_processed[i];
+        total_states += coord->num_states[i];
+    }
+    FCS_GET_TIME(mytime);
+    fprintf (out_fh, "Reached %ld ; States-in-collection: %ld ; Time: %li.%.6li\n",
+             total_processed,
+             total_states,
+             FCS_TIME_GET_SEC(mytime),
+             FCS_TIME_GET_USEC(mytime)
+            );
+    fflush(out_fh);
+}
+
+static void run_partitioned_solver(
+    const enum fcs_dbm_variant_type_t local_variant,
+    fc_solve_delta_stater_t * const delta,
+    const fcs_encoded_state_buffer_t * const init_key,
+    const int num_workers,
+    const char * const offload_dir_path,
+    FILE * const out_fh
+)
+{
+    fcs_dbm_partition_coordinator_t coord;
+
+    coord.num_workers = num_workers;
+    coord.pids = SMALLOC(coord.pids, num_workers);
+    coord.channels = SMALLOC(coord.channels, num_workers);
+    coord.pfds = SMALLOC(coord.pfds, num_workers);
+    coord.num_states_msgs_sent = SMALLOC(coord.num_states_msgs_sent, num_workers);
+    coord.num_states_msgs_at_idle = SMALLOC(coord.num_states_msgs_at_idle, num_workers);
+    coord.num_processed = SMALLOC(coord.num_processed, num_workers);
+    coord.num_states = SMALLOC(coord.num_states, num_workers);
+    coord.is_idle = SMALLOC(coord.is_idle, num_workers);
+    coord.has_stats = SMALLOC(coord.has_stats, num_workers);
+    coord.solution_was_found = FALSE;
+    coord.last_reported_num_processed = 0;
+    coord.out_fh = out_fh;
+
+    fflush(out_fh);
+    for (int i = 0 ; i < num_workers ; i++)
+    {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds))
+        {
+            fprintf(stderr, "%s\n", "Could not create a socket pair.");
+            exit(-1);
+        }
+        const pid_t pid = fork();
+        if (pid < 0)
+        {
+            fprintf(stderr, "%s\n", "Could not fork a worker.");
+            exit(-1);
+        }
+        else if (pid == 0)
+        {
+            fcs_dbm_partition_worker_t worker;
+
+            close(fds[0]);
+            /* The channels of the previous workers are inherited. */
+            for (int j = 0 ; j < i ; j++)
+            {
+                close(coord.channels[j].fd);
+            }
+            worker.idx = i;
+            worker.num_workers = num_workers;
+            worker.variant = local_variant;
+            worker.delta_stater = delta;
+            fcs_dbm_partition_channel__init(&(worker.channel), fds[1]);
+            worker_run(&worker, offload_dir_path);
+            _exit(0);
+        }
+        close(fds[1]);
+        coord.pids[i] = pid;
+        fcs_dbm_partition_channel__init(&(coord.channels[i]), fds[0]);
+        coord.num_states_msgs_sent[i] = 0;
+        coord.num_states_msgs_at_idle[i] = -1;
+        coord.num_processed[i] = coord.num_states[i] = 0;
+        coord.is_idle[i] = coord.has_stats[i] = FALSE;
+    }
+
+    {
+        fcs_dbm_partition_record_t init_rec;
+        const int owner = fcs_dbm_partition__calc_owner(init_key, num_workers);
+
+        init_rec.key = *init_key;
+        /* The NULL parent indicates the initial state. */
+        fcs_init_encoded_state(&(init_rec.parent));
+        fcs_dbm_partition_channel__send(&(coord.channels[owner]),
+            FCS_DBM_PARTITION_MSG_STATES, owner, 1, 0, &init_rec, 1);
+        coord.num_states_msgs_sent[owner]++;
+    }
+
+    while (! (coord.solution_was_found || coordinator_is_exhausted(&coord)))
+    {
+        coordinator_pump(&coord);
+    }
+
+    if (coord.solution_was_found)
+    {
+        trace_solution(&coord, local_variant, out_fh, delta);
+    }
+    else
+    {
+        fprintf (out_fh, "%s\n", "Could not solve successfully.");
+    }
+
+    for (int i = 0 ; i < num_workers ; i++)
+    {
+        fcs_dbm_partition_channel__send(&(coord.channels[i]),
+            FCS_DBM_PARTITION_MSG_STOP, i, 0, 0, NULL, 0);
+    }
+    for (fcs_bool_t has_all_stats = FALSE ; ! has_all_stats ; )
+    {
+        coordinator_pump(&coord);
+        has_all_stats = TRUE;
+        for (int i = 0 ; i < num_workers ; i++)
+        {
+            has_all_stats &= coord.has_stats[i];
+        }
+    }
+    for (int i = 0 ; i < num_workers ; i++)
+    {
+        waitpid(coord.pids[i], NULL, 0);
+        fcs_dbm_partition_channel__destroy(&(coord.channels[i]));
+    }
+    coordinator_print_stats(&coord, out_fh);
+
+    free(coord.pids);
+    free(coord.channels);
+    free(coord.pfds);
+    free(coord.num_states_msgs_sent);
+    free(coord.num_states_msgs_at_idle);
+    free(coord.num_processed);
+    free(coord.num_states);
+    free(coord.is_idle);
+    free(coord.has_stats);
+}
+
+#define USER_STATE_SIZE 2000
+
+int main(int argc, char * argv[])
+{
+    int num_processes = 2;
+    int arg;
+    const char * filename = NULL, * out_filename = NULL,
+          * offload_dir_path = NULL;
+    FILE * fh = NULL, * out_fh = NULL;
+    char user_state[USER_STATE_SIZE];
+    fc_solve_delta_stater_t * delta;
+    enum fcs_dbm_variant_type_t local_variant;
+    fcs_state_keyval_pair_t init_state;
+    fcs_encoded_state_buffer_t init_key;
+    DECLARE_IND_BUF_T(init_indirect_stacks_buffer)
+
+    local_variant = FCS_DBM_VARIANT_2FC_FREECELL;
+
+    for (arg=1;arg < argc; arg++)
+    {
+        if (!strcmp(argv[arg], "--game"))
+        {
+            arg++;
+            if (arg == argc)
+            {
+                fprintf(stderr, "--game came without an argument!\n");
+                exit(-1);
+            }
+            if (!strcmp(argv[arg], "bakers_dozen"))
+            {
+                local_variant = FCS_DBM_VARIANT_BAKERS_DOZEN;
+            }
+            else if (!strcmp(argv[arg], "freecell"))
+            {
+                local_variant = FCS_DBM_VARIANT_2FC_FREECELL;
+            }
+            else
+            {
+                fprintf(stderr, "Unknown game '%s'. Aborting\n", argv[arg]);
+                exit(-1);
+            }
+        }
+        else if (!strcmp(argv[arg], "--num-processes"))
+        {
+            arg++;
+            if (arg == argc)
+            {
+                fprintf(stderr, "--num-processes came without an argument!\n");
+                exit(-1);
+            }
+            num_processes = atoi(argv[arg]);
+            if (num_processes < 1)
+            {
+                fprintf(stderr, "--num-processes must be at least 1.\n");
+                exit(-1);
+            }
+        }
+        else if (!strcmp(argv[arg], "-o"))
+        {
+            arg++;
+            if (arg == argc)
+            {
+                fprintf(stderr, "-o came without an argument.\n");
+                exit(-1);
+            }
+            out_filename = argv[arg];
+        }
+        else if (!strcmp(argv[arg], "--offload-dir-path"))
+        {
+            arg++;
+            if (arg == argc)
+            {
+                fprintf(stderr, "--offload-dir-path came without an argument.\n");
+                exit(-1);
+            }
+            offload_dir_path = argv[arg];
+        }
+        else
+        {
+            fcs_dbm_checkpoint__reject_option(argv[arg], "partitioned_dbm_fc_solver");
+            break;
+        }
+    }
+
+    if (arg < argc-1)
+    {
+        fprintf (stderr, "%s\n", "Junk arguments!");
+        exit(-1);
+    }
+    else if (arg == argc)
+    {
+        fprintf (stderr, "%s\n", "No board specified.");
+        exit(-1);
+    }
+
+    if (! offload_dir_path)
+    {
+        fprintf (stderr, "%s\n", "--offload-dir-path must be specified.");
+        exit(-1);
+    }
+
+    if (out_filename)
+    {
+        out_fh = fopen(out_filename, "at");
+        if (! out_fh)
+        {
+            fprintf (stderr, "Cannot open '%s' for output.\n",
+                     "out_filename");
+            exit(-1);
+        }
+    }
+    else
+    {
+        out_fh = stdout;
+    }
+
+    filename = argv[arg];
+
+    fh = fopen(filename, "r");
+    if (fh == NULL)
+    {
+        fprintf (stderr, "Could not open file '%s' for input.\n", filename);
+        exit(-1);
+    }
+    memset(user_state, '\0', sizeof(user_state));
+    fread(user_state, sizeof(user_state[0]), USER_STATE_SIZE-1, fh);
+    fclose(fh);
+
+    fc_solve_initial_user_state_to_c(
+        user_state,
+        &init_state,
+        FREECELLS_NUM,
+        STACKS_NUM,
+        DECKS_NUM,
+        init_indirect_stacks_buffer
+    );
+
+    {
+        fcs_which_moves_bitmask_t which_no_use = {{'\0'}};
+        horne_prune(local_variant, &init_state, &which_no_use, NULL, NULL);
+    }
+
+    delta = fc_solve_delta_stater_alloc(
+            &init_state.s,
+            STACKS_NUM,
+            FREECELLS_NUM
+#ifndef FCS_FREECELL_ONLY
+            , ((local_variant == FCS_DBM_VARIANT_BAKERS_DOZEN)
+               ? FCS_SEQ_BUILT_BY_RANK
+               : FCS_SEQ_BUILT_BY_ALTERNATE_COLOR)
+#endif
+    );
+
+    fcs_init_and_encode_state(delta, local_variant, &(init_state), &init_key);
+
+    run_partitioned_solver(local_variant, delta, &init_key, num_processes,
+        offload_dir_path, out_fh);
+
+    fc_solve_delta_stater_free(delta);
+    delta = NULL;
+
+    if (out_filename)
+    {
+        fclose(out_fh);
+        out_fh = NULL;
+    }
+
+    return 0;
+}
@@ -0,0 +1,538 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * pattern_db.h - an additive pattern database, which gives an admissible
+ * lower bound on the number of single card moves that are needed to solve
+ * a single deck state, for the optimal A* scan.
+ *
+ * The cards are partitioned into patterns of suits_num suits by ranks_num
+ * consecutive ranks, and every pattern is abstracted by ignoring the other
+ * cards, and by relaxing the rules so a card that is exposed can always be
+ * put aside, as if there were unlimited freecells. The database holds the
+ * least number of moves of the pattern's cards that put them all in the
+ * foundations, for every arrangement of a pattern's cards. All the patterns
+ * share the same table, and since a move only moves the card of a single
+ * pattern, the sum of the patterns' entries is a lower bound too.
+ *
+ * An arrangement is encoded by what every card of the pattern is on: the
+ * foundation, a freecell, the bottom of a column, or another card of the
+ * pattern. This captures the cards that are placed above a lower card of
+ * their suit, and the cycles of such blockers between the suits of a
+ * pattern (e.g: a 3 of Spades above the 2 of Hearts and the 3 of Hearts
+ * above the 2 of Spades), one of whose cards must be moved twice.
+ *
+ * The database does not depend on the variant, as long as the cards are
+ * moved to the foundations one by one.
+ */
+#ifndef FC_SOLVE__PATTERN_DB_H
+#define FC_SOLVE__PATTERN_DB_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef WIN32
+#include <sys/mman.h>
+#endif
+
+#include "alloc_wrap.h"
+#include "inline.h"
+#include "bool.h"
+#include "min_and_max.h"
+#include "state.h"
+
+#define FCS_PATTERN_DB_MAX_CARDS 8
+#define FCS_PATTERN_DB_NUM_SUITS 4
+#define FCS_PATTERN_DB_NUM_RANKS 13
+#define FCS_PATTERN_DB_MAX_NUM_PATTERNS \
+    (FCS_PATTERN_DB_NUM_SUITS * FCS_PATTERN_DB_NUM_RANKS)
+#define FCS_PATTERN_DB_MAGIC "FCSPTDB1"
+
+/* The codes of what a card of the pattern is on, besides another card of
+ * the pattern. */
+enum
+{
+    FCS_PATTERN_DB_FOUNDATION = 0,
+    FCS_PATTERN_DB_FREECELL = 1,
+    FCS_PATTERN_DB_BOTTOM = 2,
+    FCS_PATTERN_DB_FIRST_CARD_CODE = 3
+};
+
+/* The entries of the arrangements that cannot occur. */
+#define FCS_PATTERN_DB_INVALID 0xFF
+#define FCS_PATTERN_DB_UNKNOWN 0xFE
+
+typedef struct
+{
+    int suits_num;
+    int ranks_num;
+} fcs_pattern_db_params_t;
+
+typedef struct
+{
+    char magic[8];
+    fcs_pattern_db_params_t params;
+} fcs_pattern_db_file_header_t;
+
+typedef struct
+{
+    fcs_pattern_db_params_t params;
+    /* The number of cards in a pattern, and of the codes of every card. */
+    int num_cards;
+    int num_codes;
+    size_t num_entries;
+    /* The entries, or NULL if the database was not loaded. */
+    unsigned char * values;
+    /* What was mapped (or allocated) to hold the entries. */
+    void * mapped;
+    size_t mapped_len;
+} fcs_pattern_db_t;
+
+/*
+ * Returns NULL if the params are valid, or an error message.
+ * */
+static GCC_INLINE const char * fc_solve_pattern_db__check_params(
+    const fcs_pattern_db_params_t * const params
+)
+{
+    if (! ((params->suits_num == 1) || (params->suits_num == 2)
+        || (params->suits_num == FCS_PATTERN_DB_NUM_SUITS)))
+    {
+        return "The number of suits of a pattern must be 1, 2 or 4.";
+    }
+    if ((params->ranks_num < 1)
+        || (params->suits_num * params->ranks_num > FCS_PATTERN_DB_MAX_CARDS))
+    {
+        return "A pattern must have between 1 and 8 cards.";
+    }
+    return NULL;
+}
+
+static GCC_INLINE void fc_solve_pattern_db__init(
+    fcs_pattern_db_t * const db,
+    const fcs_pattern_db_params_t * const params
+)
+{
+    db->params = *params;
+    db->num_cards = params->suits_num * params->ranks_num;
+    db->num_codes = FCS_PATTERN_DB_FIRST_CARD_CODE + db->num_cards - 1;
+    db->num_entries = 1;
+    for (int i = 0 ; i < db->num_cards ; i++)
+    {
+        db->num_entries *= (size_t)db->num_codes;
+    }
+    db->values = NULL;
+    db->mapped = NULL;
+    db->mapped_len = 0;
+}
+
+static GCC_INLINE void fc_solve_pattern_db__free(fcs_pattern_db_t * const db)
+{
+    if (db->mapped)
+    {
+#ifndef WIN32
+        munmap(db->mapped, db->mapped_len);
+#else
+        free(db->mapped);
+#endif
+    }
+    else
+    {
+        free(db->values);
+    }
+    db->values = NULL;
+    db->mapped = NULL;
+}
+
+/*
+ * The cards of a pattern are numbered by suit and then by rank, so card
+ * i can only be put in the foundation after cards i-1, i-2, etc. of the
+ * same suit. The card beneath another card is encoded without the card
+ * itself, as it cannot be beneath itself.
+ * */
+static GCC_INLINE int fc_solve_pattern_db__card_code(
+    const int card,
+    const int beneath
+)
+{
+    return FCS_PATTERN_DB_FIRST_CARD_CODE
+        + ((beneath < card) ? beneath : (beneath - 1));
+}
+
+static GCC_INLINE int fc_solve_pattern_db__beneath_card(
+    const int card,
+    const int code
+)
+{
+    const int beneath = code - FCS_PATTERN_DB_FIRST_CARD_CODE;
+    return ((beneath < card) ? beneath : (beneath + 1));
+}
+
+static GCC_INLINE size_t fc_solve_pattern_db__calc_idx(
+    const fcs_pattern_db_t * const db,
+    const int * const codes
+)
+{
+    size_t idx = 0;
+    for (int i = db->num_cards - 1 ; i >= 0 ; i--)
+    {
+        idx = idx * (size_t)db->num_codes + (size_t)codes[i];
+    }
+    return idx;
+}
+
+/*
+ * Returns whether the arrangement can occur: a card is covered by at most
+ * one card, a card in the foundation or in a freecell is not covered, and
+ * every card in a column rests on its bottom eventually. The cards of the
+ * last pattern of a suit that are above the King are in the foundation.
+ * */
+static GCC_INLINE fcs_bool_t fc_solve_pattern_db__is_valid(
+    const fcs_pattern_db_t * const db,
+    const int * const codes,
+    fcs_bool_t * const is_covered
+)
+{
+    const int num_cards = db->num_cards;
+
+    for (int i = 0 ; i < num_cards ; i++)
+    {
+        is_covered[i] = FALSE;
+    }
+    for (int i = 0 ; i < num_cards ; i++)
+    {
+        if (codes[i] >= FCS_PATTERN_DB_FIRST_CARD_CODE)
+        {
+            const int b = fc_solve_pattern_db__beneath_card(i, codes[i]);
+            if (is_covered[b] || (codes[b] < FCS_PATTERN_DB_BOTTOM))
+            {
+                return FALSE;
+            }
+            is_covered[b] = TRUE;
+        }
+    }
+    for (int i = 0 ; i < num_cards ; i++)
+    {
+        int code = codes[i];
+        int card = i;
+        for (int steps = 0 ; code >= FCS_PATTERN_DB_FIRST_CARD_CODE ; steps++)
+        {
+            if (steps == num_cards)
+            {
+                return FALSE;
+            }
+            card = fc_solve_pattern_db__beneath_card(card, code);
+            code = codes[card];
+        }
+    }
+    return TRUE;
+}
+
+/*
+ * Calculates the entry of idx, and of the arrangements that it leads to,
+ * from the least of the entries of its moves: an exposed card is either
+ * put aside in a freecell, or moved to the foundation after the lower
+ * cards of its suit. Every move puts a card in a freecell or in the
+ * foundation for good, so the recursion is at most 2*num_cards deep.
+ * */
+static GCC_INLINE int fc_solve_pattern_db__calc_entry(
+    fcs_pattern_db_t * const db,
+    const size_t idx
+)
+{
+    if (db->values[idx] != FCS_PATTERN_DB_UNKNOWN)
+    {
+        return db->values[idx];
+    }
+
+    const int num_cards = db->num_cards;
+    const int ranks_num = db->params.ranks_num;
+    int codes[FCS_PATTERN_DB_MAX_CARDS];
+    fcs_bool_t is_covered[FCS_PATTERN_DB_MAX_CARDS];
+    size_t rest = idx;
+    for (int i = 0 ; i < num_cards ; i++)
+    {
+        codes[i] = (int)(rest % (size_t)db->num_codes);
+        rest /= (size_t)db->num_codes;
+    }
+
+    int ret = 0;
+    if (! fc_solve_pattern_db__is_valid(db, codes, is_covered))
+    {
+        ret = FCS_PATTERN_DB_INVALID;
+    }
+    else if (idx != 0)
+    {
+        ret = FCS_PATTERN_DB_INVALID;
+        size_t power = 1;
+        for (int i = 0 ; i < num_cards ;
+            power *= (size_t)db->num_codes, i++)
+        {
+            const int code = codes[i];
+            if ((code == FCS_PATTERN_DB_FOUNDATION) || is_covered[i])
+            {
+                continue;
+            }
+            if (code != FCS_PATTERN_DB_FREECELL)
+            {
+                const int val = fc_solve_pattern_db__calc_entry(db,
+                    idx - power * (size_t)(code - FCS_PATTERN_DB_FREECELL));
+                ret = min(ret, val + 1);
+            }
+            if ((! (i % ranks_num))
+                || (codes[i-1] == FCS_PATTERN_DB_FOUNDATION))
+            {
+                const int val = fc_solve_pattern_db__calc_entry(db,
+                    idx - power * (size_t)code);
+                ret = min(ret, val + 1);
+            }
+        }
+    }
+
+    return (db->values[idx] = (unsigned char)ret);
+}
+
+static GCC_INLINE void fc_solve_pattern_db__generate(fcs_pattern_db_t * const db)
+{
+    db->values = SMALLOC(db->values, db->num_entries);
+    memset(db->values, FCS_PATTERN_DB_UNKNOWN, db->num_entries);
+
+    for (size_t idx = 0 ; idx < db->num_entries ; idx++)
+    {
+        fc_solve_pattern_db__calc_entry(db, idx);
+    }
+}
+
+static GCC_INLINE fcs_bool_t fc_solve_pattern_db__write(
+    const fcs_pattern_db_t * const db,
+    const char * const filename
+)
+{
+    FILE * const f = fopen(filename, "wb");
+    if (! f)
+    {
+        return FALSE;
+    }
+    fcs_pattern_db_file_header_t header;
+    memset(&header, '\0', sizeof(header));
+    memcpy(header.magic, FCS_PATTERN_DB_MAGIC, sizeof(header.magic));
+    header.params = db->params;
+    const fcs_bool_t ret =
+        ((fwrite(&header, sizeof(header), 1, f) == 1)
+         && (fwrite(db->values, 1, db->num_entries, f) == db->num_entries));
+    return ((fclose(f) == 0) && ret);
+}
+
+/*
+ * Loads the database from filename. Returns NULL on success or an error
+ * message.
+ * */
+static GCC_INLINE const char * fc_solve_pattern_db__load(
+    fcs_pattern_db_t * const db,
+    const char * const filename
+)
+{
+    FILE * const f = fopen(filename, "rb");
+    if (! f)
+    {
+        return "Could not open the pattern database.";
+    }
+    fcs_pattern_db_file_header_t header;
+    if ((fread(&header, sizeof(header), 1, f) != 1)
+        || memcmp(header.magic, FCS_PATTERN_DB_MAGIC, sizeof(header.magic))
+        || fc_solve_pattern_db__check_params(&(header.params)))
+    {
+        fclose(f);
+        return "The file is not a pattern database.";
+    }
+    fc_solve_pattern_db__init(db, &(header.params));
+    fseek(f, 0, SEEK_END);
+    if ((size_t)ftell(f) != sizeof(header) + db->num_entries)
+    {
+        fclose(f);
+        return "The pattern database is truncated.";
+    }
+
+    db->mapped_len = sizeof(header) + db->num_entries;
+#ifndef WIN32
+    db->mapped = mmap(NULL, db->mapped_len, PROT_READ, MAP_SHARED, fileno(f), 0);
+    if (db->mapped == MAP_FAILED)
+    {
+        db->mapped = NULL;
+    }
+#else
+    db->mapped = malloc(db->mapped_len);
+    fseek(f, 0, SEEK_SET);
+    if (db->mapped &&
+        (fread(db->mapped, 1, db->mapped_len, f) != db->mapped_len))
+    {
+        free(db->mapped);
+        db->mapped = NULL;
+    }
+#endif
+    fclose(f);
+    if (! db->mapped)
+    {
+        return "Could not map the pattern database.";
+    }
+    db->values = ((unsigned char *)db->mapped) + sizeof(header);
+
+    return NULL;
+}
+
+/*
+ * Returns a lower bound on the number of single card moves that solve
+ * the state. The cards that are above a lower card of their suit in their
+ * column have to be moved aside before they are moved to the foundation,
+ * so each of them is counted once, and is then taken to be in a freecell.
+ * The rest of the moves are bounded by the sum of the entries of the
+ * patterns, or, if the database was not loaded, by the number of cards
+ * outside the foundations. With more than one deck, the bound is only the
+ * number of cards outside the foundations.
+ * */
+static GCC_INLINE int fc_solve_pattern_db__calc_lower_bound(
+    const fcs_pattern_db_t * const db,
+    const fcs_state_t * const state,
+    const int freecells_num,
+    const int stacks_num,
+    const int decks_num
+)
+{
+    int num_cards_out = 0;
+    for (int found_idx = 0 ; found_idx < (decks_num << 2) ; found_idx++)
+    {
+        num_cards_out += 13 - fcs_foundation_value(*state, found_idx);
+    }
+    if (decks_num != 1)
+    {
+        return num_cards_out;
+    }
+
+    const fcs_bool_t use_db = (db->values != NULL);
+    const int suits_num = db->params.suits_num;
+    const int ranks_num = db->params.ranks_num;
+    const int num_windows = (use_db
+        ? ((FCS_PATTERN_DB_NUM_RANKS + ranks_num - 1) / ranks_num) : 0);
+    const int num_patterns =
+        num_windows * (FCS_PATTERN_DB_NUM_SUITS / (use_db ? suits_num : 1));
+    int codes[FCS_PATTERN_DB_MAX_NUM_PATTERNS][FCS_PATTERN_DB_MAX_CARDS];
+    if (use_db)
+    {
+        memset(codes, '\0', sizeof(codes[0]) * (size_t)num_patterns);
+    }
+
+#define PATTERN(suit, rank) \
+    (((suit) / suits_num) * num_windows + ((rank) - 1) / ranks_num)
+#define PATTERN_CARD(suit, rank) \
+    (((suit) % suits_num) * ranks_num + ((rank) - 1) % ranks_num)
+
+    int num_blocked = 0;
+    for (int c = 0 ; c < stacks_num ; c++)
+    {
+        const fcs_const_cards_column_t col = fcs_state_get_col(*state, c);
+        const int col_len = fcs_col_len(col);
+        int min_rank[FCS_PATTERN_DB_NUM_SUITS] = {14, 14, 14, 14};
+        int last_card[FCS_PATTERN_DB_MAX_NUM_PATTERNS];
+        if (use_db)
+        {
+            for (int p = 0 ; p < num_patterns ; p++)
+            {
+                last_card[p] = -1;
+            }
+        }
+        for (int i = 0 ; i < col_len ; i++)
+        {
+            const fcs_card_t card = fcs_col_get_card(col, i);
+            const int suit = fcs_card_suit(card);
+            const int rank = fcs_card_rank(card);
+            const fcs_bool_t is_blocked = (min_rank[suit] < rank);
+            if (is_blocked)
+            {
+                num_blocked++;
+            }
+            else
+            {
+                min_rank[suit] = rank;
+            }
+            if (use_db)
+            {
+                const int pattern = PATTERN(suit, rank);
+                const int pattern_card = PATTERN_CARD(suit, rank);
+                if (is_blocked)
+                {
+                    codes[pattern][pattern_card] = FCS_PATTERN_DB_FREECELL;
+                }
+                else
+                {
+                    codes[pattern][pattern_card] = ((last_card[pattern] < 0)
+                        ? FCS_PATTERN_DB_BOTTOM
+                        : fc_solve_pattern_db__card_code(
+                            pattern_card, last_card[pattern]));
+                    last_card[pattern] = pattern_card;
+                }
+            }
+        }
+    }
+
+    if (! use_db)
+    {
+        return num_cards_out + num_blocked;
+    }
+
+    for (int f = 0 ; f < freecells_num ; f++)
+    {
+        const fcs_card_t card = fcs_freecell_card(*state, f);
+        if (fcs_card_is_valid(card))
+        {
+            const int suit = fcs_card_suit(card);
+            const int rank = fcs_card_rank(card);
+            codes[PATTERN(suit, rank)][PATTERN_CARD(suit, rank)] =
+                FCS_PATTERN_DB_FREECELL;
+        }
+    }
+#undef PATTERN
+#undef PATTERN_CARD
+
+    int sum = num_blocked;
+    for (int p = 0 ; p < num_patterns ; p++)
+    {
+        const int val = db->values[fc_solve_pattern_db__calc_idx(db, codes[p])];
+        if (val != FCS_PATTERN_DB_INVALID)
+        {
+            sum += val;
+        }
+    }
+
+    return sum;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FC_SOLVE__PATTERN_DB_H */
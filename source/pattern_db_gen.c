@@ -0,0 +1,137 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ *  pattern_db_gen.c - generates the pattern database of the optimal A*
+ *  scan (see pattern_db.h and the --pattern-db option in USAGE.txt).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pattern_db.h"
+
+static void print_help(void)
+{
+    printf("\n%s",
+"freecell-solver-pattern-db-gen [--suits-num n] [--ranks-num n] -o filename\n"
+"\n"
+"Generates the pattern database that fc-solve's --pattern-db option loads,\n"
+"whose patterns are the cards of n suits by n consecutive ranks. It\n"
+"occupies (n+2)^n bytes for n cards in a pattern, at most 8.\n"
+"\n"
+"--suits-num n\n"
+"     The number of suits of every pattern: 1, 2 or 4 (default: 2).\n"
+"--ranks-num n\n"
+"     The number of ranks of every pattern (default: 3).\n"
+"-o filename\n"
+"     Writes the database to filename.\n"
+          );
+}
+
+int main(int argc, char * argv[])
+{
+    fcs_pattern_db_params_t params = {
+        .suits_num = 2,
+        .ranks_num = 3,
+    };
+    const char * output_filename = NULL;
+
+    for (int arg = 1 ; arg < argc ; arg++)
+    {
+        if ((!strcmp(argv[arg], "--help")) || (!strcmp(argv[arg], "-h")))
+        {
+            print_help();
+            exit(0);
+        }
+        if (arg + 1 == argc)
+        {
+            fprintf(stderr, "Unknown option or no argument for %s!\n", argv[arg]);
+            print_help();
+            exit(-1);
+        }
+        const char * const val = argv[arg + 1];
+        if (!strcmp(argv[arg], "--suits-num"))
+        {
+            params.suits_num = atoi(val);
+        }
+        else if (!strcmp(argv[arg], "--ranks-num"))
+        {
+            params.ranks_num = atoi(val);
+        }
+        else if (!strcmp(argv[arg], "-o"))
+        {
+            output_filename = val;
+        }
+        else
+        {
+            fprintf(stderr, "Unknown option %s!\n", argv[arg]);
+            print_help();
+            exit(-1);
+        }
+        arg++;
+    }
+
+    if (! output_filename)
+    {
+        fprintf(stderr, "%s", "No output file was specified!\n");
+        print_help();
+        exit(-1);
+    }
+    {
+        const char * const error = fc_solve_pattern_db__check_params(&params);
+        if (error)
+        {
+            fprintf(stderr, "%s\n", error);
+            exit(-1);
+        }
+    }
+
+    fcs_pattern_db_t db;
+    fc_solve_pattern_db__init(&db, &params);
+    fc_solve_pattern_db__generate(&db);
+
+    int max_val = 0;
+    size_t num_valid = 0;
+    for (size_t idx = 0 ; idx < db.num_entries ; idx++)
+    {
+        if (db.values[idx] != FCS_PATTERN_DB_INVALID)
+        {
+            num_valid++;
+            max_val = max(max_val, db.values[idx]);
+        }
+    }
+
+    if (! fc_solve_pattern_db__write(&db, output_filename))
+    {
+        fprintf(stderr, "Could not write \"%s\"!\n", output_filename);
+        exit(-1);
+    }
+    printf("Wrote %lu entries (%lu of them valid, with up to %d moves) to \"%s\".\n",
+        (unsigned long)db.num_entries, (unsigned long)num_valid, max_val,
+        output_filename);
+
+    fc_solve_pattern_db__free(&db);
+
+    return 0;
+}
@@ -229,6 +229,46 @@ static GCC_INLINE void fc_solve_pq_pop(
     return;
 }
 
+/*
+ * Restores the heap property after the elements were modified in place
+ * (e.g: some of them were filtered out), in O(n) time instead of the
+ * O(n*log(n)) of pushing them one by one.
+ * */
+static GCC_INLINE void fc_solve_pq_rebuild(
+    PQUEUE * const pq
+)
+{
+    pq_element_t * const Elements = pq->Elements;
+    const typeof(pq->CurrentSize) CurrentSize = pq->CurrentSize;
+
+    for (int start = PQ_PARENT_INDEX(CurrentSize) ; start >= PQ_FIRST_ENTRY ; start--)
+    {
+        const pq_element_t elem = Elements[start];
+        int i, child;
+
+        for( i=start; (child = PQ_LEFT_CHILD_INDEX(i)) <= CurrentSize; i=child )
+        {
+            if( (child != CurrentSize) &&
+                (fcs_pq_rating(Elements[child + 1]) > fcs_pq_rating(Elements[child])) )
+            {
+                child ++;
+            }
+
+            if( fcs_pq_rating( elem ) < fcs_pq_rating( Elements[ child ] ) )
+            {
+                Elements[ i ] = Elements[ child ];
+            }
+            else
+            {
+                break;
+            }
+        }
+
+        Elements[i] = elem;
+    }
+
+    return;
+}
 
 #ifdef __cplusplus
 }
@@ -43,16 +43,23 @@ typedef struct
 
 typedef Pvoid_t store_t;
 
-static GCC_INLINE void delete_state(
+static GCC_INLINE void remove_state(
     store_t * const store,
-    fcs_pdfs_lru_cache_t * const cache,
     fcs_cache_key_t * const key)
 {
     int Rc_int;
-    fcs_pdfs_cache_insert(cache, &(key->s));
     JHSD(Rc_int, *store, &(key->s), sizeof(key->s));
 }
 
+static GCC_INLINE void delete_state(
+    store_t * const store,
+    fcs_pdfs_shared_cache_t * const cache,
+    fcs_cache_key_t * const key)
+{
+    fcs_pdfs_shared_cache_insert(cache, &(key->s));
+    remove_state(store, key);
+}
+
 static GCC_INLINE void insert_state(
     store_t * store,
     fcs_cache_key_t * key)
@@ -64,7 +71,7 @@ static GCC_INLINE void insert_state(
 
 static GCC_INLINE const fcs_bool_t lookup_state(
     store_t * const store,
-    fcs_pdfs_lru_cache_t * const cache,
+    fcs_pdfs_shared_cache_t * const cache,
     fcs_cache_key_t * const key)
 {
     Word_t * PValue;
@@ -78,7 +85,7 @@ static GCC_INLINE const fcs_bool_t lookup_state(
     }
     else
     {
-        return fcs_pdfs_cache_does_key_exist(cache, &(key->s));
+        return fcs_pdfs_shared_cache_does_key_exist(cache, &(key->s));
     }
 #endif
 }
@@ -87,11 +94,13 @@ typedef struct
 {
     fcs_lock_t storage_lock;
     store_t store;
-    fcs_pdfs_lru_cache_t cache;
+    fcs_pdfs_shared_cache_t * cache;
 
     long pre_cache_max_count;
     /* The stack */
     int stack_depth, max_stack_depth;
+    /* The scan ends when the stack falls below this depth. */
+    int min_stack_depth;
     pseduo_dfs_stack_item_t * stack;
     long count_num_processed, max_count_num_processed;
     fcs_bool_t solution_was_found;
@@ -111,7 +120,7 @@ static GCC_INLINE void instance__inspect_new_state(
 {
     instance->count_num_processed++;
 
-    if (fcs_pdfs_cache_does_key_exist(&(instance->cache), &(state->s)))
+    if (fcs_pdfs_shared_cache_does_key_exist(instance->cache, &(state->s)))
     {
         instance->stack_depth--;
         return;
@@ -157,7 +166,7 @@ static GCC_INLINE void instance__inspect_new_state(
         kv.val = &(derived_list->state.info);
         fc_solve_canonize_state(&kv, FREECELLS_NUM, STACKS_NUM);
 
-        if (! lookup_state(&(instance->store), &(instance->cache), &(derived_list->state)))
+        if (! lookup_state(&(instance->store), instance->cache, &(derived_list->state)))
         {
             int i = (stack_item->count_next_states)++;
             if (i >= stack_item->max_count_next_states)
@@ -182,7 +191,7 @@ static GCC_INLINE void instance_init(
     fcs_dbm_solver_instance_t * const instance,
     enum fcs_dbm_variant_type_t local_variant,
     fcs_cache_key_t * init_state,
-    long max_num_elements_in_cache
+    fcs_pdfs_shared_cache_t * const cache
 )
 {
     instance->local_variant = local_variant;
@@ -198,6 +207,7 @@ static GCC_INLINE void instance_init(
     instance->stack = NULL;
     instance->max_stack_depth = 0;
     instance->stack_depth = 0;
+    instance->min_stack_depth = 0;
 
     fc_solve_meta_compact_allocator_init(
         &(instance->meta_alloc)
@@ -205,7 +215,7 @@ static GCC_INLINE void instance_init(
     fc_solve_compact_allocator_init(&(instance->derived_list_allocator), &(instance->meta_alloc));
     instance->derived_list_recycle_bin = NULL;
 
-    fcs_pdfs_cache_init(&(instance->cache), max_num_elements_in_cache, &(instance->meta_alloc));
+    instance->cache = cache;
 
     insert_state(&(instance->store), init_state);
 
@@ -216,7 +226,7 @@ static GCC_INLINE void instance_free(
     fcs_dbm_solver_instance_t * const instance
 )
 {
-    for (int d = 0; d < instance->stack_depth ; d++)
+    for (int d = 0; d < instance->max_stack_depth ; d++)
     {
         free (instance->stack[d].next_states);
         instance->stack[d].next_states = NULL;
@@ -227,8 +237,6 @@ static GCC_INLINE void instance_free(
     Word_t Rc_word;
     JHSFA(Rc_word, instance->store);
 
-    fcs_pdfs_cache_destroy(&(instance->cache));
-
     fc_solve_compact_allocator_finish(&(instance->derived_list_allocator));
     fc_solve_meta_compact_allocator_finish(&(instance->meta_alloc));
 }
@@ -241,7 +249,7 @@ static GCC_INLINE void instance_run(
         && (instance->should_terminate == DONT_TERMINATE))
     {
         const int depth = (instance->stack_depth);
-        if (depth < 0)
+        if (depth < instance->min_stack_depth)
         {
             instance->should_terminate = QUEUE_TERMINATE;
         }
@@ -254,7 +262,7 @@ static GCC_INLINE void instance_run(
                 /* Demote from the current depth. */
                 for (int i = 0; i < stack_item->count_next_states ; i++)
                 {
-                    delete_state(&(instance->store), &(instance->cache), &(stack_item->next_states[ i ]));
+                    delete_state(&(instance->store), instance->cache, &(stack_item->next_states[ i ]));
                 }
                 stack_item->count_next_states = 0;
                 stack_item->next_state_idx = 0;
@@ -285,6 +293,8 @@ static GCC_INLINE void instance__print_coords_to_log(
     }
 
 #if 1
+    /* The stack is empty once the scan was exhausted. */
+    if (instance->stack_depth >= 0)
     {
 
         fcs_state_locs_struct_t locs;
@@ -309,6 +319,20 @@ static GCC_INLINE void instance__print_coords_to_log(
     fprintf (log_fh, "]\n");
 }
 
+static GCC_INLINE void instance__follow_coord(
+    fcs_dbm_solver_instance_t * const instance,
+    const int coord_from_input
+)
+{
+    const int coord = coord_from_input - 1;
+    if (coord >= 0)
+    {
+        pseduo_dfs_stack_item_t * const stack_item = &(instance->stack[instance->stack_depth++]);
+        stack_item->next_state_idx = coord+1;
+        instance__inspect_new_state(instance, &(stack_item->next_states[coord]));
+    }
+}
+
 static GCC_INLINE void instance__load_coords_from_fh(
     fcs_dbm_solver_instance_t * const instance,
     FILE * const fh
@@ -317,14 +341,355 @@ static GCC_INLINE void instance__load_coords_from_fh(
     int coord_from_input;
     while (fscanf(fh, "%d,", &coord_from_input) == 1)
     {
-        const int coord = coord_from_input - 1;
-        if (coord >= 0)
+        instance__follow_coord(instance, coord_from_input);
+    }
+}
+
+/*
+ * The parallel mode: the tree is cut at split_depth and every state there
+ * is a unit of work, identified by its coordinates from the root. Each
+ * worker takes the next unit, replays its coordinates in a private instance
+ * (so its store holds the same path as in the serial scan) and scans the
+ * subtree below it. The workers share the cache of the exhausted states.
+ * */
+typedef struct
+{
+    enum fcs_dbm_variant_type_t local_variant;
+    fcs_cache_key_t * init_state;
+    fcs_pdfs_shared_cache_t cache;
+    int split_depth;
+    long iters_delta_limit;
+    /* units_coords holds split_depth coordinates for each unit. */
+    long num_units, max_num_units;
+    int * units_coords;
+    fcs_bool_t * is_unit_finished;
+    pthread_mutex_t lock;
+    long next_unit, count_finished_prefix;
+    long count_num_processed;
+    fcs_bool_t solution_was_found;
+} fcs_pdfs_parallel_t;
+
+static GCC_INLINE void parallel__add_unit(
+    fcs_pdfs_parallel_t * const parallel,
+    const pseduo_dfs_stack_item_t * const stack,
+    const int last_coord
+)
+{
+    const int split_depth = parallel->split_depth;
+    if (parallel->num_units == parallel->max_num_units)
+    {
+        parallel->max_num_units += 256;
+        parallel->units_coords = SREALLOC(parallel->units_coords,
+            parallel->max_num_units * split_depth);
+    }
+    int * const coords =
+        parallel->units_coords + parallel->num_units * split_depth;
+    for (int d = 0 ; d < split_depth - 1 ; d++)
+    {
+        coords[d] = stack[d].next_state_idx;
+    }
+    coords[split_depth-1] = last_coord;
+    parallel->num_units++;
+}
+
+/*
+ * Walks the first split_depth levels the way instance_run() does, but
+ * records the states at the bottom level instead of scanning them. Nothing
+ * is put in the cache because none of the states here was exhausted.
+ * */
+static GCC_INLINE void parallel__generate_units(
+    fcs_pdfs_parallel_t * const parallel
+)
+{
+    fcs_dbm_solver_instance_t instance;
+    const int split_depth = parallel->split_depth;
+
+    instance_init(
+        &instance,
+        parallel->local_variant,
+        parallel->init_state,
+        &(parallel->cache)
+    );
+
+    while (instance.should_terminate == DONT_TERMINATE)
+    {
+        const int depth = instance.stack_depth;
+        if (depth < 0)
         {
-            pseduo_dfs_stack_item_t * const stack_item = &(instance->stack[instance->stack_depth++]);
-            stack_item->next_state_idx = coord+1;
-            instance__inspect_new_state(instance, &(stack_item->next_states[coord]));
+            break;
+        }
+        pseduo_dfs_stack_item_t * const stack_item = instance.stack + depth;
+        if (depth == split_depth - 1)
+        {
+            for (int i = 0 ; i < stack_item->count_next_states ; i++)
+            {
+                parallel__add_unit(parallel, instance.stack, i+1);
+            }
+            stack_item->next_state_idx = stack_item->count_next_states;
+        }
+        const int idx = (stack_item->next_state_idx)++;
+        if (idx >= stack_item->count_next_states)
+        {
+            for (int i = 0; i < stack_item->count_next_states ; i++)
+            {
+                remove_state(&(instance.store), &(stack_item->next_states[ i ]));
+            }
+            stack_item->count_next_states = 0;
+            stack_item->next_state_idx = 0;
+            instance.stack_depth--;
+        }
+        else
+        {
+            instance.stack_depth++;
+            instance__inspect_new_state(&instance, &(stack_item->next_states[idx]));
         }
     }
+
+    parallel->solution_was_found =
+        (instance.should_terminate == SOLUTION_FOUND_TERMINATE);
+    parallel->count_num_processed += instance.count_num_processed;
+    parallel->is_unit_finished = SMALLOC(parallel->is_unit_finished,
+        max(parallel->num_units, 1));
+    memset(parallel->is_unit_finished, '\0',
+        sizeof(parallel->is_unit_finished[0]) * max(parallel->num_units, 1));
+
+    instance_free(&instance);
+}
+
+#define PARALLEL_LOG_FILENAME "fc-solve-pseudo-dfs-units.log.txt"
+
+/*
+ * The log only records how many units from the start are finished, because
+ * the units that finished after a gap will be rescanned after a restart
+ * anyway. The coordinates are those of the first unfinished unit.
+ * */
+static GCC_INLINE void parallel__end_unit(
+    fcs_pdfs_parallel_t * const parallel,
+    const long unit_idx,
+    const long count_num_processed,
+    const fcs_bool_t is_finished
+)
+{
+    pthread_mutex_lock(&(parallel->lock));
+    parallel->count_num_processed += count_num_processed;
+    if (! is_finished)
+    {
+        pthread_mutex_unlock(&(parallel->lock));
+        return;
+    }
+    parallel->is_unit_finished[unit_idx] = TRUE;
+    const long old_count = parallel->count_finished_prefix;
+    while ((parallel->count_finished_prefix < parallel->num_units)
+        && parallel->is_unit_finished[parallel->count_finished_prefix])
+    {
+        parallel->count_finished_prefix++;
+    }
+    if (parallel->count_finished_prefix > old_count)
+    {
+        FILE * const log_fh = fopen(PARALLEL_LOG_FILENAME, "at");
+        fprintf (log_fh, "At %ld iterations Split-Depth=%d Units=%ld Coords=[",
+            parallel->count_num_processed, parallel->split_depth,
+            parallel->count_finished_prefix
+        );
+        if (parallel->count_finished_prefix < parallel->num_units)
+        {
+            const int * const coords = parallel->units_coords
+                + parallel->count_finished_prefix * parallel->split_depth;
+            for (int d = 0 ; d < parallel->split_depth ; d++)
+            {
+                fprintf (log_fh, "%d,", coords[d]);
+            }
+        }
+        fprintf (log_fh, "]\n");
+        fclose(log_fh);
+    }
+    pthread_mutex_unlock(&(parallel->lock));
+}
+
+static void * parallel__worker_thread(void * const void_arg)
+{
+    fcs_pdfs_parallel_t * const parallel = (fcs_pdfs_parallel_t *)void_arg;
+    const int split_depth = parallel->split_depth;
+
+    while (TRUE)
+    {
+        pthread_mutex_lock(&(parallel->lock));
+        const fcs_bool_t should_stop = (parallel->solution_was_found
+            || (parallel->next_unit == parallel->num_units));
+        const long unit_idx = parallel->next_unit;
+        if (! should_stop)
+        {
+            parallel->next_unit++;
+        }
+        pthread_mutex_unlock(&(parallel->lock));
+
+        if (should_stop)
+        {
+            break;
+        }
+
+        const int * const coords =
+            parallel->units_coords + unit_idx * split_depth;
+        fcs_dbm_solver_instance_t instance;
+        instance_init(
+            &instance,
+            parallel->local_variant,
+            parallel->init_state,
+            &(parallel->cache)
+        );
+
+        /*
+         * The replay stops short if a state on the way was already
+         * exhausted by another worker, and then the unit is done.
+         * */
+        fcs_bool_t is_finished = TRUE;
+        for (int d = 0 ;
+            (d < split_depth) && (instance.should_terminate == DONT_TERMINATE)
+            && (instance.stack_depth == d) ;
+            d++)
+        {
+            instance__follow_coord(&instance, coords[d]);
+        }
+
+        if ((instance.should_terminate == DONT_TERMINATE)
+            && (instance.stack_depth == split_depth))
+        {
+            instance.min_stack_depth = split_depth;
+            while (instance.should_terminate == DONT_TERMINATE)
+            {
+                instance.max_count_num_processed =
+                    instance.count_num_processed + parallel->iters_delta_limit;
+                instance_run(&instance);
+
+                pthread_mutex_lock(&(parallel->lock));
+                const fcs_bool_t was_found = parallel->solution_was_found;
+                pthread_mutex_unlock(&(parallel->lock));
+                if (was_found)
+                {
+                    is_finished = FALSE;
+                    break;
+                }
+            }
+            if (instance.should_terminate == QUEUE_TERMINATE)
+            {
+                fcs_pdfs_shared_cache_insert(
+                    &(parallel->cache),
+                    &(instance.stack[split_depth-1].next_states[
+                        coords[split_depth-1]-1].s)
+                );
+            }
+        }
+
+        if (instance.should_terminate == SOLUTION_FOUND_TERMINATE)
+        {
+            is_finished = FALSE;
+            pthread_mutex_lock(&(parallel->lock));
+            parallel->solution_was_found = TRUE;
+            pthread_mutex_unlock(&(parallel->lock));
+        }
+        parallel__end_unit(
+            parallel, unit_idx, instance.count_num_processed, is_finished
+        );
+
+        instance_free(&instance);
+    }
+
+    return NULL;
+}
+
+static GCC_INLINE fcs_bool_t parallel__run(
+    const enum fcs_dbm_variant_type_t local_variant,
+    fcs_cache_key_t * const init_state,
+    const int num_threads,
+    const int split_depth,
+    const long iters_delta_limit,
+    const long max_num_elements_in_cache
+)
+{
+    fcs_pdfs_parallel_t parallel = {
+        .local_variant = local_variant,
+        .init_state = init_state,
+        .split_depth = split_depth,
+        .iters_delta_limit = iters_delta_limit,
+        .num_units = 0,
+        .max_num_units = 0,
+        .units_coords = NULL,
+        .is_unit_finished = NULL,
+        .next_unit = 0,
+        .count_finished_prefix = 0,
+        .count_num_processed = 0,
+        .solution_was_found = FALSE,
+    };
+
+    fcs_pdfs_shared_cache_init(
+        &(parallel.cache), num_threads * 8, max_num_elements_in_cache
+    );
+    pthread_mutex_init(&(parallel.lock), NULL);
+
+    parallel__generate_units(&parallel);
+
+    {
+        FILE * const last_line_fh = popen(("tail -1 " PARALLEL_LOG_FILENAME), "r");
+        long count_num_processed, count_finished_units;
+        int log_split_depth;
+
+        if (last_line_fh && (fscanf(
+                last_line_fh,
+                "At %ld iterations Split-Depth=%d Units=%ld Coords=[",
+                &count_num_processed, &log_split_depth, &count_finished_units
+            ) == 3))
+        {
+            if ((log_split_depth != split_depth)
+                || (count_finished_units > parallel.num_units))
+            {
+                fprintf(stderr, "%s\n", "The units log file is of a different split depth.");
+                exit(-1);
+            }
+            parallel.next_unit = parallel.count_finished_prefix =
+                count_finished_units;
+            parallel.count_num_processed = count_num_processed;
+            fprintf(stderr, "Resuming after %ld finished units.\n",
+                count_finished_units);
+        }
+        if (last_line_fh)
+        {
+            pclose(last_line_fh);
+        }
+    }
+
+    fprintf(stderr, "Split the scan into %ld units at depth %d.\n",
+        parallel.num_units, split_depth);
+
+    if (! parallel.solution_was_found)
+    {
+        pthread_t * const threads = SMALLOC(threads, num_threads);
+        for (int i = 0 ; i < num_threads ; i++)
+        {
+            if (pthread_create(
+                &(threads[i]), NULL, parallel__worker_thread, &parallel
+            ))
+            {
+                fprintf(stderr,
+                    "Worker Thread No. %d Initialization failed!\n", i
+                );
+                exit(-1);
+            }
+        }
+        for (int i = 0 ; i < num_threads ; i++)
+        {
+            pthread_join(threads[i], NULL);
+        }
+        free(threads);
+    }
+
+    printf("Processed %ld states.\n", parallel.count_num_processed);
+
+    free(parallel.units_coords);
+    free(parallel.is_unit_finished);
+    pthread_mutex_destroy(&(parallel.lock));
+    fcs_pdfs_shared_cache_destroy(&(parallel.cache));
+
+    return parallel.solution_was_found;
 }
 
 #define USER_STATE_SIZE 2000
@@ -340,7 +705,61 @@ int main(int argc, char * argv[])
 
     const int max_num_elements_in_cache = 8000000;
 
-    const char * filename = argv[1];
+    const char * filename = NULL;
+    int num_threads = 1;
+    int split_depth = 3;
+
+    int arg;
+    for (arg = 1 ; arg < argc ; arg++)
+    {
+        if (!strcmp(argv[arg], "--num-threads"))
+        {
+            arg++;
+            if (arg == argc)
+            {
+                fprintf(stderr, "--num-threads came without an argument!\n");
+                exit(-1);
+            }
+            num_threads = atoi(argv[arg]);
+            if (num_threads < 1)
+            {
+                fprintf(stderr, "--num-threads must be at least 1.\n");
+                exit(-1);
+            }
+        }
+        else if (!strcmp(argv[arg], "--split-depth"))
+        {
+            arg++;
+            if (arg == argc)
+            {
+                fprintf(stderr, "--split-depth came without an argument!\n");
+                exit(-1);
+            }
+            split_depth = atoi(argv[arg]);
+            if (split_depth < 1)
+            {
+                fprintf(stderr, "--split-depth must be at least 1.\n");
+                exit(-1);
+            }
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if (arg < argc-1)
+    {
+        fprintf (stderr, "%s\n", "Junk arguments!");
+        exit(-1);
+    }
+    else if (arg == argc)
+    {
+        fprintf (stderr, "%s\n", "No board specified.");
+        exit(-1);
+    }
+
+    filename = argv[arg];
 
 
     local_variant = FCS_DBM_VARIANT_2FC_FREECELL;
@@ -363,13 +782,32 @@ int main(int argc, char * argv[])
 
     init_state_ptr = &(init_state_pair);
 
+    if (num_threads > 1)
+    {
+        const fcs_bool_t was_found = parallel__run(
+            local_variant,
+            init_state_ptr,
+            num_threads,
+            split_depth,
+            delta_limit,
+            max_num_elements_in_cache
+        );
+        printf("%s\n",
+            (was_found ? "Solution was found." : "I could not solve it."));
+
+        return 0;
+    }
+
+    fcs_pdfs_shared_cache_t cache;
+    fcs_pdfs_shared_cache_init(&cache, 1, max_num_elements_in_cache);
+
     fcs_dbm_solver_instance_t instance;
 
     instance_init(
         &instance,
         local_variant,
         init_state_ptr,
-        max_num_elements_in_cache
+        &cache
     );
 
 #define LOG_FILENAME "fc-solve-pseudo-dfs.log.txt"
@@ -428,6 +866,7 @@ int main(int argc, char * argv[])
     }
 
     instance_free(&instance);
+    fcs_pdfs_shared_cache_destroy(&cache);
 
     return 0;
 }
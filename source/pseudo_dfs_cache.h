@@ -36,11 +36,13 @@ extern "C"
 
 #include "config.h"
 
+#include <pthread.h>
 #include <Judy.h>
 
 #include "bool.h"
 #include "inline.h"
 #include "alloc_wrap.h"
+#include "min_and_max.h"
 
 #include "state.h"
 #include "meta_alloc.h"
@@ -189,6 +191,116 @@ static GCC_INLINE fcs_pdfs_cache_key_info_t * fcs_pdfs_cache_insert(fcs_pdfs_lru
     return cache_key;
 }
 
+/*
+ * A cache that can be shared by several solving threads. It is split into
+ * shards, each guarded by its own lock and backed by its own allocators, and
+ * a key always goes to the same shard, so threads that look up different
+ * keys rarely contend.
+ * */
+typedef struct
+{
+    pthread_mutex_t lock;
+    fcs_meta_compact_allocator_t meta_alloc;
+    fcs_pdfs_lru_cache_t cache;
+} fcs_pdfs_cache_shard_t;
+
+typedef struct
+{
+    int num_shards;
+    fcs_pdfs_cache_shard_t * shards;
+} fcs_pdfs_shared_cache_t;
+
+static GCC_INLINE void fcs_pdfs_shared_cache_init(
+    fcs_pdfs_shared_cache_t * const shared,
+    const int num_shards,
+    const long max_num_elements_in_cache
+)
+{
+    shared->num_shards = num_shards;
+    shared->shards = SMALLOC(shared->shards, num_shards);
+    for (int i = 0 ; i < num_shards ; i++)
+    {
+        fcs_pdfs_cache_shard_t * const shard = &(shared->shards[i]);
+        pthread_mutex_init(&(shard->lock), NULL);
+        fc_solve_meta_compact_allocator_init(&(shard->meta_alloc));
+        fcs_pdfs_cache_init(
+            &(shard->cache),
+            max(max_num_elements_in_cache / num_shards, 2),
+            &(shard->meta_alloc)
+        );
+    }
+}
+
+static GCC_INLINE void fcs_pdfs_shared_cache_destroy(
+    fcs_pdfs_shared_cache_t * const shared
+)
+{
+    for (int i = 0 ; i < shared->num_shards ; i++)
+    {
+        fcs_pdfs_cache_shard_t * const shard = &(shared->shards[i]);
+        fcs_pdfs_cache_destroy(&(shard->cache));
+        fc_solve_meta_compact_allocator_finish(&(shard->meta_alloc));
+        pthread_mutex_destroy(&(shard->lock));
+    }
+    free(shared->shards);
+    shared->shards = NULL;
+}
+
+static GCC_INLINE fcs_pdfs_cache_shard_t * fcs_pdfs_shared_cache_get_shard(
+    fcs_pdfs_shared_cache_t * const shared,
+    const fcs_pdfs_key_t * const key
+)
+{
+    if (shared->num_shards == 1)
+    {
+        return shared->shards;
+    }
+    /* FNV-1a */
+    const unsigned char * const bytes = (const unsigned char *)key;
+    unsigned long h = 2166136261UL;
+    for (size_t i = 0 ; i < sizeof(*key) ; i++)
+    {
+        h ^= bytes[i];
+        h *= 16777619UL;
+    }
+    return &(shared->shards[h % (unsigned long)shared->num_shards]);
+}
+
+static GCC_INLINE const fcs_bool_t fcs_pdfs_shared_cache_does_key_exist(
+    fcs_pdfs_shared_cache_t * const shared,
+    fcs_pdfs_key_t * const key
+)
+{
+    fcs_pdfs_cache_shard_t * const shard =
+        fcs_pdfs_shared_cache_get_shard(shared, key);
+
+    pthread_mutex_lock(&(shard->lock));
+    const fcs_bool_t ret = fcs_pdfs_cache_does_key_exist(&(shard->cache), key);
+    pthread_mutex_unlock(&(shard->lock));
+
+    return ret;
+}
+
+/*
+ * Two threads may finish the same state, so a key that is already present
+ * is only promoted rather than inserted twice.
+ * */
+static GCC_INLINE void fcs_pdfs_shared_cache_insert(
+    fcs_pdfs_shared_cache_t * const shared,
+    fcs_pdfs_key_t * const key
+)
+{
+    fcs_pdfs_cache_shard_t * const shard =
+        fcs_pdfs_shared_cache_get_shard(shared, key);
+
+    pthread_mutex_lock(&(shard->lock));
+    if (! fcs_pdfs_cache_does_key_exist(&(shard->cache), key))
+    {
+        fcs_pdfs_cache_insert(&(shard->cache), key);
+    }
+    pthread_mutex_unlock(&(shard->lock));
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -593,6 +593,7 @@ int fc_solve_befs_or_bfs_do_solve( fc_solve_soft_thread_t * const soft_thread )
     const fcs_bool_t enable_pruning = soft_thread->enable_pruning;
 
     const int method = soft_thread->method;
+    const fcs_runtime_flags_t is_optimal_a_star = STRUCT_QUERY_FLAG(soft_thread, FCS_SOFT_THREAD_OPTIMAL_A_STAR);
     fcs_int_limit_t * const instance_num_checked_states_ptr = &(instance->i__num_checked_states);
 #ifndef FCS_SINGLE_HARD_THREAD
     fcs_int_limit_t * const hard_thread_num_checked_states_ptr = &(HT_FIELD(hard_thread, ht__num_checked_states));
@@ -769,6 +770,17 @@ int fc_solve_befs_or_bfs_do_solve( fc_solve_soft_thread_t * const soft_thread )
         BUMP_NUM_CHECKED_STATES();
 
 
+        fcs_befs_parent_terms_t parent_terms;
+        if ((method == FCS_METHOD_A_STAR) && (! is_optimal_a_star))
+        {
+            befs_init_parent_terms(
+                soft_thread,
+                WEIGHTING(soft_thread),
+                &(FCS_SCANS_the_state),
+                &parent_terms
+            );
+        }
+
         TRACE0("Insert all states");
         /* Insert all the derived states into the PQ or Queue */
         fcs_derived_states_list_item_t * derived_iter;
@@ -795,12 +807,19 @@ int fc_solve_befs_or_bfs_do_solve( fc_solve_soft_thread_t * const soft_thread )
                 fc_solve_pq_push(
                     pqueue,
                     FCS_SCANS_ptr_new_state,
-                    befs_rate_state(
+                    (is_optimal_a_star
+                     ? optimal_a_star_rate_state(
+                         instance,
+                         new_pass.key,
+                         kv_calc_depth(&(new_pass))
+                     )
+                     : befs_rate_state(
                         soft_thread,
                         WEIGHTING(soft_thread),
                         new_pass.key,
-                        BEFS_MAX_DEPTH - kv_calc_depth(&(new_pass))
-                    )
+                        BEFS_MAX_DEPTH - kv_calc_depth(&(new_pass)),
+                        &parent_terms
+                    ))
                 );
             }
             else
@@ -852,6 +871,15 @@ int fc_solve_befs_or_bfs_do_solve( fc_solve_soft_thread_t * const soft_thread )
 
 next_state:
         TRACE0("Label next state");
+        if (should_free_states(instance))
+        {
+            if (method != FCS_METHOD_A_STAR)
+            {
+                my_brfs_queue_last_item = queue_last_item;
+            }
+            free_states(instance, soft_thread);
+        }
+
         /*
             Extract the next item in the queue/priority queue.
         */
@@ -1109,6 +1137,28 @@ extern void fc_solve_sfs_check_state_end(
 #define ptr_new_state_foo (raw_ptr_new_state_raw->val)
 #define ptr_state (raw_ptr_state_raw->val)
 
+    /* Discard the endgames that are known to be dead ends. */
+    if (unlikely(instance->endgame_db_max_cards >= 0)
+        && (fc_solve_endgame_db__lookup_state(
+            &(instance->endgame_db),
+            raw_ptr_new_state_raw->key,
+            INSTANCE_FREECELLS_NUM,
+            INSTANCE_STACKS_NUM
+            ) == FCS_ENDGAME_DB_UNSOLVABLE)
+    )
+    {
+        if (HT_FIELD(hard_thread, allocated_from_list))
+        {
+            ptr_new_state_foo->parent = instance->list_of_vacant_states;
+            instance->list_of_vacant_states = INFO_STATE_PTR(raw_ptr_new_state_raw);
+        }
+        else
+        {
+            fcs_compact_alloc_release(&(HT_FIELD(hard_thread, allocator)));
+        }
+        return;
+    }
+
     if (! fc_solve_check_and_add_state(
         hard_thread,
         raw_ptr_new_state_raw,
@@ -1135,8 +1185,12 @@ extern void fc_solve_sfs_check_state_end(
          * What it means is that if the depth of the state if it
          * can be reached from this one is lower than what it
          * already have, then re-assign its parent to this state.
+         *
+         * The optimal A* scan always does that, because a state that is
+         * reached by a shorter path must be moved to it.
          * */
-        if (STRUCT_QUERY_FLAG(instance, FCS_RUNTIME_TO_REPARENT_STATES_REAL) &&
+        if ((STRUCT_QUERY_FLAG(instance, FCS_RUNTIME_TO_REPARENT_STATES_REAL)
+             || STRUCT_QUERY_FLAG(soft_thread, FCS_SOFT_THREAD_OPTIMAL_A_STAR)) &&
            (kv_calc_depth(&existing_state) > kv_calc_depth(raw_ptr_state_raw)+1)
         )
         {
@@ -176,6 +176,34 @@ static GCC_INLINE void fc_solve_initialize_befs_rater(
 
 #undef unlimited_sequence_move
 
+/*
+ * The optimal A* scan pops the states with the lowest depth plus lower
+ * bound on the moves that are left first, and the deepest among them.
+ * */
+#define FCS_OPTIMAL_A_STAR_MAX_F (1 << 20)
+#define FCS_OPTIMAL_A_STAR_DEPTH_BITS 10
+
+static GCC_INLINE pq_rating_t optimal_a_star_rate_state(
+    const fc_solve_instance_t * const instance,
+    const fcs_state_t * const state,
+    const int depth
+)
+{
+    const int f = depth + fc_solve_pattern_db__calc_lower_bound(
+        &(instance->pattern_db),
+        state,
+        INSTANCE_FREECELLS_NUM,
+        INSTANCE_STACKS_NUM,
+        INSTANCE_DECKS_NUM
+    );
+
+    return (
+        ((FCS_OPTIMAL_A_STAR_MAX_F - min(f, FCS_OPTIMAL_A_STAR_MAX_F))
+         << FCS_OPTIMAL_A_STAR_DEPTH_BITS)
+        + min(depth, (1 << FCS_OPTIMAL_A_STAR_DEPTH_BITS) - 1)
+    );
+}
+
 static int compare_rating_with_index(const void * const void_a, const void * const void_b)
 {
     const fcs_rating_with_index_t * const a = (const fcs_rating_with_index_t * const)void_a;
@@ -229,11 +257,138 @@ static GCC_INLINE fcs_depth_t calc_depth(fcs_collectible_state_t * ptr_state)
 #endif
 
 
+/*
+ * The integral per-column terms of the BeFS rating of a state. They are
+ * calculated once for the state whose derived states are being rated, and
+ * then each derived state only recalculates the terms of the columns that
+ * its move has changed, and reuses the rest.
+ * */
+typedef struct
+{
+#ifdef INDIRECT_STACK_STATES
+    /* The columns are cached, so an unchanged column has the same
+     * pointer in the derived state. */
+    fcs_const_cards_column_t col;
+#else
+    /* The state may be recycled before its derived states are rated
+     * (e.g: with FCS_RCS_STATES), so keep a copy. */
+    fcs_card_t col[MAX_NUM_CARDS_IN_A_STACK+1];
+#endif
+    int cards_under_sequences;
+    int num_cards_not_on_parents;
+} fcs_befs_col_terms_t;
+
+typedef struct
+{
+    fcs_befs_col_terms_t cols[MAX_NUM_STACKS];
+} fcs_befs_parent_terms_t;
+
+static GCC_INLINE fcs_bool_t befs_is_same_col(
+    const fcs_befs_col_terms_t * const terms,
+    const fcs_const_cards_column_t col
+)
+{
+#ifdef INDIRECT_STACK_STATES
+    return (terms->col == col);
+#else
+    return (! memcmp(terms->col, col, fcs_col_len(col)+1));
+#endif
+}
+
+static GCC_INLINE void befs_calc_col_terms(
+#ifndef FCS_FREECELL_ONLY
+    const int sequences_are_built_by,
+#endif
+    const fc_solve_state_weighting_t * const weighting,
+    const fcs_const_cards_column_t col,
+    fcs_befs_col_terms_t * const terms
+)
+{
+    const int cards_num = fcs_col_len(col);
+
+    terms->cards_under_sequences =
+    (
+        (weighting->should_go_over_stacks && (cards_num > 1))
+        ? update_col_cards_under_sequences(
+#ifndef FCS_FREECELL_ONLY
+            sequences_are_built_by,
+#endif
+            col,
+            cards_num-1
+        )
+        : 0
+    );
+
+    int num_cards_not_on_parents = 0;
+    if (weighting->num_cards_not_on_parents_factor)
+    {
+        fcs_card_t parent_card = fcs_col_get_card(col, 0);
+        for (int h = 1 ; h < cards_num ; h++)
+        {
+            const fcs_card_t child_card = fcs_col_get_card(col, h);
+
+            if (! fcs_is_parent_card(parent_card, child_card))
+            {
+                num_cards_not_on_parents++;
+            }
+            parent_card = child_card;
+        }
+    }
+    terms->num_cards_not_on_parents = num_cards_not_on_parents;
+}
+
+/*
+ * Calculates the per-column terms of the state whose derived states are
+ * about to be rated by befs_rate_state().
+ * */
+static GCC_INLINE void befs_init_parent_terms(
+    const fc_solve_soft_thread_t * const soft_thread,
+    const fc_solve_state_weighting_t * const weighting,
+    const fcs_state_t * const state,
+    fcs_befs_parent_terms_t * const parent_terms
+)
+{
+#ifndef FCS_FREECELL_ONLY
+    const fc_solve_instance_t * const instance = HT_INSTANCE(soft_thread->hard_thread);
+    const int sequences_are_built_by =
+        GET_INSTANCE_SEQUENCES_ARE_BUILT_BY(instance)
+        ;
+#endif
+#ifndef HARD_CODED_NUM_STACKS
+    SET_GAME_PARAMS();
+#endif
+
+    for (int a = 0 ; a < LOCAL_STACKS_NUM ; a++)
+    {
+        const fcs_const_cards_column_t col = fcs_state_get_col(*state, a);
+        fcs_befs_col_terms_t * const terms = &(parent_terms->cols[a]);
+#ifdef INDIRECT_STACK_STATES
+        terms->col = col;
+#else
+        memcpy(terms->col, col, fcs_col_len(col)+1);
+#endif
+        befs_calc_col_terms(
+#ifndef FCS_FREECELL_ONLY
+            sequences_are_built_by,
+#endif
+            weighting, col, terms
+        );
+    }
+}
+
+/*
+ * parent_terms may be NULL, in which case all the columns are rated from
+ * scratch. Otherwise, the terms of a column that is also present in the
+ * parent (possibly at a different index due to the canonization) are
+ * reused. The terms are accumulated in the same order either way, so the
+ * rating is identical.
+ * */
 static GCC_INLINE pq_rating_t befs_rate_state(
     const fc_solve_soft_thread_t * const soft_thread,
     const fc_solve_state_weighting_t * const weighting,
     const fcs_state_t * const state,
-    const int negated_depth
+    const int negated_depth,
+    const fcs_befs_parent_terms_t * const parent_terms
 )
 {
 #ifndef FCS_FREECELL_ONLY
@@ -267,15 +422,52 @@ static GCC_INLINE pq_rating_t befs_rate_state(
         }
     }
 
+    const fcs_bool_t should_go_over_stacks = weighting->should_go_over_stacks;
+    const double num_cards_not_on_parents_weight = weighting->num_cards_not_on_parents_factor;
     fcs_game_limit_t num_vacant_stacks = 0;
-    fcs_game_limit_t num_vacant_freecells = 0;
-    if (weighting->should_go_over_stacks)
+    int num_cards_not_on_parents = (LOCAL_DECKS_NUM*52);
+
+    if (should_go_over_stacks || num_cards_not_on_parents_weight)
     {
         for (int a = 0 ; a < LOCAL_STACKS_NUM ; a++)
         {
             const fcs_const_cards_column_t col = fcs_state_get_col(*state, a);
             const int cards_num = fcs_col_len(col);
 
+            const fcs_befs_col_terms_t * terms = NULL;
+            fcs_befs_col_terms_t calced_terms;
+            if (parent_terms)
+            {
+                /* Try the same index first, as it is the most common. */
+                if (befs_is_same_col(&(parent_terms->cols[a]), col))
+                {
+                    terms = &(parent_terms->cols[a]);
+                }
+                else
+                {
+                    for (int p = 0 ; p < LOCAL_STACKS_NUM ; p++)
+                    {
+                        if (befs_is_same_col(&(parent_terms->cols[p]), col))
+                        {
+                            terms = &(parent_terms->cols[p]);
+                            break;
+                        }
+                    }
+                }
+            }
+            if (! terms)
+            {
+                befs_calc_col_terms(
+#ifndef FCS_FREECELL_ONLY
+                    sequences_are_built_by,
+#endif
+                    weighting, col, &calced_terms
+                );
+                terms = &calced_terms;
+            }
+
+            num_cards_not_on_parents -= terms->num_cards_not_on_parents;
+
             if (cards_num <= 1)
             {
                 if (cards_num == 0)
@@ -285,15 +477,7 @@ static GCC_INLINE pq_rating_t befs_rate_state(
                 continue;
             }
 
-            const int c =
-                update_col_cards_under_sequences(
-#ifndef FCS_FREECELL_ONLY
-                        sequences_are_built_by,
-#endif
-                        col,
-                        cards_num-1
-                        )
-                ;
+            const int c = terms->cards_under_sequences;
 
             cards_under_sequences += FCS_SEQS_OVER_RENEGADE_POWER(c);
             if (c > 0)
@@ -305,7 +489,11 @@ static GCC_INLINE pq_rating_t befs_rate_state(
                     );
             }
         }
+    }
 
+    if (should_go_over_stacks)
+    {
+        fcs_game_limit_t num_vacant_freecells = 0;
         for (int freecell_idx = 0 ; freecell_idx < LOCAL_FREECELLS_NUM ; freecell_idx++)
         {
             if (fcs_freecell_is_empty((*state),freecell_idx))
@@ -339,28 +527,8 @@ static GCC_INLINE pq_rating_t befs_rate_state(
         );
     }
 
-    double num_cards_not_on_parents_weight = weighting->num_cards_not_on_parents_factor;
     if (num_cards_not_on_parents_weight)
     {
-        int num_cards_not_on_parents = (LOCAL_DECKS_NUM*52);
-        for (int stack_idx = 0 ; stack_idx < LOCAL_STACKS_NUM ; stack_idx++)
-        {
-            const fcs_const_cards_column_t col =
-                fcs_state_get_col(*state, stack_idx);
-
-            const int col_len = fcs_col_len(col);
-            fcs_card_t parent_card = fcs_col_get_card(col, 0);
-            for (int h = 1 ; h < col_len ; h++)
-            {
-                const fcs_card_t child_card = fcs_col_get_card(col, h);
-
-                if (! fcs_is_parent_card(parent_card, child_card))
-                {
-                    num_cards_not_on_parents--;
-                }
-                parent_card = child_card;
-            }
-        }
         sum += num_cards_not_on_parents * num_cards_not_on_parents_weight;
     }
 
@@ -676,6 +844,114 @@ static GCC_INLINE void free_states_handle_soft_dfs_soft_thread(
 }
 
 #if ((FCS_STATE_STORAGE == FCS_STATE_STORAGE_INTERNAL_HASH) || (FCS_STATE_STORAGE == FCS_STATE_STORAGE_GOOGLE_DENSE_HASH))
+
+/*
+ * The number of buckets of the states hash that a single step of
+ * free_states() sweeps.
+ * */
+#ifndef FCS_TRIM_NUM_BUCKETS_PER_STEP
+#define FCS_TRIM_NUM_BUCKETS_PER_STEP 4096
+#endif
+
+static GCC_INLINE void free_states_handle_befs_soft_thread(
+        fc_solve_soft_thread_t * const soft_thread,
+        const fc_solve_soft_thread_t * const running_soft_thread
+        )
+{
+    if (! STRUCT_QUERY_FLAG(soft_thread, FCS_SOFT_THREAD_INITIALIZED))
+    {
+        return;
+    }
+
+    if (soft_thread->method == FCS_METHOD_A_STAR)
+    {
+        PQUEUE * const pq = &(BEFS_VAR(soft_thread, pqueue));
+        pq_element_t * const Elements = pq->Elements;
+        pq_element_t * const end_element = Elements + pq->CurrentSize;
+
+        pq_element_t * next_element = Elements + PQ_FIRST_ENTRY;
+        pq_element_t * dest_element = next_element;
+
+        for (; next_element <= end_element ; next_element++)
+        {
+            if (! fcs__is_state_a_dead_end((*next_element).val))
+            {
+                *(dest_element++) = *(next_element);
+            }
+        }
+        pq->CurrentSize = (dest_element - Elements) - PQ_FIRST_ENTRY;
+        fc_solve_pq_rebuild(pq);
+    }
+    else
+    {
+        /* The BrFS and the optimization scans. The queue starts with
+         * a dummy item and ends with an empty one. */
+        fcs_states_linked_list_item_t * prev_item = BRFS_VAR(soft_thread, bfs_queue);
+        fcs_states_linked_list_item_t * const last_item = BRFS_VAR(soft_thread, bfs_queue_last_item);
+
+        while (prev_item->next != last_item)
+        {
+            fcs_states_linked_list_item_t * const item = prev_item->next;
+
+            if (fcs__is_state_a_dead_end(item->s))
+            {
+                prev_item->next = item->next;
+                item->next = BRFS_VAR(soft_thread, recycle_bin);
+                BRFS_VAR(soft_thread, recycle_bin) = item;
+            }
+            else
+            {
+                prev_item = item;
+            }
+        }
+    }
+
+    /* A suspended scan resumes from first_state_to_check, so it should
+     * not be left pointing to a recycled state. */
+    if ((soft_thread != running_soft_thread)
+        && soft_thread->first_state_to_check
+        && fcs__is_state_a_dead_end(soft_thread->first_state_to_check))
+    {
+        fcs_collectible_state_t * next_state = NULL;
+
+        if (soft_thread->method == FCS_METHOD_A_STAR)
+        {
+            fc_solve_pq_pop(&(BEFS_VAR(soft_thread, pqueue)), &next_state);
+        }
+        else
+        {
+            fcs_states_linked_list_item_t * const queue = BRFS_VAR(soft_thread, bfs_queue);
+            fcs_states_linked_list_item_t * const item = queue->next;
+
+            if (item != BRFS_VAR(soft_thread, bfs_queue_last_item))
+            {
+                next_state = item->s;
+                queue->next = item->next;
+                item->next = BRFS_VAR(soft_thread, recycle_bin);
+                BRFS_VAR(soft_thread, recycle_bin) = item;
+            }
+        }
+        soft_thread->first_state_to_check = next_state;
+    }
+
+    return;
+}
+
+static GCC_INLINE void free_states_handle_soft_thread(
+        fc_solve_soft_thread_t * const soft_thread,
+        const fc_solve_soft_thread_t * const running_soft_thread
+        )
+{
+    if (soft_thread->super_method_type == FCS_SUPER_METHOD_DFS)
+    {
+        free_states_handle_soft_dfs_soft_thread(soft_thread);
+    }
+    else if (soft_thread->super_method_type == FCS_SUPER_METHOD_BEFS_BRFS)
+    {
+        free_states_handle_befs_soft_thread(soft_thread, running_soft_thread);
+    }
+}
+
 static const fcs_bool_t free_states_should_delete(void * const key, void * const context)
 {
     fc_solve_instance_t * const instance = (fc_solve_instance_t * const)context;
@@ -683,10 +959,33 @@ static const fcs_bool_t free_states_should_delete(void * const key, void * const
 
     if (fcs__is_state_a_dead_end(ptr_state))
     {
-        FCS_S_NEXT(ptr_state) = instance->list_of_vacant_states;
-        instance->list_of_vacant_states = ptr_state;
+        fcs_states_trimming_t * const trimming = &(instance->trimming);
 
-        instance->active_num_states_in_collection--;
+        if (trimming->num_dead_ends == trimming->max_num_dead_ends)
+        {
+            trimming->dead_ends = SREALLOC(
+                trimming->dead_ends,
+                (trimming->max_num_dead_ends += 1024)
+            );
+        }
+        trimming->dead_ends[trimming->num_dead_ends++] = ptr_state;
+
+#ifndef FCS_RCS_STATES
+        if (instance->transposition_table.entries)
+        {
+            const fcs_state_t * const state_key = &(ptr_state->s);
+            int num_cards_out = 0;
+            for (int found_idx = 0 ; found_idx < (INSTANCE_DECKS_NUM<<2) ; found_idx++)
+            {
+                num_cards_out += fcs_foundation_value(*state_key, found_idx);
+            }
+            fc_solve_tt_insert(
+                &(instance->transposition_table),
+                fc_solve_tt_hash(state_key, sizeof(*state_key)),
+                num_cards_out
+            );
+        }
+#endif
 
         return TRUE;
     }
@@ -697,7 +996,21 @@ static const fcs_bool_t free_states_should_delete(void * const key, void * const
 }
 #endif
 
-static GCC_INLINE void free_states(fc_solve_instance_t * const instance)
+/*
+ * Trims the dead end states out of the states collection and recycles
+ * them.
+ *
+ * The collection is swept incrementally: each call sweeps
+ * FCS_TRIM_NUM_BUCKETS_PER_STEP buckets of the hash, and the states that
+ * were found are only detached from the collection. Once the sweep is
+ * over, the dead ends are filtered out of the scans' queues and stacks,
+ * after which no scan refers to them, and they are recycled. The scans
+ * keep calling free_states() as long as instance->trimming.is_active .
+ * */
+static GCC_INLINE void free_states(
+    fc_solve_instance_t * const instance,
+    const fc_solve_soft_thread_t * const running_soft_thread
+)
 {
 #ifdef DEBUG
     printf("%s\n", "FREE_STATES HIT");
@@ -706,72 +1019,171 @@ static GCC_INLINE void free_states(fc_solve_instance_t * const instance)
     return;
 #else
     {
-    /* First of all, let's make sure the soft_threads will no longer
-     * traverse to the freed states that are currently dead end.
-     * */
-
+    fcs_states_trimming_t * const trimming = &(instance->trimming);
 
-    HT_LOOP_START()
+    if (! trimming->is_active)
     {
-        ST_LOOP_START()
-        {
-            if (soft_thread->super_method_type == FCS_SUPER_METHOD_DFS)
-            {
-                free_states_handle_soft_dfs_soft_thread(soft_thread);
-            }
-            else if (soft_thread->method == FCS_METHOD_A_STAR)
-            {
-                PQUEUE new_pq;
-                fc_solve_pq_init(
-                    &(new_pq),
-                    1024
-                );
-
-                pq_element_t * const Elements = BEFS_VAR(soft_thread, pqueue).Elements;
-                pq_element_t * const end_element = Elements + BEFS_VAR(soft_thread, pqueue).CurrentSize;
-
-                pq_element_t * next_element = BEFS_VAR(soft_thread, pqueue).Elements + PQ_FIRST_ENTRY;
-
-                for (; next_element <= end_element ; next_element++)
-                {
-                    if (! fcs__is_state_a_dead_end((*next_element).val))
-                    {
-                        fc_solve_pq_push(
-                            &new_pq,
-                            (*next_element).val,
-                            (*next_element).rating
-                        );
-                    }
-                }
+        trimming->is_active = TRUE;
+        trimming->next_bucket = 0;
+        trimming->num_dead_ends = 0;
+        fc_solve_tt_next_age(&(instance->transposition_table));
+    }
 
-                fc_solve_PQueueFree(
-                    &(BEFS_VAR(soft_thread, pqueue))
-                );
+#if (FCS_STATE_STORAGE == FCS_STATE_STORAGE_INTERNAL_HASH)
+    {
+        const int start = trimming->next_bucket;
+        /* The hash may have been resized since the previous step, in
+         * which case some states may be swept twice or not at all.
+         * Neither is harmful. */
+        const int end = min(instance->hash.size, start + FCS_TRIM_NUM_BUCKETS_PER_STEP);
+
+        fc_solve_hash_foreach_in_range(
+            &(instance->hash),
+            start,
+            end,
+            free_states_should_delete,
+            ((void *)instance)
+        );
 
-                BEFS_VAR(soft_thread, pqueue) = new_pq;
-            }
-            /* TODO : Implement for the BrFS/Optimize scans. */
+        if (end < instance->hash.size)
+        {
+            trimming->next_bucket = end;
+            return;
         }
     }
-
-#if (FCS_STATE_STORAGE == FCS_STATE_STORAGE_INTERNAL_HASH)
-    /* Now let's recycle the states. */
-    fc_solve_hash_foreach(
-        &(instance->hash),
-        free_states_should_delete,
-        ((void *)instance)
-    );
 #elif (FCS_STATE_STORAGE == FCS_STATE_STORAGE_GOOGLE_DENSE_HASH)
-    /* Now let's recycle the states. */
+    /* The dense hash cannot be swept by parts. */
     fc_solve_states_google_hash_foreach(
         instance->hash,
         free_states_should_delete,
         ((void *)instance)
     );
 #endif
+
+    /* Let's make sure the soft_threads will no longer traverse to the
+     * states that are about to be recycled. States that became dead ends
+     * since they were swept are filtered out as well, which is harmless.
+     * */
+    HT_LOOP_START()
+    {
+        ST_LOOP_START()
+        {
+            free_states_handle_soft_thread(soft_thread, running_soft_thread);
+        }
+    }
+
+#ifdef FCS_SINGLE_HARD_THREAD
+    if (instance->is_optimization_st)
+    {
+        free_states_handle_soft_thread(
+            &(instance->optimization_soft_thread), running_soft_thread
+        );
+    }
+#else
+    if (instance->optimization_thread)
+    {
+        fc_solve_hard_thread_t * const hard_thread = instance->optimization_thread;
+        ST_LOOP_START()
+        {
+            free_states_handle_soft_thread(soft_thread, running_soft_thread);
+        }
+    }
+#endif
+
+    /* Now let's recycle the states. */
+    fcs_collectible_state_t * * const dead_ends = trimming->dead_ends;
+    for (fcs_int_limit_t i = 0 ; i < trimming->num_dead_ends ; i++)
+    {
+        fcs_collectible_state_t * const ptr_state = dead_ends[i];
+
+        FCS_S_NEXT(ptr_state) = instance->list_of_vacant_states;
+        instance->list_of_vacant_states = ptr_state;
+    }
+    instance->active_num_states_in_collection -= trimming->num_dead_ends;
+
+    /*
+     * If the trimming did not bring the collection below the low-water
+     * mark of 3/4 of the limit, most of the states are still alive, and
+     * sweeping again right away would free little. So back off until the
+     * collection grows by a quarter.
+     * */
+    {
+        const fcs_int_limit_t limit = instance->effective_trim_states_in_collection_from;
+        const fcs_int_limit_t num_states = instance->active_num_states_in_collection;
+
+        trimming->next_trim_at =
+            ((num_states <= limit - (limit >> 2))
+             ? 0
+             : (num_states + (max(num_states, limit) >> 2) + 1)
+            );
+    }
+
+    trimming->num_dead_ends = 0;
+    trimming->is_active = FALSE;
     }
 #endif
 }
+
+static GCC_INLINE const fcs_bool_t should_free_states(
+    const fc_solve_instance_t * const instance
+)
+{
+    return (instance->trimming.is_active
+        || (check_num_states_in_collection(instance)
+            && (instance->active_num_states_in_collection >=
+                instance->trimming.next_trim_at)
+        )
+    );
+}
+
+/*
+ * Orders the tests of an adaptive tests list by their UCB1 scores - the
+ * ratio of their derived states that led FCS_ADAPTIVE_TESTS_ORDER_PLIES
+ * deeper, plus an exploration bonus. Tests that were not tried yet come
+ * first, and ties keep the given order.
+ * */
+static GCC_INLINE void fc_solve_rank_adaptive_tests(
+    fcs_tests_list_t * const tests_list
+)
+{
+    const int num_tests = tests_list->num_tests;
+    const fcs_adaptive_test_stats_t * const stats = tests_list->adaptive_stats;
+    double scores[FCS_MOVE_FUNCS_NUM];
+    fcs_int_limit_t total_num_pulls = 0;
+
+    for (int t = 0 ; t < num_tests ; t++)
+    {
+        total_num_pulls += stats[t].num_pulls;
+    }
+    const double log_total = log((double)(total_num_pulls + 1));
+
+    for (int t = 0 ; t < num_tests ; t++)
+    {
+        scores[t] = (stats[t].num_pulls == 0)
+            ? HUGE_VAL
+            : (((double)stats[t].num_rewards / stats[t].num_pulls)
+                + sqrt(2 * log_total / stats[t].num_pulls));
+    }
+
+    unsigned char * const order = tests_list->adaptive_order;
+    for (int t = 0 ; t < num_tests ; t++)
+    {
+        order[t] = (unsigned char)t;
+    }
+    /* An insertion sort, which is stable and good enough for a handful
+     * of tests. */
+    for (int i = 1 ; i < num_tests ; i++)
+    {
+        const unsigned char t = order[i];
+        int j = i;
+        for ( ; (j > 0) && (scores[order[j-1]] < scores[t]) ; j--)
+        {
+            order[j] = order[j-1];
+        }
+        order[j] = t;
+    }
+}
+
 /*
  * fc_solve_soft_dfs_do_solve() is the event loop of the
  * Random-DFS scan. DFS which is recursive in nature is handled here
@@ -810,6 +1222,14 @@ static GCC_INLINE int fc_solve_soft_dfs_do_solve(
 
     int dfs_max_depth = DFS_VAR(soft_thread, dfs_max_depth);
     fcs_bool_t enable_pruning = soft_thread->enable_pruning;
+    const fcs_int_limit_t adaptive_tests_order_interval =
+        soft_thread->adaptive_tests_order_interval;
+
+#ifndef FCS_RCS_STATES
+    fcs_dfs_split_t * const dfs_split = instance->dfs_split;
+    /* The depth whose children are claimed, or -1 for none. */
+    const int split_parent_depth = (dfs_split ? (dfs_split->depth - 1) : -1);
+#endif
 
     DECLARE_STATE();
     ASSIGN_ptr_state (the_soft_dfs_info->state);
@@ -919,6 +1339,13 @@ static GCC_INLINE int fc_solve_soft_dfs_do_solve(
                     mark_as_dead_end (scans_synergy, PTR_STATE);
                 }
 
+                /* A dead end within FCS_ADAPTIVE_TESTS_ORDER_PLIES. */
+                if (the_soft_dfs_info->test_stats)
+                {
+                    the_soft_dfs_info->test_stats->num_pulls++;
+                    the_soft_dfs_info->test_stats = NULL;
+                }
+
                 free(the_soft_dfs_info->positions_by_rank);
                 if (unlikely(--DEPTH() < 0))
                 {
@@ -947,6 +1374,7 @@ static GCC_INLINE int fc_solve_soft_dfs_do_solve(
             }
 
             derived_states_list->num_states = 0;
+            the_soft_dfs_info->derived_states_test_stats = NULL;
 
             TRACE0("Before iter_handler");
             /* If this is the first test, then count the number of unoccupied
@@ -1062,9 +1490,34 @@ static GCC_INLINE int fc_solve_soft_dfs_do_solve(
             {
                 VERIFY_PTR_STATE_TRACE0("Verify Bar");
 
-                THE_TESTS_LIST.lists[
-                    the_soft_dfs_info->tests_list_index
-                    ].tests[the_soft_dfs_info->test_index]
+                fcs_tests_list_t * const tests_list =
+                    &(THE_TESTS_LIST.lists[the_soft_dfs_info->tests_list_index]);
+                int test_index = the_soft_dfs_info->test_index;
+
+                if (tests_list->adaptive_order)
+                {
+                    if (test_index == 0)
+                    {
+                        if (*(instance_num_checked_states_ptr)
+                            - tests_list->adaptive_ranked_at
+                            >= adaptive_tests_order_interval)
+                        {
+                            fc_solve_rank_adaptive_tests(tests_list);
+                            tests_list->adaptive_ranked_at =
+                                *(instance_num_checked_states_ptr);
+                        }
+                        memcpy(the_soft_dfs_info->adaptive_tests_order,
+                            tests_list->adaptive_order,
+                            tests_list->num_tests
+                        );
+                    }
+                    test_index =
+                        the_soft_dfs_info->adaptive_tests_order[test_index];
+                    the_soft_dfs_info->derived_states_test_stats =
+                        &(tests_list->adaptive_stats[test_index]);
+                }
+
+                tests_list->tests[test_index]
                     (
                         soft_thread,
                         STATE_TO_PASS(),
@@ -1147,6 +1600,13 @@ static GCC_INLINE int fc_solve_soft_dfs_do_solve(
                                 {
                                     fcs_derived_states_list_item_t * derived_states =
                                         derived_states_list->states;
+                                    fcs_befs_parent_terms_t parent_terms;
+                                    befs_init_parent_terms(
+                                        soft_thread,
+                                        weighting,
+                                        &(FCS_SCANS_the_state),
+                                        &parent_terms
+                                    );
                                     /* TODO : avoid excessive mallocing. */
                                     for (int i = 0 ; i < num_states ; i++)
                                     {
@@ -1161,7 +1621,8 @@ static GCC_INLINE int fc_solve_soft_dfs_do_solve(
 #else
                                             &(derived_states[rand_array[i].idx].state_ptr->s),
 #endif
-                                            BEFS_MAX_DEPTH - calc_depth(derived_states[rand_array[i].idx].state_ptr)
+                                            BEFS_MAX_DEPTH - calc_depth(derived_states[rand_array[i].idx].state_ptr),
+                                            &parent_terms
                                             );
                                     }
 
@@ -1217,6 +1678,21 @@ static GCC_INLINE int fc_solve_soft_dfs_do_solve(
                         single_derived_state,
                         soft_thread_id)
                     )
+#ifndef FCS_RCS_STATES
+                    &&
+                    (likely(DEPTH() != split_parent_depth)
+                     || fc_solve_dfs_split_claim(
+                         dfs_split,
+                         fc_solve_dfs_split_calc_key(
+                             &(single_derived_state->s),
+                             soft_thread_id,
+                             INSTANCE_STACKS_NUM,
+                             INSTANCE_FREECELLS_NUM,
+                             INSTANCE_DECKS_NUM
+                         )
+                      )
+                    )
+#endif
                    )
                 {
                     BUMP_NUM_CHECKED_STATES();
@@ -1254,16 +1730,32 @@ static GCC_INLINE int fc_solve_soft_dfs_do_solve(
                     the_soft_dfs_info->test_index = 0;
                     the_soft_dfs_info->current_state_index = 0;
                     the_soft_dfs_info->positions_by_rank = NULL;
+                    the_soft_dfs_info->test_stats =
+                        (the_soft_dfs_info-1)->derived_states_test_stats;
                     derived_states_list = &(the_soft_dfs_info->derived_states_list);
                     derived_states_list->num_states = 0;
 
+                    /* The state FCS_ADAPTIVE_TESTS_ORDER_PLIES above was
+                     * not a quick dead end. */
+                    if (DEPTH() >= FCS_ADAPTIVE_TESTS_ORDER_PLIES)
+                    {
+                        fcs_soft_dfs_stack_item_t * const ancestor =
+                            the_soft_dfs_info - FCS_ADAPTIVE_TESTS_ORDER_PLIES;
+                        if (ancestor->test_stats)
+                        {
+                            ancestor->test_stats->num_pulls++;
+                            ancestor->test_stats->num_rewards++;
+                            ancestor->test_stats = NULL;
+                        }
+                    }
+
                     calculate_real_depth(calc_real_depth, PTR_STATE);
 
-                    if (check_num_states_in_collection(instance))
+                    if (should_free_states(instance))
                     {
                         VERIFY_PTR_STATE_TRACE0("Verify Bakers_Game");
 
-                        free_states(instance);
+                        free_states(instance, soft_thread);
 
                         VERIFY_PTR_STATE_TRACE0("Verify Penguin");
                     }
@@ -0,0 +1,726 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * solution_cache.h - a persistent cache of the solutions of the boards
+ * that were already solved, so that a board that is seen again is answered
+ * without solving it.
+ *
+ * A solution is keyed by two independent hashes of the canonized initial
+ * state and by a digest of the configuration (the variant and the options
+ * of the solver), so a board whose columns or freecells are permuted finds
+ * the solution of the original. The moves are stored with the stacks and
+ * freecells renumbered to their canonized order, and are renumbered back
+ * to the order of the board that looks them up.
+ *
+ * The file is an append-only log of records after a header that holds the
+ * length of its committed part. Writers append a record and only then
+ * extend the committed length, all under an exclusive flock(), while
+ * readers take a shared one to read that length and then read the records
+ * from a read-only mapping of the file. A record that was appended by a
+ * writer that crashed before it committed it is overwritten by the next
+ * one. Every handle opens the file by itself (and reopens it after a
+ * fork()), so the threads and the processes that share a file, each with
+ * its own handle, exclude one another. The index of the records is a hash
+ * table in memory, which is built when the file is opened and extended
+ * with the records that were committed since whenever a key is looked up.
+ */
+#ifndef FC_SOLVE__SOLUTION_CACHE_H
+#define FC_SOLVE__SOLUTION_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#endif
+
+#include "alloc_wrap.h"
+#include "inline.h"
+#include "bool.h"
+#include "fcs_move.h"
+#include "state.h"
+
+#define FCS_SOLUTION_CACHE_MAGIC "FCSSOLC1"
+#define FCS_SOLUTION_CACHE_INITIAL_INDEX_SIZE 1024
+
+typedef struct
+{
+    char magic[8];
+    /* The length of the file up to the end of the last committed record. */
+    unsigned long long committed_len;
+    unsigned long long reserved[2];
+} fcs_solution_cache_file_header_t;
+
+typedef struct
+{
+    unsigned long long state_hash;
+    unsigned long long state_check;
+    unsigned long long config_digest;
+} fcs_solution_cache_key_t;
+
+/* The record is followed by num_moves moves, and is padded to 8 bytes. */
+typedef struct
+{
+    fcs_solution_cache_key_t key;
+    unsigned int num_moves;
+    unsigned int reserved;
+} fcs_solution_cache_record_t;
+
+typedef struct
+{
+    fcs_solution_cache_key_t key;
+    /* The offset of the record in the file, or 0 for an empty slot. */
+    size_t offset;
+} fcs_solution_cache_index_entry_t;
+
+typedef struct
+{
+    char * filename;
+    int fd;
+#ifndef WIN32
+    pid_t pid;
+#endif
+    fcs_bool_t is_read_only;
+    /* A mapping of the first mapped_len bytes of the file. */
+    unsigned char * mapped;
+    size_t mapped_len;
+    /* The length of the file whose records are in the index. */
+    size_t indexed_len;
+    /* An open-addressing hash table with a power of 2 size. */
+    fcs_solution_cache_index_entry_t * index;
+    size_t index_size;
+    size_t index_count;
+} fcs_solution_cache_t;
+
+static GCC_INLINE void fc_solve_solution_cache__init(
+    fcs_solution_cache_t * const cache
+)
+{
+    cache->filename = NULL;
+    cache->fd = -1;
+    cache->is_read_only = FALSE;
+    cache->mapped = NULL;
+    cache->mapped_len = 0;
+    cache->indexed_len = sizeof(fcs_solution_cache_file_header_t);
+    cache->index = NULL;
+    cache->index_size = 0;
+    cache->index_count = 0;
+}
+
+static GCC_INLINE fcs_bool_t fc_solve_solution_cache__is_loaded(
+    const fcs_solution_cache_t * const cache
+)
+{
+    return (cache->filename != NULL);
+}
+
+static GCC_INLINE void fc_solve_solution_cache__free(
+    fcs_solution_cache_t * const cache
+)
+{
+#ifndef WIN32
+    if (cache->mapped)
+    {
+        munmap(cache->mapped, cache->mapped_len);
+    }
+    if (cache->fd >= 0)
+    {
+        close(cache->fd);
+    }
+#endif
+    free(cache->filename);
+    free(cache->index);
+    fc_solve_solution_cache__init(cache);
+}
+
+/*
+ * The hashes of the key. The first one is FNV-1a and the second one is an
+ * unrelated multiplicative hash, so a board is mistaken for another only if
+ * both of them collide.
+ * */
+#define FCS_SOLUTION_CACHE_FNV_OFFSET 0xcbf29ce484222325ULL
+#define FCS_SOLUTION_CACHE_FNV_PRIME 0x100000001b3ULL
+#define FCS_SOLUTION_CACHE_CHECK_MULT 0x9e3779b97f4a7c15ULL
+
+static GCC_INLINE void fc_solve_solution_cache__hash_byte(
+    fcs_solution_cache_key_t * const key,
+    const unsigned char byte
+)
+{
+    key->state_hash = (key->state_hash ^ byte) * FCS_SOLUTION_CACHE_FNV_PRIME;
+    key->state_check =
+        (key->state_check + byte + 1) * FCS_SOLUTION_CACHE_CHECK_MULT;
+    key->state_check ^= (key->state_check >> 29);
+}
+
+/*
+ * Mixes value into the configuration digest h.
+ * */
+static GCC_INLINE unsigned long long fc_solve_solution_cache__mix_digest(
+    unsigned long long h,
+    const unsigned long long value
+)
+{
+    for (int i = 0 ; i < 8 ; i++)
+    {
+        h = (h ^ ((value >> (i * 8)) & 0xFF)) * FCS_SOLUTION_CACHE_FNV_PRIME;
+    }
+    return h;
+}
+
+static GCC_INLINE unsigned long long fc_solve_solution_cache__hash_string(
+    const char * const s
+)
+{
+    unsigned long long h = FCS_SOLUTION_CACHE_FNV_OFFSET;
+    for (const unsigned char * p = (const unsigned char *)s ; *p ; p++)
+    {
+        h = (h ^ (*p)) * FCS_SOLUTION_CACHE_FNV_PRIME;
+    }
+    return h;
+}
+
+/*
+ * Calculates the key of a canonized initial state.
+ * */
+static GCC_INLINE fcs_solution_cache_key_t fc_solve_solution_cache__calc_key(
+    const fcs_state_t * const state,
+    const int freecells_num,
+    const int stacks_num,
+    const int decks_num,
+    const unsigned long long config_digest
+)
+{
+    fcs_solution_cache_key_t key = {
+        .state_hash = FCS_SOLUTION_CACHE_FNV_OFFSET,
+        .state_check = 0,
+        .config_digest = config_digest
+    };
+
+    for (int i = 0 ; i < stacks_num ; i++)
+    {
+        const fcs_const_cards_column_t col = fcs_state_get_col(*state, i);
+        const int col_len = fcs_col_len(col);
+        fc_solve_solution_cache__hash_byte(&key, (unsigned char)col_len);
+        for (int h = 0 ; h < col_len ; h++)
+        {
+            fc_solve_solution_cache__hash_byte(&key,
+                (unsigned char)fcs_card2char(fcs_col_get_card(col, h)));
+        }
+    }
+    for (int i = 0 ; i < freecells_num ; i++)
+    {
+        fc_solve_solution_cache__hash_byte(&key,
+            (unsigned char)fcs_card2char(fcs_freecell_card(*state, i)));
+    }
+    for (int i = 0 ; i < (decks_num << 2) ; i++)
+    {
+        fc_solve_solution_cache__hash_byte(&key,
+            (unsigned char)fcs_foundation_value(*state, i));
+    }
+
+    return key;
+}
+
+static GCC_INLINE fcs_bool_t fc_solve_solution_cache__keys_are_equal(
+    const fcs_solution_cache_key_t * const a,
+    const fcs_solution_cache_key_t * const b
+)
+{
+    return ((a->state_hash == b->state_hash)
+        && (a->state_check == b->state_check)
+        && (a->config_digest == b->config_digest));
+}
+
+/*
+ * Renumbers the stacks and the freecells of the moves from the order of a
+ * board to the canonized one (if to_canonized) or back. locs are the
+ * locations of the board's canonized stacks and freecells, as calculated
+ * by fc_solve_canonize_state_with_locs().
+ * */
+static GCC_INLINE void fc_solve_solution_cache__renumber_moves(
+    fcs_move_t * const moves,
+    const int num_moves,
+    const fcs_state_locs_struct_t * const locs,
+    const fcs_bool_t to_canonized
+)
+{
+    int stack_map[MAX_NUM_STACKS];
+    int fc_map[MAX_NUM_FREECELLS];
+
+    for (int i = 0 ; i < MAX_NUM_STACKS ; i++)
+    {
+        if (to_canonized)
+        {
+            stack_map[(int)locs->stack_locs[i]] = i;
+        }
+        else
+        {
+            stack_map[i] = locs->stack_locs[i];
+        }
+    }
+    for (int i = 0 ; i < MAX_NUM_FREECELLS ; i++)
+    {
+        if (to_canonized)
+        {
+            fc_map[(int)locs->fc_locs[i]] = i;
+        }
+        else
+        {
+            fc_map[i] = locs->fc_locs[i];
+        }
+    }
+
+    for (int i = 0 ; i < num_moves ; i++)
+    {
+        fcs_move_t * const move = &(moves[i]);
+        switch (fcs_move_get_type(*move))
+        {
+            case FCS_MOVE_TYPE_STACK_TO_STACK:
+            fcs_move_set_src_stack(*move,
+                stack_map[fcs_move_get_src_stack(*move)]);
+            fcs_move_set_dest_stack(*move,
+                stack_map[fcs_move_get_dest_stack(*move)]);
+            break;
+
+            case FCS_MOVE_TYPE_STACK_TO_FREECELL:
+            fcs_move_set_src_stack(*move,
+                stack_map[fcs_move_get_src_stack(*move)]);
+            fcs_move_set_dest_freecell(*move,
+                fc_map[fcs_move_get_dest_freecell(*move)]);
+            break;
+
+            case FCS_MOVE_TYPE_FREECELL_TO_STACK:
+            fcs_move_set_src_freecell(*move,
+                fc_map[fcs_move_get_src_freecell(*move)]);
+            fcs_move_set_dest_stack(*move,
+                stack_map[fcs_move_get_dest_stack(*move)]);
+            break;
+
+            case FCS_MOVE_TYPE_FREECELL_TO_FREECELL:
+            fcs_move_set_src_freecell(*move,
+                fc_map[fcs_move_get_src_freecell(*move)]);
+            fcs_move_set_dest_freecell(*move,
+                fc_map[fcs_move_get_dest_freecell(*move)]);
+            break;
+
+            case FCS_MOVE_TYPE_STACK_TO_FOUNDATION:
+            case FCS_MOVE_TYPE_SEQ_TO_FOUNDATION:
+            case FCS_MOVE_TYPE_FLIP_CARD:
+            fcs_move_set_src_stack(*move,
+                stack_map[fcs_move_get_src_stack(*move)]);
+            break;
+
+            case FCS_MOVE_TYPE_FREECELL_TO_FOUNDATION:
+            fcs_move_set_src_freecell(*move,
+                fc_map[fcs_move_get_src_freecell(*move)]);
+            break;
+        }
+    }
+}
+
+#ifndef WIN32
+
+static GCC_INLINE size_t fc_solve_solution_cache__record_len(
+    const unsigned int num_moves
+)
+{
+    return ((sizeof(fcs_solution_cache_record_t)
+        + num_moves * sizeof(fcs_move_t) + 7) & (~((size_t)7)));
+}
+
+static GCC_INLINE size_t fc_solve_solution_cache__calc_bucket(
+    const fcs_solution_cache_t * const cache,
+    const fcs_solution_cache_key_t * const key
+)
+{
+    return ((size_t)(key->state_hash ^ key->config_digest)
+        & (cache->index_size - 1));
+}
+
+static GCC_INLINE const fcs_solution_cache_record_t *
+fc_solve_solution_cache__get_record(
+    const fcs_solution_cache_t * const cache,
+    const size_t offset
+)
+{
+    return (const fcs_solution_cache_record_t *)(cache->mapped + offset);
+}
+
+/*
+ * Returns the slot of key, which is empty if key is not in the index.
+ * */
+static GCC_INLINE fcs_solution_cache_index_entry_t *
+fc_solve_solution_cache__find_slot(
+    const fcs_solution_cache_t * const cache,
+    const fcs_solution_cache_key_t * const key
+)
+{
+    size_t bucket = fc_solve_solution_cache__calc_bucket(cache, key);
+    while (cache->index[bucket].offset
+        && (! fc_solve_solution_cache__keys_are_equal(
+            &(cache->index[bucket].key), key)))
+    {
+        bucket = ((bucket + 1) & (cache->index_size - 1));
+    }
+    return &(cache->index[bucket]);
+}
+
+static GCC_INLINE void fc_solve_solution_cache__index_record(
+    fcs_solution_cache_t * const cache,
+    const size_t offset
+);
+
+static GCC_INLINE void fc_solve_solution_cache__grow_index(
+    fcs_solution_cache_t * const cache
+)
+{
+    fcs_solution_cache_index_entry_t * const old_index = cache->index;
+    const size_t old_size = cache->index_size;
+
+    cache->index_size = (old_size
+        ? (old_size << 1) : FCS_SOLUTION_CACHE_INITIAL_INDEX_SIZE);
+    cache->index = calloc(cache->index_size, sizeof(cache->index[0]));
+    cache->index_count = 0;
+    for (size_t i = 0 ; i < old_size ; i++)
+    {
+        if (old_index[i].offset)
+        {
+            fc_solve_solution_cache__index_record(cache, old_index[i].offset);
+        }
+    }
+    free(old_index);
+}
+
+/*
+ * Adds the record at offset to the index. If its key was recorded twice
+ * (by two writers that solved the same board at once), the shorter
+ * solution wins.
+ * */
+static GCC_INLINE void fc_solve_solution_cache__index_record(
+    fcs_solution_cache_t * const cache,
+    const size_t offset
+)
+{
+    if ((cache->index_count + 1) * 2 > cache->index_size)
+    {
+        fc_solve_solution_cache__grow_index(cache);
+    }
+    const fcs_solution_cache_record_t * const record =
+        fc_solve_solution_cache__get_record(cache, offset);
+    fcs_solution_cache_index_entry_t * const slot =
+        fc_solve_solution_cache__find_slot(cache, &(record->key));
+    if (! slot->offset)
+    {
+        slot->key = record->key;
+        slot->offset = offset;
+        cache->index_count++;
+    }
+    else if (record->num_moves <
+        fc_solve_solution_cache__get_record(cache, slot->offset)->num_moves)
+    {
+        slot->offset = offset;
+    }
+}
+
+/*
+ * Maps the file up to committed_len and indexes the records that were
+ * committed since it was last called. Returns FALSE if the file could not
+ * be mapped.
+ * */
+static GCC_INLINE fcs_bool_t fc_solve_solution_cache__catch_up(
+    fcs_solution_cache_t * const cache,
+    const size_t committed_len
+)
+{
+    if (committed_len <= cache->indexed_len)
+    {
+        return TRUE;
+    }
+    if (committed_len > cache->mapped_len)
+    {
+        if (cache->mapped)
+        {
+            munmap(cache->mapped, cache->mapped_len);
+        }
+        cache->mapped = mmap(NULL, committed_len, PROT_READ, MAP_SHARED,
+            cache->fd, 0);
+        if (cache->mapped == MAP_FAILED)
+        {
+            cache->mapped = NULL;
+            cache->mapped_len = 0;
+            return FALSE;
+        }
+        cache->mapped_len = committed_len;
+    }
+
+    size_t offset = cache->indexed_len;
+    while (offset + sizeof(fcs_solution_cache_record_t) <= committed_len)
+    {
+        const fcs_solution_cache_record_t * const record =
+            fc_solve_solution_cache__get_record(cache, offset);
+        const size_t record_len =
+            fc_solve_solution_cache__record_len(record->num_moves);
+        if (offset + record_len > committed_len)
+        {
+            break;
+        }
+        fc_solve_solution_cache__index_record(cache, offset);
+        offset += record_len;
+    }
+    cache->indexed_len = committed_len;
+
+    return TRUE;
+}
+
+/*
+ * Reads the committed length from the header. The caller must hold a lock
+ * on the file.
+ * */
+static GCC_INLINE fcs_bool_t fc_solve_solution_cache__read_committed_len(
+    const fcs_solution_cache_t * const cache,
+    size_t * const committed_len
+)
+{
+    fcs_solution_cache_file_header_t header;
+    if ((pread(cache->fd, &header, sizeof(header), 0) != sizeof(header))
+        || memcmp(header.magic, FCS_SOLUTION_CACHE_MAGIC, sizeof(header.magic))
+        || (header.committed_len < sizeof(header)))
+    {
+        return FALSE;
+    }
+    *committed_len = (size_t)header.committed_len;
+    return TRUE;
+}
+
+static GCC_INLINE fcs_bool_t fc_solve_solution_cache__open_file(
+    fcs_solution_cache_t * const cache
+)
+{
+    cache->is_read_only = FALSE;
+    cache->fd = open(cache->filename, O_RDWR | O_CREAT, 0644);
+    if (cache->fd < 0)
+    {
+        cache->is_read_only = TRUE;
+        cache->fd = open(cache->filename, O_RDONLY);
+    }
+    cache->pid = getpid();
+    return (cache->fd >= 0);
+}
+
+/*
+ * A child process that inherited the handle shares the lock of its
+ * parent's file descriptor, so it opens the file again.
+ * */
+static GCC_INLINE fcs_bool_t fc_solve_solution_cache__check_pid(
+    fcs_solution_cache_t * const cache
+)
+{
+    if (cache->pid == getpid())
+    {
+        return TRUE;
+    }
+    close(cache->fd);
+    return fc_solve_solution_cache__open_file(cache);
+}
+
+/*
+ * Indexes the records that the other writers committed since the last
+ * call. Returns FALSE on an error.
+ * */
+static GCC_INLINE fcs_bool_t fc_solve_solution_cache__refresh(
+    fcs_solution_cache_t * const cache
+)
+{
+    if (! fc_solve_solution_cache__check_pid(cache))
+    {
+        return FALSE;
+    }
+    size_t committed_len;
+    flock(cache->fd, LOCK_SH);
+    const fcs_bool_t ret =
+        fc_solve_solution_cache__read_committed_len(cache, &committed_len);
+    flock(cache->fd, LOCK_UN);
+
+    return (ret && fc_solve_solution_cache__catch_up(cache, committed_len));
+}
+
+#endif
+
+/*
+ * Opens (or creates) the cache file. Returns NULL on success or an error
+ * message.
+ * */
+static GCC_INLINE const char * fc_solve_solution_cache__load(
+    fcs_solution_cache_t * const cache,
+    const char * const filename
+)
+{
+#ifdef WIN32
+    return "The solution cache is not supported on this platform.";
+#else
+    fc_solve_solution_cache__init(cache);
+    cache->filename = strdup(filename);
+    if (! fc_solve_solution_cache__open_file(cache))
+    {
+        fc_solve_solution_cache__free(cache);
+        return "Could not open the solution cache.";
+    }
+
+    if (! cache->is_read_only)
+    {
+        flock(cache->fd, LOCK_EX);
+        fcs_solution_cache_file_header_t header;
+        if (pread(cache->fd, &header, sizeof(header), 0) == 0)
+        {
+            memset(&header, '\0', sizeof(header));
+            memcpy(header.magic, FCS_SOLUTION_CACHE_MAGIC,
+                sizeof(header.magic));
+            header.committed_len = sizeof(header);
+            if (pwrite(cache->fd, &header, sizeof(header), 0)
+                != sizeof(header))
+            {
+                flock(cache->fd, LOCK_UN);
+                fc_solve_solution_cache__free(cache);
+                return "Could not write the solution cache.";
+            }
+        }
+        flock(cache->fd, LOCK_UN);
+    }
+
+    if (! fc_solve_solution_cache__refresh(cache))
+    {
+        fc_solve_solution_cache__free(cache);
+        return "The file is not a solution cache.";
+    }
+
+    return NULL;
+#endif
+}
+
+/*
+ * Looks up key. If it is found, returns TRUE and sets moves_seq to a
+ * malloc()ed copy of the solution.
+ * */
+static GCC_INLINE fcs_bool_t fc_solve_solution_cache__lookup(
+    fcs_solution_cache_t * const cache,
+    const fcs_solution_cache_key_t * const key,
+    fcs_moves_sequence_t * const moves_seq
+)
+{
+#ifdef WIN32
+    return FALSE;
+#else
+    if ((! fc_solve_solution_cache__refresh(cache)) || (! cache->index))
+    {
+        return FALSE;
+    }
+    const fcs_solution_cache_index_entry_t * const slot =
+        fc_solve_solution_cache__find_slot(cache, key);
+    if (! slot->offset)
+    {
+        return FALSE;
+    }
+    const fcs_solution_cache_record_t * const record =
+        fc_solve_solution_cache__get_record(cache, slot->offset);
+    moves_seq->num_moves = (int)record->num_moves;
+    moves_seq->moves = SMALLOC(moves_seq->moves, record->num_moves + 1);
+    memcpy(moves_seq->moves, (const void *)(record + 1),
+        sizeof(moves_seq->moves[0]) * record->num_moves);
+
+    return TRUE;
+#endif
+}
+
+/*
+ * Appends the solution of key unless a solution of it was already
+ * committed. Returns FALSE on an error.
+ * */
+static GCC_INLINE fcs_bool_t fc_solve_solution_cache__store(
+    fcs_solution_cache_t * const cache,
+    const fcs_solution_cache_key_t * const key,
+    const fcs_move_t * const moves,
+    const int num_moves
+)
+{
+#ifdef WIN32
+    return FALSE;
+#else
+    if (cache->is_read_only || (! fc_solve_solution_cache__check_pid(cache)))
+    {
+        return FALSE;
+    }
+
+    const size_t record_len = fc_solve_solution_cache__record_len(num_moves);
+    unsigned char * const buffer = calloc(record_len, 1);
+    fcs_solution_cache_record_t * const record =
+        (fcs_solution_cache_record_t *)buffer;
+    record->key = *key;
+    record->num_moves = (unsigned int)num_moves;
+    memcpy(record + 1, moves, sizeof(moves[0]) * num_moves);
+
+    size_t committed_len;
+    fcs_bool_t ret = FALSE;
+    flock(cache->fd, LOCK_EX);
+    if (fc_solve_solution_cache__read_committed_len(cache, &committed_len)
+        && fc_solve_solution_cache__catch_up(cache, committed_len))
+    {
+        if (cache->index
+            && fc_solve_solution_cache__find_slot(cache, key)->offset)
+        {
+            ret = TRUE;
+        }
+        else if (pwrite(cache->fd, buffer, record_len, (off_t)committed_len)
+            == (ssize_t)record_len)
+        {
+            const unsigned long long new_committed_len =
+                committed_len + record_len;
+            ret = (pwrite(cache->fd, &new_committed_len,
+                sizeof(new_committed_len),
+                offsetof(fcs_solution_cache_file_header_t, committed_len))
+                == sizeof(new_committed_len));
+        }
+    }
+    flock(cache->fd, LOCK_UN);
+    free(buffer);
+
+    return ret;
+#endif
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FC_SOLVE__SOLUTION_CACHE_H */
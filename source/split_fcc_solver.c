@@ -34,12 +34,20 @@
 #define DEBUG_OUT 1
 #endif
 
+/* The mark-and-sweep of the old depths walks the records of the store,
+ * which are only kept in memory without caches. */
+#ifndef FCS_DBM_WITHOUT_CACHES
+#error split_fcc_solver.c requires the kaztree store (FCS_DBM_WITHOUT_CACHES).
+#endif
+
 #include "dbm_solver_head.h"
 #include <sys/tree.h>
 #include <assert.h>
 #include "count.h"
 
 #include "depth_multi_queue.h"
+#include "dbm_metrics.h"
+#include "dbm_checkpoint.h"
 
 #ifdef FCS_DEBONDT_DELTA_STATES
 
@@ -169,6 +177,7 @@ typedef struct
     char * moves_base64_encoding_buffer;
     size_t moves_base64_encoding_buffer_max_len;
     const char * dbm_store_path;
+    fcs_dbm_metrics_t metrics;
 } fcs_dbm_solver_instance_t;
 
 #define __unused GCC_UNUSED
@@ -237,6 +246,7 @@ static GCC_INLINE void instance_init(
     }
     instance->count_of_items_in_queue = 0;
     instance->tree_recycle_bin = NULL;
+    fcs_dbm_metrics__init(&(instance->metrics));
 
     FCS_INIT_LOCK(instance->storage_lock);
     FCS_INIT_LOCK(instance->output_lock);
@@ -274,6 +284,7 @@ static GCC_INLINE void instance_destroy(
 {
     fcs_dbm_collection_by_depth_t * coll;
 
+    fcs_dbm_metrics__destroy(&(instance->metrics));
     fc_solve_compact_allocator_finish(&(instance->fcc_entry_points_allocator));
     fc_solve_meta_compact_allocator_finish(&(instance->fcc_meta_alloc));
     {
@@ -391,8 +402,52 @@ struct fcs_dbm_solver_thread_struct
     fc_solve_delta_stater_t * delta_stater;
     fcs_meta_compact_allocator_t thread_meta_alloc;
     int state_depth;
+    fcs_dbm_metrics_slot_t * metrics_slot;
 };
 
+/*
+ * The depth is the lowest one that is still queued and the depth counts
+ * are the number of queued states of every depth. Should be called with
+ * the queue lock held.
+ * */
+static void instance_export_metrics(
+    fcs_dbm_solver_instance_t * const instance
+)
+{
+    fcs_dbm_metrics_sample_t sample;
+    const fcs_depth_multi_queue_t * const depth_queue =
+        &(instance->coll.depth_queue);
+
+    if (! instance->metrics.fh)
+    {
+        return;
+    }
+
+    const int num_depths = depth_queue->max_depth + 1;
+    long * const depth_counts = SMALLOC(depth_counts, num_depths);
+
+    sample.num_processed = instance->count_num_processed;
+    sample.num_states_in_collection = instance->num_states_in_collection;
+    sample.num_items_in_queue = depth_queue->num_items_in_queue;
+    sample.num_items_in_memory = 0;
+    memset(depth_counts, '\0', sizeof(depth_counts[0]) * num_depths);
+    for (long depth = depth_queue->min_depth ; depth < num_depths ; depth++)
+    {
+        const fcs_offloading_queue_t * const queue =
+            &(depth_queue->queues_by_depth[depth - depth_queue->min_depth]);
+        sample.num_items_in_memory +=
+            fcs_offloading_queue__count_items_in_memory(queue);
+        depth_counts[depth] = queue->num_items_in_queue;
+    }
+    sample.num_cache_hits = sample.num_cache_misses = -1;
+    sample.depth = depth_queue->min_depth;
+    sample.num_depths = num_depths;
+    sample.depth_counts = depth_counts;
+
+    fcs_dbm_metrics__export(&(instance->metrics), &sample);
+    free(depth_counts);
+}
+
 static GCC_INLINE void instance_check_key(
     fcs_dbm_solver_thread_t * thread,
     fcs_dbm_solver_instance_t * instance,
@@ -715,7 +770,8 @@ static void * instance_run_solver_thread(void * void_arg)
     while (1)
     {
         /* First of all extract an item. */
-        FCS_LOCK(coll->queue_lock);
+        FCS_DBM_METRICS_LOCK(&(instance->metrics), thread->metrics_slot,
+            coll->queue_lock);
 
         if (prev_item)
         {
@@ -732,10 +788,16 @@ static void * instance_run_solver_thread(void * void_arg)
                 item = &physical_item;
                 instance->count_of_items_in_queue--;
                 instance->queue_num_extracted_and_processed++;
+                fcs_dbm_metrics__add_processed(thread->metrics_slot, 1);
                 if (++instance->count_num_processed % 100000 == 0)
                 {
                     instance_print_stats(instance, out_fh);
                 }
+                if (fcs_dbm_metrics__is_due(&(instance->metrics),
+                    instance->count_num_processed))
+                {
+                    instance_export_metrics(instance);
+                }
                 if (instance->count_num_processed >=
                     instance->max_count_num_processed)
                 {
@@ -904,18 +966,11 @@ static void * instance_run_solver_thread(void * void_arg)
         }
 
         /* Encode all the states. */
-        for (derived_iter = derived_list;
-                derived_iter ;
-                derived_iter = derived_iter->next
-        )
-        {
-            fcs_init_and_encode_state(
-                delta_stater,
-                local_variant,
-                &(derived_iter->state),
-                &(derived_iter->key)
-            );
-        }
+        fcs_init_and_encode_derived_states(
+            delta_stater,
+            local_variant,
+            derived_list
+        );
 
         instance_check_multiple_keys(thread, instance, derived_list
 #ifdef FCS_DBM_CACHE_ONLY
@@ -977,6 +1032,7 @@ static void instance_run_all_threads(
 #endif
 
     threads = SMALLOC(threads, num_threads);
+    fcs_dbm_metrics__alloc_slots(&(instance->metrics), num_threads);
 
     TRACE0("instance_run_all_threads start");
 
@@ -1008,6 +1064,7 @@ static void instance_run_all_threads(
         fc_solve_meta_compact_allocator_init(
             &(threads[i].thread.thread_meta_alloc)
         );
+        threads[i].thread.metrics_slot = &(instance->metrics.slots[i]);
         threads[i].arg.thread = &(threads[i].thread);
     }
 
@@ -1050,6 +1107,45 @@ static void instance_run_all_threads(
             /* Now that we are about to ascend to a new depth, let's mark-and-sweep
              * the old states, some of which are no longer of interest.
              * */
+#ifdef FCS_DBM_USE_BPTREE
+            dict_t * const kaz_tree = fc_solve_dbm_store_get_dict(
+                instance->coll.store
+            );
+            fcs_bp_tree_iter_t iter;
+            const size_t items_count = kaz_tree->count;
+            size_t idx = 0;
+
+            TRACE1("Start mark-and-sweep cleanup for curr_depth=%d\n", instance->curr_depth);
+            for (
+                fcs_dbm_record_t * item = fc_solve_bp_tree_iter_first(kaz_tree, &iter)
+                ;
+                item
+                ;
+                item = fc_solve_bp_tree_iter_next(&iter)
+            )
+            {
+                fcs_dbm_record_t * ancestor = item;
+                while (fcs_dbm_record_get_refcount(ancestor) == 0)
+                {
+                    fcs_dbm_record_t * const parent =
+                        fcs_dbm_record_get_parent_ptr(ancestor);
+
+                    fcs_dbm_record_recycle(ancestor, &(instance->tree_recycle_bin));
+
+                    if (!(ancestor = parent))
+                    {
+                        break;
+                    }
+                    fcs_dbm_record_decrement_refcount(ancestor);
+                }
+                if (((++idx) % 100000) == 0)
+                {
+                    fprintf(out_fh, "Mark+Sweep Progress - %ld/%ld\n",
+                        ((long)idx), ((long)items_count));
+                }
+            }
+            TRACE1("Finish mark-and-sweep cleanup for curr_depth=%d\n", instance->curr_depth);
+#else
             dict_t * kaz_tree;
             struct avl_traverser trav;
             dict_key_t item;
@@ -1102,6 +1198,7 @@ static void instance_run_all_threads(
                 }
             }
             TRACE1("Finish mark-and-sweep cleanup for curr_depth=%d\n", instance->curr_depth);
+#endif
         }
     }
 
@@ -1207,6 +1304,7 @@ static fcs_bool_t handle_and_destroy_instance_solution(
 
     TRACE0("handle_and_destroy_instance_solution start");
     instance_print_stats(instance, out_fh);
+    instance_export_metrics(instance);
 
     if (instance->queue_solution_was_found)
     {
@@ -1289,6 +1387,8 @@ int main(int argc, char * argv[])
     const char * fingerprint_input_location_path = NULL;
     const char * path_to_output_dir = NULL;
     const char * filename = NULL, * offload_dir_path = NULL;
+    const char * metrics_path = NULL;
+    double metrics_interval = FCS_DBM_METRICS_DEFAULT_INTERVAL;
     char user_state[USER_STATE_SIZE];
     enum fcs_dbm_variant_type_t local_variant = FCS_DBM_VARIANT_2FC_FREECELL;
 
@@ -1411,6 +1511,31 @@ int main(int argc, char * argv[])
             }
             path_to_output_dir = argv[arg];
         }
+        else if (!strcmp(argv[arg], "--metrics-output"))
+        {
+            arg++;
+            if (arg == argc)
+            {
+                fprintf(stderr, "--metrics-output came without an argument.\n");
+                exit(-1);
+            }
+            metrics_path = argv[arg];
+        }
+        else if (!strcmp(argv[arg], "--metrics-interval"))
+        {
+            arg++;
+            if (arg == argc)
+            {
+                fprintf(stderr, "--metrics-interval came without an argument.\n");
+                exit(-1);
+            }
+            metrics_interval = atof(argv[arg]);
+            if (metrics_interval <= 0)
+            {
+                fprintf(stderr, "--metrics-interval must be positive.\n");
+                exit(-1);
+            }
+        }
         else if (!strcmp(argv[arg], "--offload-dir-path"))
         {
             arg++;
@@ -1443,6 +1568,7 @@ int main(int argc, char * argv[])
         }
         else
         {
+            fcs_dbm_checkpoint__reject_option(argv[arg], "split_fcc_fc_solver");
             break;
         }
     }
@@ -1549,6 +1675,11 @@ int main(int argc, char * argv[])
             &fingerprint_which_irreversible_moves_bitmask,
             out_fh
         );
+        if (metrics_path)
+        {
+            fcs_dbm_metrics__open(&(instance.metrics), metrics_path,
+                metrics_interval);
+        }
 
         FILE * fingerprint_fh = fopen(fingerprint_input_location_path, "rt");
 
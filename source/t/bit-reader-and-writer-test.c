@@ -31,6 +31,127 @@
 #include <tap.h>
 #include "../bit_rw.h"
 
+#define NUM_FUZZ_ROUNDS 2000
+#define MAX_FUZZ_FIELDS 64
+#define FUZZ_BUF_SIZE (MAX_FUZZ_FIELDS * 8 + 1)
+
+/*
+ * The original bit-at-a-time writer and reader, which the word-at-a-time
+ * ones in bit_rw.h are compared against.
+ */
+typedef struct
+{
+    fcs_uchar_t * current;
+    int bit_in_char_idx;
+} ref_bit_writer_t;
+
+static void ref_bit_writer_write(ref_bit_writer_t * writer, int len, fc_solve_bit_data_t data)
+{
+    for (;len;len--,(data>>=1))
+    {
+        *(writer->current) |= ((data & 0x1) << (writer->bit_in_char_idx++));
+        if (writer->bit_in_char_idx == NUM_BITS_IN_BYTES)
+        {
+            *(++writer->current) = 0;
+            writer->bit_in_char_idx = 0;
+        }
+    }
+}
+
+typedef struct
+{
+    const fcs_uchar_t * current;
+    int bit_in_char_idx;
+} ref_bit_reader_t;
+
+static fc_solve_bit_data_t ref_bit_reader_read(ref_bit_reader_t * reader, int len)
+{
+    fc_solve_bit_data_t ret = 0;
+
+    for (int idx = 0 ; idx < len ; idx++)
+    {
+        ret |=
+        (
+            ((fc_solve_bit_data_t)((*(reader->current) >> (reader->bit_in_char_idx++)) & 0x1))
+                << idx
+        );
+
+        if (reader->bit_in_char_idx == NUM_BITS_IN_BYTES)
+        {
+            reader->current++;
+            reader->bit_in_char_idx = 0;
+        }
+    }
+
+    return ret;
+}
+
+/* xorshift64* - a deterministic pseudo-random sequence. */
+static fc_solve_bit_data_t fuzz_rand(fc_solve_bit_data_t * const seed)
+{
+    *seed ^= (*seed >> 12);
+    *seed ^= (*seed << 25);
+    *seed ^= (*seed >> 27);
+    return (*seed * 2685821657736338717ULL);
+}
+
+static void fuzz_tests(void)
+{
+    fc_solve_bit_data_t seed = 24;
+    fcs_uchar_t buffer[FUZZ_BUF_SIZE], ref_buffer[FUZZ_BUF_SIZE];
+    int lens[MAX_FUZZ_FIELDS];
+    fc_solve_bit_data_t datas[MAX_FUZZ_FIELDS];
+    fcs_bool_t writes_match = TRUE, reads_match = TRUE, values_match = TRUE;
+
+    for (int round = 0 ; round < NUM_FUZZ_ROUNDS ; round++)
+    {
+        const int num_fields = (int)(fuzz_rand(&seed) % MAX_FUZZ_FIELDS) + 1;
+        /* Most fields in the delta states are short, so favour them. */
+        const int max_len = ((round & 0x1) ? FC_SOLVE_BIT_RW_MAX_LEN : 9);
+        fc_solve_bit_writer_t writer;
+        ref_bit_writer_t ref_writer = {ref_buffer, 0};
+
+        /* Garbage past the end of the encoding should be left alone. */
+        memset(buffer, 0xA5, sizeof(buffer));
+        memset(ref_buffer, 0xA5, sizeof(ref_buffer));
+        fc_solve_bit_writer_init(&writer, buffer);
+        ref_buffer[0] = 0;
+
+        for (int i = 0 ; i < num_fields ; i++)
+        {
+            lens[i] = (int)(fuzz_rand(&seed) % (max_len + 1));
+            datas[i] = fuzz_rand(&seed);
+            fc_solve_bit_writer_write(&writer, lens[i], datas[i]);
+            ref_bit_writer_write(&ref_writer, lens[i], datas[i]);
+            writes_match &=
+                ((writer.current - buffer == ref_writer.current - ref_buffer)
+                && (writer.bit_in_char_idx == ref_writer.bit_in_char_idx)
+                && (! memcmp(buffer, ref_buffer, sizeof(buffer))));
+        }
+
+        fc_solve_bit_reader_t reader;
+        ref_bit_reader_t ref_reader = {ref_buffer, 0};
+        fc_solve_bit_reader_init(&reader, buffer);
+
+        for (int i = 0 ; i < num_fields ; i++)
+        {
+            const fc_solve_bit_data_t got = fc_solve_bit_reader_read(&reader, lens[i]);
+            reads_match &= (got == ref_bit_reader_read(&ref_reader, lens[i]));
+            values_match &= (got == fc_solve_bit_rw_mask(datas[i], lens[i]));
+        }
+        reads_match &=
+            ((reader.current - buffer == ref_reader.current - ref_buffer)
+            && (reader.bit_in_char_idx == ref_reader.bit_in_char_idx));
+    }
+
+    /* TEST */
+    ok (writes_match, "The writer matches the bit-at-a-time one.");
+    /* TEST */
+    ok (reads_match, "The reader matches the bit-at-a-time one.");
+    /* TEST */
+    ok (values_match, "The values read are the ones that were written.");
+}
+
 static int main_tests(void)
 {
     {
@@ -83,7 +204,8 @@ static int main_tests(void)
 
 int main(int argc, char * argv[])
 {
-    plan_tests(6);
+    plan_tests(9);
     main_tests();
+    fuzz_tests();
     return exit_status();
 }
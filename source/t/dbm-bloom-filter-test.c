@@ -0,0 +1,183 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * A test for the blocked Bloom filter of the DBM solver.
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <tap.h>
+
+#include "../dbm_bloom.h"
+
+#define NUM_INSERTED 20000
+
+static void make_key(fcs_encoded_state_buffer_t * const key, const long idx)
+{
+    memset(key, '\0', sizeof(*key));
+    key->s[0] = sizeof(*key) - 1;
+    memcpy(key->s + 1, &idx, sizeof(idx));
+}
+
+static long count_false_positives(fcs_dbm_bloom_t * const bloom)
+{
+    long ret = 0;
+    for (long i = NUM_INSERTED ; i < NUM_INSERTED * 2 ; i++)
+    {
+        fcs_encoded_state_buffer_t key;
+        make_key(&key, i);
+        if (fcs_dbm_bloom__may_contain(bloom, &key))
+        {
+            fcs_dbm_bloom__add_false_positive(bloom);
+            ret++;
+        }
+    }
+    return ret;
+}
+
+static int main_tests(void)
+{
+    fcs_dbm_bloom_t bloom;
+
+    fcs_dbm_bloom__init(&bloom, NUM_INSERTED,
+        FCS_DBM_BLOOM_DEFAULT_BITS_PER_STATE);
+
+    for (long i = 0 ; i < NUM_INSERTED ; i++)
+    {
+        fcs_encoded_state_buffer_t key;
+        make_key(&key, i);
+        fcs_dbm_bloom__insert(&bloom, &key);
+    }
+
+    {
+        fcs_bool_t all_found = TRUE;
+        for (long i = 0 ; i < NUM_INSERTED ; i++)
+        {
+            fcs_encoded_state_buffer_t key;
+            make_key(&key, i);
+            if (! fcs_dbm_bloom__may_contain(&bloom, &key))
+            {
+                diag("Key %ld was inserted but not found.\n", i);
+                all_found = FALSE;
+                break;
+            }
+        }
+        /* TEST
+         * */
+        ok (all_found, "No false negatives.");
+    }
+
+    const long num_false_positives = count_false_positives(&bloom);
+    /* TEST
+     * */
+    ok (num_false_positives < NUM_INSERTED / 20,
+        "False positive rate is below 5%%.");
+
+    /* TEST
+     * */
+    ok (fcs_dbm_bloom__calc_observed_fpr_ppm(&bloom)
+        == (long)((1000000.0 * num_false_positives) / NUM_INSERTED),
+        "The observed false positive rate is reported.");
+
+    /* TEST
+     * */
+    ok (fcs_dbm_bloom__calc_expected_fpr_ppm(&bloom) < 50000,
+        "The expected false positive rate is reported.");
+
+    {
+        char filename[] = "/tmp/fcs-dbm-bloom-test-XXXXXX";
+        const int fd = mkstemp(filename);
+        fcs_dbm_bloom_t loaded;
+
+        close(fd);
+        /* TEST
+         * */
+        ok (fcs_dbm_bloom__save(&bloom, filename), "Saved the filter.");
+        /* TEST
+         * */
+        ok (fcs_dbm_bloom__load(&loaded, filename), "Loaded the filter.");
+        unlink(filename);
+
+        {
+            char temp_filename[sizeof(filename) + 4];
+            sprintf(temp_filename, "%s.tmp", filename);
+            /* TEST
+             * */
+            ok (access(temp_filename, F_OK) != 0,
+                "The temporary file was renamed to the filter's."
+            );
+        }
+
+        /* TEST
+         * */
+        ok ((loaded.num_blocks == bloom.num_blocks)
+            && (loaded.num_hashes == bloom.num_hashes)
+            && (loaded.num_inserted == NUM_INSERTED)
+            && (! memcmp(loaded.blocks, bloom.blocks,
+                sizeof(bloom.blocks[0]) * bloom.num_blocks)),
+            "The loaded filter is identical."
+        );
+        fcs_dbm_bloom__destroy(&loaded);
+    }
+
+    {
+        fcs_dbm_bloom_t missing;
+        /* TEST
+         * */
+        ok (! fcs_dbm_bloom__load(&missing, "/non-existent/fcs-dbm-bloom"),
+            "Loading a non-existent file fails."
+        );
+    }
+
+    {
+        fcs_dbm_bloom_t disabled;
+        fcs_encoded_state_buffer_t key;
+
+        fcs_dbm_bloom__init(&disabled, 0, FCS_DBM_BLOOM_DEFAULT_BITS_PER_STATE);
+        make_key(&key, 0);
+        fcs_dbm_bloom__insert(&disabled, &key);
+        make_key(&key, NUM_INSERTED);
+        /* TEST
+         * */
+        ok ((! fcs_dbm_bloom__is_enabled(&disabled))
+            && (disabled.blocks == NULL)
+            && fcs_dbm_bloom__may_contain(&disabled, &key),
+            "A filter for 0 states is disabled and may contain every key."
+        );
+        fcs_dbm_bloom__destroy(&disabled);
+    }
+
+    fcs_dbm_bloom__destroy(&bloom);
+
+    return 0;
+}
+
+int main(int argc, char * argv[])
+{
+    plan_tests(10);
+    main_tests();
+    return exit_status();
+}
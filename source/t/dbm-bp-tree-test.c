@@ -0,0 +1,134 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * A test for the B+tree of bp_tree.c .
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <tap.h>
+
+#include "../bp_tree.c"
+
+#define NUM_KEYS 200000
+#define NUM_OPS 400000
+
+static void make_key(fcs_encoded_state_buffer_t * const key, const long idx)
+{
+    memset(key, '\0', sizeof(*key));
+    /* Big endian, so the order of the keys is that of the indices. */
+    for (int i = 0 ; i < (int)sizeof(idx) ; i++)
+    {
+        key->s[1 + i] = (unsigned char)(idx >> (8 * (sizeof(idx) - 1 - i)));
+    }
+}
+
+static int main_tests(void)
+{
+    fcs_meta_compact_allocator_t meta_alloc;
+    fcs_encoded_state_buffer_t * const keys = SMALLOC(keys, NUM_KEYS);
+    char * const is_in = calloc(NUM_KEYS, 1);
+    unsigned long seed = 24;
+    long num_in = 0;
+    fcs_bool_t all_ok = TRUE;
+
+    fc_solve_meta_compact_allocator_init(&meta_alloc);
+    fcs_bp_tree_t * const tree = fc_solve_bp_tree_create(&meta_alloc);
+
+    for (long i = 0 ; i < NUM_KEYS ; i++)
+    {
+        make_key(&(keys[i]), i);
+    }
+
+    /* Random insertions, lookups and deletions, compared against an
+     * array of flags. */
+    for (long op = 0 ; op < NUM_OPS ; op++)
+    {
+        seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+        const long idx = (long)((seed >> 33) % NUM_KEYS);
+        const int what = (int)((seed >> 20) % 8);
+
+        if (what < 5)
+        {
+            void * const existing = fc_solve_bp_tree_insert(tree, &(keys[idx]));
+            all_ok &= (is_in[idx] ? (existing == &(keys[idx])) : (! existing));
+            num_in += (! is_in[idx]);
+            is_in[idx] = 1;
+        }
+        else if (what < 7)
+        {
+            all_ok &= ((fc_solve_bp_tree_lookup(tree, &(keys[idx]))
+                == &(keys[idx])) == (is_in[idx] != 0));
+        }
+        else
+        {
+            fc_solve_bp_tree_delete(tree, &(keys[idx]));
+            num_in -= is_in[idx];
+            is_in[idx] = 0;
+        }
+    }
+    /* TEST */
+    ok (all_ok, "Insertions, lookups and deletions agree with the reference.");
+    /* TEST */
+    ok ((long)tree->count == num_in, "The count of items is correct.");
+
+    {
+        fcs_bp_tree_iter_t iter;
+        long expected = -1, num_scanned = 0;
+        all_ok = TRUE;
+        for (fcs_encoded_state_buffer_t * item = fc_solve_bp_tree_iter_first(tree, &iter) ;
+            item ;
+            item = fc_solve_bp_tree_iter_next(&iter))
+        {
+            const long idx = item - keys;
+            while ((++expected < NUM_KEYS) && (! is_in[expected]))
+            {
+            }
+            all_ok &= (idx == expected);
+            num_scanned++;
+        }
+        /* TEST */
+        ok (all_ok && (num_scanned == num_in),
+            "The leaves are scanned in the order of the keys.");
+    }
+
+    /* TEST */
+    ok (tree->height > 2, "The tree has grown.");
+
+    fc_solve_bp_tree_destroy(tree);
+    fc_solve_meta_compact_allocator_finish(&meta_alloc);
+    free(keys);
+    free(is_in);
+
+    return 0;
+}
+
+int main(int argc, char * argv[])
+{
+    plan_tests(4);
+    main_tests();
+    return exit_status();
+}
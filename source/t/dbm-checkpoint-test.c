@@ -0,0 +1,215 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * A test for the checkpoints of the DBM solver.
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <dirent.h>
+
+#include <tap.h>
+
+/* Like in dbm_solver_head.h . */
+#define FCS_DBM_USE_OFFLOADING_QUEUE 1
+
+#include "../dbm_kaztree.c"
+#include "../dbm_checkpoint.h"
+
+#define NUM_KEYS 1000
+#define NUM_EXTRACTED 9
+#define ITEMS_PER_PAGE 16
+
+static void make_key(fcs_encoded_state_buffer_t * const key, const long idx)
+{
+    memset(key, '\0', sizeof(*key));
+    key->s[0] = sizeof(*key) - 1;
+    memcpy(key->s + 1, &idx, sizeof(idx));
+}
+
+static long key_idx(const fcs_encoded_state_buffer_t * const key)
+{
+    long idx;
+    memcpy(&idx, key->s + 1, sizeof(idx));
+    return idx;
+}
+
+/* Builds a tree where the parent of key i is key i/2 and queues all of
+ * them, except for the root. */
+static void populate(fcs_dbm_store_t store, fcs_offloading_queue_t * queue)
+{
+    fcs_encoded_state_buffer_t key;
+    fcs_dbm_record_t * records[NUM_KEYS];
+
+    for (long i = 0 ; i < NUM_KEYS ; i++)
+    {
+        make_key(&key, i);
+        records[i] = fc_solve_dbm_store_insert_key_value(store, &key,
+            (i ? records[i / 2] : NULL), TRUE);
+        fcs_dbm_record_set_refcount(records[i], (unsigned char)(i % 7));
+        if (i)
+        {
+            const fcs_offloading_queue_item_t token =
+                (fcs_offloading_queue_item_t)records[i];
+            fcs_offloading_queue__insert(queue, &token);
+        }
+    }
+}
+
+static int main_tests(void)
+{
+    char offload_dir[] = "/tmp/fcs-checkpoint-test-XXXXXX";
+    char ckpt_path[sizeof(offload_dir) + 32];
+    void * recycle_bin = NULL, * restored_recycle_bin = NULL;
+    fcs_dbm_store_t store, restored_store;
+    fcs_offloading_queue_t queue, restored_queue;
+    fcs_dbm_checkpointer_t checkpointer;
+    fcs_encoded_state_buffer_t first_key;
+    long count_num_processed, num_states_in_collection, num_items;
+
+    if (! mkdtemp(offload_dir))
+    {
+        return 1;
+    }
+    snprintf(ckpt_path, sizeof(ckpt_path), "%s/ckpt", offload_dir);
+
+    fc_solve_dbm_store_init(&store, "", &recycle_bin);
+    fcs_offloading_queue__init(&queue, ITEMS_PER_PAGE, offload_dir, 0);
+    populate(store, &queue);
+    {
+        fcs_offloading_queue_item_t token;
+        for (int i = 0 ; i < NUM_EXTRACTED ; i++)
+        {
+            fcs_offloading_queue__extract(&queue, &token);
+        }
+    }
+    make_key(&first_key, 0);
+
+    fcs_dbm_checkpointer__init(&checkpointer, ckpt_path, 100);
+    fcs_dbm_checkpointer__count(&checkpointer, 99);
+    /* TEST */
+    ok (! checkpointer.is_pending, "Not pending before the interval.");
+    fcs_dbm_checkpointer__count(&checkpointer, 200);
+    /* TEST */
+    ok (checkpointer.is_pending, "Pending at the interval.");
+
+    fcs_dbm_checkpointer__take(&checkpointer, store, &queue, &first_key,
+        12345, NUM_KEYS);
+    /* The writer works on a snapshot, so the queue may change meanwhile. */
+    {
+        fcs_offloading_queue_item_t token;
+        for (int i = 0 ; i < 3 * ITEMS_PER_PAGE ; i++)
+        {
+            fcs_offloading_queue__extract(&queue, &token);
+        }
+    }
+    fcs_dbm_checkpointer__finish(&checkpointer);
+    /* TEST */
+    ok (! checkpointer.is_pending, "Not pending after being taken.");
+
+    fc_solve_dbm_store_init(&restored_store, "", &restored_recycle_bin);
+    fcs_offloading_queue__init(&restored_queue, ITEMS_PER_PAGE, offload_dir, 1);
+    fcs_dbm_checkpoint__restore(ckpt_path, restored_store, &restored_queue,
+        &first_key, &count_num_processed, &num_states_in_collection,
+        &num_items);
+
+    /* TEST */
+    ok ((count_num_processed == 12345)
+        && (num_states_in_collection == NUM_KEYS)
+        && (num_items == NUM_KEYS - 1 - NUM_EXTRACTED),
+        "The counters were restored.");
+
+    {
+        dict_t * const tree = fc_solve_dbm_store_get_dict(restored_store);
+        fcs_bool_t all_ok = (tree->avl_count == NUM_KEYS);
+        for (long i = 0 ; all_ok && (i < NUM_KEYS) ; i++)
+        {
+            fcs_encoded_state_buffer_t key;
+            make_key(&key, i);
+            fcs_dbm_record_t * const record =
+                fcs_dbm_checkpoint__lookup(tree, &key);
+            fcs_dbm_record_t * const parent =
+                fcs_dbm_record_get_parent_ptr(record);
+            all_ok = (fcs_dbm_record_get_refcount(record) == i % 7)
+                && (i ? (parent && (key_idx(&(parent->key)) == i / 2))
+                    : (parent == NULL));
+        }
+        /* TEST */
+        ok (all_ok, "The records and their parents were restored.");
+    }
+
+    {
+        fcs_bool_t all_ok = TRUE;
+        fcs_offloading_queue_item_t token;
+        for (long i = NUM_EXTRACTED + 1 ; all_ok && (i < NUM_KEYS) ; i++)
+        {
+            all_ok = fcs_offloading_queue__extract(&restored_queue, &token)
+                && (key_idx(&(((const fcs_dbm_record_t *)token)->key)) == i);
+        }
+        /* TEST */
+        ok (all_ok && (! fcs_offloading_queue__extract(&restored_queue, &token)),
+            "The queue was restored in order.");
+    }
+
+    {
+        int num_leftovers = 0;
+        DIR * const dir = opendir(offload_dir);
+        struct dirent * entry;
+        while ((entry = readdir(dir)))
+        {
+            if (! strncmp(entry->d_name, "ckpt.", 5))
+            {
+                num_leftovers++;
+            }
+        }
+        closedir(dir);
+        /* TEST */
+        ok (num_leftovers == 0, "The writer cleaned up its temporary files.");
+    }
+
+    fcs_offloading_queue__destroy(&queue);
+    fcs_offloading_queue__destroy(&restored_queue);
+    fc_solve_dbm_store_destroy(store);
+    fc_solve_dbm_store_destroy(restored_store);
+
+    {
+        char command[sizeof(offload_dir) + 16];
+        snprintf(command, sizeof(command), "rm -rf %s", offload_dir);
+        if (system(command))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char * argv[])
+{
+    plan_tests(7);
+    main_tests();
+    return exit_status();
+}
@@ -0,0 +1,193 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * A test for the on-disk files of the delayed duplicate detection mode.
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <tap.h>
+
+#include "../dbm_ddd.h"
+
+static void make_record(fcs_ddd_record_t * const rec, const int key, const int parent)
+{
+    memset(rec, '\0', sizeof(*rec));
+    rec->key.s[0] = rec->parent.s[0] = sizeof(rec->key) - 1;
+    /* Big-endian so the sort order follows the integer order. */
+    rec->key.s[1] = (unsigned char)(key >> 8);
+    rec->key.s[2] = (unsigned char)(key & 0xFF);
+    rec->parent.s[1] = (unsigned char)(parent >> 8);
+    rec->parent.s[2] = (unsigned char)(parent & 0xFF);
+}
+
+static int record_int(const fcs_ddd_record_t * const rec)
+{
+    return ((((int)rec->key.s[1]) << 8) | rec->key.s[2]);
+}
+
+/* Returns TRUE if path contains exactly the keys low, low+step, ... < high. */
+static fcs_bool_t file_has_keys(const char * const path,
+    const int low, const int high, const int step)
+{
+    fcs_ddd_reader_t reader;
+    const fcs_ddd_record_t * rec;
+    int expected = low;
+    fcs_bool_t ret = TRUE;
+
+    fcs_ddd_reader__init(&reader, path, 0, -1);
+    while ((rec = fcs_ddd_reader__next(&reader)))
+    {
+        if (record_int(rec) != expected)
+        {
+            diag("Got %d instead of %d.\n", record_int(rec), expected);
+            ret = FALSE;
+            break;
+        }
+        expected += step;
+    }
+    fcs_ddd_reader__destroy(&reader);
+
+    return (ret && (expected >= high));
+}
+
+static int main_tests(void)
+{
+    char dir[] = "/tmp/fcs-dbm-ddd-test-XXXXXX";
+    char in0[100], in1[100], sorted[100], tmp[100], visited[100],
+         frontier[100], new_visited[100];
+
+    if (! mkdtemp(dir))
+    {
+        return 1;
+    }
+    sprintf(in0, "%s/in0", dir);
+    sprintf(in1, "%s/in1", dir);
+    sprintf(sorted, "%s/sorted", dir);
+    sprintf(tmp, "%s/tmp", dir);
+    sprintf(visited, "%s/visited", dir);
+    sprintf(frontier, "%s/frontier", dir);
+    sprintf(new_visited, "%s/visited.new", dir);
+
+    {
+        /* Every even key from 0 to 9998, several times and shuffled. */
+        FILE * const f0 = fcs_ddd__open(in0, "wb");
+        FILE * const f1 = fcs_ddd__open(in1, "wb");
+        srand(24);
+        for (int i = 0 ; i < 30000 ; i++)
+        {
+            fcs_ddd_record_t rec;
+            make_record(&rec, (rand() % 5000) * 2, i);
+            fcs_ddd__write((i & 1) ? f1 : f0, &rec, 1);
+        }
+        for (int i = 0 ; i < 5000 ; i++)
+        {
+            fcs_ddd_record_t rec;
+            make_record(&rec, i * 2, i);
+            fcs_ddd__write(f0, &rec, 1);
+        }
+        fclose(f0);
+        fclose(f1);
+    }
+
+    {
+        char * in_paths[3] = {in0, in1, "/non-existent/fcs-ddd"};
+        /* A run size that requires several merge passes. */
+        const off_t count = fcs_ddd__sort_unique(
+            in_paths, 3, sorted, tmp, 100, 3
+        );
+
+        /* TEST
+         * */
+        ok (count == 5000, "sort_unique returned the number of unique keys.");
+        /* TEST
+         * */
+        ok (file_has_keys(sorted, 0, 10000, 2),
+            "sort_unique produced sorted unique keys.");
+    }
+
+    {
+        FILE * const f = fcs_ddd__open(visited, "wb");
+        for (int i = 0 ; i < 10000 ; i += 4)
+        {
+            fcs_ddd_record_t rec;
+            make_record(&rec, i, 0);
+            fcs_ddd__write(f, &rec, 1);
+        }
+        fclose(f);
+    }
+
+    {
+        const off_t count = fcs_ddd__subtract_and_merge(
+            sorted, visited, frontier, new_visited
+        );
+        /* TEST
+         * */
+        ok (count == 2500, "subtract_and_merge returned the new count.");
+        /* TEST
+         * */
+        ok (file_has_keys(frontier, 2, 10000, 4),
+            "Only the unvisited keys are in the frontier.");
+        /* TEST
+         * */
+        ok (file_has_keys(new_visited, 0, 10000, 2),
+            "The visited file is the union of both.");
+    }
+
+    {
+        fcs_ddd_record_t key_rec, got;
+        make_record(&key_rec, 4242, 0);
+        /* TEST
+         * */
+        ok (fcs_ddd__lookup(new_visited, &(key_rec.key), &got)
+            && (record_int(&got) == 4242),
+            "lookup found an existing key.");
+
+        make_record(&key_rec, 4243, 0);
+        /* TEST
+         * */
+        ok (! fcs_ddd__lookup(new_visited, &(key_rec.key), &got),
+            "lookup did not find a missing key.");
+    }
+
+    unlink(in0);
+    unlink(in1);
+    unlink(sorted);
+    unlink(visited);
+    unlink(frontier);
+    unlink(new_visited);
+    rmdir(dir);
+
+    return 0;
+}
+
+int main(int argc, char * argv[])
+{
+    plan_tests(7);
+    main_tests();
+    return exit_status();
+}
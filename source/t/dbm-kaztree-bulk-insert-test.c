@@ -0,0 +1,121 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * A test for the bulk insertion of keys into the kaztree DBM store.
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <tap.h>
+
+#include "../dbm_kaztree.c"
+
+#define NUM_BATCHES 500
+
+static void make_key(fcs_encoded_state_buffer_t * const key, const long idx)
+{
+    memset(key, '\0', sizeof(*key));
+    key->s[0] = sizeof(*key) - 1;
+    memcpy(key->s + 1, &idx, sizeof(idx));
+}
+
+static long key_idx(const fcs_encoded_state_buffer_t * const key)
+{
+    long idx;
+    memcpy(&idx, key->s + 1, sizeof(idx));
+    return idx;
+}
+
+static int main_tests(void)
+{
+    void * bulk_recycle_bin = NULL, * single_recycle_bin = NULL;
+    fcs_dbm_store_t bulk_store, single_store;
+    fcs_encoded_state_buffer_t key_bufs[FCS_DBM_STORE_MAX_BULK_COUNT];
+    const fcs_encoded_state_buffer_t * keys[FCS_DBM_STORE_MAX_BULK_COUNT];
+    fcs_dbm_record_t * parents[FCS_DBM_STORE_MAX_BULK_COUNT];
+    fcs_dbm_record_t * results[FCS_DBM_STORE_MAX_BULK_COUNT];
+    fcs_bool_t same_results = TRUE, same_parents = TRUE;
+    unsigned long seed = 24;
+
+    fc_solve_dbm_store_init(&bulk_store, "", &bulk_recycle_bin);
+    fc_solve_dbm_store_init(&single_store, "", &single_recycle_bin);
+
+    make_key(&(key_bufs[0]), 0);
+    fcs_dbm_record_t * const root =
+        fc_solve_dbm_store_insert_key_value(bulk_store, &(key_bufs[0]), NULL, TRUE);
+    fc_solve_dbm_store_insert_key_value(single_store, &(key_bufs[0]), NULL, TRUE);
+
+    for (int batch = 0 ; batch < NUM_BATCHES ; batch++)
+    {
+        const int count = 1 + batch % FCS_DBM_STORE_MAX_BULK_COUNT;
+        /* Random keys from a small range, so many of them recur, within
+         * the batch and with the earlier batches. */
+        for (int i = 0 ; i < count ; i++)
+        {
+            seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+            make_key(&(key_bufs[i]), (long)((seed >> 33) % 5000));
+            keys[i] = &(key_bufs[i]);
+            parents[i] = ((i % 3) ? root : NULL);
+        }
+        fc_solve_dbm_store_insert_key_values(bulk_store, count, keys,
+            parents, results, TRUE);
+        for (int i = 0 ; i < count ; i++)
+        {
+            fcs_dbm_record_t * const single =
+                fc_solve_dbm_store_insert_key_value(single_store, keys[i],
+                    parents[i], TRUE);
+            same_results &= ((! results[i]) == (! single));
+            if (results[i])
+            {
+                same_results &= (key_idx(&(results[i]->key))
+                    == key_idx(keys[i]));
+                same_parents &= (fcs_dbm_record_get_parent_ptr(results[i])
+                    == parents[i]);
+            }
+        }
+    }
+
+    /* TEST */
+    ok (same_results, "The new keys are the same as when inserting one by one.");
+    /* TEST */
+    ok (same_parents, "The first occurrence of a key sets its parent.");
+    /* TEST */
+    ok (fc_solve_dbm_store_get_dict(bulk_store)->avl_count
+        == fc_solve_dbm_store_get_dict(single_store)->avl_count,
+        "The stores have the same number of keys.");
+
+    fc_solve_dbm_store_destroy(bulk_store);
+    fc_solve_dbm_store_destroy(single_store);
+
+    return 0;
+}
+
+int main(int argc, char * argv[])
+{
+    plan_tests(3);
+    main_tests();
+    return exit_status();
+}
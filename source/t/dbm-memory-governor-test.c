@@ -0,0 +1,96 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * A test for the memory governor of the DBM solvers.
+ */
+
+#include <tap.h>
+
+#include "../dbm_memory_governor.h"
+
+static void test_parse_size(void)
+{
+    /* TEST */
+    ok ((fcs_dbm_memory_governor__parse_size("4096") == 4096)
+        && (fcs_dbm_memory_governor__parse_size("3k") == 3 * 1024)
+        && (fcs_dbm_memory_governor__parse_size("512M") == 512LL << 20)
+        && (fcs_dbm_memory_governor__parse_size("3G") == 3LL << 30),
+        "The sizes are parsed with their suffixes.");
+
+    /* TEST */
+    ok ((fcs_dbm_memory_governor__parse_size("") < 0)
+        && (fcs_dbm_memory_governor__parse_size("0") < 0)
+        && (fcs_dbm_memory_governor__parse_size("-5M") < 0)
+        && (fcs_dbm_memory_governor__parse_size("5T") < 0)
+        && (fcs_dbm_memory_governor__parse_size("5MB") < 0),
+        "Invalid sizes are rejected.");
+}
+
+static void test_decide(void)
+{
+    fcs_dbm_memory_governor_t governor;
+
+    fcs_dbm_memory_governor__init(&governor, 1000);
+
+    /* TEST */
+    ok (fcs_dbm_memory_governor__decide(&governor, 500, TRUE)
+        == FCS_DBM_MEMORY_KEEP,
+        "Nothing is done when nothing was shrunk and within the budget.");
+
+    /* TEST */
+    ok ((fcs_dbm_memory_governor__decide(&governor, 1200, TRUE)
+        == FCS_DBM_MEMORY_SHRINK)
+        && (fcs_dbm_memory_governor__decide(&governor, 1100, TRUE)
+        == FCS_DBM_MEMORY_SHRINK),
+        "Shrinks when over the budget.");
+
+    /* TEST */
+    ok (fcs_dbm_memory_governor__decide(&governor, 900, TRUE)
+        == FCS_DBM_MEMORY_KEEP,
+        "Does not grow back while close to the budget.");
+
+    /* TEST */
+    ok ((fcs_dbm_memory_governor__decide(&governor, 600, TRUE)
+        == FCS_DBM_MEMORY_GROW)
+        && (fcs_dbm_memory_governor__decide(&governor, 600, TRUE)
+        == FCS_DBM_MEMORY_GROW)
+        && (fcs_dbm_memory_governor__decide(&governor, 600, TRUE)
+        == FCS_DBM_MEMORY_KEEP),
+        "Grows back only as many times as it had shrunk.");
+
+    /* TEST */
+    ok ((fcs_dbm_memory_governor__decide(&governor, 1200, FALSE)
+        == FCS_DBM_MEMORY_SHRINK)
+        && (fcs_dbm_memory_governor__decide(&governor, 100, FALSE)
+        == FCS_DBM_MEMORY_KEEP),
+        "Never grows after a shrink that could not be done.");
+}
+
+int main(int argc, char * argv[])
+{
+    plan_tests(7);
+    test_parse_size();
+    test_decide();
+    return exit_status();
+}
@@ -0,0 +1,118 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * A test for the JSON lines exporter of the DBM solvers' metrics.
+ */
+
+#include <string.h>
+#include <stdio.h>
+
+#include <tap.h>
+
+#include "../dbm_metrics.h"
+
+#define PATH "dbm-metrics-test.jsonl"
+
+static void read_line(char * const buffer, const size_t size)
+{
+    FILE * const fh = fopen(PATH, "r");
+    buffer[0] = '\0';
+    if (fh)
+    {
+        if (! fgets(buffer, size, fh))
+        {
+            buffer[0] = '\0';
+        }
+        fclose(fh);
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    fcs_dbm_metrics_t metrics;
+    fcs_dbm_metrics_sample_t sample;
+    const long depth_counts[3] = {1, 6, 21};
+    char line[2000];
+
+    plan_tests(6);
+
+    unlink(PATH);
+    fcs_dbm_metrics__init(&metrics);
+    /* TEST */
+    ok (! fcs_dbm_metrics__is_due(&metrics, FCS_DBM_METRICS_CHECK_EVERY),
+        "Nothing is due while the metrics are disabled.");
+
+    fcs_dbm_metrics__open(&metrics, PATH, 1000.0);
+    fcs_dbm_metrics__alloc_slots(&metrics, 2);
+    fcs_dbm_metrics__add_processed(&(metrics.slots[0]), 100);
+    fcs_dbm_metrics__add_processed(&(metrics.slots[1]), 50);
+    fcs_dbm_metrics__add_lock_wait(&(metrics.slots[1]), 0.25);
+    /* TEST */
+    ok (! fcs_dbm_metrics__is_due(&metrics, FCS_DBM_METRICS_CHECK_EVERY),
+        "Nothing is due before the interval is over.");
+
+    sample.num_processed = 150;
+    sample.num_states_in_collection = 400;
+    sample.num_items_in_queue = 250;
+    sample.num_items_in_memory = 200;
+    sample.num_cache_hits = sample.num_cache_misses = -1;
+    sample.depth = 2;
+    sample.num_depths = 3;
+    sample.depth_counts = depth_counts;
+    fcs_dbm_metrics__export(&metrics, &sample);
+
+    read_line(line, sizeof(line));
+    /* TEST */
+    ok (strstr(line, "\"processed\":150,")
+        && strstr(line, "\"states_in_collection\":400,")
+        && strstr(line, "\"queue_items\":250,\"queue_items_in_memory\":200,"
+            "\"queue_items_offloaded\":50"),
+        "The gauges are exported.");
+    /* TEST */
+    ok (strstr(line, "\"depth\":2,\"depth_counts\":[1,6,21]")
+        && (! strstr(line, "cache")),
+        "The depths are exported and the missing cache is not.");
+    /* TEST */
+    ok (strstr(line, "\"threads\":[100,50],\"lock_wait_sec\":0.250000}\n"),
+        "The per-thread slots are summed up.");
+
+    sample.num_processed = 300;
+    sample.num_cache_hits = 30;
+    sample.num_cache_misses = 10;
+    fcs_dbm_metrics__export(&metrics, &sample);
+    fcs_dbm_metrics__destroy(&metrics);
+    {
+        FILE * const fh = fopen(PATH, "r");
+        fgets(line, sizeof(line), fh);
+        fgets(line, sizeof(line), fh);
+        fclose(fh);
+    }
+    /* TEST */
+    ok (strstr(line, "\"cache_hits\":30,\"cache_misses\":10,"
+        "\"cache_hit_rate\":0.7500"),
+        "The cache hit rate is exported.");
+
+    unlink(PATH);
+    return exit_status();
+}
@@ -0,0 +1,165 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * A test for the memory-mapped hash DBM store.
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <tap.h>
+
+#include "../dbm_mmap_hash.c"
+
+#define NUM_KEYS 200000
+
+static void make_key(fcs_encoded_state_buffer_t * const key, const long idx)
+{
+    memset(key, '\0', sizeof(*key));
+    key->s[0] = sizeof(*key) - 1;
+    memcpy(key->s + 1, &idx, sizeof(idx));
+}
+
+static int compare_kvs(const void * a, const void * b, void * context)
+{
+    return memcmp(&(((const fcs_pre_cache_key_val_pair_t *)a)->key),
+        &(((const fcs_pre_cache_key_val_pair_t *)b)->key),
+        sizeof(fcs_encoded_state_buffer_t));
+}
+
+/* Offloads the keys [start, end) with key idx having the parent idx+1. */
+static void offload_range(fcs_dbm_store_t store, const long start, const long end)
+{
+    fcs_meta_compact_allocator_t meta_alloc;
+    void * recycle_bin = NULL;
+    fcs_pre_cache_t pre_cache;
+    fcs_pre_cache_key_val_pair_t * const kvs = SMALLOC(kvs, end - start);
+
+    fc_solve_meta_compact_allocator_init(&meta_alloc);
+    pre_cache.kaz_tree = avl_create(compare_kvs, NULL, &meta_alloc, &recycle_bin);
+    pre_cache.count_elements = 0;
+    for (long i = start ; i < end ; i++)
+    {
+        fcs_pre_cache_key_val_pair_t * const kv = &(kvs[i - start]);
+        make_key(&(kv->key), i);
+        make_key(&(kv->parent), i + 1);
+        avl_insert(pre_cache.kaz_tree, kv);
+        pre_cache.count_elements++;
+    }
+    fc_solve_dbm_store_offload_pre_cache(store, &pre_cache);
+
+    avl_destroy(pre_cache.kaz_tree, NULL);
+    fc_solve_meta_compact_allocator_finish(&meta_alloc);
+    free(kvs);
+}
+
+static fcs_bool_t check_range(fcs_dbm_store_t store, const long start,
+    const long end)
+{
+    for (long i = start ; i < end ; i++)
+    {
+        fcs_encoded_state_buffer_t key, parent, expected_parent;
+        make_key(&key, i);
+        make_key(&expected_parent, i + 1);
+        if (! (fc_solve_dbm_store_does_key_exist(store, key.s)
+            && fc_solve_dbm_store_lookup_parent(store, key.s, parent.s)
+            && (! memcmp(&parent, &expected_parent, sizeof(parent)))))
+        {
+            diag("Key %ld is wrong.\n", i);
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+static int main_tests(void)
+{
+    char path[] = "/tmp/fcs-dbm-mmap-hash-test-XXXXXX";
+    fcs_dbm_store_t store;
+    fcs_encoded_state_buffer_t key, parent;
+
+    close(mkstemp(path));
+    unlink(path);
+
+    fc_solve_dbm_store_init(&store, path, NULL);
+    /* Several batches that grow the table a few times. */
+    offload_range(store, 0, NUM_KEYS / 2);
+    offload_range(store, NUM_KEYS / 4, NUM_KEYS);
+
+    /* TEST
+     * */
+    ok (check_range(store, 0, NUM_KEYS), "All keys were found.");
+
+    /* TEST
+     * */
+    ok (((dbm_t *)store)->header->count == NUM_KEYS,
+        "The count is right and duplicates were not inserted twice.");
+
+    make_key(&key, NUM_KEYS);
+    /* TEST
+     * */
+    ok ((! fc_solve_dbm_store_does_key_exist(store, key.s))
+        && (! fc_solve_dbm_store_lookup_parent(store, key.s, parent.s)),
+        "A missing key was not found.");
+
+    fc_solve_dbm_store_destroy(store);
+
+    fc_solve_dbm_store_init(&store, path, NULL);
+    /* TEST
+     * */
+    ok (check_range(store, 0, NUM_KEYS), "The keys persisted.");
+
+    {
+        /* Simulate a crash that tore one of the slots. */
+        dbm_t * const db = (dbm_t *)store;
+        uint64_t i;
+        for (i = 0 ; ! db->slots[i].check ; i++)
+        {
+        }
+        db->slots[i].parent.s[1] ^= 0x1;
+        mmap_hash_sync(db);
+        mmap_hash_unmap(db);
+        free(db->path);
+        free(db);
+    }
+
+    fc_solve_dbm_store_init(&store, path, NULL);
+    /* TEST
+     * */
+    ok (((dbm_t *)store)->header->count == NUM_KEYS - 1,
+        "The torn slot was dropped when recovering.");
+    fc_solve_dbm_store_destroy(store);
+
+    unlink(path);
+
+    return 0;
+}
+
+int main(int argc, char * argv[])
+{
+    plan_tests(5);
+    main_tests();
+    return exit_status();
+}
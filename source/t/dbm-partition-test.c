@@ -0,0 +1,204 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * A test for the building blocks of the partitioned DBM solver.
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <sys/socket.h>
+
+#include <tap.h>
+
+#include "../dbm_partition.h"
+
+#define NUM_KEYS 100000
+#define NUM_MSGS 2000
+
+static void make_key(fcs_encoded_state_buffer_t * const key, const long idx)
+{
+    memset(key, '\0', sizeof(*key));
+    key->s[0] = sizeof(*key) - 1;
+    memcpy(key->s + 1, &idx, sizeof(idx));
+}
+
+static void test_store(void)
+{
+    fcs_dbm_partition_store_t store;
+    fcs_dbm_partition_record_t rec;
+    fcs_dbm_partition_record_t * first = NULL;
+    fcs_bool_t all_ok = TRUE;
+
+    fcs_dbm_partition_store__init(&store);
+    for (long i = 0 ; i < NUM_KEYS ; i++)
+    {
+        make_key(&(rec.key), i);
+        make_key(&(rec.parent), i + 1);
+        fcs_dbm_partition_record_t * const got =
+            fcs_dbm_partition_store__insert(&store, &rec);
+        all_ok &= (got != NULL);
+        if (i == 0)
+        {
+            first = got;
+        }
+    }
+    /* TEST */
+    ok (all_ok && (store.count == NUM_KEYS), "All the new keys were inserted.");
+
+    make_key(&(rec.key), 17);
+    /* TEST */
+    ok (! fcs_dbm_partition_store__insert(&store, &rec),
+        "An existing key is not inserted again.");
+
+    all_ok = TRUE;
+    for (long i = 0 ; i < NUM_KEYS ; i++)
+    {
+        fcs_encoded_state_buffer_t key, parent;
+        make_key(&key, i);
+        make_key(&parent, i + 1);
+        const fcs_dbm_partition_record_t * const got =
+            fcs_dbm_partition_store__lookup(&store, &key);
+        all_ok &= (got && (! memcmp(&(got->parent), &parent, sizeof(parent))));
+    }
+    /* TEST */
+    ok (all_ok, "The parents are found after the table has grown.");
+
+    make_key(&(rec.key), 0);
+    /* TEST */
+    ok (fcs_dbm_partition_store__lookup(&store, &(rec.key)) == first,
+        "The records do not move when the table grows.");
+
+    make_key(&(rec.key), NUM_KEYS);
+    /* TEST */
+    ok (! fcs_dbm_partition_store__lookup(&store, &(rec.key)),
+        "A missing key is not found.");
+
+    fcs_dbm_partition_store__destroy(&store);
+}
+
+static void test_partitioning(void)
+{
+    int counts[4] = {0, 0, 0, 0};
+    fcs_encoded_state_buffer_t key;
+
+    for (long i = 0 ; i < NUM_KEYS ; i++)
+    {
+        make_key(&key, i);
+        counts[fcs_dbm_partition__calc_owner(&key, 4)]++;
+    }
+    fcs_bool_t is_balanced = TRUE;
+    for (int i = 0 ; i < 4 ; i++)
+    {
+        is_balanced &= ((counts[i] > NUM_KEYS / 4 * 9 / 10)
+            && (counts[i] < NUM_KEYS / 4 * 11 / 10));
+    }
+    /* TEST */
+    ok (is_balanced, "The keys are spread evenly among the partitions.");
+
+    fcs_init_encoded_state(&key);
+    /* TEST */
+    ok (fcs_dbm_partition__is_null_key(&key), "The null key is recognised.");
+}
+
+/* Sends many messages over a socket pair without a reader, so the
+ * output is buffered and delivered in pieces. */
+static void test_channel(void)
+{
+    int fds[2];
+    fcs_dbm_partition_channel_t a, b;
+    fcs_dbm_partition_record_t recs[64];
+    fcs_dbm_partition_msg_header_t header;
+    const fcs_dbm_partition_record_t * got;
+    size_t num_got;
+    int num_msgs = 0;
+    fcs_bool_t all_ok = TRUE;
+
+    socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    fcs_dbm_partition_channel__init(&a, fds[0]);
+    fcs_dbm_partition_channel__init(&b, fds[1]);
+
+    for (int m = 0 ; m < NUM_MSGS ; m++)
+    {
+        const int num_recs = m % 64;
+        for (int i = 0 ; i < num_recs ; i++)
+        {
+            make_key(&(recs[i].key), m * 64 + i);
+            make_key(&(recs[i].parent), m);
+        }
+        fcs_dbm_partition_channel__send(&a, FCS_DBM_PARTITION_MSG_STATES,
+            m % 3, num_recs, 0, recs, num_recs);
+        fcs_dbm_partition_channel__write(&a);
+    }
+    fcs_dbm_partition_channel__send(&a, FCS_DBM_PARTITION_MSG_IDLE, 1,
+        NUM_MSGS, 12345, NULL, 0);
+    /* TEST */
+    ok (fcs_dbm_partition_channel__has_output(&a),
+        "The output that did not fit in the socket is buffered.");
+
+    while (num_msgs <= NUM_MSGS)
+    {
+        fcs_dbm_partition_channel__write(&a);
+        fcs_dbm_partition_channel__read(&b);
+        while (fcs_dbm_partition_channel__next(&b, &header, &got, &num_got))
+        {
+            if (num_msgs < NUM_MSGS)
+            {
+                all_ok &= ((header.type == FCS_DBM_PARTITION_MSG_STATES)
+                    && (header.partition == num_msgs % 3)
+                    && (num_got == (size_t)(num_msgs % 64)));
+                for (size_t i = 0 ; all_ok && (i < num_got) ; i++)
+                {
+                    fcs_encoded_state_buffer_t key;
+                    make_key(&key, num_msgs * 64 + (long)i);
+                    all_ok &= (! memcmp(&key, &(got[i].key), sizeof(key)));
+                }
+            }
+            else
+            {
+                all_ok &= ((header.type == FCS_DBM_PARTITION_MSG_IDLE)
+                    && (header.count == NUM_MSGS)
+                    && (header.num_processed == 12345) && (num_got == 0));
+            }
+            num_msgs++;
+        }
+    }
+    /* TEST */
+    ok (all_ok && (num_msgs == NUM_MSGS + 1),
+        "All the messages arrived intact and in order.");
+
+    fcs_dbm_partition_channel__destroy(&a);
+    fcs_dbm_partition_channel__read(&b);
+    /* TEST */
+    ok (b.is_eof, "The end of the channel is detected.");
+    fcs_dbm_partition_channel__destroy(&b);
+}
+
+int main(int argc, char * argv[])
+{
+    plan_tests(10);
+    test_store();
+    test_partitioning();
+    test_channel();
+    return exit_status();
+}
@@ -0,0 +1,44 @@
+#!/usr/bin/perl
+
+use strict;
+use warnings;
+
+use Test::More;
+use File::Spec;
+use File::Temp qw(tempdir);
+
+# Tests that a dbm_fc_solver that was built with caches shrinks them when
+# it is over --memory-budget, before it stops.
+
+my $path = File::Spec->catdir(File::Spec->curdir(), 't', 't', 'data');
+my $tempdir = tempdir(CLEANUP => 1);
+my $store_path = File::Spec->catfile($tempdir, 'store');
+
+# No process fits in a budget of 1MB.
+my $got_text = `./dbm_fc_solver --dbm-store-path $store_path --pre-cache-max-count 4000 --caches-delta 4000 --num-threads 1 --memory-budget 1M @{[File::Spec->catfile($path, 'sample-boards', '24-mid40.board')]} 2>&1`;
+
+if ($got_text !~ m{^>>>Store Stats:}ms)
+{
+    plan skip_all => 'dbm_fc_solver was built without caches.';
+}
+if ($got_text =~ m{Cannot measure the memory usage})
+{
+    plan skip_all => 'The memory usage cannot be measured here.';
+}
+
+plan tests => 3;
+
+# TEST
+like ($got_text,
+    qr/^>>>Memory: usage=\d+ budget=1048576 ; Shrinking the caches to pre-cache=2000 cache=4000$/ms,
+    "The caches were halved first.");
+
+# TEST
+like ($got_text,
+    qr/^>>>Memory: usage=\d+ budget=1048576 ; Shrinking the caches to pre-cache=1000 cache=2000$/ms,
+    "The caches were halved down to the minimal pre-cache.");
+
+# TEST
+like ($got_text,
+    qr/^>>>Memory: usage=\d+ budget=1048576 ; Nothing left to shrink - stopping\.$/ms,
+    "The solver stopped once there was nothing left to shrink.");
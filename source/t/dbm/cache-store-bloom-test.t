@@ -0,0 +1,74 @@
+#!/usr/bin/perl
+
+use strict;
+use warnings;
+
+use Test::More;
+use File::Spec;
+use File::Temp qw(tempdir);
+
+# Tests the Bloom filter in front of the store of a dbm_fc_solver that was
+# built with caches (e.g: -DFCS_DBM_BACKEND=mmap_hash).
+
+my $path = File::Spec->catdir(File::Spec->curdir(), 't', 't', 'data');
+my $board = File::Spec->catfile($path, 'sample-boards', '24-mid40.board');
+
+sub _run
+{
+    my ($bloom_args) = @_;
+
+    my $tempdir = tempdir(CLEANUP => 1);
+    my $store_path = File::Spec->catfile($tempdir, 'store');
+
+    # A small pre-cache, so most of the states are looked up in the store.
+    my $text = `./dbm_fc_solver --dbm-store-path $store_path --pre-cache-max-count 1000 --caches-delta 1000 --num-threads 1 $bloom_args $board`;
+
+    my %ret = (text => $text);
+    if ($text =~ m{^>>>Store Stats: lookups=(\d+)$}ms)
+    {
+        $ret{lookups} = $1;
+    }
+    if ($text =~ m{^>>>Bloom Stats: .*? skipped=(\d+)$}ms)
+    {
+        $ret{skipped} = $1;
+    }
+
+    return \%ret;
+}
+
+sub _solution
+{
+    my $text = shift;
+
+    $text =~ s{\A.*?^Success!\n}{}ms;
+
+    return $text;
+}
+
+my $without = _run('');
+
+if (!defined($without->{lookups}))
+{
+    plan skip_all => 'dbm_fc_solver was built without caches.';
+}
+
+plan tests => 5;
+
+my $with = _run('--bloom-expected-states 100000');
+
+# TEST
+like ($without->{text}, qr/^Success!$/ms, "Solved without the filter.");
+
+# TEST
+like ($with->{text}, qr/^Success!$/ms, "Solved with the filter.");
+
+# TEST
+ok (($with->{skipped} || 0) > 0, "Negative probes were answered by the filter.");
+
+# TEST
+is ($with->{lookups} + $with->{skipped}, $without->{lookups},
+    "The skipped probes did not reach the store.");
+
+# TEST
+is (_solution($with->{text}), _solution($without->{text}),
+    "The filter does not change the solution.");
@@ -0,0 +1,50 @@
+#!/usr/bin/perl
+
+use strict;
+use warnings;
+
+use Test::More;
+use File::Spec;
+use File::Temp qw(tempdir);
+
+# Solves a board with a dbm_fc_solver that was built with caches (e.g:
+# -DFCS_DBM_BACKEND=mmap_hash), and a pre-cache that is small enough for
+# most of the states to be offloaded to the store.
+
+sub _slurp
+{
+    my $filename = shift;
+
+    open my $in, '<', $filename
+        or die "Cannot open '$filename' for slurping - $!";
+
+    local $/;
+    my $contents = <$in>;
+
+    close($in);
+
+    return $contents;
+}
+
+my $path = File::Spec->catdir(File::Spec->curdir(), 't', 't', 'data');
+my $tempdir = tempdir(CLEANUP => 1);
+my $store_path = File::Spec->catfile($tempdir, 'store');
+
+my $got_text = `./dbm_fc_solver --dbm-store-path $store_path --pre-cache-max-count 1000 --caches-delta 1000 --num-threads 1 @{[File::Spec->catfile($path, 'sample-boards', '24-mid40.board')]}`;
+
+if ($got_text !~ m{^>>>Store Stats:}ms)
+{
+    plan skip_all => 'dbm_fc_solver was built without caches.';
+}
+
+plan tests => 1;
+
+my $expected_text = _slurp(File::Spec->catfile($path, 'sample-solutions', 'dbm-24-mid40-with-caches.sol'));
+
+foreach my $text ($got_text, $expected_text)
+{
+    $text =~ s/Time: \d+(?:\.\d+)?/Time: 24/g;
+}
+
+# TEST
+is ($got_text, $expected_text, "Texts are the same");
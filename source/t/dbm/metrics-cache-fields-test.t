@@ -0,0 +1,54 @@
+#!/usr/bin/perl
+
+use strict;
+use warnings;
+
+use Test::More tests => 2;
+use File::Spec;
+use File::Temp qw(tempdir);
+
+# Tests that the cache fields of the --metrics-output lines of
+# dbm_fc_solver are filled in when it was built with caches, and omitted
+# otherwise.
+
+sub _slurp
+{
+    my $filename = shift;
+
+    open my $in, '<', $filename
+        or die "Cannot open '$filename' for slurping - $!";
+
+    local $/;
+    my $contents = <$in>;
+
+    close($in);
+
+    return $contents;
+}
+
+my $path = File::Spec->catdir(File::Spec->curdir(), 't', 't', 'data');
+my $tempdir = tempdir(CLEANUP => 1);
+my $store_path = File::Spec->catfile($tempdir, 'store');
+my $metrics_path = File::Spec->catfile($tempdir, 'metrics.json');
+
+my $got_text = `./dbm_fc_solver --dbm-store-path $store_path --offload-dir-path $tempdir --pre-cache-max-count 1000 --caches-delta 1000 --num-threads 1 --metrics-output $metrics_path @{[File::Spec->catfile($path, 'sample-boards', '24-mid40.board')]}`;
+
+my @lines = split /\n/, _slurp($metrics_path);
+my $last_line = $lines[-1];
+
+# TEST
+like ($last_line, qr/"processed":36543,/, "The final line was exported.");
+
+if ($got_text =~ m{^>>>Store Stats:}ms)
+{
+    # TEST
+    like ($last_line,
+        qr/"cache_hits":[1-9]\d*,"cache_misses":[1-9]\d*,"cache_hit_rate":0\.\d+,/,
+        "The cache fields are filled in with caches.");
+}
+else
+{
+    # TEST
+    unlike ($last_line, qr/"cache_/,
+        "The cache fields are omitted without caches.");
+}
@@ -51,6 +51,9 @@ static int test_encode_and_decode(fc_solve_delta_stater_t * delta, fcs_state_key
     char * as_str;
     DECLARE_IND_BUF_T(new_derived_indirect_stacks_buffer)
     fcs_state_locs_struct_t locs;
+    enum fcs_dbm_variant_type_t local_variant;
+
+    local_variant = FCS_DBM_VARIANT_2FC_FREECELL;
 
     fc_solve_init_locs(&locs);
 
@@ -94,6 +97,10 @@ static int test_encode_and_decode(fc_solve_delta_stater_t * delta, fcs_state_key
 
 int main_tests()
 {
+    enum fcs_dbm_variant_type_t local_variant;
+
+    local_variant = FCS_DBM_VARIANT_2FC_FREECELL;
+
     {
         fcs_state_keyval_pair_t s;
         fc_solve_delta_stater_t delta;
@@ -104,6 +111,7 @@ int main_tests()
 #ifndef FCS_FREECELL_ONLY
         delta.sequences_are_built_by = FCS_SEQ_BUILT_BY_ALTERNATE_COLOR;
 #endif
+        fc_solve_delta_stater__init_parent_cards_masks(&delta);
         fc_solve_state_init(&s, STACKS_NUM, indirect_stacks_buffer);
 
         col = fcs_state_get_col(s.s, 0);
@@ -212,7 +220,7 @@ int main_tests()
 
             /* TEST
              * */
-            ok (enc.enc[0] ==
+            ok (enc.enc ==
                     (6  /* 3 bits of orig len. */
                      | (0 << 3) /*  4 bits of derived len. */
                     )
@@ -221,11 +229,11 @@ int main_tests()
 
             /* TEST
              */
-            ok (enc.end == enc.enc, "Only 7 bits.");
+            ok (enc.num_bits / 8 == 0, "Only 7 bits.");
 
             /* TEST
              * */
-            ok (enc.bit_in_char_idx == 7, "Only 7 bits (2).");
+            ok (enc.num_bits % 8 == 7, "Only 7 bits (2).");
         }
 
 #define SUIT_HC 0
@@ -237,7 +245,7 @@ int main_tests()
 
             /* TEST
              * */
-            ok (enc.enc[0] ==
+            ok (enc.enc ==
                     (3  /* 3 bits of orig len. */
                      | (1 << 3) /*  4 bits of derived len. */
                      | (SUIT_DS << (3+4)) /* 1 bit of suit. */
@@ -247,11 +255,11 @@ int main_tests()
 
             /* TEST
              */
-            ok (enc.end == enc.enc+1, "8 bits.");
+            ok (enc.num_bits / 8 == 1, "8 bits.");
 
             /* TEST
              * */
-            ok (enc.bit_in_char_idx == 0, "8 bits (2).");
+            ok (enc.num_bits % 8 == 0, "8 bits (2).");
         }
 
         {
@@ -263,7 +271,7 @@ int main_tests()
             card_9S = make_card(9, 3);
             /* TEST
              * */
-            ok (enc.enc[0] ==
+            ok ((enc.enc & 0xFF) ==
                     (0  /* 3 bits of orig len. */
                      | (1 << 3) /*  4 bits of derived len. */
                      | ((card_9S&0x1) << (3+4)) /* 1 bit of init_card. */
@@ -273,7 +281,7 @@ int main_tests()
 
             /* TEST
              * */
-            ok ((enc.enc[1] ==
+            ok (((enc.enc >> 8) ==
                     (card_9S >> 1) /* Remaining 5 bits of card. */
                 )
                 , "fc_solve_get_column_encoding_composite() col 5 - byte 1"
@@ -281,11 +289,11 @@ int main_tests()
 
             /* TEST
              */
-            ok (enc.end == enc.enc+1, "3+4+7 bits.");
+            ok (enc.num_bits / 8 == 1, "3+4+7 bits.");
 
             /* TEST
              * */
-            ok (enc.bit_in_char_idx == (3+4+6-8), "3+4+7 bits (2).");
+            ok (enc.num_bits % 8 == (3+4+6-8), "3+4+7 bits (2).");
         }
 
         {
@@ -466,6 +474,7 @@ int main_tests()
         char * s;
 
         s = fc_solve_user_INTERNAL_delta_states_enc_and_dec(
+                local_variant,
                 (
                  "Foundations: H-0 C-0 D-0 S-0 \n"
                  "Freecells:        \n"
@@ -575,6 +584,7 @@ int main_tests()
 
         fcs_init_and_encode_state(
             delta,
+            local_variant,
             &derived_state,
             &first_enc_state
             );
@@ -602,6 +612,7 @@ int main_tests()
 
         fcs_init_and_encode_state(
             delta,
+            local_variant,
             &derived_state,
             &second_enc_state
             );
@@ -676,6 +687,7 @@ int main_tests()
         fcs_encoded_state_buffer_t first_enc_state;
         fcs_init_and_encode_state(
             delta,
+            local_variant,
             &derived_state,
             &first_enc_state
             );
@@ -702,6 +714,7 @@ int main_tests()
         fcs_encoded_state_buffer_t second_enc_state;
         fcs_init_and_encode_state(
             delta,
+            local_variant,
             &derived_state,
             &second_enc_state
             );
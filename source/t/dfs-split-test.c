@@ -0,0 +1,75 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * A test for the subtrees' claims table of the parallel Soft-DFS.
+ */
+
+#include <stdio.h>
+
+#include <tap.h>
+
+#include "../dfs_split.h"
+
+#define NUM_SLOTS 64
+
+int main(int argc, char * argv[])
+{
+    fcs_dfs_split_t split;
+    fcs_bool_t all_ok = TRUE;
+
+    plan_tests(5);
+    fc_solve_dfs_split_init(&split, 2, NUM_SLOTS - 10);
+
+    /* Keys that share the same first slot. */
+    for (fcs_dfs_split_key_t key = 1 ; key <= NUM_SLOTS ; key++)
+    {
+        all_ok &= fc_solve_dfs_split_claim(&split, key * NUM_SLOTS);
+    }
+    /* TEST */
+    ok (all_ok, "The first worker to reach a subtree claims it.");
+
+    all_ok = TRUE;
+    for (fcs_dfs_split_key_t key = 1 ; key <= NUM_SLOTS ; key++)
+    {
+        all_ok &= (! fc_solve_dfs_split_claim(&split, key * NUM_SLOTS));
+    }
+    /* TEST */
+    ok (all_ok, "A claimed subtree is skipped by the other workers.");
+
+    /* TEST */
+    ok (fc_solve_dfs_split_claim(&split, 1)
+        && fc_solve_dfs_split_claim(&split, 1),
+        "Subtrees are explored by everyone once the table is full.");
+
+    /* TEST */
+    ok (! fc_solve_dfs_split_is_solved(&split), "The board is not solved yet.");
+
+    fc_solve_dfs_split_mark_as_solved(&split);
+    /* TEST */
+    ok (fc_solve_dfs_split_is_solved(&split), "The board was solved.");
+
+    fc_solve_dfs_split_free(&split);
+
+    return exit_status();
+}
@@ -0,0 +1,182 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * A test for the endgame database.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <tap.h>
+
+#include "../endgame_db.h"
+#include "../indirect_buffer.h"
+
+static void gen_db(fcs_endgame_db_t * const db, const int freecells_num)
+{
+    const fcs_endgame_db_params_t params =
+    {
+        .max_cards = 4,
+        .freecells_num = freecells_num,
+        .stacks_num = 1,
+        .sequences_are_built_by = FCS_SEQ_BUILT_BY_ALTERNATE_COLOR,
+        .empty_stacks_fill = FCS_ES_FILLED_BY_ANY_CARD,
+    };
+    fc_solve_endgame_db__init(db, &params);
+    fc_solve_endgame_db__generate(db);
+}
+
+/* Whether the Queen and the King of the first suit are solvable in a
+ * single column. */
+static fcs_bool_t is_qk_solvable(
+    const fcs_endgame_db_t * const db,
+    const fcs_bool_t is_king_on_top
+)
+{
+    const int counts[FCS_ENDGAME_DB_NUM_SUITS] = {2, 0, 0, 0};
+    /* Card 0 is the Queen and card 1 is the King. */
+    int beneath[2];
+    if (is_king_on_top)
+    {
+        beneath[0] = FCS_ENDGAME_DB_BOTTOM;
+        beneath[1] = 0;
+    }
+    else
+    {
+        beneath[0] = 1;
+        beneath[1] = FCS_ENDGAME_DB_BOTTOM;
+    }
+    return fc_solve_endgame_db__get_bit(db,
+        db->offsets[fc_solve_endgame_db__calc_composition_idx(4, counts)]
+        + fc_solve_endgame_db__rank(2, beneath));
+}
+
+static void test_rank(void)
+{
+    fcs_bool_t all_ok = TRUE;
+    int beneath[FCS_ENDGAME_DB_MAX_CARDS];
+    const unsigned long long num_entries =
+        fc_solve_endgame_db__calc_num_entries(5);
+
+    for (unsigned long long idx = 0 ; idx < num_entries ; idx++)
+    {
+        fc_solve_endgame_db__unrank(5, idx, beneath);
+        for (int i = 0 ; i < 5 ; i++)
+        {
+            all_ok &= (beneath[i] != i);
+        }
+        all_ok &= (fc_solve_endgame_db__rank(5, beneath) == idx);
+    }
+    /* TEST */
+    ok (all_ok, "rank() is the inverse of unrank() and no card is beneath itself.");
+}
+
+static void test_compositions(void)
+{
+    int counts[FCS_ENDGAME_DB_NUM_SUITS];
+    int num_compositions = 0;
+
+    fc_solve_endgame_db__first_composition(counts, 3);
+    do
+    {
+        num_compositions++;
+    } while (fc_solve_endgame_db__next_composition(counts));
+    /* TEST */
+    ok (num_compositions == 20, "There are 20 ways to split 3 cards among 4 suits.");
+}
+
+static void test_generate(void)
+{
+    fcs_endgame_db_t db, db_fc;
+
+    gen_db(&db, 0);
+    /* TEST */
+    ok (fc_solve_endgame_db__get_bit(&db, 0), "The empty position is solvable.");
+    /* TEST */
+    ok (is_qk_solvable(&db, FALSE), "The Queen on top of the King is solvable.");
+    /* TEST */
+    ok (! is_qk_solvable(&db, TRUE),
+        "The King on top of the Queen is a dead end without a freecell."
+    );
+
+    gen_db(&db_fc, 1);
+    /* TEST */
+    ok (is_qk_solvable(&db_fc, TRUE),
+        "The King on top of the Queen is solvable with a freecell."
+    );
+
+    char filename[] = "/tmp/fcs-endgame-db-test-XXXXXX";
+    const int fd = mkstemp(filename);
+    close(fd);
+    fcs_endgame_db_t loaded;
+    /* TEST */
+    ok ((fc_solve_endgame_db__write(&db, filename)
+        && (! fc_solve_endgame_db__load(&loaded, filename))
+        && (loaded.params.freecells_num == 0)
+        && (loaded.num_bits == db.num_bits)
+        && (! memcmp(loaded.bits, db.bits,
+            fc_solve_endgame_db__calc_bits_len(&db)))),
+        "The database is the same after it is written and loaded."
+    );
+
+    {
+        fcs_state_keyval_pair_t s;
+        DECLARE_IND_BUF_T(indirect_stacks_buffer)
+        fc_solve_state_init(&s, 1, indirect_stacks_buffer);
+        fcs_set_foundation(s.s, 0, 11);
+        for (int f = 1 ; f < FCS_ENDGAME_DB_NUM_SUITS ; f++)
+        {
+            fcs_set_foundation(s.s, f, 13);
+        }
+        fcs_cards_column_t col = fcs_state_get_col(s.s, 0);
+        fcs_col_push_card(col, fcs_make_card(12, 0));
+        fcs_col_push_card(col, fcs_make_card(13, 0));
+        /* TEST */
+        ok (fc_solve_endgame_db__lookup_state(&loaded, &(s.s), 0, 1)
+            == FCS_ENDGAME_DB_UNSOLVABLE,
+            "A state with the King on top of the Queen is looked up as a dead end."
+        );
+
+        fcs_set_foundation(s.s, 1, 8);
+        /* TEST */
+        ok (fc_solve_endgame_db__lookup_state(&loaded, &(s.s), 0, 1)
+            == FCS_ENDGAME_DB_NOT_COVERED,
+            "A state with too many cards is not covered."
+        );
+    }
+
+    fc_solve_endgame_db__free(&loaded);
+    unlink(filename);
+    fc_solve_endgame_db__free(&db);
+    fc_solve_endgame_db__free(&db_fc);
+}
+
+int main(int argc, char * argv[])
+{
+    plan_tests(9);
+    test_rank();
+    test_compositions();
+    test_generate();
+    return exit_status();
+}
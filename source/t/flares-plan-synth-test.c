@@ -0,0 +1,131 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * A test for the synthesis of the flares plans.
+ */
+
+#include <stdio.h>
+
+#include <tap.h>
+
+#include "../flares_plan_synth.h"
+
+#define NUM_BOARDS 10
+
+static long iters[2 * NUM_BOARDS];
+static const fcs_flares_plan_synth_table_t table =
+    {.num_flares = 2, .num_boards = NUM_BOARDS, .iters = iters};
+
+static void set_iters(const int flare, const int start, const int end, const long val)
+{
+    for (int b = start ; b < end ; b++)
+    {
+        FCS_FLARES_PLAN_SYNTH_ITERS(&table, flare, b) = val;
+    }
+}
+
+static void test_complementary_flares(void)
+{
+    fcs_flares_plan_synth_plan_t plan;
+    long board_iters[NUM_BOARDS];
+
+    set_iters(0, 0, 5, 100);
+    set_iters(0, 5, NUM_BOARDS, -1);
+    set_iters(1, 0, 5, -1);
+    set_iters(1, 5, NUM_BOARDS, 100);
+    fc_solve_flares_plan_synth(&table, 100, 0, &plan);
+    /* TEST */
+    ok ((plan.num_items == 2)
+        && (plan.items[0].quota == 100) && (plan.items[1].quota == 100)
+        && (plan.items[0].flare != plan.items[1].flare),
+        "Each flare runs for as long as it needs for its boards.");
+    /* TEST */
+    ok ((fc_solve_flares_plan_synth__eval(&table, &plan, board_iters) == 1500)
+        && (board_iters[plan.items[0].flare ? 5 : 0] == 100)
+        && (board_iters[plan.items[0].flare ? 0 : 5] == 200),
+        "The iterations of the boards are counted along the plan.");
+    free(plan.items);
+
+    set_iters(1, 5, 6, -1);
+    fc_solve_flares_plan_synth(&table, 100, 0, &plan);
+    /* TEST */
+    ok ((plan.num_items == 2)
+        && (fc_solve_flares_plan_synth__eval(&table, &plan, board_iters) == 1300)
+        && (board_iters[5] == -1),
+        "The boards that no flare solves are left unsolved.");
+    free(plan.items);
+}
+
+static void test_single_flare(void)
+{
+    fcs_flares_plan_synth_plan_t plan;
+
+    for (int b = 0 ; b < NUM_BOARDS ; b++)
+    {
+        FCS_FLARES_PLAN_SYNTH_ITERS(&table, 0, b) = 100 * (b + 1) - 50;
+    }
+    set_iters(1, 0, NUM_BOARDS, -1);
+    fc_solve_flares_plan_synth(&table, 100, 0, &plan);
+    /* TEST */
+    ok ((plan.num_items == 1) && (plan.items[0].flare == 0)
+        && (plan.items[0].quota == 100 * NUM_BOARDS),
+        "The consecutive items of the same flare are merged and rounded up"
+        " to the quota unit.");
+    free(plan.items);
+}
+
+/*
+ * Flare 0 solves eight boards in 100 iterations and flare 1 solves the
+ * other two, and three of the first eight, in a single iteration.
+ * */
+static void test_percentile(void)
+{
+    fcs_flares_plan_synth_plan_t plan;
+
+    set_iters(0, 0, 8, 100);
+    set_iters(0, 8, NUM_BOARDS, -1);
+    set_iters(1, 0, 5, -1);
+    set_iters(1, 5, NUM_BOARDS, 1);
+
+    fc_solve_flares_plan_synth(&table, 100, 0, &plan);
+    /* TEST */
+    ok ((plan.num_items == 2) && (plan.items[0].flare == 1),
+        "The total iterations are minimised by the cheaper boards first.");
+    free(plan.items);
+
+    fc_solve_flares_plan_synth(&table, 100, 80, &plan);
+    /* TEST */
+    ok ((plan.num_items == 2) && (plan.items[0].flare == 0),
+        "The percentile is minimised by solving most of the boards first.");
+    free(plan.items);
+}
+
+int main(int argc, char * argv[])
+{
+    plan_tests(6);
+    test_complementary_flares();
+    test_single_flare();
+    test_percentile();
+    return exit_status();
+}
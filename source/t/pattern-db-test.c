@@ -0,0 +1,175 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * A test for the pattern database of the optimal A* scan.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <tap.h>
+
+#include "../pattern_db.h"
+#include "../indirect_buffer.h"
+
+/*
+ * The patterns are the cards of 2 suits by 2 ranks. Cards 0 and 1 are the
+ * lower and the higher ranks of the first suit, and cards 2 and 3 of the
+ * second suit.
+ * */
+static void gen_db(fcs_pattern_db_t * const db)
+{
+    const fcs_pattern_db_params_t params = {.suits_num = 2, .ranks_num = 2};
+    fc_solve_pattern_db__init(db, &params);
+    fc_solve_pattern_db__generate(db);
+}
+
+static int get_entry(const fcs_pattern_db_t * const db, const int * const codes)
+{
+    return db->values[fc_solve_pattern_db__calc_idx(db, codes)];
+}
+
+#define ON(card, beneath) fc_solve_pattern_db__card_code((card), (beneath))
+
+static void test_generate(void)
+{
+    fcs_pattern_db_t db;
+    gen_db(&db);
+
+    {
+        const int codes[4] = {0, 0, 0, 0};
+        /* TEST */
+        ok (get_entry(&db, codes) == 0, "All the cards in the foundations.");
+    }
+    {
+        const int codes[4] = {FCS_PATTERN_DB_BOTTOM, FCS_PATTERN_DB_FREECELL,
+            FCS_PATTERN_DB_BOTTOM, FCS_PATTERN_DB_BOTTOM};
+        /* TEST */
+        ok (get_entry(&db, codes) == 4, "Every card is moved once.");
+    }
+    {
+        const int codes[4] = {FCS_PATTERN_DB_BOTTOM, ON(1, 0), 0, 0};
+        /* TEST */
+        ok (get_entry(&db, codes) == 3,
+            "A card above a lower card of its suit is moved twice.");
+    }
+    {
+        const int codes[4] = {ON(0, 1), FCS_PATTERN_DB_BOTTOM, 0, 0};
+        /* TEST */
+        ok (get_entry(&db, codes) == 2,
+            "A card above a higher card of its suit is moved once.");
+    }
+    {
+        /* The higher card of each suit is above the lower card of the
+         * other suit. */
+        const int codes[4] = {FCS_PATTERN_DB_BOTTOM, ON(1, 2),
+            FCS_PATTERN_DB_BOTTOM, ON(3, 0)};
+        /* TEST */
+        ok (get_entry(&db, codes) == 5,
+            "One of the cards of a cycle of blockers is moved twice.");
+    }
+    {
+        const int codes[4] = {ON(0, 1), ON(1, 0), 0, 0};
+        /* TEST */
+        ok (get_entry(&db, codes) == FCS_PATTERN_DB_INVALID,
+            "A cycle of cards is invalid.");
+    }
+
+    char filename[] = "/tmp/fcs-pattern-db-test-XXXXXX";
+    const int fd = mkstemp(filename);
+    close(fd);
+    fcs_pattern_db_t loaded;
+    /* TEST */
+    ok ((fc_solve_pattern_db__write(&db, filename)
+        && (! fc_solve_pattern_db__load(&loaded, filename))
+        && (loaded.num_entries == db.num_entries)
+        && (! memcmp(loaded.values, db.values, db.num_entries))),
+        "The database is the same after it is written and loaded."
+    );
+    unlink(filename);
+
+    {
+        /* The Jacks and Queens of Hearts and Clubs form a cycle, and the
+         * Kings are in their own columns. */
+        fcs_state_keyval_pair_t s;
+        DECLARE_IND_BUF_T(indirect_stacks_buffer)
+        fc_solve_state_init(&s, 4, indirect_stacks_buffer);
+        fcs_set_foundation(s.s, 0, 10);
+        fcs_set_foundation(s.s, 1, 10);
+        fcs_set_foundation(s.s, 2, 13);
+        fcs_set_foundation(s.s, 3, 13);
+        fcs_cards_column_t col = fcs_state_get_col(s.s, 0);
+        fcs_col_push_card(col, fcs_make_card(11, 0));
+        fcs_col_push_card(col, fcs_make_card(12, 1));
+        col = fcs_state_get_col(s.s, 1);
+        fcs_col_push_card(col, fcs_make_card(11, 1));
+        fcs_col_push_card(col, fcs_make_card(12, 0));
+        col = fcs_state_get_col(s.s, 2);
+        fcs_col_push_card(col, fcs_make_card(13, 0));
+        col = fcs_state_get_col(s.s, 3);
+        fcs_col_push_card(col, fcs_make_card(13, 1));
+
+        fcs_pattern_db_t no_db;
+        no_db.values = NULL;
+        /* TEST */
+        ok (fc_solve_pattern_db__calc_lower_bound(&no_db, &(s.s), 0, 4, 1) == 6,
+            "Without the database, the bound is the number of cards out.");
+        /* TEST */
+        ok (fc_solve_pattern_db__calc_lower_bound(&loaded, &(s.s), 0, 4, 1) == 7,
+            "The database finds the cycle."
+        );
+
+        /* Put the Jack of Hearts above the Queen of Hearts. */
+        col = fcs_state_get_col(s.s, 1);
+        fcs_col_pop_top(col);
+        col = fcs_state_get_col(s.s, 0);
+        fcs_col_pop_top(col);
+        fcs_col_pop_top(col);
+        fcs_col_push_card(col, fcs_make_card(12, 0));
+        fcs_col_push_card(col, fcs_make_card(12, 1));
+        fcs_col_push_card(col, fcs_make_card(11, 0));
+        /* TEST */
+        ok (fc_solve_pattern_db__calc_lower_bound(&loaded, &(s.s), 0, 4, 1) == 6,
+            "A card above a higher card of its suit is moved once."
+        );
+        col = fcs_state_get_col(s.s, 2);
+        fcs_col_pop_top(col);
+        col = fcs_state_get_col(s.s, 0);
+        fcs_col_push_card(col, fcs_make_card(13, 0));
+        /* TEST */
+        ok (fc_solve_pattern_db__calc_lower_bound(&loaded, &(s.s), 0, 4, 1) == 7,
+            "A card above a lower card of its suit in another pattern is moved twice."
+        );
+    }
+
+    fc_solve_pattern_db__free(&loaded);
+    fc_solve_pattern_db__free(&db);
+}
+
+int main(int argc, char * argv[])
+{
+    plan_tests(11);
+    test_generate();
+    return exit_status();
+}
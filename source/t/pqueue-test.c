@@ -0,0 +1,108 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * A test for the priority queue of the BeFS scans.
+ */
+
+#include <stdlib.h>
+
+#include <tap.h>
+
+#include "../alloc_wrap.h"
+#include "../pqueue.h"
+
+#define NUM_ITEMS 10000
+
+static fcs_collectible_state_t states[NUM_ITEMS];
+
+static pq_rating_t rating_of(const int idx)
+{
+    /* Plenty of equal ratings. */
+    return (pq_rating_t)((idx * 7919) % 503);
+}
+
+static fcs_bool_t is_filtered_out(const int idx)
+{
+    return ((idx % 3) == 1);
+}
+
+int main(int argc, char * argv[])
+{
+    PQUEUE pq;
+
+    plan_tests(3);
+
+    fc_solve_pq_init(&pq, 1024);
+    for (int i = 0 ; i < NUM_ITEMS ; i++)
+    {
+        fc_solve_pq_push(&pq, &(states[i]), rating_of(i));
+    }
+
+    /* Filter out some of the elements in place, the way the states
+     * trimming does. */
+    pq_element_t * const Elements = pq.Elements;
+    int dest = PQ_FIRST_ENTRY;
+    for (int i = PQ_FIRST_ENTRY ; i <= pq.CurrentSize ; i++)
+    {
+        if (! is_filtered_out(Elements[i].val - states))
+        {
+            Elements[dest++] = Elements[i];
+        }
+    }
+    pq.CurrentSize = dest - PQ_FIRST_ENTRY;
+    fc_solve_pq_rebuild(&pq);
+
+    int num_expected = 0;
+    for (int i = 0 ; i < NUM_ITEMS ; i++)
+    {
+        if (! is_filtered_out(i))
+        {
+            num_expected++;
+        }
+    }
+
+    fcs_bool_t is_ordered = TRUE, is_filtered = TRUE;
+    int num_popped = 0;
+    pq_rating_t prev_rating = FC_SOLVE_PQUEUE_MaxRating;
+    fcs_collectible_state_t * val;
+    while ((fc_solve_pq_pop(&pq, &val), val))
+    {
+        const int idx = val - states;
+        is_filtered &= (! is_filtered_out(idx));
+        is_ordered &= (rating_of(idx) <= prev_rating);
+        prev_rating = rating_of(idx);
+        num_popped++;
+    }
+
+    /* TEST */
+    ok (is_filtered, "The filtered out elements are gone.");
+    /* TEST */
+    ok (num_popped == num_expected, "All the remaining elements were popped.");
+    /* TEST */
+    ok (is_ordered, "The elements are popped in descending order of rating.");
+
+    fc_solve_PQueueFree(&pq);
+
+    return exit_status();
+}
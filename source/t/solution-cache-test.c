@@ -0,0 +1,255 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * A test for the persistent solution cache.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <tap.h>
+
+#include "../solution_cache.h"
+#include "../indirect_buffer.h"
+
+static fcs_solution_cache_key_t calc_key(
+    const fcs_card_t top_card,
+    const unsigned long long config_digest
+)
+{
+    fcs_state_keyval_pair_t s;
+    DECLARE_IND_BUF_T(indirect_stacks_buffer)
+    fc_solve_state_init(&s, 2, indirect_stacks_buffer);
+    fcs_set_foundation(s.s, 0, 10);
+    fcs_cards_column_t col = fcs_state_get_col(s.s, 0);
+    fcs_col_push_card(col, fcs_make_card(13, 0));
+    fcs_col_push_card(col, top_card);
+    col = fcs_state_get_col(s.s, 1);
+    fcs_col_push_card(col, fcs_make_card(11, 0));
+    fcs_put_card_in_freecell(s.s, 0, fcs_make_card(13, 1));
+
+    return fc_solve_solution_cache__calc_key(&(s.s), 1, 2, 1, config_digest);
+}
+
+static fcs_move_t make_move(const int type, const int src, const int dest)
+{
+    fcs_move_t move;
+    fcs_move_set_type(move, type);
+    fcs_move_set_src_stack(move, src);
+    fcs_move_set_dest_stack(move, dest);
+    fcs_move_set_num_cards_in_seq(move, 1);
+    return move;
+}
+
+static fcs_bool_t moves_are_equal(
+    const fcs_move_t * const a,
+    const fcs_move_t * const b,
+    const int num_moves
+)
+{
+    return (! memcmp(a, b, sizeof(a[0]) * num_moves));
+}
+
+static void test_keys(void)
+{
+    const fcs_solution_cache_key_t key = calc_key(fcs_make_card(12, 0), 1);
+    const fcs_solution_cache_key_t same = calc_key(fcs_make_card(12, 0), 1);
+    const fcs_solution_cache_key_t other_card =
+        calc_key(fcs_make_card(12, 1), 1);
+    const fcs_solution_cache_key_t other_config =
+        calc_key(fcs_make_card(12, 0), 2);
+
+    /* TEST */
+    ok (fc_solve_solution_cache__keys_are_equal(&key, &same),
+        "The same state has the same key.");
+    /* TEST */
+    ok ((! fc_solve_solution_cache__keys_are_equal(&key, &other_card))
+        && (key.state_hash != other_card.state_hash)
+        && (key.state_check != other_card.state_check),
+        "Both hashes tell different states apart.");
+    /* TEST */
+    ok (! fc_solve_solution_cache__keys_are_equal(&key, &other_config),
+        "The configuration is a part of the key.");
+}
+
+static void test_renumber_moves(void)
+{
+    fcs_state_locs_struct_t locs;
+    fc_solve_init_locs(&locs);
+    /* The canonized stack 0 is the board's stack 2, and vice versa, and
+     * the canonized freecell 0 is the board's freecell 1. */
+    locs.stack_locs[0] = 2;
+    locs.stack_locs[2] = 0;
+    locs.fc_locs[0] = 1;
+    locs.fc_locs[1] = 0;
+
+    const fcs_move_t board_moves[3] = {
+        make_move(FCS_MOVE_TYPE_STACK_TO_STACK, 2, 1),
+        make_move(FCS_MOVE_TYPE_STACK_TO_FREECELL, 0, 1),
+        make_move(FCS_MOVE_TYPE_STACK_TO_FOUNDATION, 2, 3),
+    };
+    const fcs_move_t canonized_moves[3] = {
+        make_move(FCS_MOVE_TYPE_STACK_TO_STACK, 0, 1),
+        make_move(FCS_MOVE_TYPE_STACK_TO_FREECELL, 2, 0),
+        make_move(FCS_MOVE_TYPE_STACK_TO_FOUNDATION, 0, 3),
+    };
+
+    fcs_move_t moves[3];
+    memcpy(moves, board_moves, sizeof(moves));
+    fc_solve_solution_cache__renumber_moves(moves, 3, &locs, TRUE);
+    /* TEST */
+    ok (moves_are_equal(moves, canonized_moves, 3),
+        "The moves are renumbered to the canonized order, except for the "
+        "foundations."
+    );
+    fc_solve_solution_cache__renumber_moves(moves, 3, &locs, FALSE);
+    /* TEST */
+    ok (moves_are_equal(moves, board_moves, 3),
+        "The moves are renumbered back to the board's order."
+    );
+}
+
+static fcs_bool_t lookup(
+    fcs_solution_cache_t * const cache,
+    const fcs_solution_cache_key_t * const key,
+    const fcs_move_t * const expected_moves,
+    const int num_moves
+)
+{
+    fcs_moves_sequence_t moves_seq;
+    if (! fc_solve_solution_cache__lookup(cache, key, &moves_seq))
+    {
+        return FALSE;
+    }
+    const fcs_bool_t ret = ((moves_seq.num_moves == num_moves)
+        && moves_are_equal(moves_seq.moves, expected_moves, num_moves));
+    free(moves_seq.moves);
+    return ret;
+}
+
+static void test_file(void)
+{
+    const char * const filename = "solution-cache-test.tmp";
+    unlink(filename);
+
+    const fcs_solution_cache_key_t keys[3] = {
+        calc_key(fcs_make_card(12, 0), 1),
+        calc_key(fcs_make_card(12, 1), 1),
+        calc_key(fcs_make_card(12, 2), 1),
+    };
+    const fcs_move_t moves[3] = {
+        make_move(FCS_MOVE_TYPE_STACK_TO_STACK, 0, 1),
+        make_move(FCS_MOVE_TYPE_STACK_TO_FOUNDATION, 1, 0),
+        make_move(FCS_MOVE_TYPE_STACK_TO_FOUNDATION, 0, 0),
+    };
+
+    fcs_solution_cache_t writer, reader;
+    /* TEST */
+    ok ((! fc_solve_solution_cache__load(&writer, filename))
+        && (! fc_solve_solution_cache__load(&reader, filename)),
+        "Two handles open a new cache."
+    );
+    /* TEST */
+    ok (! lookup(&reader, &(keys[0]), moves, 3),
+        "An empty cache has no solutions.");
+
+    fc_solve_solution_cache__store(&writer, &(keys[0]), moves, 3);
+    /* TEST */
+    ok (lookup(&reader, &(keys[0]), moves, 3)
+        && lookup(&writer, &(keys[0]), moves, 3),
+        "A solution is found by both handles once it is stored."
+    );
+
+    /* Another solution of the same board is not appended. */
+    const size_t committed_len = writer.indexed_len;
+    fc_solve_solution_cache__store(&reader, &(keys[0]), moves, 2);
+    fc_solve_solution_cache__store(&reader, &(keys[1]), moves + 1, 2);
+    /* TEST */
+    ok (lookup(&writer, &(keys[1]), moves + 1, 2)
+        && lookup(&writer, &(keys[0]), moves, 3)
+        && (writer.indexed_len == committed_len
+            + fc_solve_solution_cache__record_len(2)),
+        "A board is only stored once."
+    );
+
+    const pid_t pid = fork();
+    if (pid == 0)
+    {
+        /* The child stores with the handle it inherited. */
+        _exit(fc_solve_solution_cache__store(&writer, &(keys[2]), moves, 0)
+            ? 0 : 1);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    /* TEST */
+    ok (WIFEXITED(status) && (WEXITSTATUS(status) == 0)
+        && lookup(&reader, &(keys[2]), moves, 0),
+        "A child process stores a solution with an inherited handle."
+    );
+
+    fc_solve_solution_cache__free(&reader);
+    fc_solve_solution_cache__free(&writer);
+
+    fcs_solution_cache_t reopened;
+    /* TEST */
+    ok ((! fc_solve_solution_cache__load(&reopened, filename))
+        && (reopened.index_count == 3)
+        && lookup(&reopened, &(keys[0]), moves, 3)
+        && lookup(&reopened, &(keys[1]), moves + 1, 2)
+        && lookup(&reopened, &(keys[2]), moves, 0),
+        "The index is rebuilt when the cache is opened again."
+    );
+    fc_solve_solution_cache__free(&reopened);
+
+    /* A record that was appended but not committed is ignored. */
+    FILE * f = fopen(filename, "ab");
+    fwrite(moves, sizeof(moves[0]), 3, f);
+    fclose(f);
+    /* TEST */
+    ok ((! fc_solve_solution_cache__load(&reopened, filename))
+        && (reopened.index_count == 3),
+        "The uncommitted tail of the file is ignored."
+    );
+    fc_solve_solution_cache__free(&reopened);
+    unlink(filename);
+
+    f = fopen(filename, "wb");
+    fputs("Not a cache.", f);
+    fclose(f);
+    /* TEST */
+    ok (fc_solve_solution_cache__load(&reopened, filename) != NULL,
+        "A file that is not a cache is rejected."
+    );
+    unlink(filename);
+}
+
+int main(int argc, char * argv[])
+{
+    plan_tests(13);
+    test_keys();
+    test_renumber_moves();
+    test_file();
+    return exit_status();
+}
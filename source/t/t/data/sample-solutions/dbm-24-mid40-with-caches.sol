@@ -0,0 +1,290 @@
+instance_run_all_threads start
+instance_run_solver_thread start
+instance_run_solver_thread end
+instance_run_all_threads end
+handle_and_destroy_instance_solution start
+Reached 36543 ; States-in-collection: 60132 ; Time: 24
+>>>Queue Stats: inserted=60132 items_in_queue=23589 extracted=36543
+>>>Store Stats: lookups=105996
+Success!
+--------
+Foundations: H-0 C-0 D-0 S-2 
+Freecells:  TH    
+: 4C 2C 9C
+: 5H QH 3C AC 3H 4H
+: QC JD TC 9H 8C
+: KS QD JC TD 9S 8D 7S 6H
+: 2D KD QS JH
+: 7H JS KH TS KC 7C 6D 5C 4D 3S 2H
+: AH 5S 6S AD 8H
+: 9D 8S 7D 6C 5D 4S 3D
+
+==
+Column 6 -> Column 0
+--------
+Foundations: H-0 C-0 D-A S-2 
+Freecells:  TH    
+: 4C 2C 9C 8H
+: 5H QH 3C AC 3H 4H
+: QC JD TC 9H 8C
+: KS QD JC TD 9S 8D 7S 6H
+: 2D KD QS JH
+: 7H JS KH TS KC 7C 6D 5C 4D 3S 2H
+: AH 5S 6S
+: 9D 8S 7D 6C 5D 4S 3D
+
+==
+Column 6 -> Freecell 1
+--------
+Foundations: H-0 C-0 D-A S-2 
+Freecells:  6S  TH
+: 4C 2C 9C 8H
+: 5H QH 3C AC 3H 4H
+: QC JD TC 9H 8C
+: KS QD JC TD 9S 8D 7S 6H
+: 2D KD QS JH
+: 7H JS KH TS KC 7C 6D 5C 4D 3S 2H
+: AH 5S
+: 9D 8S 7D 6C 5D 4S 3D
+
+==
+Column 6 -> Column 3
+--------
+Foundations: H-2 C-0 D-A S-3 
+Freecells:  6S  TH
+: 4C 2C 9C 8H
+: 5H QH 3C AC 3H 4H
+: QC JD TC 9H 8C
+: KS QD JC TD 9S 8D 7S 6H 5S
+: 2D KD QS JH
+: 7H JS KH TS KC 7C 6D 5C 4D
+: 
+: 9D 8S 7D 6C 5D 4S 3D
+
+==
+Freecell 1 -> Column 6
+--------
+Foundations: H-2 C-0 D-A S-3 
+Freecells:  6S    
+: 4C 2C 9C 8H
+: 5H QH 3C AC 3H 4H
+: QC JD TC 9H 8C
+: KS QD JC TD 9S 8D 7S 6H 5S
+: 2D KD QS JH
+: 7H JS KH TS KC 7C 6D 5C 4D
+: TH
+: 9D 8S 7D 6C 5D 4S 3D
+
+==
+Column 0 -> Freecell 1
+--------
+Foundations: H-2 C-0 D-A S-3 
+Freecells:  6S  8H
+: 4C 2C 9C
+: 5H QH 3C AC 3H 4H
+: QC JD TC 9H 8C
+: KS QD JC TD 9S 8D 7S 6H 5S
+: 2D KD QS JH
+: 7H JS KH TS KC 7C 6D 5C 4D
+: TH
+: 9D 8S 7D 6C 5D 4S 3D
+
+==
+Column 1 -> Column 3
+--------
+Foundations: H-2 C-0 D-A S-3 
+Freecells:  6S  8H
+: 4C 2C 9C
+: 5H QH 3C AC 3H
+: QC JD TC 9H 8C
+: KS QD JC TD 9S 8D 7S 6H 5S 4H
+: 2D KD QS JH
+: 7H JS KH TS KC 7C 6D 5C 4D
+: TH
+: 9D 8S 7D 6C 5D 4S 3D
+
+==
+Column 0 -> Column 6
+--------
+Foundations: H-2 C-0 D-A S-3 
+Freecells:  6S  8H
+: 4C 2C
+: 5H QH 3C AC 3H
+: QC JD TC 9H 8C
+: KS QD JC TD 9S 8D 7S 6H 5S 4H
+: 2D KD QS JH
+: 7H JS KH TS KC 7C 6D 5C 4D
+: TH 9C
+: 9D 8S 7D 6C 5D 4S 3D
+
+==
+Freecell 1 -> Column 6
+--------
+Foundations: H-2 C-0 D-A S-3 
+Freecells:  6S    
+: 4C 2C
+: 5H QH 3C AC 3H
+: QC JD TC 9H 8C
+: KS QD JC TD 9S 8D 7S 6H 5S 4H
+: 2D KD QS JH
+: 7H JS KH TS KC 7C 6D 5C 4D
+: TH 9C 8H
+: 9D 8S 7D 6C 5D 4S 3D
+
+==
+Column 4 -> Freecell 1
+--------
+Foundations: H-2 C-0 D-A S-3 
+Freecells:  6S  JH
+: 4C 2C
+: 5H QH 3C AC 3H
+: QC JD TC 9H 8C
+: KS QD JC TD 9S 8D 7S 6H 5S 4H
+: 2D KD QS
+: 7H JS KH TS KC 7C 6D 5C 4D
+: TH 9C 8H
+: 9D 8S 7D 6C 5D 4S 3D
+
+==
+Column 1 -> Foundation 0
+--------
+Foundations: H-4 C-3 D-A S-3 
+Freecells:  6S  JH
+: 4C
+: 5H QH
+: QC JD TC 9H 8C
+: KS QD JC TD 9S 8D 7S 6H 5S
+: 2D KD QS
+: 7H JS KH TS KC 7C 6D 5C 4D
+: TH 9C 8H
+: 9D 8S 7D 6C 5D 4S 3D
+
+==
+Column 0 -> Foundation 1
+--------
+Foundations: H-4 C-4 D-A S-3 
+Freecells:  6S  JH
+: TH 9C 8H
+: 5H QH
+: QC JD TC 9H 8C
+: KS QD JC TD 9S 8D 7S 6H 5S
+: 2D KD QS
+: 7H JS KH TS KC 7C 6D 5C 4D
+: 
+: 9D 8S 7D 6C 5D 4S 3D
+
+==
+Column 4 -> Column 6
+--------
+Foundations: H-4 C-4 D-A S-3 
+Freecells:  6S  JH
+: QS
+: 5H QH
+: QC JD TC 9H 8C
+: KS QD JC TD 9S 8D 7S 6H 5S
+: 2D KD
+: 7H JS KH TS KC 7C 6D 5C 4D
+: TH 9C 8H
+: 9D 8S 7D 6C 5D 4S 3D
+
+==
+Freecell 1 -> Column 0
+--------
+Foundations: H-4 C-4 D-A S-3 
+Freecells:  6S    
+: QS JH
+: 5H QH
+: QC JD TC 9H 8C
+: KS QD JC TD 9S 8D 7S 6H 5S
+: 2D KD
+: 7H JS KH TS KC 7C 6D 5C 4D
+: TH 9C 8H
+: 9D 8S 7D 6C 5D 4S 3D
+
+==
+Column 4 -> Freecell 1
+--------
+Foundations: H-4 C-6 D-7 S-6 
+Freecells:  KD    
+: QS JH
+: 5H QH
+: QC JD TC 9H 8C
+: KS QD JC TD 9S 8D 7S 6H
+: TH 9C 8H
+: 7H JS KH TS KC 7C
+: 
+: 9D 8S
+
+==
+Column 1 -> Freecell 1
+--------
+Foundations: H-6 C-8 D-9 S-8 
+Freecells:  QH  KD
+: QS JH
+: TH 9C 8H
+: QC JD TC 9H
+: KS QD JC TD 9S
+: 
+: 7H JS KH TS KC
+: 
+: 
+
+==
+Column 5 -> Column 7
+--------
+Foundations: H-6 C-8 D-9 S-8 
+Freecells:  QH  KD
+: KC
+: QS JH
+: QC JD TC 9H
+: KS QD JC TD 9S
+: TH 9C 8H
+: 7H JS KH TS
+: 
+: 
+
+==
+Column 5 -> Column 1
+--------
+Foundations: H-6 C-8 D-9 S-8 
+Freecells:  QH  KD
+: KC
+: QS JH TS
+: QC JD TC 9H
+: KS QD JC TD 9S
+: TH 9C 8H
+: 7H JS KH
+: 
+: 
+
+==
+Column 5 -> Column 7
+--------
+Foundations: H-6 C-8 D-9 S-8 
+Freecells:  QH  KD
+: KC
+: KH
+: QC JD TC 9H
+: KS QD JC TD 9S
+: QS JH TS
+: 7H JS
+: TH 9C 8H
+: 
+
+==
+Column 5 -> Column 7
+--------
+Foundations: H-K C-K D-K S-K 
+Freecells:        
+: 
+: 
+: 
+: 
+: 
+: 
+: 
+: 
+
+==
+END
+handle_and_destroy_instance_solution end
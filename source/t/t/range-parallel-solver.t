@@ -3,7 +3,10 @@
 use strict;
 use warnings;
 
-use Test::More tests => 9;
+use Test::More tests => 17;
+use File::Spec;
+use File::Temp qw(tempdir);
+use Storable qw(retrieve);
 
 my $range_solver = $ENV{'FCS_PATH'} . "/freecell-solver-range-parallel-solve";
 
@@ -46,6 +49,88 @@ ok (!system($range_solver, "1", "64", "1", "-l", "cool-jives", "-opt"),
     }
 }
 
+# The states that were trimmed in one board should not be reused after the
+# instance was recycled for the next one. The solutions are checked with the
+# verifier, because trimming may lead the scan to different solutions than
+# an untrimmed run.
+my $range_verifier = $ENV{'FCS_SRC_PATH'} . '/scripts/verify-range-in-dir-and-collect-stats.pl';
+
+sub _test_trimmed_range
+{
+    my ($args, $blurb) = @_;
+
+    local $Test::Builder::Level = $Test::Builder::Level + 1;
+
+    my $sols_dir = tempdir(CLEANUP => 1);
+    my $stats_file = File::Spec->catfile($sols_dir, 'summary.stats.perl-storable');
+
+    ok (!system($range_solver, "1", $args->{max}, "1",
+            "--solutions-directory", "$sols_dir/",
+            @{$args->{solver_args}}, "-p", "-t", "-sam"),
+        "Range solver with $blurb was successful"
+    );
+
+    ok (!system($^X, $range_verifier,
+            '--summary-lock', File::Spec->catfile($sols_dir, 'summary.lock'),
+            '--summary-stats-file', $stats_file,
+            '--summary-file', File::Spec->catfile($sols_dir, 'summary.txt'),
+            '-g', 'freecell',
+            '--min-idx', 1, '--max-idx', $args->{max},
+            $sols_dir,
+        ),
+        "The solutions of the range solver with $blurb are valid"
+    );
+
+    if (defined($args->{min_solved}))
+    {
+        my $num_solved = 0;
+        foreach my $count
+            (values(%{retrieve($stats_file)->{counts}->{solved}->{iters}}))
+        {
+            $num_solved += $count;
+        }
+
+            cmp_ok ($num_solved, '>=', $args->{min_solved},
+            "The range solver with $blurb solved enough boards"
+        );
+    }
+
+    return;
+}
+
+# TEST*3
+_test_trimmed_range(
+    {
+        max => 30,
+        solver_args => ["-mi", "100000", "--trim-max-stored-states", "2000"],
+        min_solved => 28,
+    },
+    "--trim-max-stored-states",
+);
+
+# TEST*3
+_test_trimmed_range(
+    {
+        max => 20,
+        solver_args => ["-mi", "100000", "--method", "a-star",
+            "--trim-max-stored-states", "3000"],
+        min_solved => 19,
+    },
+    "A* and --trim-max-stored-states",
+);
+
+# No board is solved by BrFS within the iterations limit, so this only
+# verifies that all of them are reported as unsolved in the proper format.
+# TEST*2
+_test_trimmed_range(
+    {
+        max => 5,
+        solver_args => ["-mi", "10000", "--method", "bfs",
+            "--trim-max-stored-states", "2000"],
+    },
+    "BrFS and --trim-max-stored-states",
+);
+
 =head1 COPYRIGHT AND LICENSE
 
 Copyright (c) 2008 Shlomi Fish
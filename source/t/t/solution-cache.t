@@ -0,0 +1,80 @@
+#!/usr/bin/perl
+
+use strict;
+use warnings;
+
+use Test::More tests => 3;
+use File::Spec;
+use File::Temp qw( tempdir );
+
+my $fc_solve_exe = $ENV{'FCS_PATH'} . "/fc-solve";
+my $temp_dir = tempdir (CLEANUP => 1);
+my $board_fn = File::Spec->catfile(
+    $ENV{FCS_SRC_PATH}, 't', 't', 'data', 'sample-boards', '24-mid.board'
+);
+my $cache_fn = File::Spec->catfile($temp_dir, "solutions.cache");
+
+sub solve_board
+{
+    my @args = @_;
+
+    open my $fc_solve_output, "-|", $fc_solve_exe, @args, "-p", "-t", "-sam",
+        $board_fn
+        or die "Could not run fc-solve";
+
+    my @lines =
+        grep { !m{\A(?:Total number of states checked|This scan generated)} }
+        <$fc_solve_output>;
+
+    close($fc_solve_output);
+
+    return join('', @lines);
+}
+
+my $expected = solve_board("-l", "as");
+
+# TEST
+like ($expected, qr{^This game is solveable\.$}ms, "The board was solved.");
+
+# Fill the cache with the solution of the default configuration.
+solve_board("--solution-cache", $cache_fn);
+
+# The options that follow --solution-cache select the configuration as
+# well, so this should not get the solution of the default one.
+# TEST
+is (solve_board("--solution-cache", $cache_fn, "-l", "as"), $expected,
+    "Options after --solution-cache select a different configuration."
+);
+
+# TEST
+is (solve_board("-l", "as", "--solution-cache", $cache_fn), $expected,
+    "The cached solution is the one of the same configuration."
+);
+
+=head1 COPYRIGHT AND LICENSE
+
+Copyright (c) 2015 Shlomi Fish
+
+Permission is hereby granted, free of charge, to any person
+obtaining a copy of this software and associated documentation
+files (the "Software"), to deal in the Software without
+restriction, including without limitation the rights to use,
+copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the
+Software is furnished to do so, subject to the following
+conditions:
+
+The above copyright notice and this permission notice shall be
+included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+OTHER DEALINGS IN THE SOFTWARE.
+
+=cut
+
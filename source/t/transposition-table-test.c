@@ -0,0 +1,100 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * A test for the transposition table of the trimmed dead ends.
+ */
+
+#include <stdio.h>
+
+#include <tap.h>
+
+#include "../transposition_table.h"
+
+#define NUM_ENTRIES 1024
+
+static void test_lookup(void)
+{
+    fcs_transposition_table_t tt;
+    fcs_bool_t all_ok = TRUE;
+
+    fc_solve_tt_init(&tt, NUM_ENTRIES + 100);
+    /* TEST */
+    ok (tt.buckets_mask == NUM_ENTRIES / 2 - 1,
+        "The size is rounded down to a power of 2.");
+
+    for (long i = 0 ; i < NUM_ENTRIES / 2 ; i++)
+    {
+        fc_solve_tt_insert(&tt, fc_solve_tt_hash(&i, sizeof(i)), 10);
+    }
+    for (long i = 0 ; i < NUM_ENTRIES / 2 ; i++)
+    {
+        all_ok &= fc_solve_tt_lookup(&tt, fc_solve_tt_hash(&i, sizeof(i)));
+    }
+    /* TEST */
+    ok (all_ok, "The inserted dead ends are found.");
+
+    const long missing = NUM_ENTRIES * 100;
+    /* TEST */
+    ok (! fc_solve_tt_lookup(&tt, fc_solve_tt_hash(&missing, sizeof(missing))),
+        "A state that was not inserted is not found.");
+
+    fc_solve_tt_free(&tt);
+}
+
+static void test_replacement(void)
+{
+    fcs_transposition_table_t tt;
+    /* Three hashes that share the same (and only) bucket. */
+    const fcs_tt_hash_t shallow = 0x100000, deep = 0x200000, newer = 0x300000;
+
+    fc_solve_tt_init(&tt, 2);
+    fc_solve_tt_insert(&tt, shallow, 5);
+    fc_solve_tt_insert(&tt, deep, 30);
+    fc_solve_tt_insert(&tt, newer, 40);
+    /* TEST */
+    ok (fc_solve_tt_lookup(&tt, shallow) && fc_solve_tt_lookup(&tt, newer)
+        && (! fc_solve_tt_lookup(&tt, deep)),
+        "The dead end with the fewest cards out is kept in its age.");
+
+    fc_solve_tt_next_age(&tt);
+    fc_solve_tt_insert(&tt, deep, 30);
+    /* TEST */
+    ok (fc_solve_tt_lookup(&tt, shallow) && fc_solve_tt_lookup(&tt, deep)
+        && (! fc_solve_tt_lookup(&tt, newer)),
+        "An entry of an older age is demoted.");
+
+    fc_solve_tt_free(&tt);
+
+    fc_solve_tt_init(&tt, 1);
+    /* TEST */
+    ok (! tt.entries, "A size below 2 disables the table.");
+}
+
+int main(int argc, char * argv[])
+{
+    plan_tests(6);
+    test_lookup();
+    test_replacement();
+    return exit_status();
+}
@@ -0,0 +1,189 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * transposition_table.h - a fixed-size and lossy table of the dead end
+ * states that were trimmed out of the states collection, so the scans
+ * will not explore them again if they are reached after the trimming.
+ *
+ * Each entry fits in 64 bits: a 47-bit check of the state's hash, the
+ * age (= the trimming in which it was inserted) and the number of cards
+ * in the foundations. The table is made of two-entry buckets - the first
+ * entry keeps the dead end with the fewest cards out (which roots the
+ * largest sub-tree) as long as it is not older than the new one, and the
+ * second one is always replaced.
+ */
+#ifndef FC_SOLVE__TRANSPOSITION_TABLE_H
+#define FC_SOLVE__TRANSPOSITION_TABLE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdlib.h>
+
+#include "inline.h"
+#include "bool.h"
+
+typedef unsigned long long fcs_tt_entry_t;
+typedef unsigned long long fcs_tt_hash_t;
+
+typedef struct
+{
+    /* num_buckets * 2 entries, or NULL if the table is disabled. */
+    fcs_tt_entry_t * entries;
+    unsigned long buckets_mask;
+    unsigned char age;
+} fcs_transposition_table_t;
+
+#define FCS_TT_CHECK_MASK (~((fcs_tt_entry_t)0xFFFF))
+#define FCS_TT_ENTRY_AGE(entry) ((unsigned char)((entry) >> 8))
+#define FCS_TT_ENTRY_NUM_CARDS_OUT(entry) ((unsigned char)(entry))
+
+/*
+ * num_entries is rounded down to a power of 2. A value below 2 disables
+ * the table.
+ * */
+static GCC_INLINE void fc_solve_tt_init(
+    fcs_transposition_table_t * const tt,
+    const long num_entries
+)
+{
+    tt->age = 0;
+    if (num_entries < 2)
+    {
+        tt->entries = NULL;
+        tt->buckets_mask = 0;
+        return;
+    }
+
+    unsigned long num_buckets = 1;
+    while ((num_buckets << 2) <= (unsigned long)num_entries)
+    {
+        num_buckets <<= 1;
+    }
+    tt->buckets_mask = num_buckets - 1;
+    tt->entries = calloc(num_buckets * 2, sizeof(tt->entries[0]));
+}
+
+static GCC_INLINE void fc_solve_tt_free(
+    fcs_transposition_table_t * const tt
+)
+{
+    free(tt->entries);
+    tt->entries = NULL;
+}
+
+/* FNV-1a over the bytes of the state's key. */
+static GCC_INLINE fcs_tt_hash_t fc_solve_tt_hash(
+    const void * const key,
+    const size_t size
+)
+{
+    const unsigned char * s_ptr = (const unsigned char *)key;
+    const unsigned char * const s_end = s_ptr + size;
+    fcs_tt_hash_t hash = 14695981039346656037ULL;
+
+    while (s_ptr < s_end)
+    {
+        hash ^= *(s_ptr++);
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+/*
+ * The bucket is selected by the low bits of the hash, and the check is
+ * taken from the high bits, with its lowest bit set so no entry is ever
+ * empty (= 0).
+ * */
+static GCC_INLINE fcs_tt_entry_t * fc_solve_tt__bucket(
+    const fcs_transposition_table_t * const tt,
+    const fcs_tt_hash_t hash
+)
+{
+    return tt->entries + ((hash & tt->buckets_mask) << 1);
+}
+
+static GCC_INLINE fcs_tt_entry_t fc_solve_tt__check(const fcs_tt_hash_t hash)
+{
+    return ((hash & FCS_TT_CHECK_MASK) | 0x10000);
+}
+
+static GCC_INLINE fcs_bool_t fc_solve_tt_lookup(
+    const fcs_transposition_table_t * const tt,
+    const fcs_tt_hash_t hash
+)
+{
+    const fcs_tt_entry_t * const bucket = fc_solve_tt__bucket(tt, hash);
+    const fcs_tt_entry_t check = fc_solve_tt__check(hash);
+
+    return (((bucket[0] & FCS_TT_CHECK_MASK) == check)
+        || ((bucket[1] & FCS_TT_CHECK_MASK) == check));
+}
+
+static GCC_INLINE void fc_solve_tt_insert(
+    fcs_transposition_table_t * const tt,
+    const fcs_tt_hash_t hash,
+    const int num_cards_out
+)
+{
+    fcs_tt_entry_t * const bucket = fc_solve_tt__bucket(tt, hash);
+    const fcs_tt_entry_t check = fc_solve_tt__check(hash);
+    const fcs_tt_entry_t entry =
+        (check | (((fcs_tt_entry_t)tt->age) << 8) | (unsigned char)num_cards_out);
+
+    if ((bucket[0] & FCS_TT_CHECK_MASK) == check)
+    {
+        bucket[0] = entry;
+    }
+    else if ((! bucket[0])
+        || (FCS_TT_ENTRY_AGE(bucket[0]) != tt->age)
+        || (num_cards_out <= FCS_TT_ENTRY_NUM_CARDS_OUT(bucket[0])))
+    {
+        /* Demote the previous entry instead of discarding it. This also
+         * takes care of a stale copy of the new one in the second entry. */
+        bucket[1] = bucket[0];
+        bucket[0] = entry;
+    }
+    else
+    {
+        bucket[1] = entry;
+    }
+}
+
+/* Starts a new age, so the entries of the previous ones can be replaced
+ * regardless of their number of cards out. */
+static GCC_INLINE void fc_solve_tt_next_age(
+    fcs_transposition_table_t * const tt
+)
+{
+    tt->age++;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FC_SOLVE__TRANSPOSITION_TABLE_H */
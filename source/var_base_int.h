@@ -0,0 +1,49 @@
+/* Copyright (c) 2015 Shlomi Fish
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*
+ * var_base_int.h - selects the integer type of var_base_writer.h and
+ * var_base_reader.h . The encoded states are at most 128 bits long, so a
+ * native unsigned __int128 is used where the compiler has one, and GMP
+ * otherwise (or when FCS_VAR_BASE_WITH_GMP is defined).
+ */
+#ifndef FC_SOLVE__VAR_BASE_INT_H
+#define FC_SOLVE__VAR_BASE_INT_H
+
+#include "config.h"
+
+#if defined(__SIZEOF_INT128__) && (MAX_NUM_DECKS == 1) && (! defined(FCS_VAR_BASE_WITH_GMP))
+
+#define FCS_VAR_BASE_USE_INT128 1
+
+typedef unsigned __int128 fcs_var_base_int_t;
+
+#define FCS_VAR_BASE_INT_NUM_BYTES ((int)sizeof(fcs_var_base_int_t))
+
+#else
+
+#include <gmp.h>
+
+#endif
+
+#endif /* FC_SOLVE__VAR_BASE_INT_H */
@@ -30,9 +30,64 @@
 #define FC_SOLVE__VAR_BASE_READER_H
 
 #include <assert.h>
-#include <gmp.h>
 
 #include "inline.h"
+#include "var_base_int.h"
+
+#ifdef FCS_VAR_BASE_USE_INT128
+
+typedef struct
+{
+    fcs_var_base_int_t data;
+} fcs_var_base_reader_t;
+
+static GCC_INLINE void fc_solve_var_base_reader_init(
+    fcs_var_base_reader_t * const s
+)
+{
+}
+
+static GCC_INLINE void fc_solve_var_base_reader_start(
+    fcs_var_base_reader_t * const s,
+    const unsigned char * const data,
+    const size_t data_len
+)
+{
+    fcs_var_base_int_t ret = 0;
+
+    /* The bytes beyond the width of the integer must be zero. */
+    for (size_t count = data_len ; count > FCS_VAR_BASE_INT_NUM_BYTES ; count--)
+    {
+        assert(data[count-1] == 0);
+    }
+    for (size_t count = ((data_len < FCS_VAR_BASE_INT_NUM_BYTES)
+        ? data_len : FCS_VAR_BASE_INT_NUM_BYTES) ; count > 0 ; count--)
+    {
+        ret = ((ret << 8) | data[count-1]);
+    }
+    s->data = ret;
+}
+
+static GCC_INLINE const int fc_solve_var_base_reader_read(
+    fcs_var_base_reader_t * const reader,
+    const int base
+)
+{
+    const fcs_var_base_int_t q = reader->data / (fcs_var_base_int_t)base;
+    const int r = (int)(reader->data - q * (fcs_var_base_int_t)base);
+
+    reader->data = q;
+
+    return r;
+}
+
+static GCC_INLINE void fc_solve_var_base_reader_release(
+    fcs_var_base_reader_t * s
+)
+{
+}
+
+#else
 
 typedef struct
 {
@@ -87,4 +142,6 @@ static GCC_INLINE void fc_solve_var_base_reader_release(
     mpz_clear(s->data_byte_offset);
 }
 
+#endif
+
 #endif /* FC_SOLVE__VAR_BASE_READER_H */
@@ -30,9 +30,84 @@
 #define FC_SOLVE__VAR_BASE_WRITER_H
 
 #include <assert.h>
-#include <gmp.h>
 
+#include "bool.h"
 #include "inline.h"
+#include "var_base_int.h"
+
+#ifdef FCS_VAR_BASE_USE_INT128
+
+typedef struct
+{
+    fcs_var_base_int_t data;
+    fcs_var_base_int_t multiplier;
+#ifndef NDEBUG
+    /* Set once the multiplier no longer fits, after which only zero
+     * digits may be written. */
+    fcs_bool_t overflowed;
+#endif
+} fcs_var_base_writer_t;
+
+static GCC_INLINE void fc_solve_var_base_writer_init(fcs_var_base_writer_t * const s)
+{
+}
+
+static GCC_INLINE void fc_solve_var_base_writer_start(fcs_var_base_writer_t * const s)
+{
+    s->data = 0;
+    s->multiplier = 1;
+#ifndef NDEBUG
+    s->overflowed = FALSE;
+#endif
+}
+
+static GCC_INLINE void fc_solve_var_base_writer_write(
+    fcs_var_base_writer_t * const w,
+    const int base,
+    const int item
+)
+{
+    assert(item >= 0);
+    assert(item < base);
+    assert((! w->overflowed) || (item == 0));
+    assert((item == 0) ||
+        (w->multiplier * (fcs_var_base_int_t)item
+            <= ~((fcs_var_base_int_t)0) - w->data));
+
+    w->data += w->multiplier * (fcs_var_base_int_t)item;
+
+#ifndef NDEBUG
+    if (w->multiplier > ~((fcs_var_base_int_t)0) / (fcs_var_base_int_t)base)
+    {
+        w->overflowed = TRUE;
+    }
+#endif
+    w->multiplier *= (fcs_var_base_int_t)base;
+}
+
+static GCC_INLINE const size_t fc_solve_var_base_writer_get_data(
+    fcs_var_base_writer_t * const w,
+    unsigned char * const exported
+)
+{
+    size_t count = 0;
+
+    for (fcs_var_base_int_t data = w->data ; data ; data >>= 8)
+    {
+        exported[count++] = (unsigned char)data;
+    }
+    w->data = 0;
+
+    return count;
+}
+
+static GCC_INLINE void fc_solve_var_base_writer_release(
+    fcs_var_base_writer_t * const w
+)
+{
+}
+
+#else
 
 typedef struct
 {
@@ -96,4 +171,6 @@ static GCC_INLINE void fc_solve_var_base_writer_release(
     mpz_clear(w->remainder);
 }
 
+#endif
+
 #endif /* FC_SOLVE__VAR_BASE_WRITER_H */